@@ -0,0 +1,118 @@
+# Engine, sound and platform sources shared by the firmware and the host build
+# (host/host.cmake). Paths are relative to the top-level source directory.
+
+# Doomgeneric sources
+file(GLOB DOOMGENERIC_SOURCES src/doomgeneric/doomgeneric/*.c)
+
+# Exclude platform specific and replaced files
+list(FILTER DOOMGENERIC_SOURCES EXCLUDE REGEX ".*doomgeneric_.*\\.c$") # Exclude all doomgeneric_*.c
+list(FILTER DOOMGENERIC_SOURCES EXCLUDE REGEX ".*i_.*\\.c$") # Exclude all i_*.c
+list(FILTER DOOMGENERIC_SOURCES EXCLUDE REGEX ".*w_file_stdc\\.c$")
+list(FILTER DOOMGENERIC_SOURCES EXCLUDE REGEX ".*m_misc\\.c$")
+
+# Add back necessary i_*.c files
+# We need i_video.c, i_timer.c, i_input.c, i_sound.c, i_endoom.c
+list(APPEND DOOMGENERIC_SOURCES
+    src/doomgeneric/doomgeneric/i_video.c
+    src/doomgeneric/doomgeneric/i_timer.c
+    src/doomgeneric/doomgeneric/i_input.c
+    src/doomgeneric/doomgeneric/i_sound.c
+    src/doomgeneric/doomgeneric/i_endoom.c
+    src/doomgeneric/doomgeneric/doomgeneric.c # Re-add doomgeneric.c if it was excluded
+    src/doomgeneric/doomgeneric/wi_stuff.c
+    src/pico/i_picosound.c
+    src/pico/i_oplmusic.c
+    src/midifile.c
+    src/opl/emu8950.c
+    src/opl/emuadpcm.c
+    src/opl/opl_api.c
+    src/opl/opl_pico.c
+    src/opl/opl_ima.c
+    src/opl/slot_render.cpp
+)
+
+# Remove duplicates
+list(REMOVE_DUPLICATES DOOMGENERIC_SOURCES)
+
+# Platform layer above the drivers (automap drawing, start screen, benchmark, frame hashes, input events,
+# interpolation and presentation, level read-ahead, patch spans, PSRAM calibration, SFX resampling,
+# sight cache and SRAM blockmap, game state snapshots, thinker pools, profiler, FatFs stdio)
+set(MURMDOOM_PLATFORM_SOURCES
+    src/doomgeneric_rp2350.c
+    src/murmdoom_amdraw.c
+    src/murmdoom_bench.c
+    src/murmdoom_console.c
+    src/murmdoom_framehash.c
+    src/murmdoom_input.c
+    src/murmdoom_interp.c
+    src/murmdoom_levelload.c
+    src/murmdoom_patchspan.c
+    src/murmdoom_present.c
+    src/murmdoom_psramcal.c
+    src/murmdoom_resample.c
+    src/murmdoom_sight.c
+    src/murmdoom_snapshot.c
+    src/murmdoom_thinkers.c
+    src/murmdoom_prof.c
+    src/doomgeneric_fatfs/w_file_fatfs.c
+    src/doomgeneric_fatfs/m_misc_fatfs.c
+    src/doomgeneric_fatfs/stdio_fatfs.c
+)
+
+set(MURMDOOM_INCLUDE_DIRS
+    src
+    src/doomgeneric/doomgeneric
+    src/pico
+    src/fatfs
+    src/opl
+    drivers
+    drivers/sdcard
+    drivers/ps2mouse
+)
+
+# Engine feature set; the firmware adds board, clock and EMU8950_ASM on top.
+set(MURMDOOM_FEATURE_DEFINITIONS
+    CMAP256
+    DOOMGENERIC_RESX=320
+    DOOMGENERIC_RESY=240
+    FEATURE_SOUND  # Enable sound support
+    USE_PICO_SOUND  # Use Pico audio i2s backend
+    USE_OPL_MUSIC=1  # Enable OPL music
+    USE_EMU8950_OPL=1  # Use emu8950 OPL emulator
+    NUM_SOUND_CHANNELS=16
+    NO_USE_LIBSAMPLERATE
+    NO_USE_TIMIDITY
+    NO_USE_GUS
+    NO_USE_MUSIC_PACKS
+    USE_DIRECT_MIDI_LUMP=0  # Use file-based MIDI (works, uses PSRAM allocation)
+    # EMU8950 optimizations from rp2040-doom
+    EMU8950_NO_WAVE_TABLE_MAP=1
+    EMU8950_NO_TLL=1
+    EMU8950_NO_FLOAT=1
+    EMU8950_NO_TIMER=1
+    EMU8950_NO_TEST_FLAG=1
+    EMU8950_SIMPLER_NOISE=1
+    EMU8950_SHORT_NOISE_UPDATE_CHECK=1
+    EMU8950_LINEAR_SKIP=1
+    EMU8950_LINEAR_END_OF_NOTE_OPTIMIZATION=1
+    EMU8950_NO_PERCUSSION_MODE=1
+    EMU8950_LINEAR=1
+    EMU8950_SLOT_RENDER=1
+    EMU8950_NO_RATECONV=1
+    MURMDOOM_VERSION="${MURMDOOM_VERSION}"
+    MURMDOOM_STDIO_BUFFER=${MURMDOOM_STDIO_BUFFER}
+    MURMDOOM_BLOCKMAP_SRAM=${MURMDOOM_BLOCKMAP_SRAM}
+)
+
+# Wrap stdio functions to use FatFS
+set(MURMDOOM_STDIO_WRAP_OPTIONS
+    -Wl,--wrap=fopen
+    -Wl,--wrap=fclose
+    -Wl,--wrap=fread
+    -Wl,--wrap=fgetc
+    -Wl,--wrap=fwrite
+    -Wl,--wrap=fseek
+    -Wl,--wrap=ftell
+    -Wl,--wrap=remove
+    -Wl,--wrap=rename
+)
@@ -0,0 +1,61 @@
+# Report the SRAM hot-code budget of a linked murmdoom ELF.
+#
+# Invoked by the murmdoom_sram_report target:
+#   cmake -DOBJDUMP=<objdump> -DELF=<murmdoom.elf> -DBUDGET=<bytes> -P sram_report.cmake
+
+if(NOT OBJDUMP OR NOT ELF)
+    message(FATAL_ERROR "sram_report: OBJDUMP and ELF must be set")
+endif()
+if(NOT BUDGET)
+    set(BUDGET 0)
+endif()
+
+execute_process(
+    COMMAND ${OBJDUMP} -t ${ELF}
+    OUTPUT_VARIABLE SYMTAB
+    RESULT_VARIABLE RC
+)
+if(NOT RC EQUAL 0)
+    message(FATAL_ERROR "sram_report: ${OBJDUMP} -t ${ELF} failed (${RC})")
+endif()
+
+string(REPLACE "\n" ";" LINES "${SYMTAB}")
+
+set(TOTAL 0)
+set(COUNT 0)
+set(ROWS "")
+foreach(LINE IN LISTS LINES)
+    # 20000180 l     F .murmdoom_hot	00000064 dma_handler_HDMI
+    if(LINE MATCHES "^([0-9a-fA-F]+) .* F \\.murmdoom_hot[ \t]+([0-9a-fA-F]+) (.+)$")
+        set(ADDR "${CMAKE_MATCH_1}")
+        math(EXPR SIZE "0x${CMAKE_MATCH_2}" OUTPUT_FORMAT DECIMAL)
+        set(NAME "${CMAKE_MATCH_3}")
+        math(EXPR TOTAL "${TOTAL} + ${SIZE}")
+        math(EXPR COUNT "${COUNT} + 1")
+        string(LENGTH "${SIZE}" SIZE_LEN)
+        set(PAD "")
+        if(SIZE_LEN LESS 6)
+            math(EXPR PAD_LEN "6 - ${SIZE_LEN}")
+            string(REPEAT " " ${PAD_LEN} PAD)
+        endif()
+        string(APPEND ROWS "  0x${ADDR} ${PAD}${SIZE}  ${NAME}\n")
+    endif()
+endforeach()
+
+message("SRAM hot code (.murmdoom_hot) in ${ELF}:")
+if(COUNT EQUAL 0)
+    message("  (no functions copied - was MURMDOOM_HOT_SRAM disabled?)")
+else()
+    message("  address       bytes  function\n${ROWS}")
+endif()
+
+if(BUDGET GREATER 0)
+    math(EXPR PCT "(${TOTAL} * 100) / ${BUDGET}")
+    message("Total: ${TOTAL} bytes in ${COUNT} functions, budget ${BUDGET} bytes (${PCT}%)")
+    if(TOTAL GREATER BUDGET)
+        math(EXPR OVER "${TOTAL} - ${BUDGET}")
+        message(FATAL_ERROR "SRAM hot code exceeds MURMDOOM_HOT_BUDGET by ${OVER} bytes")
+    endif()
+else()
+    message("Total: ${TOTAL} bytes in ${COUNT} functions")
+endif()
@@ -1,4 +1,5 @@
 #include "../src/board_config.h"
+#include "../src/murmdoom_hot.h"
 #include "HDMI.h"
 #include <stdio.h>
 #include <string.h>
@@ -18,12 +19,36 @@ int graphics_buffer_shift_x = 0;
 int graphics_buffer_shift_y = 0;
 enum graphics_mode_t hdmi_graphics_mode = GRAPHICSMODE_DEFAULT;
 
-static uint8_t *graphics_buffer = NULL;
+static uint8_t *volatile graphics_buffer = NULL;
+static uint8_t *volatile pending_buffer = NULL;
+static volatile uint32_t vsync_count = 0;
+static volatile uint32_t present_vsync = 0;
+static volatile uint32_t vsync_time_us = 0;
 
 void graphics_set_buffer(uint8_t *buffer) {
     graphics_buffer = buffer;
 }
 
+void graphics_present_buffer(uint8_t *buffer) {
+    pending_buffer = buffer;
+}
+
+bool graphics_present_pending(void) {
+    return pending_buffer != NULL;
+}
+
+uint32_t graphics_get_vsync_count(void) {
+    return vsync_count;
+}
+
+uint32_t graphics_get_present_vsync(void) {
+    return present_vsync;
+}
+
+uint32_t graphics_get_vsync_time_us(void) {
+    return vsync_time_us;
+}
+
 uint8_t* graphics_get_buffer(void) {
     return graphics_buffer;
 }
@@ -46,7 +71,7 @@ void graphics_set_shift(int x, int y) {
     graphics_buffer_shift_y = y;
 }
 
-uint8_t* get_line_buffer(int line) {
+uint8_t* __murmdoom_hot(get_line_buffer)(int line) {
     if (!graphics_buffer) return NULL;
     if (line < 0 || line >= graphics_buffer_height) return NULL;
     return graphics_buffer + line * graphics_buffer_width;
@@ -61,16 +86,26 @@ static struct video_mode_t video_mode[] = {
     }
 };
 
-struct video_mode_t graphics_get_video_mode(int mode) {
+struct video_mode_t __murmdoom_hot(graphics_get_video_mode)(int mode) {
     return video_mode[0];
 }
 
-int get_video_mode() {
+int __murmdoom_hot(get_video_mode)() {
     return 0;
 }
 
-void vsync_handler() {
-    // Optional: Add vsync callback if needed
+// Runs when the line counter wraps, before the first visible line is fetched.
+void __murmdoom_hot(vsync_handler)() {
+    vsync_time_us = time_us_32();
+    vsync_count++;
+    uint8_t *next = pending_buffer;
+    if (next) {
+        graphics_buffer = next;
+        pending_buffer = NULL;
+        present_vsync = vsync_count;
+    }
+    // Wake anything waiting for the refresh in WFE, on either core.
+    __sev();
 }
 
 // --- New HDMI Driver Code ---
@@ -225,7 +260,7 @@ static void pio_set_x(PIO pio, const int sm, uint32_t v) {
     pio_sm_exec(pio, sm, instr_mov);
 }
 
-static void dma_handler_HDMI() {
+static void __murmdoom_hot(dma_handler_HDMI)() {
     static uint32_t inx_buf_dma;
     static uint line = 0;
     struct video_mode_t mode = graphics_get_video_mode(get_video_mode());
@@ -54,6 +54,16 @@ enum graphics_mode_t {
 void graphics_init(g_out g_out);
 void graphics_set_buffer(uint8_t *buffer);
 uint8_t* graphics_get_buffer(void);
+// Switch to `buffer` at the start of the next refresh, so no frame tears.
+void graphics_present_buffer(uint8_t *buffer);
+// True while a buffer passed to graphics_present_buffer() waits for vsync.
+bool graphics_present_pending(void);
+// Refreshes since start-up, counted by the vsync interrupt.
+uint32_t graphics_get_vsync_count(void);
+// Value of graphics_get_vsync_count() when the last presented buffer went on screen.
+uint32_t graphics_get_present_vsync(void);
+// time_us_32() at the last vsync.
+uint32_t graphics_get_vsync_time_us(void);
 uint32_t graphics_get_width(void);
 uint32_t graphics_get_height(void);
 void graphics_set_res(int w, int h);
@@ -61,6 +61,9 @@ public:
     std::function<void(hid_keyboard_report_t *curr, hid_keyboard_report_t *prev)> keyHandler);
   
   void init_gpio();
+
+  // State machine claimed by init_gpio(), for enabling its RX interrupt.
+  uint sm() const { return _sm; }
   
   void __not_in_flash_func(tick)();
 };
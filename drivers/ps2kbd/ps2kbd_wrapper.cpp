@@ -2,14 +2,8 @@
 #include "ps2kbd_wrapper.h"
 #include "ps2kbd_mrmltr.h"
 #include "doomkeys.h"
-#include <queue>
-
-struct KeyEvent {
-    int pressed;
-    unsigned char key;
-};
-
-static std::queue<KeyEvent> event_queue;
+#include "murmdoom_input.h"
+#include "hardware/irq.h"
 
 // HID to Doom mapping (partial)
 static unsigned char hid_to_doom(uint8_t code) {
@@ -23,6 +17,7 @@ static unsigned char hid_to_doom(uint8_t code) {
     if (code == 0x2A) return KEY_BACKSPACE;
     if (code == 0x2B) return KEY_TAB;
     if (code == 0x2C) return KEY_USE;  // Space key mapped to USE action
+    if (code == 0x35) return '`';      // Grave: profiler overlay toggle
     if (code == 0x4F) return KEY_RIGHTARROW;
     if (code == 0x50) return KEY_LEFTARROW;
     if (code == 0x51) return KEY_DOWNARROW;
@@ -46,17 +41,17 @@ static void key_handler(hid_keyboard_report_t *curr, hid_keyboard_report_t *prev
         // Map Ctrl (left or right) to KEY_FIRE for shooting
         if (changed_mods & (KEYBOARD_MODIFIER_LEFTCTRL | KEYBOARD_MODIFIER_RIGHTCTRL)) {
             int ctrl_pressed = (curr->modifier & (KEYBOARD_MODIFIER_LEFTCTRL | KEYBOARD_MODIFIER_RIGHTCTRL)) != 0;
-            event_queue.push({ctrl_pressed, KEY_FIRE});  // Changed from KEY_RCTRL to KEY_FIRE
+            input_key(ctrl_pressed, KEY_FIRE);  // Changed from KEY_RCTRL to KEY_FIRE
         }
         // Map Shift to Shift (for running)
         if (changed_mods & (KEYBOARD_MODIFIER_LEFTSHIFT | KEYBOARD_MODIFIER_RIGHTSHIFT)) {
             int shift_pressed = (curr->modifier & (KEYBOARD_MODIFIER_LEFTSHIFT | KEYBOARD_MODIFIER_RIGHTSHIFT)) != 0;
-            event_queue.push({shift_pressed, KEY_RSHIFT});
+            input_key(shift_pressed, KEY_RSHIFT);
         }
         // Map Alt to Alt (for strafing)
         if (changed_mods & (KEYBOARD_MODIFIER_LEFTALT | KEYBOARD_MODIFIER_RIGHTALT)) {
             int alt_pressed = (curr->modifier & (KEYBOARD_MODIFIER_LEFTALT | KEYBOARD_MODIFIER_RIGHTALT)) != 0;
-            event_queue.push({alt_pressed, KEY_RALT});
+            input_key(alt_pressed, KEY_RALT);
         }
     }
 
@@ -72,7 +67,7 @@ static void key_handler(hid_keyboard_report_t *curr, hid_keyboard_report_t *prev
             }
             if (!found) {
                 unsigned char k = hid_to_doom(curr->keycode[i]);
-                if (k) event_queue.push({1, k});
+                if (k) input_key(1, k);
             }
         }
     }
@@ -88,7 +83,7 @@ static void key_handler(hid_keyboard_report_t *curr, hid_keyboard_report_t *prev
             }
             if (!found) {
                 unsigned char k = hid_to_doom(prev->keycode[i]);
-                if (k) event_queue.push({0, k});
+                if (k) input_key(0, k);
             }
         }
     }
@@ -96,23 +91,21 @@ static void key_handler(hid_keyboard_report_t *curr, hid_keyboard_report_t *prev
 
 static Ps2Kbd_Mrmltr* kbd = nullptr;
 
+static void __not_in_flash_func(ps2kbd_irq)(void) {
+    kbd->tick();
+}
+
 extern "C" void ps2kbd_init(void) {
     // PS2 keyboard driver expects base_gpio as CLK, and base_gpio+1 as DATA
     // For M1: PS2_PIN_CLK=0, PS2_PIN_DATA=1, so base should be PS2_PIN_CLK
     // For M2: PS2_PIN_CLK=2, PS2_PIN_DATA=3, so base should be PS2_PIN_CLK
     kbd = new Ps2Kbd_Mrmltr(pio0, PS2_PIN_CLK, key_handler);
     kbd->init_gpio();
-}
-
-extern "C" void ps2kbd_tick(void) {
-    if (kbd) kbd->tick();
-}
 
-extern "C" int ps2kbd_get_key(int* pressed, unsigned char* key) {
-    if (event_queue.empty()) return 0;
-    KeyEvent e = event_queue.front();
-    event_queue.pop();
-    *pressed = e.pressed;
-    *key = e.key;
-    return 1;
+    // Decode scan codes as they arrive rather than when the game loop next
+    // polls: the state machine raises PIO0_IRQ_0 while its RX FIFO is not
+    // empty, and tick() drains it.
+    pio_set_irq0_source_enabled(pio0, (pio_interrupt_source)(pis_sm0_rx_fifo_not_empty + kbd->sm()), true);
+    irq_set_exclusive_handler(PIO0_IRQ_0, ps2kbd_irq);
+    irq_set_enabled(PIO0_IRQ_0, true);
 }
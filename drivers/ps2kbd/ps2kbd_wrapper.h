@@ -5,9 +5,8 @@
 extern "C" {
 #endif
 
+// Key events go to the input ring (murmdoom_input.h) from the PIO interrupt.
 void ps2kbd_init(void);
-void ps2kbd_tick(void);
-int ps2kbd_get_key(int* pressed, unsigned char* key);
 
 #ifdef __cplusplus
 }
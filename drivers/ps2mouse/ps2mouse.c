@@ -7,10 +7,18 @@
 #include <pico/stdlib.h>
 #include <hardware/gpio.h>
 #include <hardware/irq.h>
+#include <hardware/sync.h>
+#include <hardware/pio.h>
+#include <hardware/dma.h>
+#include <hardware/clocks.h>
+#include "ps2mouse.pio.h"
 #include <string.h>
 #include <stdio.h>
 
-// Use GPIO interrupt-based approach (PIO is used by keyboard)
+// Initialization talks to the mouse by bit-banging GPIO, with a falling-edge
+// IRQ per clock for the responses; from then on bytes are received by PIO+DMA
+// (see below), falling back to the GPIO IRQ if no state machine or DMA
+// channel is free.
 
 #define MOUSE_CLK_PIN   PS2_MOUSE_CLK
 #define MOUSE_DATA_PIN  PS2_MOUSE_DATA
@@ -58,6 +66,19 @@ static uint8_t packet_data[4];
 static uint8_t packet_index = 0;
 static uint8_t packet_size = 3;  // 3 for standard, 4 for IntelliMouse
 
+// Packet consumer; while set (and initialized), bytes are parsed in the IRQ
+// (the DMA IRQ, or the GPIO one as a fallback)
+static volatile ps2mouse_packet_fn packet_handler = NULL;
+
+// IRQs taken (one per clock edge on GPIO, one per DMA transfer on PIO),
+// valid packets, frames with a bad stop or parity bit
+static volatile uint32_t stat_irqs = 0;
+static volatile uint32_t stat_packets = 0;
+static volatile uint32_t stat_errors = 0;
+static int mouse_pio_active = 0;
+
+static void feed_byte(uint8_t byte);
+
 //-----------------------------------------------------------------------------
 // Low-level GPIO helpers
 //-----------------------------------------------------------------------------
@@ -225,6 +246,7 @@ done:
 
 static void __not_in_flash_func(mouse_gpio_callback)(uint gpio, uint32_t events) {
     if (gpio != MOUSE_CLK_PIN) return;
+    stat_irqs++;
     
     // Small delay to ensure data line is stable after clock edge
     // At 504 MHz, a few NOPs give ~10-20ns settling time
@@ -249,6 +271,12 @@ static void __not_in_flash_func(mouse_gpio_callback)(uint gpio, uint32_t events)
     
     // Complete byte received (11 bits: start + 8 data + parity + stop)
     if (mouse_bitcount == 11) {
+        if (packet_handler && mouse_state.initialized) {
+            feed_byte(mouse_incoming);
+            mouse_bitcount = 0;
+            mouse_incoming = 0;
+            return;
+        }
         // Add to circular buffer
         uint8_t next_head = (mouse_buffer_head + 1) % MOUSE_BUFFER_SIZE;
         if (next_head != mouse_buffer_tail) {
@@ -260,6 +288,119 @@ static void __not_in_flash_func(mouse_gpio_callback)(uint gpio, uint32_t events)
     }
 }
 
+//-----------------------------------------------------------------------------
+// PIO + DMA receiver
+//
+// Once initialized the mouse only sends, so the per-bit GPIO IRQ (11 per
+// byte) is replaced: a PIO state machine frames whole bytes and a DMA channel
+// lands them in a ring, raising one IRQ when the rest of the current packet
+// has arrived. A frame with a bad stop or parity bit means the state machine
+// missed a clock edge and is out of step; it is stopped and restarted once
+// the packet is over.
+//-----------------------------------------------------------------------------
+
+#define MOUSE_PIO pio0              // pio1 runs HDMI and I2S audio
+#define MOUSE_DMA_IRQ DMA_IRQ_2     // DMA_IRQ_0 is HDMI, DMA_IRQ_1 I2S audio
+#define MOUSE_DMA_IRQ_INDEX 2
+#define DMA_RING_WORDS 16
+#define RESYNC_US 5000              // longer than the rest of any packet
+
+static uint32_t dma_ring[DMA_RING_WORDS] __attribute__((aligned(DMA_RING_WORDS * 4)));
+static int mouse_sm = -1;
+static uint mouse_offset;
+static int mouse_dma = -1;
+static uint32_t dma_read = 0;       // next ring word to parse
+static uint32_t dma_armed = 0;      // words in the transfer in flight
+
+static inline int frame_ok(uint32_t frame) {
+    // Stop bit set, odd parity over data and parity bits
+    return (frame >> 31) && __builtin_parity((frame >> 22) & 0x1ff);
+}
+
+static inline void dma_arm(uint32_t words) {
+    dma_armed = words;
+    dma_channel_set_trans_count(mouse_dma, words, true);
+}
+
+static int64_t resync_alarm(alarm_id_t id, void *user_data) {
+    (void)id;
+    (void)user_data;
+    // Still clocking: try again in a millisecond
+    if (!gpio_get(MOUSE_CLK_PIN)) return 1000;
+    pio_sm_clear_fifos(MOUSE_PIO, mouse_sm);
+    pio_sm_restart(MOUSE_PIO, mouse_sm);
+    pio_sm_exec(MOUSE_PIO, mouse_sm, pio_encode_jmp(mouse_offset));
+    packet_index = 0;
+    dma_read = 0;
+    dma_channel_set_write_addr(mouse_dma, dma_ring, false);
+    dma_arm(packet_size);
+    pio_sm_set_enabled(MOUSE_PIO, mouse_sm, true);
+    return 0;
+}
+
+static void __not_in_flash_func(mouse_dma_irq)(void) {
+    dma_irqn_acknowledge_channel(MOUSE_DMA_IRQ_INDEX, mouse_dma);
+    stat_irqs++;
+    
+    for (uint32_t i = 0; i < dma_armed; i++) {
+        uint32_t frame = dma_ring[dma_read++ % DMA_RING_WORDS];
+        if (!frame_ok(frame)) {
+            stat_errors++;
+            pio_sm_set_enabled(MOUSE_PIO, mouse_sm, false);
+            add_alarm_in_us(RESYNC_US, resync_alarm, NULL, true);
+            return;
+        }
+        feed_byte((uint8_t)(frame >> 22));
+    }
+    
+    // Skipped bytes (ACKs, resync) leave the packet short; wait for the rest
+    dma_arm(packet_size - packet_index);
+}
+
+static int mouse_pio_start(void) {
+    if (!pio_can_add_program(MOUSE_PIO, &ps2mouse_program)) return 0;
+    mouse_sm = pio_claim_unused_sm(MOUSE_PIO, false);
+    if (mouse_sm < 0) return 0;
+    mouse_dma = dma_claim_unused_channel(false);
+    if (mouse_dma < 0) {
+        pio_sm_unclaim(MOUSE_PIO, mouse_sm);
+        return 0;
+    }
+    mouse_offset = pio_add_program(MOUSE_PIO, &ps2mouse_program);
+    
+    pio_sm_set_consecutive_pindirs(MOUSE_PIO, mouse_sm, MOUSE_CLK_PIN, 1, false);
+    pio_sm_set_consecutive_pindirs(MOUSE_PIO, mouse_sm, MOUSE_DATA_PIN, 1, false);
+    pio_sm_config c = ps2mouse_program_get_default_config(mouse_offset);
+    sm_config_set_in_pins(&c, MOUSE_DATA_PIN);
+    sm_config_set_jmp_pin(&c, MOUSE_CLK_PIN);
+    // Shift right, autopush at 10 bits
+    sm_config_set_in_shift(&c, true, true, 10);
+    sm_config_set_fifo_join(&c, PIO_FIFO_JOIN_RX);
+    // As the keyboard: no less than 8 SM cycles per 16.7 kHz clock
+    sm_config_set_clkdiv(&c, (float)clock_get_hz(clk_sys) / (8 * 16700));
+    pio_sm_init(MOUSE_PIO, mouse_sm, mouse_offset, &c);
+    
+    dma_channel_config d = dma_channel_get_default_config(mouse_dma);
+    channel_config_set_transfer_data_size(&d, DMA_SIZE_32);
+    channel_config_set_read_increment(&d, false);
+    channel_config_set_write_increment(&d, true);
+    channel_config_set_ring(&d, true, __builtin_ctz(sizeof(dma_ring)));
+    channel_config_set_dreq(&d, pio_get_dreq(MOUSE_PIO, mouse_sm, false));
+    dma_channel_configure(mouse_dma, &d, dma_ring, &MOUSE_PIO->rxf[mouse_sm], packet_size, false);
+    dma_read = 0;
+    dma_armed = packet_size;
+    packet_index = 0;
+    
+    dma_irqn_set_channel_enabled(MOUSE_DMA_IRQ_INDEX, mouse_dma, true);
+    irq_set_exclusive_handler(MOUSE_DMA_IRQ, mouse_dma_irq);
+    irq_set_enabled(MOUSE_DMA_IRQ, true);
+    
+    mouse_irq_off();
+    dma_channel_start(mouse_dma);
+    pio_sm_set_enabled(MOUSE_PIO, mouse_sm, true);
+    return 1;
+}
+
 //-----------------------------------------------------------------------------
 // Get byte from buffer
 //-----------------------------------------------------------------------------
@@ -277,7 +418,7 @@ static int mouse_buffer_get(uint8_t *byte) {
 // Process a complete mouse packet
 //-----------------------------------------------------------------------------
 
-static void process_mouse_packet(void) {
+static void __not_in_flash_func(process_mouse_packet)(void) {
     uint8_t status = packet_data[0];
     
     // PS/2 mouse status byte bit 3 should always be 1 (sync bit)
@@ -312,6 +453,12 @@ static void process_mouse_packet(void) {
         if (wheel < -8) wheel = -8;
     }
     
+    stat_packets++;
+    if (packet_handler) {
+        packet_handler(dx, dy, wheel, buttons);
+        return;
+    }
+
     // Accumulate movement
     mouse_state.delta_x += dx;
     mouse_state.delta_y += dy;
@@ -400,9 +547,38 @@ void ps2mouse_init(void) {
     while (mouse_buffer_get(&dummy)) {}
     
     mouse_state.initialized = 1;
+    mouse_pio_active = mouse_pio_start();
+    
+    printf("PS/2 Mouse initialized%s, %s\n", 
+           mouse_state.has_wheel ? " (IntelliMouse with wheel)" : "",
+           mouse_pio_active ? "PIO+DMA" : "GPIO IRQ");
+}
+
+//-----------------------------------------------------------------------------
+// Add a byte to the packet being assembled
+//-----------------------------------------------------------------------------
+
+static void __not_in_flash_func(feed_byte)(uint8_t byte) {
+    // Skip ACK bytes
+    if (byte == MOUSE_RESP_ACK) return;
+    
+    // If this is the first byte of a packet, validate it
+    // The status byte (first byte) must have bit 3 set (always 1 sync bit)
+    if (packet_index == 0) {
+        if (!(byte & 0x08)) {
+            // Invalid first byte - skip it and try to resync
+            return;
+        }
+    }
     
-    printf("PS/2 Mouse initialized%s\n", 
-           mouse_state.has_wheel ? " (IntelliMouse with wheel)" : "");
+    // Add byte to packet
+    packet_data[packet_index++] = byte;
+    
+    // Check for complete packet
+    if (packet_index >= packet_size) {
+        process_mouse_packet();
+        packet_index = 0;
+    }
 }
 
 //-----------------------------------------------------------------------------
@@ -413,29 +589,23 @@ void ps2mouse_poll(void) {
     uint8_t byte;
     
     while (mouse_buffer_get(&byte)) {
-        // Skip ACK bytes
-        if (byte == MOUSE_RESP_ACK) continue;
-        
-        // If this is the first byte of a packet, validate it
-        // The status byte (first byte) must have bit 3 set (always 1 sync bit)
-        if (packet_index == 0) {
-            if (!(byte & 0x08)) {
-                // Invalid first byte - skip it and try to resync
-                continue;
-            }
-        }
-        
-        // Add byte to packet
-        packet_data[packet_index++] = byte;
-        
-        // Check for complete packet
-        if (packet_index >= packet_size) {
-            process_mouse_packet();
-            packet_index = 0;
-        }
+        feed_byte(byte);
     }
 }
 
+//-----------------------------------------------------------------------------
+// Hand packets over to the IRQ
+//-----------------------------------------------------------------------------
+
+void ps2mouse_set_packet_handler(ps2mouse_packet_fn fn) {
+    // Finish what is buffered before the IRQ starts parsing; a clock edge
+    // meanwhile stays pending for the few microseconds this takes
+    uint32_t save = save_and_disable_interrupts();
+    packet_handler = fn;
+    ps2mouse_poll();
+    restore_interrupts(save);
+}
+
 //-----------------------------------------------------------------------------
 // Get accumulated mouse state
 //-----------------------------------------------------------------------------
@@ -464,3 +634,10 @@ int ps2mouse_get_state(int16_t *dx, int16_t *dy, int8_t *wheel, uint8_t *buttons
 int ps2mouse_is_initialized(void) {
     return mouse_state.initialized;
 }
+
+void ps2mouse_get_stats(ps2mouse_stats_t *stats) {
+    stats->irqs = stat_irqs;
+    stats->packets = stat_packets;
+    stats->errors = stat_errors;
+    stats->pio = mouse_pio_active;
+}
@@ -21,9 +21,16 @@ typedef struct {
     int     initialized;  // True if mouse detected and initialized
 } ps2mouse_state_t;
 
+// Called with each complete packet
+typedef void (*ps2mouse_packet_fn)(int16_t dx, int16_t dy, int8_t wheel, uint8_t buttons);
+
 // Initialize the PS/2 mouse driver
 void ps2mouse_init(void);
 
+// Once initialized, parse packets in the clock interrupt and hand each one to
+// fn instead of accumulating them for ps2mouse_get_state()
+void ps2mouse_set_packet_handler(ps2mouse_packet_fn fn);
+
 // Poll for mouse data (call regularly from main loop)
 void ps2mouse_poll(void);
 
@@ -34,6 +41,16 @@ int ps2mouse_get_state(int16_t *dx, int16_t *dy, int8_t *wheel, uint8_t *buttons
 // Check if mouse is initialized
 int ps2mouse_is_initialized(void);
 
+// Running counts since init
+typedef struct {
+    uint32_t irqs;        // one per clock edge on GPIO, one per DMA transfer on PIO
+    uint32_t packets;     // valid packets decoded
+    uint32_t errors;      // PIO frames with a bad stop or parity bit
+    int      pio;         // receiving through PIO+DMA
+} ps2mouse_stats_t;
+
+void ps2mouse_get_stats(ps2mouse_stats_t *stats);
+
 #ifdef __cplusplus
 }
 #endif
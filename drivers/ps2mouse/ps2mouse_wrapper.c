@@ -2,74 +2,55 @@
 // Interfaces ps2mouse driver with DOOM's event system
 // SPDX-License-Identifier: GPL-2.0-or-later
 
-// Include d_event.h first - it pulls in doomtype.h which defines its own boolean type
-// This must come before ps2mouse.h which uses stdbool.h
-#include "d_event.h"
 #include "ps2mouse_wrapper.h"
 #include "ps2mouse.h"
+#include "murmdoom_console.h"
+#include "murmdoom_input.h"
+#include <pico/stdlib.h>
 #include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+// Counts at the last "ps2mouse reset", for rates
+static ps2mouse_stats_t stats_base;
+static uint32_t stats_base_us;
+
+// Runs in the mouse IRQ (DMA, or GPIO clock edge as a fallback). Motion is
+// accumulated and posted once per tic by input_tic(), clamped and scaled there.
+static void __not_in_flash_func(mouse_packet)(int16_t dx, int16_t dy, int8_t wheel, uint8_t buttons) {
+    (void)wheel;
+    // PS/2 button mapping matches DOOM: bit 0 = left, bit 1 = right, bit 2 = middle
+    // PS/2 X is positive when moving right, Y when moving UP (away from user),
+    // as DOOM expects for turn and forward motion
+    input_mouse(dx, dy, buttons & 0x07);
+}
 
-// External DOOM function to post events
-extern void D_PostEvent(event_t *ev);
-
-// Mouse sensitivity multiplier (increase for faster response)
-#define MOUSE_SENSITIVITY_MULT 2
-
-// Maximum delta per tick to prevent abrupt jumps
-#define MOUSE_MAX_DELTA 40
-
-// Track previous button state to detect changes
-static uint8_t prev_buttons = 0;
-
-// Clamp value to range
-static inline int16_t clamp_delta(int16_t val, int16_t max_val) {
-    if (val > max_val) return max_val;
-    if (val < -max_val) return -max_val;
-    return val;
+static void ps2mouse_command(int argc, char **argv) {
+    ps2mouse_stats_t now;
+    ps2mouse_get_stats(&now);
+    if (argc > 1 && !strcmp(argv[1], "reset")) {
+        stats_base = now;
+        stats_base_us = time_us_32();
+        printf("ps2mouse: reset\n");
+        return;
+    }
+    
+    const uint32_t elapsed_ms = (time_us_32() - stats_base_us) / 1000;
+    const uint32_t irqs = now.irqs - stats_base.irqs;
+    const uint32_t packets = now.packets - stats_base.packets;
+    printf("ps2mouse: %s, %lu packets, %lu IRQs in %lu ms (%lu IRQs/s, %lu.%lu per packet), %lu framing errors\n",
+           now.pio ? "PIO+DMA" : "GPIO IRQ", (unsigned long)packets, (unsigned long)irqs,
+           (unsigned long)elapsed_ms, (unsigned long)(elapsed_ms ? (uint64_t)irqs * 1000 / elapsed_ms : 0),
+           (unsigned long)(packets ? irqs / packets : 0),
+           (unsigned long)(packets ? irqs * 10 / packets % 10 : 0),
+           (unsigned long)(now.errors - stats_base.errors));
 }
 
 void ps2mouse_wrapper_init(void) {
     ps2mouse_init();
-    prev_buttons = 0;
-}
-
-void ps2mouse_wrapper_tick(void) {
-    int16_t dx, dy;
-    int8_t wheel;
-    uint8_t buttons;
-    
-    // Get accumulated mouse movement
-    int has_motion = ps2mouse_get_state(&dx, &dy, &wheel, &buttons);
-    
-    // Only post event if there's actual motion or button change
-    // DOOM expects: data1 = buttons, data2 = X motion (turn), data3 = Y motion (forward)
-    if (has_motion || buttons != prev_buttons) {
-        event_t ev;
-        ev.type = ev_mouse;
-        
-        // PS/2 button mapping matches DOOM: bit 0 = left, bit 1 = right, bit 2 = middle
-        // Only include button state, mask off any other bits
-        ev.data1 = buttons & 0x07;
-        
-        // Clamp deltas to prevent abrupt movements from noise or fast flicks
-        dx = clamp_delta(dx, MOUSE_MAX_DELTA);
-        dy = clamp_delta(dy, MOUSE_MAX_DELTA);
-        
-        // X motion = turn (positive = turn right)
-        // PS/2 X is positive when moving right
-        // Apply sensitivity multiplier
-        ev.data2 = dx * MOUSE_SENSITIVITY_MULT;
-        
-        // Y motion = forward/backward
-        // PS/2 Y is positive when moving UP (away from user)
-        // DOOM expects positive = forward, negative = backward
-        // Apply sensitivity multiplier
-        ev.data3 = dy * MOUSE_SENSITIVITY_MULT;
-        
-        ev.data4 = 0;
-        
-        D_PostEvent(&ev);
-        
-        prev_buttons = buttons & 0x07;
-    }
+    ps2mouse_set_packet_handler(mouse_packet);
+    ps2mouse_get_stats(&stats_base);
+    stats_base_us = time_us_32();
+    murmdoom_console_register("ps2mouse", "[reset] PS/2 mouse receiver, packets and IRQs per packet",
+                              ps2mouse_command);
 }
@@ -10,12 +10,9 @@ extern "C" {
 #endif
 
 // Initialize PS/2 mouse for DOOM
+// Packets go to the input accumulator (murmdoom_input.h) from the mouse IRQ
 void ps2mouse_wrapper_init(void);
 
-// Poll mouse and post events to DOOM
-// Call this from the main game loop
-void ps2mouse_wrapper_tick(void);
-
 #ifdef __cplusplus
 }
 #endif
@@ -11,8 +11,6 @@
 #endif
 
 void __no_inline_not_in_flash_func(psram_init)(uint cs_pin) {
-    const int clock_hz = clock_get_hz(clk_sys); 
-
     gpio_set_function(cs_pin, GPIO_FUNC_XIP_CS1);
 
     qmi_hw->direct_csr = 10 << QMI_DIRECT_CSR_CLKDIV_LSB | 
@@ -25,31 +23,9 @@ void __no_inline_not_in_flash_func(psram_init)(uint cs_pin) {
     while (qmi_hw->direct_csr & QMI_DIRECT_CSR_BUSY_BITS);
 
 
-    const int max_psram_freq = PSRAM_MAX_FREQ_MHZ * 1000000; 
-    
-    int divisor = (clock_hz + max_psram_freq - 1) / max_psram_freq;
-    if (divisor == 1 && clock_hz > 100000000) {
-        divisor = 2;
-    }
-    
-    int rxdelay = divisor;
-    if (clock_hz / divisor > 100000000) {
-        rxdelay += 1; 
-    }
-
-    const int clock_period_fs = 1000000000000000ll / clock_hz;
-    
-    const int max_select_val = (125 * 1000000) / clock_period_fs;
-
-    const int min_deselect = (18 * 1000000 + (clock_period_fs - 1)) / clock_period_fs - (divisor + 1) / 2;
-
-    qmi_hw->m[1].timing = 
-        1 << QMI_M1_TIMING_COOLDOWN_LSB | 
-        QMI_M1_TIMING_PAGEBREAK_VALUE_1024 << QMI_M1_TIMING_PAGEBREAK_LSB | 
-        max_select_val << QMI_M1_TIMING_MAX_SELECT_LSB | 
-        min_deselect << QMI_M1_TIMING_MIN_DESELECT_LSB | 
-        rxdelay << QMI_M1_TIMING_RXDELAY_LSB | 
-        divisor << QMI_M1_TIMING_CLKDIV_LSB;
+    psram_timing_t timing;
+    psram_default_timing(&timing);
+    psram_set_timing(&timing);
 
     qmi_hw->m[1].rfmt =
         QMI_M0_RFMT_PREFIX_WIDTH_VALUE_Q << QMI_M0_RFMT_PREFIX_WIDTH_LSB | 
@@ -76,3 +52,70 @@ void __no_inline_not_in_flash_func(psram_init)(uint cs_pin) {
     
     hw_set_bits(&xip_ctrl_hw->ctrl, XIP_CTRL_WRITABLE_M1_BITS);
 }
+
+void psram_default_timing(psram_timing_t *t) {
+    const int clock_hz = clock_get_hz(clk_sys);
+    const int max_psram_freq = PSRAM_MAX_FREQ_MHZ * 1000000;
+
+    int divisor = (clock_hz + max_psram_freq - 1) / max_psram_freq;
+    if (divisor == 1 && clock_hz > 100000000) {
+        divisor = 2;
+    }
+
+    int rxdelay = divisor;
+    if (clock_hz / divisor > 100000000) {
+        rxdelay += 1;
+    }
+
+    t->clkdiv = divisor;
+    t->rxdelay = rxdelay;
+    t->cooldown = 1;
+}
+
+void psram_get_timing(psram_timing_t *t) {
+    const uint32_t timing = qmi_hw->m[1].timing;
+    t->clkdiv = (timing & QMI_M1_TIMING_CLKDIV_BITS) >> QMI_M1_TIMING_CLKDIV_LSB;
+    t->rxdelay = (timing & QMI_M1_TIMING_RXDELAY_BITS) >> QMI_M1_TIMING_RXDELAY_LSB;
+    t->cooldown = (timing & QMI_M1_TIMING_COOLDOWN_BITS) >> QMI_M1_TIMING_COOLDOWN_LSB;
+}
+
+void __no_inline_not_in_flash_func(psram_set_timing)(const psram_timing_t *t) {
+    const int clock_hz = clock_get_hz(clk_sys);
+    const int divisor = t->clkdiv;
+
+    const int clock_period_fs = 1000000000000000ll / clock_hz;
+
+    const int max_select_val = (125 * 1000000) / clock_period_fs;
+
+    const int min_deselect = (18 * 1000000 + (clock_period_fs - 1)) / clock_period_fs - (divisor + 1) / 2;
+
+    qmi_hw->m[1].timing =
+        t->cooldown << QMI_M1_TIMING_COOLDOWN_LSB |
+        QMI_M1_TIMING_PAGEBREAK_VALUE_1024 << QMI_M1_TIMING_PAGEBREAK_LSB |
+        max_select_val << QMI_M1_TIMING_MAX_SELECT_LSB |
+        min_deselect << QMI_M1_TIMING_MIN_DESELECT_LSB |
+        t->rxdelay << QMI_M1_TIMING_RXDELAY_LSB |
+        divisor << QMI_M1_TIMING_CLKDIV_LSB;
+}
+
+// One command byte in direct mode, CS held around it.
+static void __no_inline_not_in_flash_func(psram_direct_cmd)(uint32_t tx) {
+    qmi_hw->direct_csr |= QMI_DIRECT_CSR_ASSERT_CS1N_BITS;
+    qmi_hw->direct_tx = QMI_DIRECT_TX_NOPUSH_BITS | tx;
+    while (qmi_hw->direct_csr & QMI_DIRECT_CSR_BUSY_BITS);
+    qmi_hw->direct_csr &= ~QMI_DIRECT_CSR_ASSERT_CS1N_BITS;
+}
+
+void __no_inline_not_in_flash_func(psram_reset_device)(void) {
+    qmi_hw->direct_csr = 10 << QMI_DIRECT_CSR_CLKDIV_LSB | QMI_DIRECT_CSR_EN_BITS;
+    while (qmi_hw->direct_csr & QMI_DIRECT_CSR_BUSY_BITS);
+
+    // Leave QPI mode (sent as quad; a chip in SPI mode sees half a command
+    // and ignores it), reset, then back into QPI as psram_init does.
+    psram_direct_cmd(QMI_DIRECT_TX_OE_BITS | QMI_DIRECT_TX_IWIDTH_VALUE_Q << QMI_DIRECT_TX_IWIDTH_LSB | 0xF5);
+    psram_direct_cmd(0x66);
+    psram_direct_cmd(0x99);
+    psram_direct_cmd(0x35);
+
+    qmi_hw->direct_csr = 0;
+}
@@ -3,6 +3,34 @@
 
 #include "pico/stdlib.h"
 
+// PSRAM (CS1) through the XIP cache, where psram_malloc hands out memory,
+// and the same bytes with the cache bypassed.
+#define PSRAM_CACHED_BASE 0x11000000u
+#if PICO_ON_DEVICE
+#define PSRAM_UNCACHED_BASE 0x15000000u
+#else
+#define PSRAM_UNCACHED_BASE PSRAM_CACHED_BASE
+#endif
+
+// QMI M1 timing fields that decide how fast PSRAM runs.
+typedef struct {
+    uint8_t clkdiv;     // SCK = clk_sys / clkdiv
+    uint8_t rxdelay;    // read data sampled this many half clk_sys cycles late
+    uint8_t cooldown;   // CS held 64 * cooldown clk_sys cycles for sequential reads
+} psram_timing_t;
+
+#define PSRAM_RXDELAY_MAX 7
+#define PSRAM_COOLDOWN_MAX 3
+
 void psram_init(uint cs_pin);
 
+// Timing psram_init uses, derived from PSRAM_MAX_FREQ_MHZ and clk_sys.
+void psram_default_timing(psram_timing_t *t);
+void psram_get_timing(psram_timing_t *t);
+// Only while nothing else is accessing PSRAM.
+void psram_set_timing(const psram_timing_t *t);
+// Reset the chip and put it back in QPI mode, e.g. after a clock it could not
+// follow garbled a command.
+void psram_reset_device(void);
+
 #endif
@@ -13,6 +13,7 @@
 
 #include "ff.h"
 #include "diskio.h"
+#include "../../src/murmdoom_prof.h"
 
 
 /*--------------------------------------------------------------------------
@@ -428,6 +429,8 @@ DRESULT disk_read (
 	UINT count		/* Number of sectors to read (1..128) */
 )
 {
+	PROF_SCOPE(PROF_DISK);
+
 	if (drv || !count) return RES_PARERR;		/* Check parameter */
 	if (Stat & STA_NOINIT) return RES_NOTRDY;	/* Check if drive is ready */
 
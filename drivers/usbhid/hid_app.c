@@ -33,41 +33,14 @@ static hid_keyboard_report_t prev_kbd_report = { 0, 0, {0} };
 // Previous mouse report for detecting button changes  
 static hid_mouse_report_t prev_mouse_report = { 0 };
 
-// Accumulated mouse movement
-static volatile int16_t cumulative_dx = 0;
-static volatile int16_t cumulative_dy = 0;
-static volatile int8_t cumulative_wheel = 0;
-static volatile uint8_t current_buttons = 0;
-static volatile int mouse_has_motion = 0;
-
 // Device connection state
 static volatile int keyboard_connected = 0;
 static volatile int mouse_connected = 0;
 
-// Key action queue (for detecting press/release)
-#define KEY_ACTION_QUEUE_SIZE 32
-typedef struct {
-    uint8_t keycode;
-    int down;
-} key_action_t;
-
-static key_action_t key_action_queue[KEY_ACTION_QUEUE_SIZE];
-static volatile int key_action_head = 0;
-static volatile int key_action_tail = 0;
-
 //--------------------------------------------------------------------
 // Internal functions
 //--------------------------------------------------------------------
 
-static void queue_key_action(uint8_t keycode, int down) {
-    int next_head = (key_action_head + 1) % KEY_ACTION_QUEUE_SIZE;
-    if (next_head != key_action_tail) {
-        key_action_queue[key_action_head].keycode = keycode;
-        key_action_queue[key_action_head].down = down;
-        key_action_head = next_head;
-    }
-}
-
 static int find_keycode_in_report(hid_keyboard_report_t const *report, uint8_t keycode) {
     for (int i = 0; i < 6; i++) {
         if (report->keycode[i] == keycode) return 1;
@@ -92,29 +65,29 @@ static void process_kbd_report(hid_keyboard_report_t const *report, hid_keyboard
     // Map modifier bits to pseudo-keycodes (using high byte to distinguish)
     // These will be translated in the wrapper
     if (released_mods & (KEYBOARD_MODIFIER_LEFTSHIFT | KEYBOARD_MODIFIER_RIGHTSHIFT)) {
-        queue_key_action(0xE1, 0); // SHIFT released (HID Left Shift)
+        usbhid_on_key(0xE1, 0); // SHIFT released (HID Left Shift)
     }
     if (pressed_mods & (KEYBOARD_MODIFIER_LEFTSHIFT | KEYBOARD_MODIFIER_RIGHTSHIFT)) {
-        queue_key_action(0xE1, 1); // SHIFT pressed
+        usbhid_on_key(0xE1, 1); // SHIFT pressed
     }
     if (released_mods & (KEYBOARD_MODIFIER_LEFTCTRL | KEYBOARD_MODIFIER_RIGHTCTRL)) {
-        queue_key_action(0xE0, 0); // CTRL released
+        usbhid_on_key(0xE0, 0); // CTRL released
     }
     if (pressed_mods & (KEYBOARD_MODIFIER_LEFTCTRL | KEYBOARD_MODIFIER_RIGHTCTRL)) {
-        queue_key_action(0xE0, 1); // CTRL pressed
+        usbhid_on_key(0xE0, 1); // CTRL pressed
     }
     if (released_mods & (KEYBOARD_MODIFIER_LEFTALT | KEYBOARD_MODIFIER_RIGHTALT)) {
-        queue_key_action(0xE2, 0); // ALT released
+        usbhid_on_key(0xE2, 0); // ALT released
     }
     if (pressed_mods & (KEYBOARD_MODIFIER_LEFTALT | KEYBOARD_MODIFIER_RIGHTALT)) {
-        queue_key_action(0xE2, 1); // ALT pressed
+        usbhid_on_key(0xE2, 1); // ALT pressed
     }
     
     // Check for released keys
     for (int i = 0; i < 6; i++) {
         uint8_t keycode = prev_report->keycode[i];
         if (keycode && !find_keycode_in_report(report, keycode)) {
-            queue_key_action(keycode, 0); // Key released
+            usbhid_on_key(keycode, 0); // Key released
         }
     }
     
@@ -122,7 +95,7 @@ static void process_kbd_report(hid_keyboard_report_t const *report, hid_keyboard
     for (int i = 0; i < 6; i++) {
         uint8_t keycode = report->keycode[i];
         if (keycode && !find_keycode_in_report(prev_report, keycode)) {
-            queue_key_action(keycode, 1); // Key pressed
+            usbhid_on_key(keycode, 1); // Key pressed
         }
     }
 }
@@ -134,14 +107,7 @@ static void process_kbd_report(hid_keyboard_report_t const *report, hid_keyboard
 static void process_mouse_report(hid_mouse_report_t const *report) {
     // Standard boot protocol mouse report
     // Note: Y axis inverted for DOOM (positive Y = forward in game)
-    cumulative_dx += report->x;
-    cumulative_dy += -report->y;  // Invert Y for correct forward/back
-    cumulative_wheel += report->wheel;
-    current_buttons = report->buttons & 0x07;
-    
-    if (report->x != 0 || report->y != 0) {
-        mouse_has_motion = 1;
-    }
+    usbhid_on_mouse(report->x, -report->y, report->buttons & 0x07);
     
     prev_mouse_report = *report;
 }
@@ -265,13 +231,6 @@ void usbhid_init(void) {
     // Clear state
     memset(&prev_kbd_report, 0, sizeof(prev_kbd_report));
     memset(&prev_mouse_report, 0, sizeof(prev_mouse_report));
-    cumulative_dx = 0;
-    cumulative_dy = 0;
-    cumulative_wheel = 0;
-    current_buttons = 0;
-    mouse_has_motion = 0;
-    key_action_head = 0;
-    key_action_tail = 0;
 }
 
 void usbhid_task(void) {
@@ -291,35 +250,7 @@ void usbhid_get_keyboard_state(usbhid_keyboard_state_t *state) {
     if (state) {
         memcpy(state->keycode, prev_kbd_report.keycode, 6);
         state->modifier = prev_kbd_report.modifier;
-        state->has_key = (key_action_head != key_action_tail);
     }
 }
 
-void usbhid_get_mouse_state(usbhid_mouse_state_t *state) {
-    if (state) {
-        state->dx = cumulative_dx;
-        state->dy = cumulative_dy;
-        state->wheel = cumulative_wheel;
-        state->buttons = current_buttons;
-        state->has_motion = mouse_has_motion;
-        
-        // Reset accumulated values
-        cumulative_dx = 0;
-        cumulative_dy = 0;
-        cumulative_wheel = 0;
-        mouse_has_motion = 0;
-    }
-}
-
-int usbhid_get_key_action(uint8_t *keycode, int *down) {
-    if (key_action_head == key_action_tail) {
-        return 0; // No actions queued
-    }
-    
-    *keycode = key_action_queue[key_action_tail].keycode;
-    *down = key_action_queue[key_action_tail].down;
-    key_action_tail = (key_action_tail + 1) % KEY_ACTION_QUEUE_SIZE;
-    return 1;
-}
-
 #endif // CFG_TUH_ENABLED
@@ -22,18 +22,8 @@ extern "C" {
 typedef struct {
     uint8_t keycode[6];     // Currently pressed keys (HID keycodes)
     uint8_t modifier;       // Modifier keys (shift, ctrl, alt, etc.)
-    int has_key;            // Non-zero if a key event is pending
 } usbhid_keyboard_state_t;
 
-// USB mouse state
-typedef struct {
-    int16_t dx;             // Accumulated X movement
-    int16_t dy;             // Accumulated Y movement
-    int8_t wheel;           // Wheel movement
-    uint8_t buttons;        // Button state (bit 0=left, 1=right, 2=middle)
-    int has_motion;         // Non-zero if motion/button change occurred
-} usbhid_mouse_state_t;
-
 //--------------------------------------------------------------------
 // API Functions
 //--------------------------------------------------------------------
@@ -68,19 +58,25 @@ int usbhid_mouse_connected(void);
  */
 void usbhid_get_keyboard_state(usbhid_keyboard_state_t *state);
 
+//--------------------------------------------------------------------
+// Report handlers, implemented by the wrapper
+// Called from the TinyUSB report callback, i.e. inside usbhid_task()
+//--------------------------------------------------------------------
+
 /**
- * Get current mouse state and reset deltas
- * @param state Pointer to state structure to fill
+ * A key went down or up
+ * @param keycode HID keycode, or 0xE0/0xE1/0xE2 for Ctrl/Shift/Alt
+ * @param down Non-zero if key pressed, 0 if released
  */
-void usbhid_get_mouse_state(usbhid_mouse_state_t *state);
+void usbhid_on_key(uint8_t keycode, int down);
 
 /**
- * Get pending key action (for wrapper compatibility)
- * @param keycode HID keycode of the key
- * @param down Non-zero if key pressed, 0 if released
- * @return Non-zero if action available
+ * A mouse report arrived
+ * @param dx X movement, positive right
+ * @param dy Y movement, positive forward (already inverted)
+ * @param buttons Button state (bit 0=left, 1=right, 2=middle)
  */
-int usbhid_get_key_action(uint8_t *keycode, int *down);
+void usbhid_on_mouse(int dx, int dy, uint8_t buttons);
 
 #ifdef __cplusplus
 }
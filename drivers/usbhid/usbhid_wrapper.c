@@ -5,32 +5,12 @@
  * SPDX-License-Identifier: GPL-2.0-or-later
  */
 
-// Include d_event.h first - it pulls in doomtype.h which defines its own boolean type
-#include "d_event.h"
 #include "doomkeys.h"
 #include "usbhid.h"
 #include "usbhid_wrapper.h"
+#include "murmdoom_input.h"
 #include <stdint.h>
 
-// External DOOM function to post events
-extern void D_PostEvent(event_t *ev);
-
-// Mouse sensitivity multiplier (increase for faster response)
-#define MOUSE_SENSITIVITY_MULT 2
-
-// Maximum delta per tick to prevent abrupt jumps
-#define MOUSE_MAX_DELTA 40
-
-// Track previous button state to detect changes
-static uint8_t prev_usb_buttons = 0;
-
-// Clamp value to range
-static inline int16_t clamp_delta(int16_t val, int16_t max_val) {
-    if (val > max_val) return max_val;
-    if (val < -max_val) return -max_val;
-    return val;
-}
-
 //--------------------------------------------------------------------
 // HID Keycode to DOOM Key Mapping
 //--------------------------------------------------------------------
@@ -107,54 +87,34 @@ void usbhid_wrapper_init(void) {
 #ifdef USB_HID_ENABLED
     usbhid_init();
     usb_hid_initialized = 1;
-    prev_usb_buttons = 0;
 #endif
 }
 
 //--------------------------------------------------------------------
-// Mouse Tick - Process USB HID mouse events only
-// Keyboard events flow through usbhid_wrapper_get_key() -> DG_GetKey()
+// Task - run TinyUSB host; reports arrive through the handlers below
 //--------------------------------------------------------------------
 
-void usbhid_wrapper_mouse_tick(void) {
+void usbhid_wrapper_task(void) {
 #ifdef USB_HID_ENABLED
     if (!usb_hid_initialized) return;
-    
-    // Process USB host events (this also queues keyboard events for get_key)
     usbhid_task();
-    
-    // Process mouse events
-    usbhid_mouse_state_t mouse;
-    usbhid_get_mouse_state(&mouse);
-    
-    // Only post event if there's actual motion or button change
-    // Check for real motion (non-zero deltas) or actual button state change
-    int has_real_motion = (mouse.dx != 0 || mouse.dy != 0);
-    int buttons_changed = ((mouse.buttons & 0x07) != prev_usb_buttons);
-    
-    if (has_real_motion || buttons_changed) {
-        event_t ev;
-        ev.type = ev_mouse;
-        
-        // USB mouse buttons: bit 0=left, 1=right, 2=middle (same as DOOM)
-        // Only update buttons when they actually change
-        ev.data1 = mouse.buttons & 0x07;
-        
-        // Clamp deltas to prevent abrupt movements
-        int16_t dx = clamp_delta(mouse.dx, MOUSE_MAX_DELTA);
-        int16_t dy = clamp_delta(mouse.dy, MOUSE_MAX_DELTA);
-        
-        // USB mouse: dx=turn, dy=forward/back  
-        // Y axis already inverted in hid_app.c
-        ev.data2 = dx * MOUSE_SENSITIVITY_MULT;   // Turn left/right
-        ev.data3 = dy * MOUSE_SENSITIVITY_MULT;   // Forward/back
-        ev.data4 = 0;
-        
-        D_PostEvent(&ev);
-        
-        prev_usb_buttons = mouse.buttons & 0x07;
+#endif
+}
+
+//--------------------------------------------------------------------
+// Report handlers (called from usbhid_task) - straight to the input ring
+//--------------------------------------------------------------------
+
+void usbhid_on_key(uint8_t keycode, int down) {
+    unsigned char doom_key = hid_to_doom_key(keycode);
+    if (doom_key != 0) {
+        input_key(down, doom_key);
     }
-#endif // USB_HID_ENABLED
+}
+
+void usbhid_on_mouse(int dx, int dy, uint8_t buttons) {
+    // USB mouse: dx=turn, dy=forward/back; Y axis already inverted in hid_app.c
+    input_mouse(dx, dy, buttons & 0x07);
 }
 
 //--------------------------------------------------------------------
@@ -178,28 +138,3 @@ int usbhid_wrapper_mouse_connected(void) {
     return 0;
 #endif
 }
-
-int usbhid_wrapper_get_key(int *pressed, unsigned char *key) {
-#ifdef USB_HID_ENABLED
-    if (!usb_hid_initialized) return 0;
-    
-    // Process USB events first
-    usbhid_task();
-    
-    // Get next key action from the queue
-    uint8_t hid_keycode;
-    int down;
-    if (usbhid_get_key_action(&hid_keycode, &down)) {
-        unsigned char doom_key = hid_to_doom_key(hid_keycode);
-        if (doom_key != 0) {
-            *pressed = down;
-            *key = doom_key;
-            return 1;
-        }
-    }
-#else
-    (void)pressed;
-    (void)key;
-#endif
-    return 0;
-}
@@ -24,12 +24,11 @@ extern "C" {
 void usbhid_wrapper_init(void);
 
 /**
- * Process USB HID mouse events only
- * Call every frame during Doom gameplay
- * Posts ev_mouse events to DOOM
- * Note: Keyboard events flow through usbhid_wrapper_get_key() -> DG_GetKey()
+ * Run the TinyUSB host stack
+ * Call every frame (DG_GetKey does); keyboard and mouse reports go from the
+ * TinyUSB callbacks straight to the input ring (murmdoom_input.h)
  */
-void usbhid_wrapper_mouse_tick(void);
+void usbhid_wrapper_task(void);
 
 /**
  * Check if USB keyboard is connected
@@ -43,23 +42,13 @@ int usbhid_wrapper_keyboard_connected(void);
  */
 int usbhid_wrapper_mouse_connected(void);
 
-/**
- * Get the next key event from the USB keyboard queue
- * Works like ps2kbd_get_key() for use before DOOM engine starts
- * @param pressed Output: 1 if key pressed, 0 if released
- * @param key Output: DOOM key code
- * @return Non-zero if a key event was available
- */
-int usbhid_wrapper_get_key(int *pressed, unsigned char *key);
-
 #else // !USB_HID_ENABLED
 
 // Stub functions when USB HID is disabled
 static inline void usbhid_wrapper_init(void) {}
-static inline void usbhid_wrapper_mouse_tick(void) {}
+static inline void usbhid_wrapper_task(void) {}
 static inline int usbhid_wrapper_keyboard_connected(void) { return 0; }
 static inline int usbhid_wrapper_mouse_connected(void) { return 0; }
-static inline int usbhid_wrapper_get_key(int *pressed, unsigned char *key) { (void)pressed; (void)key; return 0; }
 
 #endif // USB_HID_ENABLED
 
@@ -0,0 +1,194 @@
+/*
+ * pico_audio producer pool and I2S consumer for the host build (see host.h).
+ */
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "pico/audio_i2s.h"
+#include "pico/time.h"
+
+#include "host.h"
+
+struct audio_buffer_pool {
+    audio_buffer_t *free_list;
+    audio_buffer_t *queue_head;
+    audio_buffer_t *queue_tail;
+};
+
+static audio_buffer_pool_t *producer;
+static struct audio_format output_format;
+static bool enabled;
+static bool gametic_clock;
+static uint64_t enable_us;
+static uint64_t played;         // samples handed to the "DAC"
+static uint32_t underruns;
+
+static int wav_fd = -1;
+static uint64_t wav_bytes;
+
+audio_buffer_pool_t *audio_new_producer_pool(struct audio_buffer_format *format, int buffer_count,
+                                             int buffer_sample_count) {
+    audio_buffer_pool_t *pool = calloc(1, sizeof(*pool));
+    if (!pool) return NULL;
+    for (int i = 0; i < buffer_count; ++i) {
+        audio_buffer_t *ab = calloc(1, sizeof(*ab));
+        mem_buffer_t *mb = calloc(1, sizeof(*mb));
+        const size_t size = (size_t)buffer_sample_count * format->sample_stride;
+        uint8_t *bytes = calloc(1, size);
+        if (!ab || !mb || !bytes) return NULL;
+        mb->size = size;
+        mb->bytes = bytes;
+        ab->buffer = mb;
+        ab->format = format;
+        ab->max_sample_count = (uint32_t)buffer_sample_count;
+        ab->next = pool->free_list;
+        pool->free_list = ab;
+    }
+    producer = pool;
+    return pool;
+}
+
+static void wav_write(const void *data, size_t size) {
+    if (wav_fd < 0) return;
+    if (write(wav_fd, data, size) != (ssize_t)size) {
+        printf("host audio: WAV write failed, closing\n");
+        close(wav_fd);
+        wav_fd = -1;
+        return;
+    }
+    wav_bytes += size;
+}
+
+// Retire queued buffers whose samples the DAC has reached by `pos`.
+static void consume_to(uint64_t pos) {
+    while (played < pos) {
+        audio_buffer_t *ab = producer ? producer->queue_head : NULL;
+        if (!ab) {
+            if (enabled) underruns++;
+            played = pos;
+            break;
+        }
+        if (played + ab->sample_count > pos) break;
+        producer->queue_head = ab->next;
+        if (!producer->queue_head) producer->queue_tail = NULL;
+        played += ab->sample_count;
+        wav_write(ab->buffer->bytes, ab->sample_count * (size_t)ab->format->sample_stride);
+        ab->next = producer->free_list;
+        producer->free_list = ab;
+    }
+}
+
+static void consume_realtime(void) {
+    if (!enabled || gametic_clock) return;
+    consume_to((time_us_64() - enable_us) * output_format.sample_freq / 1000000u);
+}
+
+audio_buffer_t *take_audio_buffer(audio_buffer_pool_t *pool, bool block) {
+    for (;;) {
+        if (pool == producer) consume_realtime();
+        audio_buffer_t *ab = pool->free_list;
+        if (ab) {
+            pool->free_list = ab->next;
+            ab->next = NULL;
+            ab->sample_count = 0;
+            return ab;
+        }
+        if (!block || gametic_clock) return NULL;
+        sleep_us(1000);
+    }
+}
+
+void give_audio_buffer(audio_buffer_pool_t *pool, audio_buffer_t *buffer) {
+    buffer->next = NULL;
+    if (pool->queue_tail) {
+        pool->queue_tail->next = buffer;
+    } else {
+        pool->queue_head = buffer;
+    }
+    pool->queue_tail = buffer;
+}
+
+const struct audio_format *audio_i2s_setup(const struct audio_format *intended_audio_format,
+                                           const struct audio_i2s_config *config) {
+    (void)config;
+    output_format = *intended_audio_format;
+    return &output_format;
+}
+
+bool audio_i2s_connect_extra(audio_buffer_pool_t *pool, bool buffer_on_give, uint buffer_count,
+                             uint samples_per_buffer, void *connection) {
+    (void)buffer_on_give;
+    (void)buffer_count;
+    (void)samples_per_buffer;
+    (void)connection;
+    producer = pool;
+    return true;
+}
+
+void audio_i2s_set_enabled(bool enable) {
+    if (enable && !enabled) {
+        enable_us = time_us_64();
+        played = 0;
+    }
+    enabled = enable;
+}
+
+void host_audio_set_gametic_clock(bool gametic) {
+    gametic_clock = gametic;
+}
+
+void host_audio_advance_to(uint64_t sample_pos) {
+    if (enabled && gametic_clock) consume_to(sample_pos);
+}
+
+static void put_le(uint8_t *p, uint32_t v, int bytes) {
+    for (int i = 0; i < bytes; ++i) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static void wav_header(uint8_t hdr[44], uint32_t rate, uint32_t data_bytes) {
+    memcpy(hdr, "RIFF", 4);
+    put_le(hdr + 4, 36 + data_bytes, 4);
+    memcpy(hdr + 8, "WAVEfmt ", 8);
+    put_le(hdr + 16, 16, 4);
+    put_le(hdr + 20, 1, 2);             // PCM
+    put_le(hdr + 22, 2, 2);             // stereo
+    put_le(hdr + 24, rate, 4);
+    put_le(hdr + 28, rate * 4, 4);
+    put_le(hdr + 32, 4, 2);
+    put_le(hdr + 34, 16, 2);
+    memcpy(hdr + 36, "data", 4);
+    put_le(hdr + 40, data_bytes, 4);
+}
+
+bool host_audio_open_wav(const char *path) {
+    wav_fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (wav_fd < 0) return false;
+    // Placeholder header, rewritten with the real sizes on close.
+    uint8_t hdr[44];
+    wav_header(hdr, 0, 0);
+    wav_write(hdr, sizeof(hdr));
+    wav_bytes = 0;
+    return wav_fd >= 0;
+}
+
+void host_audio_close(void) {
+    if (wav_fd < 0) return;
+    uint8_t hdr[44];
+    wav_header(hdr, output_format.sample_freq, (uint32_t)wav_bytes);
+    if (pwrite(wav_fd, hdr, sizeof(hdr), 0) != (ssize_t)sizeof(hdr)) {
+        printf("host audio: failed to finalise WAV header\n");
+    }
+    close(wav_fd);
+    wav_fd = -1;
+}
+
+uint64_t host_audio_samples(void) {
+    return played;
+}
+
+uint32_t host_audio_underruns(void) {
+    return underruns;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+// Shared by the host/bench_*.c microbenchmarks. Each one runs the code a
+// change replaced (re-implemented in the bench) and the code in the tree on
+// the same input, times both, and prints "identical" or "DIFFER" for the
+// output; it exits non-zero when the output differs, so the short runs
+// registered with CTest in host.cmake fail.
+
+#include <stdint.h>
+#include <time.h>
+
+static inline uint64_t bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+// xorshift32: the same input on every run and every host.
+static inline uint32_t bench_rand(uint32_t *state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+static inline const char *bench_verdict(int same) {
+    return same ? "identical" : "DIFFER";
+}
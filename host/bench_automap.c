@@ -0,0 +1,347 @@
+/*
+ * Automap benchmark: AM_Drawer's walls the old way (clear the whole window,
+ * clip every linedef, Bresenham with a multiply per pixel) against
+ * src/murmdoom_amdraw.c (blockmap cells around the window, pointer-stepping
+ * lines, clearing what the last frame drew).
+ *
+ *   build-host/bench_automap [frames] [lines]
+ *
+ * The map is synthetic: rooms of 4 to 12 walls on a grid, with a blockmap
+ * built from the line bounding boxes (a superset of what a node builder
+ * lists). Each view pans a little every frame, as when following the
+ * player: the whole map, the automap's opening zoom, and the zoom it
+ * follows the player at. Both ways must produce the same frame.
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "m_bbox.h"
+#include "murmdoom_amdraw.h"
+
+#define F_W 320
+#define F_H 208
+#define BLOCK 128
+#define ROOM 320
+#define BACKGROUND 0
+
+typedef struct {
+    int ax, ay, bx, by;     // map units
+} mapline_t;
+
+typedef struct {
+    int x, y;
+} point_t;
+
+static mapline_t *map;
+static int numlines;
+static int map_w, map_h;
+static int min_x, min_y, max_x, max_y;     // vertex bounds
+
+static short *blockmaplump;
+static int bmapwidth, bmapheight;
+
+static byte fb_old[F_W * F_H];
+static byte fb_new[F_W * F_H];
+
+// Window on the map, in map units scaled by 1/scale pixels per unit.
+static double m_x, m_y, m_w, m_h, scale;
+
+static uint32_t rng = 0x9e3779b9u;
+
+static void make_map(int want) {
+    int rooms = 0;
+    map = malloc(sizeof(*map) * (want + 16));
+    numlines = 0;
+
+    int grid = 1;
+    while (grid * grid * 8 < want) grid++;
+    map_w = map_h = grid * ROOM;
+
+    while (numlines < want) {
+        const int cx = (rooms % grid) * ROOM + ROOM / 2, cy = (rooms / grid % grid) * ROOM + ROOM / 2;
+        const int sides = 4 + (int)(bench_rand(&rng) % 9);
+        point_t p[12];
+        for (int i = 0; i < sides; i++) {
+            const double a = 6.2831853 * i / sides;
+            const double r = ROOM * (0.25 + (bench_rand(&rng) % 100) / 500.0);
+            p[i].x = cx + (int)(r * cos(a));
+            p[i].y = cy + (int)(r * sin(a));
+        }
+        for (int i = 0; i < sides && numlines < want; i++) {
+            mapline_t *l = &map[numlines++];
+            l->ax = p[i].x;
+            l->ay = p[i].y;
+            l->bx = p[(i + 1) % sides].x;
+            l->by = p[(i + 1) % sides].y;
+        }
+        rooms++;
+    }
+
+    min_x = min_y = map_w;
+    max_x = max_y = 0;
+    for (int i = 0; i < numlines; i++) {
+        const mapline_t *l = &map[i];
+        min_x = l->ax < min_x ? l->ax : min_x;
+        max_x = l->ax > max_x ? l->ax : max_x;
+        min_y = l->ay < min_y ? l->ay : min_y;
+        max_y = l->ay > max_y ? l->ay : max_y;
+    }
+}
+
+// Lists of the lines whose bounding box meets each cell, laid out as in the
+// BLOCKMAP lump: header, offsets, then 0, lines..., -1 per cell.
+static void make_blockmap(void) {
+    bmapwidth = map_w / BLOCK + 1;
+    bmapheight = map_h / BLOCK + 1;
+    const int cells = bmapwidth * bmapheight;
+    int *count = calloc(cells, sizeof(int));
+    int total = 0;
+
+    for (int pass = 0; pass < 2; pass++) {
+        short *list = blockmaplump + 4 + cells;
+        for (int c = 0; c < cells; c++) {
+            if (pass) {
+                blockmaplump[4 + c] = (short)(list - blockmaplump);
+                *list++ = 0;
+            }
+            const int bx = c % bmapwidth, by = c / bmapwidth;
+            for (int i = 0; i < numlines; i++) {
+                const mapline_t *l = &map[i];
+                const int x0 = (l->ax < l->bx ? l->ax : l->bx) / BLOCK, x1 = (l->ax < l->bx ? l->bx : l->ax) / BLOCK;
+                const int y0 = (l->ay < l->by ? l->ay : l->by) / BLOCK, y1 = (l->ay < l->by ? l->by : l->ay) / BLOCK;
+                if (bx < x0 || bx > x1 || by < y0 || by > y1) continue;
+                if (pass) {
+                    *list++ = (short)i;
+                } else {
+                    count[c]++;
+                }
+            }
+            if (pass) {
+                *list++ = -1;
+            } else {
+                total += count[c] + 2;
+            }
+        }
+        if (!pass) {
+            if (4 + cells + total > 0x7fff) {
+                fprintf(stderr, "bench_automap: blockmap offsets overflow a short; use fewer lines\n");
+                exit(1);
+            }
+            blockmaplump = malloc(sizeof(short) * (4 + cells + total));
+            blockmaplump[2] = (short)bmapwidth;
+            blockmaplump[3] = (short)bmapheight;
+        }
+    }
+    free(count);
+}
+
+// --- AM_clipMline, in frame coordinates -------------------------------------
+
+static int cx(int x) { return (int)((x - m_x) * scale); }
+static int cy(int y) { return F_H - (int)((y - m_y) * scale); }
+
+enum { LEFT = 1, RIGHT = 2, BOTTOM = 4, TOP = 8 };
+
+static int outcode(int x, int y) {
+    int oc = 0;
+    if (y < 0) oc |= TOP;
+    else if (y >= F_H) oc |= BOTTOM;
+    if (x < 0) oc |= LEFT;
+    else if (x >= F_W) oc |= RIGHT;
+    return oc;
+}
+
+static int clip(const mapline_t *ml, point_t *a, point_t *b) {
+    const double x2 = m_x + m_w, y2 = m_y + m_h;
+    int oc1 = ml->ay > y2 ? TOP : ml->ay < m_y ? BOTTOM : 0;
+    int oc2 = ml->by > y2 ? TOP : ml->by < m_y ? BOTTOM : 0;
+    if (oc1 & oc2) return 0;
+    oc1 |= ml->ax < m_x ? LEFT : ml->ax > x2 ? RIGHT : 0;
+    oc2 |= ml->bx < m_x ? LEFT : ml->bx > x2 ? RIGHT : 0;
+    if (oc1 & oc2) return 0;
+
+    a->x = cx(ml->ax);
+    a->y = cy(ml->ay);
+    b->x = cx(ml->bx);
+    b->y = cy(ml->by);
+    oc1 = outcode(a->x, a->y);
+    oc2 = outcode(b->x, b->y);
+    if (oc1 & oc2) return 0;
+
+    while (oc1 | oc2) {
+        const int outside = oc1 ? oc1 : oc2;
+        point_t t;
+        if (outside & TOP) {
+            t.x = a->x + (b->x - a->x) * a->y / (a->y - b->y);
+            t.y = 0;
+        } else if (outside & BOTTOM) {
+            t.x = a->x + (b->x - a->x) * (a->y - F_H) / (a->y - b->y);
+            t.y = F_H - 1;
+        } else if (outside & RIGHT) {
+            t.y = a->y + (b->y - a->y) * (F_W - 1 - a->x) / (b->x - a->x);
+            t.x = F_W - 1;
+        } else {
+            t.y = a->y + (b->y - a->y) * -a->x / (b->x - a->x);
+            t.x = 0;
+        }
+        if (outside == oc1) {
+            *a = t;
+            oc1 = outcode(a->x, a->y);
+        } else {
+            *b = t;
+            oc2 = outcode(b->x, b->y);
+        }
+        if (oc1 & oc2) return 0;
+    }
+    return 1;
+}
+
+// ----------------------------------------------------------------------------
+
+// AM_drawFline's loop; a call per line, as there.
+__attribute__((noinline)) static void old_line(const point_t *a, const point_t *b, int color) {
+    const int dx = b->x - a->x, ax = 2 * (dx < 0 ? -dx : dx), sx = dx < 0 ? -1 : 1;
+    const int dy = b->y - a->y, ay = 2 * (dy < 0 ? -dy : dy), sy = dy < 0 ? -1 : 1;
+    int x = a->x, y = a->y, d;
+
+    if (ax > ay) {
+        d = ay - ax / 2;
+        for (;;) {
+            fb_old[y * F_W + x] = (byte)color;
+            if (x == b->x) return;
+            if (d >= 0) {
+                y += sy;
+                d -= ax;
+            }
+            x += sx;
+            d += ay;
+        }
+    } else {
+        d = ax - ay / 2;
+        for (;;) {
+            fb_old[y * F_W + x] = (byte)color;
+            if (y == b->y) return;
+            if (d >= 0) {
+                x += sx;
+                d -= ay;
+            }
+            y += sy;
+            d += ax;
+        }
+    }
+}
+
+static int color_of(int line) {
+    return 1 + line % 200;
+}
+
+static void old_frame(void) {
+    point_t a, b;
+    memset(fb_old, BACKGROUND, sizeof(fb_old));
+    for (int i = 0; i < numlines; i++) {
+        if (clip(&map[i], &a, &b)) old_line(&a, &b, color_of(i));
+    }
+}
+
+// AM_drawWalls' choice of cells; returns the lines visited.
+static int new_frame(uint32_t *visible, int first) {
+    int empty[4];
+    const int words = (numlines + 31) / 32;
+    point_t a, b;
+    int visited = 0;
+
+    M_ClearBox(empty);
+    amdraw_begin(fb_new, F_W, F_H, BACKGROUND, first, empty);
+
+    // The map bounds on screen, as AM_drawWalls marks them.
+    const double bx0 = m_x > min_x ? m_x : min_x, bx1 = m_x + m_w < max_x ? m_x + m_w : max_x;
+    const double by0 = m_y > min_y ? m_y : min_y, by1 = m_y + m_h < max_y ? m_y + m_h : max_y;
+    if (bx0 <= bx1 && by0 <= by1) {
+        const int fx0 = cx((int)bx0), fx1 = cx((int)bx1), fy0 = cy((int)by1), fy1 = cy((int)by0);
+        amdraw_mark(fx0 - 1, fy0 - 1, fx1 - fx0 + 3, fy1 - fy0 + 3);
+    }
+
+    int x0 = (int)m_x / BLOCK - 1, x1 = (int)(m_x + m_w) / BLOCK + 1;
+    int y0 = (int)m_y / BLOCK - 1, y1 = (int)(m_y + m_h) / BLOCK + 1;
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 >= bmapwidth) x1 = bmapwidth - 1;
+    if (y1 >= bmapheight) y1 = bmapheight - 1;
+
+    if (x0 > x1 || y0 > y1 || 4 * (x1 - x0 + 1) * (y1 - y0 + 1) >= bmapwidth * bmapheight) {
+        for (int i = 0; i < numlines; i++) {
+            if (clip(&map[i], &a, &b)) amdraw_line(a.x, a.y, b.x, b.y, color_of(i));
+        }
+        return numlines;
+    }
+
+    memset(visible, 0, words * sizeof(*visible));
+    amdraw_blocklines(blockmaplump, bmapwidth, x0, y0, x1, y1, numlines, visible);
+    for (int w = 0; w < words; w++) {
+        for (uint32_t bits = visible[w]; bits; bits &= bits - 1) {
+            const int i = w * 32 + __builtin_ctz(bits);
+            visited++;
+            if (clip(&map[i], &a, &b)) amdraw_line(a.x, a.y, b.x, b.y, color_of(i));
+        }
+    }
+    return visited;
+}
+
+// Map units per pixel `units`; the window starts at the map centre and
+// drifts by 2 pixels a frame. Whether both drew the same frames.
+static int run(const char *name, double units, int frames) {
+    uint32_t *visible = malloc(((numlines + 31) / 32) * sizeof(uint32_t));
+    const double start_x = map_w / 2.0 - F_W * units / 2, start_y = map_h / 2.0 - F_H * units / 2;
+    uint64_t old_ns = 0, new_ns = 0, visited = 0, cleared = 0;
+    int same = 1;
+
+    scale = 1.0 / units;
+    m_w = F_W * units;
+    m_h = F_H * units;
+
+    for (int n = 0; n < frames; n++) {
+        m_x = start_x + 2 * units * (n % 64);
+        m_y = start_y + units * (n % 64);
+
+        uint64_t t0 = bench_now_ns();
+        old_frame();
+        old_ns += bench_now_ns() - t0;
+
+        t0 = bench_now_ns();
+        visited += new_frame(visible, n == 0);
+        new_ns += bench_now_ns() - t0;
+
+        int box[4];
+        if (amdraw_touched(box)) {
+            cleared += (uint64_t)(box[BOXRIGHT] - box[BOXLEFT] + 1) * (box[BOXTOP] - box[BOXBOTTOM] + 1);
+        }
+        same = same && !memcmp(fb_old, fb_new, sizeof(fb_old));
+    }
+
+    printf("  %-8s %4.1f units/px: old %7.1f us/frame, new %7.1f us/frame (%.2fx); lines clipped %d of %d, "
+           "%llu%% of the window written; frames %s\n",
+           name, units, old_ns / 1000.0 / frames, new_ns / 1000.0 / frames, (double)old_ns / new_ns,
+           (int)(visited / frames), numlines, (unsigned long long)(cleared * 100 / frames / (F_W * F_H)),
+           bench_verdict(same));
+    free(visible);
+    return same;
+}
+
+int main(int argc, char **argv) {
+    const int frames = argc > 1 ? atoi(argv[1]) : 500;
+    const int lines = argc > 2 ? atoi(argv[2]) : 4000;
+
+    make_map(lines);
+    make_blockmap();
+
+    printf("bench_automap: %d frames, %d lines on %dx%d units, blockmap %dx%d\n", frames, numlines, map_w, map_h,
+           bmapwidth, bmapheight);
+    const double whole = (double)map_w / F_W > (double)map_h / F_H ? (double)map_w / F_W : (double)map_h / F_H;
+    int same = run("whole", whole * 1.1, frames);
+    same &= run("opening", whole * 0.7, frames);
+    same &= run("follow", 5.0, frames);
+    return same ? 0 : 1;
+}
@@ -0,0 +1,133 @@
+/*
+ * OPL output path benchmark: the old three-pass conversion (render into an
+ * int32 scratch buffer, unpack to the int16 output, shift every sample for
+ * gain) against OPL_calc_buffer_stereo_s16, which renders into the output
+ * buffer and converts it there in a second pass.
+ *
+ *   build-host/bench_opl_mix [buffers]
+ *
+ * Both paths drive identical emulator instances through the same register
+ * writes, so the output is compared sample for sample as well; the only
+ * expected differences are peaks the old path wrapped instead of clipping.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "emu8950.h"
+#include "i_picosound.h"
+
+#define GAIN_SHIFT 3
+// One tic of audio, as i_picosound.c sizes its buffers.
+#define BUFFER_SAMPLES ((PICO_SOUND_SAMPLE_FREQ + 34) / 35)
+#define OPL_CLOCK 3579552
+
+static int32_t scratch[BUFFER_SAMPLES];
+static int16_t out_old[BUFFER_SAMPLES * 2];
+static int16_t out_new[BUFFER_SAMPLES * 2] __attribute__((aligned(4)));
+
+static void three_pass(OPL *opl, int16_t *out, uint32_t nsamples) {
+    OPL_calc_buffer_stereo(opl, scratch, nsamples);
+    for (uint32_t i = 0; i < nsamples; i++) {
+        out[i * 2] = (int16_t)(scratch[i] >> 16);
+        out[i * 2 + 1] = (int16_t)(scratch[i] & 0xffff);
+    }
+    for (uint32_t i = 0; i < nsamples * 2; i++) {
+        out[i] <<= GAIN_SHIFT;
+    }
+}
+
+// Operator register offsets of the modulator of each melodic channel; the
+// carrier is 3 above.
+static const uint8_t op_offset[9] = { 0x00, 0x01, 0x02, 0x08, 0x09, 0x0a, 0x10, 0x11, 0x12 };
+
+static void write_both(OPL *a, OPL *b, uint32_t reg, uint8_t val) {
+    OPL_writeReg(a, reg, val);
+    OPL_writeReg(b, reg, val);
+}
+
+static void setup_voices(OPL *a, OPL *b) {
+    write_both(a, b, 0x01, 0x20);                       // waveform select
+    for (int ch = 0; ch < 9; ch++) {
+        for (int op = 0; op < 2; op++) {
+            const uint32_t o = op_offset[ch] + op * 3;
+            write_both(a, b, 0x20 + o, 0x21);           // sustain, multiple 1
+            write_both(a, b, 0x40 + o, op ? 0x0c : 0x18);
+            write_both(a, b, 0x60 + o, 0xf4);
+            write_both(a, b, 0x80 + o, 0x46);
+            write_both(a, b, 0xe0 + o, (uint8_t)(ch & 3));
+        }
+        write_both(a, b, 0xc0 + ch, (uint8_t)(0x30 | (ch & 1))); // FM and additive
+    }
+}
+
+// A new chord every 8 buffers: all nine channels, spread over four octaves.
+static void key_chord(OPL *a, OPL *b, int step) {
+    for (int ch = 0; ch < 9; ch++) {
+        const uint32_t fnum = 0x157 + ((step * 37 + ch * 61) % 0x120);
+        const uint32_t block = 2 + ((step + ch) & 3);
+        write_both(a, b, 0xb0 + ch, (uint8_t)(block << 2 | fnum >> 8));   // key off
+        write_both(a, b, 0xa0 + ch, (uint8_t)fnum);
+        write_both(a, b, 0xb0 + ch, (uint8_t)(0x20 | block << 2 | fnum >> 8));
+    }
+}
+
+int main(int argc, char **argv) {
+    const int buffers = argc > 1 ? atoi(argv[1]) : 20000;
+
+    OPL *opl_old = OPL_new(OPL_CLOCK, PICO_SOUND_SAMPLE_FREQ);
+    OPL *opl_new = OPL_new(OPL_CLOCK, PICO_SOUND_SAMPLE_FREQ);
+    if (!opl_old || !opl_new) {
+        fprintf(stderr, "bench_opl_mix: out of memory\n");
+        return 1;
+    }
+    setup_voices(opl_old, opl_new);
+
+    uint64_t old_ns = 0, new_ns = 0;
+    uint64_t differing = 0, clipped = 0;
+    for (int b = 0; b < buffers; b++) {
+        if (b % 8 == 0) key_chord(opl_old, opl_new, b / 8);
+
+        // Alternate the order so neither path always runs with a warm cache.
+        uint64_t t0, t1, t2;
+        if (b & 1) {
+            t0 = bench_now_ns();
+            three_pass(opl_old, out_old, BUFFER_SAMPLES);
+            t1 = bench_now_ns();
+            OPL_calc_buffer_stereo_s16(opl_new, out_new, BUFFER_SAMPLES, GAIN_SHIFT);
+            t2 = bench_now_ns();
+            old_ns += t1 - t0;
+            new_ns += t2 - t1;
+        } else {
+            t0 = bench_now_ns();
+            OPL_calc_buffer_stereo_s16(opl_new, out_new, BUFFER_SAMPLES, GAIN_SHIFT);
+            t1 = bench_now_ns();
+            three_pass(opl_old, out_old, BUFFER_SAMPLES);
+            t2 = bench_now_ns();
+            new_ns += t1 - t0;
+            old_ns += t2 - t1;
+        }
+
+        for (int i = 0; i < BUFFER_SAMPLES * 2; i++) {
+            if (out_old[i] != out_new[i]) {
+                differing++;
+                if (out_new[i] == INT16_MAX || out_new[i] == INT16_MIN) clipped++;
+            }
+        }
+    }
+
+    const uint64_t samples = (uint64_t)buffers * BUFFER_SAMPLES;
+    printf("bench_opl_mix: %d buffers of %d samples at %d Hz\n", buffers, BUFFER_SAMPLES,
+           PICO_SOUND_SAMPLE_FREQ);
+    printf("  three-pass  %8.2f us/buffer  %6.2f ns/sample\n",
+           old_ns / 1000.0 / buffers, (double)old_ns / samples);
+    printf("  two-pass    %8.2f us/buffer  %6.2f ns/sample  (%.1f%% of three-pass)\n",
+           new_ns / 1000.0 / buffers, (double)new_ns / samples, 100.0 * new_ns / old_ns);
+    printf("  %llu samples differ, %llu of them clipped where the old path wrapped\n",
+           (unsigned long long)differing, (unsigned long long)clipped);
+
+    OPL_delete(opl_old);
+    OPL_delete(opl_new);
+    return differing == clipped ? 0 : 1;
+}
@@ -0,0 +1,208 @@
+/*
+ * OPL register write timing: where the music sequencer's register writes land
+ * in the output, for the old segment loop in OPL_Pico_Mix_callback against
+ * the timestamped write ring (src/opl/opl_ring.h) it uses now.
+ *
+ *   build-host/bench_opl_timing [seconds]
+ *
+ * A synthetic score stands in for i_oplmusic.c: each track callback makes a
+ * few register writes and schedules the next one a MIDI delta later, at a
+ * 140 Hz tick and 500000 us per beat as DMX scores use. The ideal sample of a
+ * write is the first one at or after its exact score time.
+ *
+ * The old loop rendered up to the next callback, then advanced its us clock
+ * by the floor of the segment length and ran whatever was due, so a write
+ * landed at the end of the segment it was due in and the clock the next
+ * delay was scheduled from fell behind by up to a microsecond per segment.
+ * The ring path sequences the whole buffer first and applies each write
+ * at its stamped sample. Only the timing is modelled; no emulator is run.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "i_picosound.h"
+#include "opl_ring.h"
+
+#define OPL_SECOND 1000000ull
+// One tic of audio, as i_picosound.c sizes its buffers.
+#define BUFFER_SAMPLES ((PICO_SOUND_SAMPLE_FREQ + 34) / 35)
+#define TICKS_PER_BEAT 140
+#define US_PER_BEAT 500000
+#define TRACKS 8
+
+typedef struct {
+    uint64_t due;           // us, in the clock of the model
+    uint64_t score;         // us, exact score time of the same event
+    uint32_t rng;
+} track_t;
+
+typedef struct {
+    uint64_t writes;
+    uint64_t err_sum;       // |landed - ideal|, samples
+    uint64_t err_max;
+    int64_t last_err;       // signed, of the last write
+} timing_t;
+
+static uint32_t next_rand(uint32_t *s) {
+    *s = *s * 1664525u + 1013904223u;
+    return *s >> 8;
+}
+
+// Ticks to the next event: mostly short notes, now and then a rest.
+static uint64_t next_delay(track_t *t) {
+    const uint32_t r = next_rand(&t->rng);
+    const uint32_t ticks = (r & 7) ? 1 + r % 35 : 35 + r % 140;
+    return (uint64_t)ticks * US_PER_BEAT / TICKS_PER_BEAT;
+}
+
+static uint64_t ideal_sample(uint64_t us) {
+    return (us * PICO_SOUND_SAMPLE_FREQ + OPL_SECOND - 1) / OPL_SECOND;
+}
+
+static void land(timing_t *t, uint64_t sample, uint64_t score, int nwrites) {
+    const int64_t err = (int64_t)sample - (int64_t)ideal_sample(score);
+    const uint64_t abs_err = (uint64_t)(err < 0 ? -err : err);
+    t->writes += nwrites;
+    t->err_sum += abs_err * nwrites;
+    if (abs_err > t->err_max) t->err_max = abs_err;
+    t->last_err = err;
+}
+
+static void init_tracks(track_t *tracks) {
+    for (int i = 0; i < TRACKS; i++) {
+        tracks[i].rng = 0x9e3779b9u * (i + 1);
+        tracks[i].due = tracks[i].score = next_delay(&tracks[i]);
+    }
+}
+
+static track_t *earliest(track_t *tracks) {
+    track_t *t = &tracks[0];
+    for (int i = 1; i < TRACKS; i++) {
+        if (tracks[i].due < t->due) t = &tracks[i];
+    }
+    return t;
+}
+
+static int writes_for(track_t *t) {
+    return 1 + (int)(next_rand(&t->rng) % 6);
+}
+
+// The old OPL_Pico_Mix_callback: render to the next callback, AdvanceTime.
+static void run_old(uint64_t buffers, timing_t *timing) {
+    track_t tracks[TRACKS];
+    init_tracks(tracks);
+    uint64_t current_time = 0, sample = 0;
+
+    for (uint64_t b = 0; b < buffers; b++) {
+        unsigned filled = 0;
+        while (filled < BUFFER_SAMPLES) {
+            const track_t *next = earliest(tracks);
+            uint64_t nsamples = (next->due - current_time) * PICO_SOUND_SAMPLE_FREQ;
+            nsamples = (nsamples + OPL_SECOND - 1) / OPL_SECOND;
+            if (nsamples > BUFFER_SAMPLES - filled) nsamples = BUFFER_SAMPLES - filled;
+
+            filled += nsamples;
+            sample += nsamples;
+            current_time += nsamples * OPL_SECOND / PICO_SOUND_SAMPLE_FREQ;
+
+            track_t *t;
+            while ((t = earliest(tracks))->due <= current_time) {
+                land(timing, sample, t->score, writes_for(t));
+                const uint64_t delay = next_delay(t);
+                t->due = current_time + delay;
+                t->score += delay;
+            }
+        }
+    }
+}
+
+// The ring path: RunSequencer, then ApplyDueWrites between segments.
+static opl_ring_t ring;
+// Score time of the write in each ring slot, to check where it is applied.
+static uint64_t slot_score[OPL_RING_SIZE];
+
+static void run_ring(uint64_t buffers, timing_t *timing) {
+    track_t tracks[TRACKS];
+    init_tracks(tracks);
+    uint64_t synth_sample = 0;
+    opl_ring_init(&ring);
+
+    for (uint64_t b = 0; b < buffers; b++) {
+        const uint64_t end_sample = synth_sample + BUFFER_SAMPLES;
+        track_t *t;
+        while (ideal_sample((t = earliest(tracks))->due) < end_sample) {
+            uint64_t due = ideal_sample(t->due);
+            if (due < synth_sample) due = synth_sample;
+            const int n = writes_for(t);
+            for (int i = 0; i < n; i++) {
+                slot_score[ring.head & (OPL_RING_SIZE - 1)] = t->score;
+                if (!opl_ring_push(&ring, (uint32_t)due, 0xb0 + i, 0x20)) {
+                    fprintf(stderr, "bench_opl_timing: ring full\n");
+                    exit(1);
+                }
+            }
+            // Scheduled from the exact due time, as RunSequencer does.
+            const uint64_t delay = next_delay(t);
+            t->due += delay;
+            t->score += delay;
+        }
+
+        unsigned filled = 0;
+        while (filled < BUFFER_SAMPLES) {
+            unsigned nsamples = BUFFER_SAMPLES - filled;
+            uint32_t reg, value;
+            while (!opl_ring_empty(&ring)) {
+                const uint32_t due_in = opl_ring_due_in(&ring, (uint32_t)synth_sample);
+                if (due_in) {
+                    if (due_in < nsamples) nsamples = due_in;
+                    break;
+                }
+                land(timing, synth_sample, slot_score[ring.tail & (OPL_RING_SIZE - 1)], 1);
+                opl_ring_pop(&ring, &reg, &value);
+            }
+            filled += nsamples;
+            synth_sample += nsamples;
+        }
+    }
+}
+
+static void report(const char *name, const timing_t *t) {
+    printf("  %-12s %8llu writes  error avg %6.3f  max %4llu samples  drift at end %+lld samples (%+.2f ms)\n",
+           name, (unsigned long long)t->writes, t->writes ? (double)t->err_sum / t->writes : 0.0,
+           (unsigned long long)t->err_max, (long long)t->last_err,
+           t->last_err * 1000.0 / PICO_SOUND_SAMPLE_FREQ);
+}
+
+int main(int argc, char **argv) {
+    const int seconds = argc > 1 ? atoi(argv[1]) : 600;
+    const uint64_t buffers = (uint64_t)seconds * PICO_SOUND_SAMPLE_FREQ / BUFFER_SAMPLES;
+
+    timing_t old_timing = {0}, ring_timing = {0};
+    run_old(buffers, &old_timing);
+    run_ring(buffers, &ring_timing);
+
+    printf("bench_opl_timing: %d s of music, %d tracks, buffers of %d samples at %d Hz\n",
+           seconds, TRACKS, BUFFER_SAMPLES, PICO_SOUND_SAMPLE_FREQ);
+    report("segment loop", &old_timing);
+    report("write ring", &ring_timing);
+
+    // Cost of the ring itself: one push and one pop per write.
+    const int iterations = 10000000;
+    uint32_t reg, value, sink = 0;
+    opl_ring_init(&ring);
+    const uint64_t t0 = bench_now_ns();
+    for (int i = 0; i < iterations; i++) {
+        opl_ring_push(&ring, (uint32_t)i, (uint32_t)i & 0x1ff, (uint32_t)i & 0xff);
+        if ((i & 63) == 63) {
+            while (!opl_ring_empty(&ring)) {
+                opl_ring_pop(&ring, &reg, &value);
+                sink += reg ^ value;
+            }
+        }
+    }
+    const uint64_t t1 = bench_now_ns();
+    printf("  ring push + pop %.2f ns per write (%u)\n", (double)(t1 - t0) / iterations, sink & 1);
+
+    return ring_timing.err_max == 0 ? 0 : 1;
+}
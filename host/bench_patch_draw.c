@@ -0,0 +1,258 @@
+/*
+ * Patch drawing benchmark: V_DrawPatch's column loop against the row-major
+ * span form in src/murmdoom_patchspan.c, on the patches of a menu frame and
+ * an intermission frame.
+ *
+ *   build-host/bench_patch_draw [frames]
+ *
+ * The patches are synthetic, sized and shaped like the shareware ones: the
+ * intermission redraws a full-screen background (posts split at 128 rows as
+ * in the WAD) and its text and digits every frame, the menu draws the title,
+ * six items and the skull. Besides host time, each way is run through a
+ * model of the RP2350 XIP cache (16 KB, 2-way, 8-byte lines) that sees the
+ * framebuffer writes and the patch reads, as both sit in PSRAM. Both ways
+ * must produce the same frame.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "murmdoom_patchspan.h"
+
+#define SCREEN_W 320
+#define SCREEN_H 240
+#define MAX_PATCHES 32
+
+#define CACHE_LINE 8
+#define CACHE_WAYS 2
+#define CACHE_SETS (16 * 1024 / CACHE_LINE / CACHE_WAYS)
+
+typedef struct {
+    patch_t *patch;
+    byte *spans;
+    int x, y;
+} placed_t;
+
+typedef struct {
+    const char *name;
+    placed_t patches[MAX_PATCHES];
+    int count;
+} frame_t;
+
+static byte screen_old[SCREEN_W * SCREEN_H];
+static byte screen_new[SCREEN_W * SCREEN_H];
+
+static uint32_t rng = 0x2545f491u;
+
+// A w x h patch, encoded from a raster as the WAD tools do: runs of opaque
+// pixels down each column, split into posts of at most 128 rows. Opaque
+// patches are solid; others are a few random strokes, like glyphs.
+static patch_t *make_patch(int w, int h, int opaque) {
+    byte *raster = calloc(1, (size_t)w * h);
+    if (opaque) {
+        memset(raster, 1, (size_t)w * h);
+    } else {
+        for (int stroke = 0; stroke < w / 3 + 2; stroke++) {
+            const int vertical = bench_rand(&rng) & 1;
+            const int sw = vertical ? 2 + (int)(bench_rand(&rng) % 3) : 3 + (int)(bench_rand(&rng) % (unsigned)(w / 2 + 1));
+            const int sh = vertical ? 3 + (int)(bench_rand(&rng) % (unsigned)h) : 2 + (int)(bench_rand(&rng) % 2);
+            const int sx = (int)(bench_rand(&rng) % (unsigned)w), sy = (int)(bench_rand(&rng) % (unsigned)h);
+            for (int y = sy; y < sy + sh && y < h; y++) {
+                for (int x = sx; x < sx + sw && x < w; x++) raster[y * w + x] = 1;
+            }
+        }
+    }
+
+    byte *data = calloc(1, 8 + 4 * w + (size_t)w * (h + 4 * (h / 2 + 2) + 1));
+    patch_t *patch = (patch_t *)data;
+    patch->width = (short)w;
+    patch->height = (short)h;
+    byte *p = data + 8 + 4 * w;
+
+    for (int col = 0; col < w; col++) {
+        patch->columnofs[col] = (int)(p - data);
+        for (int y = 0; y < h;) {
+            if (!raster[y * w + col]) {
+                y++;
+                continue;
+            }
+            int length = 0;
+            while (y + length < h && length < 128 && raster[(y + length) * w + col]) length++;
+            *p++ = (byte)y;
+            *p++ = (byte)length;
+            *p++ = 0;
+            for (int i = 0; i < length; i++) *p++ = (byte)bench_rand(&rng);
+            *p++ = 0;
+            y += length;
+        }
+        *p++ = 0xff;
+    }
+    free(raster);
+    return patch;
+}
+
+static void place(frame_t *f, int x, int y, int w, int h, int opaque) {
+    placed_t *pl = &f->patches[f->count++];
+    pl->patch = make_patch(w, h, opaque);
+    pl->x = x;
+    pl->y = y;
+    pl->spans = NULL;
+}
+
+// The column loop from V_DrawPatch.
+static void draw_columns(byte *screen, const placed_t *pl) {
+    const patch_t *patch = pl->patch;
+    byte *desttop = screen + pl->y * SCREEN_W + pl->x;
+    for (int col = 0; col < patch->width; col++, desttop++) {
+        const column_t *column = (const column_t *)((const byte *)patch + patch->columnofs[col]);
+        while (column->topdelta != 0xff) {
+            const byte *source = (const byte *)column + 3;
+            byte *dest = desttop + column->topdelta * SCREEN_W;
+            int count = column->length;
+            while (count--) {
+                *dest = *source++;
+                dest += SCREEN_W;
+            }
+            column = (const column_t *)((const byte *)column + column->length + 4);
+        }
+    }
+}
+
+// --- XIP cache model --------------------------------------------------------
+
+static uintptr_t tags[CACHE_SETS][CACHE_WAYS];
+static uint64_t misses;
+
+static void cache_reset(void) {
+    memset(tags, 0, sizeof(tags));
+    misses = 0;
+}
+
+static void touch(const void *addr) {
+    const uintptr_t line = (uintptr_t)addr / CACHE_LINE;
+    uintptr_t *set = tags[line % CACHE_SETS];
+    // Way 0 is the most recently used.
+    if (set[0] == line) return;
+    if (set[1] != line) misses++;
+    set[1] = set[0];
+    set[0] = line;
+}
+
+static void touch_range(const byte *p, int n) {
+    for (const byte *end = p + n; p < end; p = (const byte *)(((uintptr_t)p / CACHE_LINE + 1) * CACHE_LINE)) {
+        touch(p);
+    }
+}
+
+static void model_columns(const placed_t *pl) {
+    const patch_t *patch = pl->patch;
+    const byte *desttop = screen_old + pl->y * SCREEN_W + pl->x;
+    for (int col = 0; col < patch->width; col++, desttop++) {
+        touch(&patch->columnofs[col]);
+        const column_t *column = (const column_t *)((const byte *)patch + patch->columnofs[col]);
+        while (touch(column), column->topdelta != 0xff) {
+            const byte *source = (const byte *)column + 3;
+            const byte *dest = desttop + column->topdelta * SCREEN_W;
+            for (int i = 0; i < column->length; i++, dest += SCREEN_W) {
+                touch(source + i);
+                touch(dest);
+            }
+            column = (const column_t *)((const byte *)column + column->length + 4);
+        }
+    }
+}
+
+static void model_spans(const placed_t *pl) {
+    const byte *p = pl->spans;
+    const byte *dest = screen_new + pl->y * SCREEN_W + pl->x;
+    touch(p);
+    for (int rows = p[0] | p[1] << 8; p += 2, rows > 0; rows--, dest += SCREEN_W) {
+        for (;;) {
+            touch(p);
+            const int x = p[0] | p[1] << 8;
+            if (x == 0xffff) break;
+            const int length = p[2] | p[3] << 8;
+            touch_range(p + 4, length);
+            touch_range(dest + x, length);
+            p += 4 + length;
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+static int run(frame_t *f, int frames) {
+    uint64_t t0 = bench_now_ns();
+    size_t span_bytes = 0;
+    for (int i = 0; i < f->count; i++) {
+        const int size = patchspan_size(f->patches[i].patch);
+        f->patches[i].spans = malloc(size);
+        patchspan_build(f->patches[i].patch, f->patches[i].spans);
+        span_bytes += size;
+    }
+    const uint64_t build_ns = bench_now_ns() - t0;
+
+    memset(screen_old, 0, sizeof(screen_old));
+    memset(screen_new, 0, sizeof(screen_new));
+
+    t0 = bench_now_ns();
+    for (int n = 0; n < frames; n++) {
+        for (int i = 0; i < f->count; i++) draw_columns(screen_old, &f->patches[i]);
+    }
+    const uint64_t columns_ns = bench_now_ns() - t0;
+
+    t0 = bench_now_ns();
+    for (int n = 0; n < frames; n++) {
+        for (int i = 0; i < f->count; i++) {
+            const placed_t *pl = &f->patches[i];
+            patchspan_draw(pl->spans, screen_new + pl->y * SCREEN_W + pl->x, SCREEN_W);
+        }
+    }
+    const uint64_t spans_ns = bench_now_ns() - t0;
+
+    cache_reset();
+    for (int i = 0; i < f->count; i++) model_columns(&f->patches[i]);
+    const uint64_t columns_misses = misses;
+    cache_reset();
+    for (int i = 0; i < f->count; i++) model_spans(&f->patches[i]);
+    const uint64_t spans_misses = misses;
+
+    const int same = !memcmp(screen_old, screen_new, sizeof(screen_old));
+    printf("  %-12s %2d patches: columns %7.1f us/frame, spans %7.1f us/frame (%.2fx)\n", f->name, f->count,
+           columns_ns / 1000.0 / frames, spans_ns / 1000.0 / frames, (double)columns_ns / spans_ns);
+    printf("  %-12s XIP cache line misses per frame: columns %llu, spans %llu (%.1fx fewer)\n", "",
+           (unsigned long long)columns_misses, (unsigned long long)spans_misses,
+           (double)columns_misses / spans_misses);
+    printf("  %-12s span forms %zu KB, built once in %.1f us; frames %s\n", "", span_bytes / 1024,
+           build_ns / 1000.0, bench_verdict(same));
+    return same;
+}
+
+int main(int argc, char **argv) {
+    const int frames = argc > 1 ? atoi(argv[1]) : 2000;
+
+    // WI_Drawer: INTERPIC, level name, "finished", kills/items/secrets/time
+    // labels, 3-digit percentages and the time digits.
+    static frame_t intermission = { "intermission" };
+    place(&intermission, 0, 20, 320, 200, 1);
+    place(&intermission, 100, 22, 120, 14, 0);
+    place(&intermission, 130, 38, 60, 12, 0);
+    for (int i = 0; i < 4; i++) place(&intermission, 50, 70 + 24 * i, 70, 14, 0);
+    for (int i = 0; i < 3; i++) {
+        for (int d = 0; d < 3; d++) place(&intermission, 200 + 14 * d, 70 + 24 * i, 14, 16, 0);
+        place(&intermission, 244, 70 + 24 * i, 14, 16, 0);
+    }
+    for (int d = 0; d < 4; d++) place(&intermission, 200 + 14 * d, 142, 14, 16, 0);
+
+    // M_Drawer over the view: M_DOOM, the six main menu items and the skull.
+    static frame_t menu = { "menu" };
+    place(&menu, 94, 22, 132, 57, 0);
+    for (int i = 0; i < 6; i++) place(&menu, 97, 84 + 16 * i, 120, 15, 0);
+    place(&menu, 65, 82, 20, 19, 0);
+
+    printf("bench_patch_draw: %d frames\n", frames);
+    int same = run(&intermission, frames);
+    same &= run(&menu, frames);
+    return same ? 0 : 1;
+}
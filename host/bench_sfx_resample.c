@@ -0,0 +1,195 @@
+/*
+ * SFX rate conversion benchmark: the mixer's old nearest-sample fetch with a
+ * one-pole low-pass against the interpolating run mixer in
+ * src/murmdoom_resample.c, for speed and for quality.
+ *
+ *   build-host/bench_sfx_resample [buffers]
+ *
+ * The sources are 11025 Hz 8-bit signals cut into 249-sample blocks, as the
+ * mixer sees DMX sounds after ADPCM decoding. Quality is the SNR of each
+ * path's output against a float windowed-sinc resampling of the same 8-bit
+ * source, taken at whichever delay (in 1/16 source samples) suits the path
+ * best, so neither is penalised for latency alone.
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "i_picosound.h"
+#include "murmdoom_resample.h"
+
+#define SOURCE_FREQ 11025
+#define BLOCK 249
+#define BLOCKS 200
+#define SOURCE_LEN (BLOCK * BLOCKS)
+// One tic of audio, as i_picosound.c sizes its buffers.
+#define BUFFER_SAMPLES ((PICO_SOUND_SAMPLE_FREQ + 34) / 35)
+#define VOL 127
+#define SINC_TAPS 32            // each side
+
+static int8_t source[1 + SOURCE_LEN];
+static int16_t out_old[SOURCE_LEN * 5 * 2];
+static int16_t out_new[SOURCE_LEN * 5 * 2] __attribute__((aligned(4)));
+
+static int16_t clamp_s16(int32_t v) {
+    return v > INT16_MAX ? INT16_MAX : v < INT16_MIN ? INT16_MIN : (int16_t)v;
+}
+
+// The mixer before: per sample, fetch, low-pass, mix with clamping and check
+// for the end of the block.
+static uint32_t mix_old(int16_t *samples, uint32_t count, int *block, uint32_t offset, uint32_t step, int *lp) {
+    const int alpha256 = 256u * 201u * SOURCE_FREQ / (201u * SOURCE_FREQ + 64u * (unsigned)PICO_SOUND_SAMPLE_FREQ);
+    const int beta256 = 256 - alpha256;
+    const int8_t *data = source + 1 + *block * BLOCK;
+    int sample = *lp;
+    for (uint32_t s = 0; s < count; s++) {
+        sample = (beta256 * sample + alpha256 * data[offset >> 16]) / 256;
+        samples[0] = clamp_s16(samples[0] + sample * VOL);
+        samples[1] = clamp_s16(samples[1] + sample * VOL);
+        samples += 2;
+        offset += step;
+        if (offset >= BLOCK * 65536u) {
+            offset -= BLOCK * 65536u;
+            if (++*block == BLOCKS) break;
+            data = source + 1 + *block * BLOCK;
+        }
+    }
+    *lp = sample;
+    return offset;
+}
+
+// The mixer now: one run per block.
+static uint32_t mix_new(int16_t *samples, uint32_t count, int *block, uint32_t offset, uint32_t step) {
+    while (count && *block < BLOCKS) {
+        uint32_t run = resample_run(offset, BLOCK * 65536u, step);
+        if (run > count) run = count;
+        offset = resample_mix_s8(samples, run, source + 1 + *block * BLOCK, offset, step, VOL, VOL);
+        samples += run * 2;
+        count -= run;
+        if (offset >= BLOCK * 65536u) {
+            offset -= BLOCK * 65536u;
+            ++*block;
+        }
+    }
+    return offset;
+}
+
+static double sinc_at(double t) {
+    const int centre = (int)floor(t);
+    const double cutoff = (double)SOURCE_FREQ < PICO_SOUND_SAMPLE_FREQ ? 1.0 : (double)PICO_SOUND_SAMPLE_FREQ / SOURCE_FREQ;
+    double acc = 0;
+    for (int i = centre - SINC_TAPS + 1; i <= centre + SINC_TAPS; i++) {
+        if (i < 0 || i >= SOURCE_LEN) continue;
+        const double x = t - i;
+        const double w = 0.42 + 0.5 * cos(M_PI * x / SINC_TAPS) + 0.08 * cos(2 * M_PI * x / SINC_TAPS);
+        const double s = fabs(x) < 1e-9 ? 1.0 : sin(M_PI * x * cutoff) / (M_PI * x * cutoff);
+        acc += source[1 + i] * s * w * cutoff;
+    }
+    return acc;
+}
+
+// Compared over a window clear of the start, at delays of d/16 source
+// samples.
+#define WINDOW_START 1000
+#define WINDOW 8192
+#define DELAYS 33
+
+static double reference[DELAYS][WINDOW];
+
+static void build_reference(uint32_t step) {
+    for (int d = 0; d < DELAYS; d++) {
+        for (uint32_t n = 0; n < WINDOW; n++) {
+            reference[d][n] = VOL * sinc_at((double)(WINDOW_START + n) * step / 65536.0 - d / 16.0);
+        }
+    }
+}
+
+static double best_snr(const int16_t *out, int *best_delay) {
+    double best = -1e9;
+    for (int d = 0; d < DELAYS; d++) {
+        double sig = 0, err = 0;
+        for (uint32_t n = 0; n < WINDOW; n++) {
+            const double r = reference[d][n];
+            const double e = out[(WINDOW_START + n) * 2] - r;
+            sig += r * r;
+            err += e * e;
+        }
+        const double snr = 10 * log10(sig / (err ? err : 1e-9));
+        if (snr > best) {
+            best = snr;
+            *best_delay = d;
+        }
+    }
+    return best;
+}
+
+typedef struct {
+    const char *name;
+    double freq[3];
+} signal_t;
+
+static const signal_t signals[] = {
+    { "200 Hz", { 200 } },
+    { "1 kHz", { 1000 } },
+    { "3 kHz", { 3000 } },
+    { "chord", { 330, 1250, 4100 } },
+};
+
+int main(int argc, char **argv) {
+    const int buffers = argc > 1 ? atoi(argv[1]) : 20000;
+    const uint32_t step = SOURCE_FREQ * 65536u / PICO_SOUND_SAMPLE_FREQ;
+    const uint32_t outputs = (uint32_t)((uint64_t)SOURCE_LEN * 65536 / step) - 1;
+    int ok = 1;
+
+    printf("bench_sfx_resample: %d Hz 8-bit to %d Hz\n", SOURCE_FREQ, PICO_SOUND_SAMPLE_FREQ);
+    printf("  SNR against a windowed-sinc reference (best delay, source samples):\n");
+    for (size_t s = 0; s < sizeof(signals) / sizeof(signals[0]); s++) {
+        int parts = 0;
+        for (; parts < 3 && signals[s].freq[parts]; parts++) {}
+        for (int i = 0; i < SOURCE_LEN; i++) {
+            double v = 0;
+            for (int p = 0; p < parts; p++) v += sin(2 * M_PI * signals[s].freq[p] * i / SOURCE_FREQ);
+            source[1 + i] = (int8_t)lrint(100.0 * v / parts);
+        }
+        build_reference(step);
+
+        memset(out_old, 0, sizeof(out_old));
+        memset(out_new, 0, sizeof(out_new));
+        int block = 0, lp = 0;
+        mix_old(out_old, outputs, &block, 0, step, &lp);
+        block = 0;
+        mix_new(out_new, outputs, &block, 0, step);
+
+        int d_old = 0, d_new = 0;
+        const double snr_old = best_snr(out_old, &d_old);
+        const double snr_new = best_snr(out_new, &d_new);
+        printf("    %-7s nearest+low-pass %6.1f dB (%.2f)   linear %6.1f dB (%.2f)\n", signals[s].name,
+               snr_old, d_old / 16.0, snr_new, d_new / 16.0);
+        if (snr_new < snr_old) ok = 0;
+    }
+
+    // Speed: one channel mixed into one buffer at a time, as the mixer does.
+    uint64_t old_ns = 0, new_ns = 0;
+    int block_old = 0, block_new = 0, lp = 0;
+    uint32_t off_old = 0, off_new = 0;
+    for (int b = 0; b < buffers; b++) {
+        if (block_old == BLOCKS) block_old = 0, off_old = 0;
+        if (block_new == BLOCKS) block_new = 0, off_new = 0;
+        const uint64_t t0 = bench_now_ns();
+        off_old = mix_old(out_old, BUFFER_SAMPLES, &block_old, off_old, step, &lp);
+        const uint64_t t1 = bench_now_ns();
+        off_new = mix_new(out_new, BUFFER_SAMPLES, &block_new, off_new, step);
+        const uint64_t t2 = bench_now_ns();
+        old_ns += t1 - t0;
+        new_ns += t2 - t1;
+        memset(out_old, 0, BUFFER_SAMPLES * 4);
+        memset(out_new, 0, BUFFER_SAMPLES * 4);
+    }
+    const uint64_t samples = (uint64_t)buffers * BUFFER_SAMPLES;
+    printf("  nearest+low-pass %6.2f ns/sample\n", (double)old_ns / samples);
+    printf("  linear runs      %6.2f ns/sample  (%.1f%% of nearest+low-pass)\n", (double)new_ns / samples,
+           100.0 * new_ns / old_ns);
+    return ok ? 0 : 1;
+}
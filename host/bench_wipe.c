@@ -0,0 +1,275 @@
+/*
+ * Melt wipe check: the melt as vanilla ran it (transposed copies of both
+ * screens, each moving column rewritten in the screen every tic, the menu
+ * drawn on top) against f_wipe.c (the end screen left in I_VideoBuffer and
+ * each line composed as I_FinishUpdate copies it out, wipe_ComposeMelt
+ * once the menu shows).
+ *
+ *   build-host/bench_wipe [wipes]
+ *
+ * Each wipe melts a random screen into another, 1 to 3 tics per step. In
+ * most of them a menu, a few patch-like blocks that change from step to
+ * step as the skull does, is open for a random run of steps: from the
+ * start, from the middle, to the end, or opened and closed again. Every
+ * frame copied out, the screen left after the wipe and the M_Random
+ * values drawn must be the same both ways. Host time per wipe is printed
+ * for both.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "f_wipe.h"
+#include "i_video.h"
+#include "m_random.h"
+#include "z_zone.h"
+
+#define SCREEN_BYTES (SCREENWIDTH * SCREENHEIGHT)
+#define MAX_STEPS 256
+
+// ----------------------------------------------------------------------------
+// What f_wipe.c needs from the engine.
+
+byte *I_VideoBuffer;
+
+extern int rndindex;            // m_random.c, M_Random's place in its table
+
+void I_ReadScreen(byte *scr) {
+    memcpy(scr, I_VideoBuffer, SCREEN_BYTES);
+}
+
+void V_MarkRect(int x, int y, int width, int height) {
+    (void)x;
+    (void)y;
+    (void)width;
+    (void)height;
+}
+
+void *Z_Malloc(int size, int tag, void *ptr) {
+    (void)tag;
+    (void)ptr;
+    void *p = malloc(size);
+    if (!p) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+    return p;
+}
+
+void Z_Free(void *ptr) {
+    free(ptr);
+}
+
+// ----------------------------------------------------------------------------
+// Vanilla's melt (f_wipe.c before the line composition).
+
+static byte *old_scr;
+static byte *old_start;
+static byte *old_end;
+static int old_y[SCREENWIDTH / 2];
+
+static void col_major(short *array, int width, int height) {
+    short *dest = malloc(width * height * 2);
+    for (int y = 0; y < height; y++)
+        for (int x = 0; x < width; x++) dest[x * height + y] = array[y * width + x];
+    memcpy(array, dest, width * height * 2);
+    free(dest);
+}
+
+static void old_init(void) {
+    const int width = SCREENWIDTH / 2;
+    memcpy(old_scr, old_start, SCREEN_BYTES);
+    col_major((short *)old_start, width, SCREENHEIGHT);
+    col_major((short *)old_end, width, SCREENHEIGHT);
+    // Vanilla's y[] has SCREENWIDTH entries, all drawn, half of them used.
+    int y[SCREENWIDTH];
+    y[0] = -(M_Random() % 16);
+    for (int i = 1; i < SCREENWIDTH; i++) {
+        const int r = (M_Random() % 3) - 1;
+        y[i] = y[i - 1] + r;
+        if (y[i] > 0) y[i] = 0;
+        else if (y[i] == -16) y[i] = -15;
+    }
+    memcpy(old_y, y, sizeof(old_y));
+}
+
+static int old_do(int ticks) {
+    const int width = SCREENWIDTH / 2;
+    const int height = SCREENHEIGHT;
+    int done = 1;
+
+    while (ticks--) {
+        for (int i = 0; i < width; i++) {
+            if (old_y[i] < 0) {
+                old_y[i]++;
+                done = 0;
+            } else if (old_y[i] < height) {
+                int dy = (old_y[i] < 16) ? old_y[i] + 1 : 8;
+                if (old_y[i] + dy >= height) dy = height - old_y[i];
+                const short *s = &((short *)old_end)[i * height + old_y[i]];
+                short *d = &((short *)old_scr)[old_y[i] * width + i];
+                for (int j = dy, idx = 0; j; j--, idx += width) d[idx] = *(s++);
+                old_y[i] += dy;
+                s = &((short *)old_start)[i * height];
+                d = &((short *)old_scr)[old_y[i] * width + i];
+                for (int j = height - old_y[i], idx = 0; j; j--, idx += width) d[idx] = *(s++);
+                done = 0;
+            }
+        }
+    }
+    return done;
+}
+
+// ----------------------------------------------------------------------------
+
+typedef struct {
+    int steps;
+    int ticks[MAX_STEPS];
+    int menu[MAX_STEPS];        // M_Drawer draws on this step
+} plan_t;
+
+// M_Drawer: the menu title, items and the skull, with transparent gaps as
+// patches have, and the skull animating.
+static void draw_menu(byte *screen, int step) {
+    static const int boxes[][4] = {
+        {94, 2, 132, 40}, {97, 64, 120, 16}, {97, 80, 120, 16}, {97, 96, 120, 16},
+        {65, 60 + 0, 20, 20},
+    };
+    for (size_t b = 0; b < sizeof(boxes) / sizeof(boxes[0]); b++) {
+        const int skull = b == sizeof(boxes) / sizeof(boxes[0]) - 1;
+        for (int y = 0; y < boxes[b][3]; y++) {
+            for (int x = 0; x < boxes[b][2]; x++) {
+                const int v = (x * 7 + y * 13 + (int)b * 31 + (skull ? step / 8 : 0) * 5) & 0xff;
+                if (v % 5) screen[(boxes[b][1] + y) * SCREENWIDTH + boxes[b][0] + x] = (byte)v;
+            }
+        }
+    }
+}
+
+static void random_screen(byte *screen) {
+    for (int i = 0; i < SCREEN_BYTES; i++) screen[i] = (byte)rand();
+}
+
+static void make_plan(plan_t *p) {
+    const int from = rand() % 48;
+    const int kind = rand() % 5;
+    int to;
+
+    switch (kind) {
+    case 0: to = -1; break;                        // no menu
+    case 1: to = MAX_STEPS; break;                 // open to the end
+    default: to = from + 1 + rand() % 24; break;   // opened and closed
+    }
+    p->steps = 0;
+    for (int s = 0; s < MAX_STEPS; s++) {
+        p->ticks[s] = 1 + rand() % 3;
+        p->menu[s] = kind == 4 ? s < to : (s >= from && s < to);
+    }
+}
+
+// The melt from start to end as vanilla showed it; frames[] gets every
+// frame copied out, screen what I_VideoBuffer holds after it.
+static int run_old(const byte *start, const byte *end, const plan_t *p, byte *frames, byte *screen,
+                   uint64_t *ns) {
+    old_scr = screen;
+    old_start = malloc(SCREEN_BYTES);
+    old_end = malloc(SCREEN_BYTES);
+    memcpy(old_start, start, SCREEN_BYTES);
+    memcpy(old_end, end, SCREEN_BYTES);
+    memcpy(old_scr, start, SCREEN_BYTES);
+    M_ClearRandom();
+
+    const uint64_t t0 = bench_now_ns();
+    int s = 0;
+    for (int done = 0; !done && s < MAX_STEPS; s++) {
+        if (s == 0) old_init();
+        done = old_do(p->ticks[s]);
+        if (p->menu[s]) draw_menu(old_scr, s);
+        memcpy(frames + (size_t)s * SCREEN_BYTES, old_scr, SCREEN_BYTES);
+    }
+    *ns += bench_now_ns() - t0;
+    free(old_start);
+    free(old_end);
+    return s;
+}
+
+static int run_new(const byte *start, const byte *end, const plan_t *p, byte *frames, byte *screen,
+                   uint64_t *ns) {
+    I_VideoBuffer = screen;
+    memcpy(screen, start, SCREEN_BYTES);
+    wipe_StartScreen(0, 0, SCREENWIDTH, SCREENHEIGHT);
+    memcpy(screen, end, SCREEN_BYTES);
+    wipe_EndScreen(0, 0, SCREENWIDTH, SCREENHEIGHT);
+    M_ClearRandom();
+
+    const uint64_t t0 = bench_now_ns();
+    int s = 0;
+    for (int done = 0; !done && s < MAX_STEPS; s++) {
+        done = wipe_ScreenWipe(wipe_Melt, 0, 0, SCREENWIDTH, SCREENHEIGHT, p->ticks[s]);
+        if (p->menu[s]) {
+            wipe_ComposeMelt();
+            draw_menu(screen, s);
+        }
+        // I_FinishUpdate
+        for (int row = 0; row < SCREENHEIGHT; row++) {
+            const byte *line = wipe_melting ? wipe_MeltLine(row) : screen + row * SCREENWIDTH;
+            memcpy(frames + (size_t)s * SCREEN_BYTES + row * SCREENWIDTH, line, SCREENWIDTH);
+        }
+    }
+    *ns += bench_now_ns() - t0;
+    return s;
+}
+
+int main(int argc, char **argv) {
+    const int wipes = argc > 1 ? atoi(argv[1]) : 200;
+    byte *start = malloc(SCREEN_BYTES), *end = malloc(SCREEN_BYTES);
+    byte *screen_old = malloc(SCREEN_BYTES), *screen_new = malloc(SCREEN_BYTES);
+    byte *frames_old = malloc((size_t)MAX_STEPS * SCREEN_BYTES);
+    byte *frames_new = malloc((size_t)MAX_STEPS * SCREEN_BYTES);
+    uint64_t old_ns = 0, new_ns = 0;
+    int with_menu = 0, differ = 0;
+    static plan_t plan;
+
+    srand(1);
+    for (int w = 0; w < wipes; w++) {
+        random_screen(start);
+        random_screen(end);
+        make_plan(&plan);
+
+        const int n_old = run_old(start, end, &plan, frames_old, screen_old, &old_ns);
+        const int rnd_old = rndindex;
+        const int n_new = run_new(start, end, &plan, frames_new, screen_new, &new_ns);
+        const int rnd_new = rndindex;
+        int menu = 0;
+        for (int s = 0; s < n_old; s++) menu |= plan.menu[s];
+        with_menu += menu;
+
+        int bad = n_old != n_new ? 0 : -1;
+        for (int s = 0; bad < 0 && s < n_old; s++) {
+            if (memcmp(frames_old + (size_t)s * SCREEN_BYTES, frames_new + (size_t)s * SCREEN_BYTES,
+                       SCREEN_BYTES)) {
+                bad = s;
+            }
+        }
+        if (bad < 0 && memcmp(screen_old, screen_new, SCREEN_BYTES)) bad = n_old;
+        if (bad < 0 && rnd_old != rnd_new) {
+            bad = n_old;
+            if (!differ) {
+                printf("  wipe %d: M_Random index %d after vanilla's melt, %d after f_wipe.c's\n", w, rnd_old,
+                       rnd_new);
+            }
+        } else if (bad >= 0 && !differ) {
+            printf("  wipe %d: %d/%d steps, first difference at step %d\n", w, n_old, n_new, bad);
+        }
+        if (bad >= 0) {
+            differ++;
+        }
+    }
+
+    printf("  %d wipes, %d with the menu open for part of them\n", wipes, with_menu);
+    printf("  vanilla %7.1f us/wipe, composed %7.1f us/wipe (%.2fx); frames and M_Random %s\n",
+           old_ns / 1000.0 / wipes, new_ns / 1000.0 / wipes, (double)old_ns / new_ns,
+           bench_verdict(!differ));
+    return differ ? 1 : 0;
+}
@@ -0,0 +1,249 @@
+/*
+ * FatFs disk I/O for the host build: a FAT image file, or a RAM volume filled
+ * from a host directory (see host.h).
+ */
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+// FatFs and POSIX both name their directory handle DIR.
+#define DIR FF_DIR
+#include "ff.h"
+#include "diskio.h"
+#undef DIR
+#include <dirent.h>
+
+#include "murmdoom_prof.h"
+#include "host.h"
+
+#define SECTOR_SIZE 512u
+
+static int image_fd = -1;           // image file mode
+static uint8_t *ram = NULL;         // RAM volume mode
+static LBA_t sector_count = 0;
+static char source_dir[512];        // RAM volume: host directory to copy back to
+
+// ---------------------------------------------------------------------------
+// diskio.h
+
+DSTATUS disk_initialize(BYTE pdrv) {
+    return disk_status(pdrv);
+}
+
+DSTATUS disk_status(BYTE pdrv) {
+    if (pdrv != 0) return STA_NOINIT;
+    return (image_fd >= 0 || ram) ? 0 : STA_NODISK;
+}
+
+DRESULT disk_read(BYTE pdrv, BYTE *buff, LBA_t sector, UINT count) {
+    PROF_SCOPE(PROF_DISK);
+    if (pdrv != 0 || sector + count > sector_count) return RES_PARERR;
+    const size_t size = (size_t)count * SECTOR_SIZE;
+    const off_t offset = (off_t)sector * SECTOR_SIZE;
+    if (ram) {
+        memcpy(buff, ram + offset, size);
+        return RES_OK;
+    }
+    // Read through a local buffer: the destination may be a protected PSRAM
+    // page (latency injection), which the kernel would refuse with EFAULT.
+    uint8_t bounce[8 * SECTOR_SIZE];
+    for (size_t done = 0; done < size; ) {
+        const size_t n = size - done < sizeof(bounce) ? size - done : sizeof(bounce);
+        if (pread(image_fd, bounce, n, offset + (off_t)done) != (ssize_t)n) return RES_ERROR;
+        memcpy(buff + done, bounce, n);
+        done += n;
+    }
+    return RES_OK;
+}
+
+DRESULT disk_write(BYTE pdrv, const BYTE *buff, LBA_t sector, UINT count) {
+    if (pdrv != 0 || sector + count > sector_count) return RES_PARERR;
+    const size_t size = (size_t)count * SECTOR_SIZE;
+    const off_t offset = (off_t)sector * SECTOR_SIZE;
+    if (ram) {
+        memcpy(ram + offset, buff, size);
+        return RES_OK;
+    }
+    uint8_t bounce[8 * SECTOR_SIZE];
+    for (size_t done = 0; done < size; ) {
+        const size_t n = size - done < sizeof(bounce) ? size - done : sizeof(bounce);
+        memcpy(bounce, buff + done, n);
+        if (pwrite(image_fd, bounce, n, offset + (off_t)done) != (ssize_t)n) return RES_ERROR;
+        done += n;
+    }
+    return RES_OK;
+}
+
+DRESULT disk_ioctl(BYTE pdrv, BYTE cmd, void *buff) {
+    if (pdrv != 0) return RES_PARERR;
+    switch (cmd) {
+        case CTRL_SYNC:
+            if (image_fd >= 0) fsync(image_fd);
+            return RES_OK;
+        case GET_SECTOR_COUNT:
+            *(LBA_t *)buff = sector_count;
+            return RES_OK;
+        case GET_SECTOR_SIZE:
+            *(WORD *)buff = SECTOR_SIZE;
+            return RES_OK;
+        case GET_BLOCK_SIZE:
+            *(DWORD *)buff = 1;
+            return RES_OK;
+        default:
+            return RES_PARERR;
+    }
+}
+
+DWORD get_fattime(void) {
+    const time_t now = time(NULL);
+    struct tm tm;
+    localtime_r(&now, &tm);
+    return (DWORD)(tm.tm_year - 80) << 25 | (DWORD)(tm.tm_mon + 1) << 21 | (DWORD)tm.tm_mday << 16 |
+           (DWORD)tm.tm_hour << 11 | (DWORD)tm.tm_min << 5 | (DWORD)(tm.tm_sec / 2);
+}
+
+// ---------------------------------------------------------------------------
+// RAM volume
+
+static uint64_t dir_size(const char *path) {
+    uint64_t total = 0;
+    DIR *dir = opendir(path);
+    if (!dir) return 0;
+    struct dirent *de;
+    while ((de = readdir(dir)) != NULL) {
+        if (de->d_name[0] == '.' && (!de->d_name[1] || (de->d_name[1] == '.' && !de->d_name[2]))) continue;
+        char child[1024];
+        snprintf(child, sizeof(child), "%s/%s", path, de->d_name);
+        struct stat st;
+        if (stat(child, &st)) continue;
+        // Round every file up to a 4KB cluster and add room for directories.
+        total += S_ISDIR(st.st_mode) ? dir_size(child) + 4096 : ((uint64_t)st.st_size + 4095) & ~4095ull;
+    }
+    closedir(dir);
+    return total;
+}
+
+static bool copy_in(const char *host_path, const char *fat_path) {
+    DIR *dir = opendir(host_path);
+    if (!dir) return false;
+    bool ok = true;
+    struct dirent *de;
+    static uint8_t chunk[64 * 1024];
+    while (ok && (de = readdir(dir)) != NULL) {
+        if (de->d_name[0] == '.' && (!de->d_name[1] || (de->d_name[1] == '.' && !de->d_name[2]))) continue;
+        char child[1024], fat_child[1024];
+        snprintf(child, sizeof(child), "%s/%s", host_path, de->d_name);
+        snprintf(fat_child, sizeof(fat_child), "%s/%s", fat_path, de->d_name);
+        struct stat st;
+        if (stat(child, &st)) continue;
+        if (S_ISDIR(st.st_mode)) {
+            ok = f_mkdir(fat_child) == FR_OK && copy_in(child, fat_child);
+            continue;
+        }
+        const int fd = open(child, O_RDONLY);
+        FIL fil;
+        if (fd < 0 || f_open(&fil, fat_child, FA_WRITE | FA_CREATE_ALWAYS) != FR_OK) {
+            printf("host disk: cannot copy %s\n", child);
+            if (fd >= 0) close(fd);
+            ok = false;
+            break;
+        }
+        ssize_t n;
+        while ((n = read(fd, chunk, sizeof(chunk))) > 0) {
+            UINT written;
+            if (f_write(&fil, chunk, (UINT)n, &written) != FR_OK || written != (UINT)n) {
+                ok = false;
+                break;
+            }
+        }
+        f_close(&fil);
+        close(fd);
+    }
+    closedir(dir);
+    return ok;
+}
+
+// Write /doom/<fat_path> back to <host dir>/<fat_path>, recursively.
+static void copy_out(const char *fat_path) {
+    FF_DIR dir;
+    FILINFO info;
+    char fat_dir[512], host_dir[1024];
+    snprintf(fat_dir, sizeof(fat_dir), "/doom/%s", fat_path);
+    if (f_opendir(&dir, fat_dir) != FR_OK) return;
+    snprintf(host_dir, sizeof(host_dir), "%s/%s", source_dir, fat_path);
+    mkdir(host_dir, 0755);
+
+    static uint8_t chunk[64 * 1024];
+    while (f_readdir(&dir, &info) == FR_OK && info.fname[0]) {
+        char fat_child[512], host_child[1024];
+        snprintf(fat_child, sizeof(fat_child), "%s/%s", fat_path, info.fname);
+        if (info.fattrib & AM_DIR) {
+            copy_out(fat_child);
+            continue;
+        }
+        snprintf(fat_child, sizeof(fat_child), "%s/%s", fat_dir, info.fname);
+        snprintf(host_child, sizeof(host_child), "%s/%s", host_dir, info.fname);
+        FIL fil;
+        if (f_open(&fil, fat_child, FA_READ) != FR_OK) continue;
+        const int fd = open(host_child, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        UINT n;
+        while (fd >= 0 && f_read(&fil, chunk, sizeof(chunk), &n) == FR_OK && n > 0) {
+            if (write(fd, chunk, n) != (ssize_t)n) break;
+        }
+        if (fd >= 0) close(fd);
+        f_close(&fil);
+    }
+    f_closedir(&dir);
+}
+
+// Free space on the RAM volume. Golden frames (-framehash record) take 75 KB
+// per frame; calloc'd pages cost nothing until written.
+#define RAM_VOLUME_HEADROOM ((uint64_t)512 * 1024 * 1024)
+
+static bool ram_volume(const char *path) {
+    const uint64_t size = (dir_size(path) + RAM_VOLUME_HEADROOM + 0xFFFFF) & ~0xFFFFFull;
+    ram = calloc(1, (size_t)size);
+    if (!ram) return false;
+    sector_count = (LBA_t)(size / SECTOR_SIZE);
+
+    static uint8_t work[FF_MAX_SS * 8];
+    const MKFS_PARM opt = { FM_ANY, 0, 0, 0, 0 };
+    FATFS fs;
+    if (f_mkfs("", &opt, work, sizeof(work)) != FR_OK || f_mount(&fs, "", 1) != FR_OK ||
+        f_mkdir("/doom") != FR_OK) {
+        return false;
+    }
+    const bool ok = copy_in(path, "/doom");
+    f_mount(NULL, "", 0);
+    snprintf(source_dir, sizeof(source_dir), "%s", path);
+    printf("host disk: %s in a %lu MB RAM volume\n", path, (unsigned long)(size >> 20));
+    return ok;
+}
+
+bool host_disk_open(const char *path) {
+    struct stat st;
+    if (stat(path, &st)) return false;
+    if (S_ISDIR(st.st_mode)) return ram_volume(path);
+
+    image_fd = open(path, O_RDWR);
+    if (image_fd < 0) return false;
+    sector_count = (LBA_t)(st.st_size / SECTOR_SIZE);
+    return true;
+}
+
+void host_disk_close(void) {
+    if (ram && source_dir[0]) {
+        // The RAM volume is still mounted by DG_Init(); keep what the run produced.
+        copy_out("bench");
+        copy_out("golden");
+        copy_out(".savegame");
+    }
+    if (image_fd >= 0) {
+        close(image_fd);
+        image_fd = -1;
+    }
+}
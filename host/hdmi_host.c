@@ -0,0 +1,135 @@
+/*
+ * drivers/HDMI.h for the host build: keeps the framebuffer pointer and the
+ * 256-entry palette, and converts frames to RGB on demand (see host.h).
+ */
+#include <string.h>
+
+#include "HDMI.h"
+
+#include "pico/time.h"
+
+#include "host.h"
+
+// Refreshes are emulated at 60 Hz of wall time. A presented buffer goes on
+// screen at the first refresh after it was queued, evaluated lazily.
+#define HOST_REFRESH_HZ 60
+
+static uint8_t *framebuffer = NULL;
+static int width = 320;
+static int height = 240;
+static int shift_x = 0;
+static int shift_y = 0;
+static uint32_t palette[256];
+static uint32_t bgcolor = 0;
+static uint32_t frames = 0;
+static uint8_t *pending = NULL;
+static uint32_t pending_vsync = 0;
+static uint32_t present_vsync = 0;
+
+void graphics_init(g_out g_out) {
+    (void)g_out;
+}
+
+void graphics_set_buffer(uint8_t *buffer) {
+    framebuffer = buffer;
+}
+
+uint8_t *graphics_get_buffer(void) {
+    return framebuffer;
+}
+
+uint32_t graphics_get_vsync_count(void) {
+    const uint32_t now = (uint32_t)(time_us_64() * HOST_REFRESH_HZ / 1000000);
+    if (pending && now != pending_vsync) {
+        framebuffer = pending;
+        pending = NULL;
+        present_vsync = pending_vsync + 1;
+    }
+    return now;
+}
+
+void graphics_present_buffer(uint8_t *buffer) {
+    pending_vsync = graphics_get_vsync_count();
+    pending = buffer;
+}
+
+bool graphics_present_pending(void) {
+    graphics_get_vsync_count();
+    return pending != NULL;
+}
+
+uint32_t graphics_get_present_vsync(void) {
+    return present_vsync;
+}
+
+uint32_t graphics_get_vsync_time_us(void) {
+    const uint64_t count = graphics_get_vsync_count();
+    return (uint32_t)((count * 1000000 + HOST_REFRESH_HZ - 1) / HOST_REFRESH_HZ);
+}
+
+uint32_t graphics_get_width(void) {
+    return (uint32_t)width;
+}
+
+uint32_t graphics_get_height(void) {
+    return (uint32_t)height;
+}
+
+void graphics_set_res(int w, int h) {
+    width = w;
+    height = h;
+}
+
+void graphics_set_shift(int x, int y) {
+    shift_x = x;
+    shift_y = y;
+}
+
+void graphics_set_palette(uint8_t i, uint32_t color888) {
+    palette[i] = color888;
+}
+
+void graphics_restore_sync_colors(void) {
+}
+
+void startVIDEO(uint8_t vol) {
+    (void)vol;
+}
+
+void set_palette(uint8_t n) {
+    if (n >= sizeof(tab_color) / sizeof(tab_color[0])) return;
+    for (int i = 0; i < 16; ++i) {
+        palette[i] = tab_color[n][i];
+    }
+}
+
+struct video_mode_t graphics_get_video_mode(int mode) {
+    (void)mode;
+    struct video_mode_t vm = { 800, 640, 60, 25200000 };
+    return vm;
+}
+
+void graphics_set_bgcolor(uint32_t color888) {
+    bgcolor = color888;
+}
+
+void host_hdmi_scanout(uint8_t *rgb) {
+    for (int y = 0; y < height; ++y) {
+        const int sy = y - shift_y;
+        for (int x = 0; x < width; ++x) {
+            const int sx = x - shift_x;
+            uint32_t c = bgcolor;
+            if (framebuffer && sx >= 0 && sx < width && sy >= 0 && sy < height) {
+                c = palette[framebuffer[sy * width + sx]];
+            }
+            *rgb++ = (uint8_t)(c >> 16);
+            *rgb++ = (uint8_t)(c >> 8);
+            *rgb++ = (uint8_t)c;
+        }
+    }
+    frames++;
+}
+
+uint32_t host_hdmi_frames(void) {
+    return frames;
+}
@@ -0,0 +1,216 @@
+# Host (Linux) build of murmdoom for benchmarking:
+#
+#   cmake -DMURMDOOM_HOST_BUILD=ON -S . -B build-host && cmake --build build-host
+#   build-host/murmdoom_host -sd sd/ -iwad doom1.wad -timedemo demo1
+#
+# The engine, platform layer (start screen, benchmark, profiler, FatFs
+# stdio), sound mixer, OPL emulator and PSRAM allocator are the firmware
+# sources. host/include stands in for the Pico SDK headers, and the files in
+# host/ replace the drivers that talk to hardware: HDMI scanout, I2S, PSRAM
+# setup, SD card and PS/2 input. See host/host.h for the knobs.
+
+add_executable(murmdoom_host
+    host/main_host.c
+    host/pico_host.c
+    host/audio_i2s_host.c
+    host/diskio_host.c
+    host/hdmi_host.c
+    host/input_host.c
+    host/psram_host.c
+    drivers/psram_allocator.c
+    src/fatfs/ff.c
+    src/fatfs/ffunicode.c
+    src/fatfs/ffsystem.c
+    ${MURMDOOM_PLATFORM_SOURCES}
+    ${DOOMGENERIC_SOURCES}
+)
+
+target_include_directories(murmdoom_host PRIVATE
+    host
+    host/include
+    ${MURMDOOM_INCLUDE_DIRS}
+    drivers/ps2kbd
+)
+
+target_compile_definitions(murmdoom_host PRIVATE
+    BOARD_${BOARD_VARIANT}
+    CPU_CLOCK_MHZ=${CPU_SPEED}
+    PSRAM_MAX_FREQ_MHZ=${PSRAM_SPEED}
+    DCPU_SPEED=${CPU_SPEED}
+    DPSRAM_SPEED=${PSRAM_SPEED}
+    DBOARD_VARIANT="${BOARD_VARIANT}"
+    ${MURMDOOM_FEATURE_DEFINITIONS}
+    PICO_AUDIO_I2S_PIO=1
+    PICO_AUDIO_I2S_STATE_MACHINE=2
+    PICO_AUDIO_I2S_DMA_IRQ=1
+    PICO_AUDIO_I2S_DATA_PIN=26
+    PICO_AUDIO_I2S_CLOCK_PIN_BASE=27
+    EMU8950_ASM=0
+    PICO_BUILD=1
+    PICO_ON_DEVICE=0
+    MURMDOOM_HOT_SRAM=0
+)
+
+if(MURMDOOM_QUIET)
+    target_compile_definitions(murmdoom_host PRIVATE MURMDOOM_QUIET=1)
+else()
+    target_compile_definitions(murmdoom_host PRIVATE MURMDOOM_QUIET=0)
+endif()
+
+if(MURMDOOM_PROF)
+    target_compile_definitions(murmdoom_host PRIVATE MURMDOOM_PROF=1)
+else()
+    target_compile_definitions(murmdoom_host PRIVATE MURMDOOM_PROF=0)
+endif()
+
+# Same FatFs-backed stdio as the firmware.
+target_link_options(murmdoom_host PRIVATE ${MURMDOOM_STDIO_WRAP_OPTIONS})
+target_link_libraries(murmdoom_host m pthread)
+
+# OPL output path benchmark (host/bench_opl_mix.c): just the emulator, built
+# with the same feature set as the firmware.
+add_executable(bench_opl_mix
+    host/bench_opl_mix.c
+    src/opl/emu8950.c
+    src/opl/slot_render.cpp
+)
+
+target_include_directories(bench_opl_mix PRIVATE
+    host
+    host/include
+    ${MURMDOOM_INCLUDE_DIRS}
+)
+
+target_compile_definitions(bench_opl_mix PRIVATE
+    ${MURMDOOM_FEATURE_DEFINITIONS}
+    EMU8950_ASM=0
+    PICO_BUILD=1
+    PICO_ON_DEVICE=0
+    MURMDOOM_HOT_SRAM=0
+    MURMDOOM_PROF=0
+    MURMDOOM_QUIET=1
+)
+
+target_link_libraries(bench_opl_mix m)
+
+# OPL register write timing (host/bench_opl_timing.c): models the old segment
+# loop and the timestamped write ring, no emulator.
+add_executable(bench_opl_timing
+    host/bench_opl_timing.c
+)
+
+target_include_directories(bench_opl_timing PRIVATE
+    host
+    host/include
+    ${MURMDOOM_INCLUDE_DIRS}
+)
+
+target_compile_definitions(bench_opl_timing PRIVATE
+    ${MURMDOOM_FEATURE_DEFINITIONS}
+    PICO_BUILD=1
+    PICO_ON_DEVICE=0
+    MURMDOOM_QUIET=1
+)
+
+# SFX rate conversion benchmark (host/bench_sfx_resample.c): the old
+# nearest-sample mixer loop against src/murmdoom_resample.c, speed and SNR.
+add_executable(bench_sfx_resample
+    host/bench_sfx_resample.c
+    src/murmdoom_resample.c
+)
+
+target_include_directories(bench_sfx_resample PRIVATE
+    host
+    host/include
+    ${MURMDOOM_INCLUDE_DIRS}
+)
+
+target_compile_definitions(bench_sfx_resample PRIVATE
+    ${MURMDOOM_FEATURE_DEFINITIONS}
+    PICO_BUILD=1
+    PICO_ON_DEVICE=0
+    MURMDOOM_HOT_SRAM=0
+    MURMDOOM_QUIET=1
+)
+
+target_link_libraries(bench_sfx_resample m)
+
+# Patch drawing benchmark (host/bench_patch_draw.c): V_DrawPatch's column
+# loop against the span form in src/murmdoom_patchspan.c, with an XIP cache
+# model.
+add_executable(bench_patch_draw
+    host/bench_patch_draw.c
+    src/murmdoom_patchspan.c
+)
+
+target_include_directories(bench_patch_draw PRIVATE
+    host
+    host/include
+    ${MURMDOOM_INCLUDE_DIRS}
+)
+
+target_compile_definitions(bench_patch_draw PRIVATE
+    ${MURMDOOM_FEATURE_DEFINITIONS}
+    PICO_BUILD=1
+    PICO_ON_DEVICE=0
+    MURMDOOM_HOT_SRAM=0
+    MURMDOOM_QUIET=0
+)
+
+# Automap benchmark (host/bench_automap.c): AM_Drawer's walls over every
+# linedef against src/murmdoom_amdraw.c, on a large synthetic map.
+add_executable(bench_automap
+    host/bench_automap.c
+    src/murmdoom_amdraw.c
+    src/doomgeneric/doomgeneric/m_bbox.c
+)
+
+target_include_directories(bench_automap PRIVATE
+    host
+    host/include
+    ${MURMDOOM_INCLUDE_DIRS}
+)
+
+target_compile_definitions(bench_automap PRIVATE
+    ${MURMDOOM_FEATURE_DEFINITIONS}
+    PICO_BUILD=1
+    PICO_ON_DEVICE=0
+    MURMDOOM_HOT_SRAM=0
+    MURMDOOM_QUIET=0
+)
+
+target_link_libraries(bench_automap m)
+
+# Melt wipe check (host/bench_wipe.c): vanilla's melt with the menu drawn
+# over it against f_wipe.c's line composition, frame by frame.
+add_executable(bench_wipe
+    host/bench_wipe.c
+    src/doomgeneric/doomgeneric/f_wipe.c
+    src/doomgeneric/doomgeneric/m_random.c
+)
+
+target_include_directories(bench_wipe PRIVATE
+    host
+    host/include
+    ${MURMDOOM_INCLUDE_DIRS}
+)
+
+target_compile_definitions(bench_wipe PRIVATE
+    ${MURMDOOM_FEATURE_DEFINITIONS}
+    PICO_BUILD=1
+    PICO_ON_DEVICE=0
+    MURMDOOM_HOT_SRAM=0
+    MURMDOOM_QUIET=0
+)
+
+# The benchmarks' old-against-new output checks, on short runs: each exits
+# non-zero when the two differ (host/bench.h).
+#
+#   ctest --test-dir build-host
+enable_testing()
+add_test(NAME opl_mix COMMAND bench_opl_mix 500)
+add_test(NAME opl_timing COMMAND bench_opl_timing 60)
+add_test(NAME sfx_resample COMMAND bench_sfx_resample 500)
+add_test(NAME patch_draw COMMAND bench_patch_draw 50)
+add_test(NAME automap COMMAND bench_automap 20 2000)
+add_test(NAME wipe COMMAND bench_wipe 100)
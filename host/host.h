@@ -0,0 +1,49 @@
+#pragma once
+
+// Host-side hooks behind the stubbed SDK and drivers, driven by main_host.c.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// --- PSRAM (psram_host.c) ---------------------------------------------------
+// With latency injection enabled, only `resident_pages` 4KB pages of the PSRAM
+// window stay accessible; touching any other page costs `miss_ns` of busy wait
+// and evicts the oldest resident page (FIFO), roughly modelling the XIP cache
+// sitting in front of QSPI PSRAM.
+void host_psram_set_latency(uint32_t miss_ns, uint32_t resident_pages);
+uint64_t host_psram_misses(void);
+
+// --- Video (hdmi_host.c) ----------------------------------------------------
+// Convert the current framebuffer through the palette, as the scanout does.
+// `rgb` receives width * height * 3 bytes.
+void host_hdmi_scanout(uint8_t *rgb);
+uint32_t host_hdmi_frames(void);
+
+// --- Audio (audio_i2s_host.c) -----------------------------------------------
+// By default queued buffers are consumed at the output sample rate in wall
+// time. With `gametic` set, playback only advances through
+// host_audio_advance_to(), so the mixer runs once per simulated tic however
+// fast the host renders.
+void host_audio_set_gametic_clock(bool gametic);
+void host_audio_advance_to(uint64_t sample_pos);
+// Write everything played to a 16-bit stereo WAV file (closed at exit).
+bool host_audio_open_wav(const char *path);
+void host_audio_close(void);
+uint64_t host_audio_samples(void);
+uint32_t host_audio_underruns(void);
+
+// --- SD card (diskio_host.c) ------------------------------------------------
+// Back the FatFs volume with a FAT image file, or build a RAM volume holding
+// the files of a host directory under /doom. Files written below /doom/bench
+// and /doom/.savegame are copied back to that directory at exit.
+bool host_disk_open(const char *path);
+void host_disk_close(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "pico.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum clock_index {
+    clk_gpout0 = 0,
+    clk_ref = 4,
+    clk_sys = 5,
+    clk_peri = 6,
+    clk_hstx = 7,
+    clk_usb = 8,
+    clk_adc = 9,
+    CLK_COUNT
+};
+
+typedef enum clock_index clock_handle_t;
+
+// Reports the configured CPU_CLOCK_MHZ so logs match the firmware.
+uint32_t clock_get_hz(clock_handle_t clock);
+bool set_sys_clock_khz(uint32_t freq_khz, bool required);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,24 @@
+#pragma once
+
+// DMA channels can be claimed so drivers that reserve one keep working, but
+// no transfers run on the host; the scanout and I2S consumers that the DMA
+// would feed are emulated in host/hdmi_host.c and host/audio_i2s_host.c.
+
+#include "pico.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define NUM_DMA_CHANNELS 16
+#define DMA_IRQ_0 10
+#define DMA_IRQ_1 11
+
+int dma_claim_unused_channel(bool required);
+void dma_channel_claim(uint channel);
+void dma_channel_unclaim(uint channel);
+bool dma_channel_is_claimed(uint channel);
+
+#ifdef __cplusplus
+}
+#endif
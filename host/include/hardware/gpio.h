@@ -0,0 +1,39 @@
+#pragma once
+
+// GPIO calls are accepted and ignored on the host.
+
+#include "pico.h"
+
+enum gpio_function {
+    GPIO_FUNC_SPI = 1,
+    GPIO_FUNC_UART = 2,
+    GPIO_FUNC_PIO0 = 6,
+    GPIO_FUNC_PIO1 = 7,
+    GPIO_FUNC_SIO = 5,
+    GPIO_FUNC_NULL = 0x1f,
+};
+
+enum gpio_drive_strength {
+    GPIO_DRIVE_STRENGTH_2MA = 0,
+    GPIO_DRIVE_STRENGTH_4MA = 1,
+    GPIO_DRIVE_STRENGTH_8MA = 2,
+    GPIO_DRIVE_STRENGTH_12MA = 3,
+};
+
+enum gpio_slew_rate {
+    GPIO_SLEW_RATE_SLOW = 0,
+    GPIO_SLEW_RATE_FAST = 1,
+};
+
+#define GPIO_OUT 1
+#define GPIO_IN 0
+
+static inline void gpio_init(uint gpio) { (void)gpio; }
+static inline void gpio_set_function(uint gpio, enum gpio_function fn) { (void)gpio; (void)fn; }
+static inline void gpio_set_dir(uint gpio, bool out) { (void)gpio; (void)out; }
+static inline void gpio_put(uint gpio, bool value) { (void)gpio; (void)value; }
+static inline bool gpio_get(uint gpio) { (void)gpio; return false; }
+static inline void gpio_pull_up(uint gpio) { (void)gpio; }
+static inline void gpio_pull_down(uint gpio) { (void)gpio; }
+static inline void gpio_set_drive_strength(uint gpio, enum gpio_drive_strength drive) { (void)gpio; (void)drive; }
+static inline void gpio_set_slew_rate(uint gpio, enum gpio_slew_rate slew) { (void)gpio; (void)slew; }
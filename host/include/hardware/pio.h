@@ -0,0 +1,29 @@
+#pragma once
+
+// PIO blocks and state machines can be claimed; programs never run on the host.
+
+#include "pico.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define NUM_PIOS 3
+#define NUM_PIO_STATE_MACHINES 4
+
+typedef struct pio_hw pio_hw_t;
+typedef pio_hw_t *PIO;
+
+#define pio0 ((PIO)(uintptr_t)1)
+#define pio1 ((PIO)(uintptr_t)2)
+#define pio2 ((PIO)(uintptr_t)3)
+
+static inline uint pio_get_index(PIO pio) { return (uint)(uintptr_t)pio - 1; }
+
+int pio_claim_unused_sm(PIO pio, bool required);
+void pio_sm_claim(PIO pio, uint sm);
+void pio_sm_unclaim(PIO pio, uint sm);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,8 @@
+#pragma once
+
+#include "pico.h"
+
+typedef struct spi_inst spi_inst_t;
+
+#define spi0 ((spi_inst_t *)0)
+#define spi1 ((spi_inst_t *)1)
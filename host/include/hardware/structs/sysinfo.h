@@ -0,0 +1,19 @@
+#pragma once
+
+// board_config.h reads the package select register directly. The host
+// provides a two-word block that reports an RP2350B (bit 0 clear).
+
+#include "pico.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern io_ro_32 host_sysinfo_regs[2];
+
+#ifdef __cplusplus
+}
+#endif
+
+#define SYSINFO_BASE ((uintptr_t)host_sysinfo_regs)
+#define SYSINFO_PACKAGE_SEL_OFFSET 0x00000004
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "pico.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// There are no interrupts on the host; input producers and the game loop
+// share one thread.
+static inline uint32_t save_and_disable_interrupts(void) { return 0; }
+static inline void restore_interrupts(uint32_t status) { (void)status; }
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,15 @@
+#pragma once
+
+enum vreg_voltage {
+    VREG_VOLTAGE_1_10 = 0x0b,
+    VREG_VOLTAGE_1_15 = 0x0c,
+    VREG_VOLTAGE_1_20 = 0x0d,
+    VREG_VOLTAGE_1_25 = 0x0e,
+    VREG_VOLTAGE_1_30 = 0x0f,
+    VREG_VOLTAGE_1_50 = 0x13,
+    VREG_VOLTAGE_1_60 = 0x14,
+    VREG_VOLTAGE_1_65 = 0x15,
+};
+
+static inline void vreg_set_voltage(enum vreg_voltage voltage) { (void)voltage; }
+static inline void vreg_disable_voltage_limit(void) { }
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "pico.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// There is nothing to reboot into on the host: the process exits with status 0.
+void watchdog_reboot(uint32_t pc, uint32_t sp, uint32_t delay_ms) __attribute__((noreturn));
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,69 @@
+#pragma once
+
+// Host build stand-in for the Pico SDK base header: the integer types,
+// placement attributes and core intrinsics the murmdoom sources rely on.
+// Placement attributes expand to nothing; barriers map to compiler fences.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef unsigned int uint;
+
+typedef volatile uint32_t io_rw_32;
+typedef const volatile uint32_t io_ro_32;
+typedef volatile uint32_t io_wo_32;
+
+#ifndef PICO_ON_DEVICE
+#define PICO_ON_DEVICE 0
+#endif
+
+#define PICO_OK 0
+#define PICO_ERROR_NONE 0
+#define PICO_ERROR_TIMEOUT (-1)
+#define PICO_ERROR_GENERIC (-2)
+
+#define __not_in_flash(group)
+#define __not_in_flash_func(func) func
+#define __no_inline_not_in_flash_func(func) __attribute__((noinline)) func
+#define __time_critical_func(func) func
+#define __scratch_x(group)
+#define __scratch_y(group)
+#define __uninitialized_ram(var) var
+#define __force_inline inline __attribute__((always_inline))
+#ifndef __noinline
+#define __noinline __attribute__((noinline))
+#endif
+
+#ifndef MIN
+#define MIN(a, b) ((b) < (a) ? (b) : (a))
+#endif
+#ifndef MAX
+#define MAX(a, b) ((a) < (b) ? (b) : (a))
+#endif
+
+#define count_of(a) (sizeof(a) / sizeof((a)[0]))
+
+static inline void tight_loop_contents(void) { }
+
+static inline void __dmb(void) { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+static inline void __dsb(void) { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+static inline void __isb(void) { __atomic_signal_fence(__ATOMIC_SEQ_CST); }
+static inline void __sev(void) { }
+static inline void __wfe(void) { }
+static inline void __wfi(void) { }
+
+// Prints the message and exits with status 1 (pico_host.c).
+void panic(const char *fmt, ...) __attribute__((noreturn, format(printf, 1, 2)));
+
+// 1 on the thread started by multicore_launch_core1() (pico_host.c).
+extern __thread uint host_core_num;
+static inline uint get_core_num(void) { return host_core_num; }
+
+#ifdef __cplusplus
+}
+#endif
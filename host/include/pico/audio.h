@@ -0,0 +1,59 @@
+#pragma once
+
+// Producer side of the pico_audio buffer pools (pico-extras). On the host the
+// consumer is host/audio_i2s_host.c, which drains queued buffers against the
+// host's sample clock and optionally writes them to a WAV file.
+
+#include "pico.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define AUDIO_BUFFER_FORMAT_PCM_S16 1
+#define AUDIO_BUFFER_FORMAT_PCM_S8 2
+#define AUDIO_BUFFER_FORMAT_PCM_U16 3
+#define AUDIO_BUFFER_FORMAT_PCM_U8 4
+
+enum audio_correction_mode {
+    none,
+    fixed_dither,
+    dither,
+};
+
+typedef struct mem_buffer {
+    size_t size;
+    uint8_t *bytes;
+    uint8_t flags;
+} mem_buffer_t;
+
+struct audio_format {
+    uint32_t sample_freq;
+    uint16_t format;
+    uint16_t channel_count;
+};
+
+struct audio_buffer_format {
+    const struct audio_format *format;
+    uint16_t sample_stride;
+};
+
+typedef struct audio_buffer {
+    mem_buffer_t *buffer;
+    const struct audio_buffer_format *format;
+    uint32_t sample_count;
+    uint32_t max_sample_count;
+    uint32_t user_data;
+    struct audio_buffer *next;
+} audio_buffer_t;
+
+typedef struct audio_buffer_pool audio_buffer_pool_t;
+
+audio_buffer_pool_t *audio_new_producer_pool(struct audio_buffer_format *format, int buffer_count,
+                                             int buffer_sample_count);
+audio_buffer_t *take_audio_buffer(audio_buffer_pool_t *ac, bool block);
+void give_audio_buffer(audio_buffer_pool_t *ac, audio_buffer_t *buffer);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "pico/audio.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct audio_i2s_config {
+    uint8_t data_pin;
+    uint8_t clock_pin_base;
+    uint8_t dma_channel;
+    uint8_t pio_sm;
+};
+
+const struct audio_format *audio_i2s_setup(const struct audio_format *intended_audio_format,
+                                           const struct audio_i2s_config *config);
+bool audio_i2s_connect_extra(audio_buffer_pool_t *producer, bool buffer_on_give, uint buffer_count,
+                             uint samples_per_buffer, void *connection);
+void audio_i2s_set_enabled(bool enabled);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,5 @@
+#pragma once
+
+#define bi_decl(...)
+#define bi_decl_if_func_used(...)
+#define bi_program_feature(...) 0
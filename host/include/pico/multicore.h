@@ -0,0 +1,20 @@
+#pragma once
+
+// Host stand-in for pico_multicore: core 1 is a thread, and the two
+// inter-core FIFOs are blocking queues (pico_host.c). get_core_num() tells
+// the two apart.
+
+#include "pico.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void multicore_launch_core1(void (*entry)(void));
+void multicore_fifo_push_blocking(uint32_t data);
+uint32_t multicore_fifo_pop_blocking(void);
+bool multicore_fifo_rvalid(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,38 @@
+#pragma once
+
+// The host build runs the game, mixer and OPL on one thread, so a mutex only
+// has to track its owner; re-entry from the same "core" is a bug on device
+// as well and is reported through panic().
+
+#include "pico.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    int8_t owner;   // -1 when free
+} mutex_t;
+
+typedef mutex_t recursive_mutex_t;
+
+static inline void mutex_init(mutex_t *mtx) { mtx->owner = -1; }
+
+static inline bool mutex_try_enter(mutex_t *mtx, uint32_t *owner_out) {
+    if (mtx->owner >= 0) {
+        if (owner_out) *owner_out = (uint32_t)mtx->owner;
+        return false;
+    }
+    mtx->owner = (int8_t)get_core_num();
+    return true;
+}
+
+static inline void mutex_enter_blocking(mutex_t *mtx) {
+    if (!mutex_try_enter(mtx, NULL)) panic("mutex_enter_blocking: deadlock");
+}
+
+static inline void mutex_exit(mutex_t *mtx) { mtx->owner = -1; }
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,20 @@
+#pragma once
+
+// Host stdio: stdout is the serial console, stdin feeds the command console.
+
+#include "pico.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+bool stdio_init_all(void);
+void stdio_flush(void);
+// Next byte from stdin or PICO_ERROR_TIMEOUT; stdin is non-blocking on the host.
+int getchar_timeout_us(uint32_t timeout_us);
+int putchar_raw(int c);
+int puts_raw(const char *s);
+
+#ifdef __cplusplus
+}
+#endif
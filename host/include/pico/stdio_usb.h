@@ -0,0 +1,5 @@
+#pragma once
+
+#include "pico.h"
+
+static inline bool stdio_usb_connected(void) { return true; }
@@ -0,0 +1,6 @@
+#pragma once
+
+#include "pico.h"
+#include "pico/stdio.h"
+#include "pico/time.h"
+#include "hardware/gpio.h"
@@ -0,0 +1,53 @@
+#pragma once
+
+// Pairing heap with the pico_util API (node ids are 1-based, 0 means none).
+// Nodes come from a fixed array; ordering is decided by the caller's
+// comparator on node ids. Implementation in host/pico_host.c.
+
+#include "pico.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef uint8_t pheap_node_id_t;
+
+typedef struct pheap_node {
+    pheap_node_id_t child, sibling, parent;
+} pheap_node_t;
+
+// Return true if a should come before b.
+typedef bool (*pheap_comparator)(void *user_data, pheap_node_id_t a, pheap_node_id_t b);
+
+typedef struct pheap {
+    pheap_node_t *nodes;
+    pheap_comparator comparator;
+    void *user_data;
+    pheap_node_id_t max_nodes;
+    pheap_node_id_t root_id;
+    pheap_node_id_t free_head_id;
+    pheap_node_id_t free_tail_id;
+} pheap_t;
+
+#define PHEAP_DEFINE_STATIC(name, _max_nodes) \
+    static pheap_node_t name ## _nodes[_max_nodes]; \
+    static pheap_t name = { .nodes = name ## _nodes, .max_nodes = (_max_nodes) }
+
+static inline pheap_node_t *ph_get_node(pheap_t *heap, pheap_node_id_t id) {
+    return heap->nodes + id - 1;
+}
+
+static inline pheap_node_id_t ph_peek_head(pheap_t *heap) {
+    return heap->root_id;
+}
+
+void ph_post_alloc_init(pheap_t *heap, uint max_nodes, pheap_comparator comparator, void *user_data);
+void ph_clear(pheap_t *heap);
+pheap_node_id_t ph_new_node(pheap_t *heap);
+void ph_free_node(pheap_t *heap, pheap_node_id_t id);
+void ph_insert_node(pheap_t *heap, pheap_node_id_t id);
+pheap_node_id_t ph_remove_head(pheap_t *heap, bool free);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,12 @@
+/*
+ * PS/2 keyboard and mouse wrappers for the host build. There is no input
+ * device; runs are driven by -iwad/-timedemo/-playdemo or bench.cfg.
+ */
+#include "ps2kbd_wrapper.h"
+#include "ps2mouse_wrapper.h"
+
+void ps2kbd_init(void) {
+}
+
+void ps2mouse_wrapper_init(void) {
+}
@@ -0,0 +1,197 @@
+/*
+ * murmdoom_host: the firmware's engine, platform layer, mixer and OPL code
+ * running headless on Linux for benchmarking (see host/host.cmake).
+ */
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "doomgeneric.h"
+#include "i_timer.h"
+#include "pico/stdlib.h"
+#include "i_picosound.h"
+#include "murmdoom_present.h"
+#include "opl.h"
+#include "murmdoom_prof.h"
+
+#include "host.h"
+
+// From d_loop.h, which is not included: engine headers turn printf into a
+// no-op under MURMDOOM_QUIET, and the run summary must always print.
+extern int gametic;
+
+static const char *ppm_dir = NULL;
+static int raw_fd = -1;
+static uint32_t dump_every = 1;
+static uint32_t max_frames = 0;
+static bool audio_gametic = false;
+
+static uint32_t *frame_us = NULL;
+static uint32_t frame_count = 0;
+static uint32_t frame_cap = 0;
+static uint64_t run_start_us = 0;
+
+static void usage(const char *self) {
+    printf("usage: %s -sd <dir|image> [host options] [doom options]\n"
+           "  -sd <path>               FAT image, or directory copied into a RAM volume as /doom\n"
+           "  -frames <n>              exit after n frames\n"
+           "  -ppm <dir>               write frames as <dir>/frame_NNNNNN.ppm\n"
+           "  -raw <file>              append frames as raw rgb24 (320x240)\n"
+           "  -dumpevery <n>           only dump every n-th frame (default 1)\n"
+           "  -wav <file>              record the audio output\n"
+           "  -audio-tic               play one tic of audio per gametic instead of wall time\n"
+           "  -psram-latency <ns>[:p]  busy-wait ns per PSRAM page miss, p resident 4KB pages (default 4)\n"
+           "doom options are passed through, e.g. -iwad doom1.wad -timedemo demo1\n", self);
+}
+
+static int compare_u32(const void *a, const void *b) {
+    const uint32_t x = *(const uint32_t *)a;
+    const uint32_t y = *(const uint32_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static void host_exit(void) {
+    const uint64_t elapsed_us = time_us_64() - run_start_us;
+    printf("\nhost: %lu frames in %lu ms", (unsigned long)frame_count, (unsigned long)(elapsed_us / 1000));
+    if (frame_count) {
+        uint64_t total = 0;
+        for (uint32_t i = 0; i < frame_count; ++i) total += frame_us[i];
+        qsort(frame_us, frame_count, sizeof(frame_us[0]), compare_u32);
+        printf(", frame us avg %lu p50 %lu p99 %lu max %lu",
+               (unsigned long)(total / frame_count),
+               (unsigned long)frame_us[frame_count / 2],
+               (unsigned long)frame_us[(uint32_t)((uint64_t)frame_count * 99 / 100)],
+               (unsigned long)frame_us[frame_count - 1]);
+    }
+    printf("\nhost: audio %lu samples, %lu underruns; psram misses %llu\n",
+           (unsigned long)host_audio_samples(), (unsigned long)host_audio_underruns(),
+           (unsigned long long)host_psram_misses());
+    present_report();
+    OPL_Pico_ReportStats();
+    prof_dump();
+
+    host_audio_close();
+    host_disk_close();
+    if (raw_fd >= 0) close(raw_fd);
+    fflush(stdout);
+}
+
+static void write_all(int fd, const void *data, size_t size) {
+    if (write(fd, data, size) != (ssize_t)size) {
+        printf("host: short write while dumping a frame\n");
+    }
+}
+
+static void dump_frame(uint32_t frame) {
+    static uint8_t rgb[DOOMGENERIC_RESX * DOOMGENERIC_RESY * 3];
+    host_hdmi_scanout(rgb);
+    if (raw_fd >= 0) {
+        write_all(raw_fd, rgb, sizeof(rgb));
+    }
+    if (ppm_dir) {
+        char path[512];
+        snprintf(path, sizeof(path), "%s/frame_%06lu.ppm", ppm_dir, (unsigned long)frame);
+        const int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            printf("host: cannot write %s\n", path);
+            return;
+        }
+        char header[32];
+        const int n = snprintf(header, sizeof(header), "P6\n%d %d\n255\n", DOOMGENERIC_RESX, DOOMGENERIC_RESY);
+        write_all(fd, header, (size_t)n);
+        write_all(fd, rgb, sizeof(rgb));
+        close(fd);
+    }
+}
+
+static void frame_done(uint32_t us) {
+    if (frame_count == frame_cap) {
+        frame_cap = frame_cap ? frame_cap * 2 : 4096;
+        frame_us = realloc(frame_us, frame_cap * sizeof(frame_us[0]));
+        if (!frame_us) panic("host: out of memory for frame times");
+    }
+    frame_us[frame_count++] = us;
+
+    if ((ppm_dir || raw_fd >= 0) && (frame_count - 1) % dump_every == 0) {
+        dump_frame(frame_count - 1);
+    }
+    if (max_frames && frame_count >= max_frames) {
+        exit(0);
+    }
+}
+
+int main(int argc, char **argv) {
+    const char *sd = NULL;
+    const char *wav = NULL;
+    uint32_t latency_ns = 0, latency_pages = 0;
+
+    // Host options are consumed here; everything else goes to the engine.
+    char **doom_argv = calloc((size_t)argc + 1, sizeof(char *));
+    int doom_argc = 0;
+    doom_argv[doom_argc++] = argv[0];
+    for (int i = 1; i < argc; ++i) {
+        const bool has_value = i + 1 < argc;
+        if (!strcmp(argv[i], "-sd") && has_value) {
+            sd = argv[++i];
+        } else if (!strcmp(argv[i], "-frames") && has_value) {
+            max_frames = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (!strcmp(argv[i], "-ppm") && has_value) {
+            ppm_dir = argv[++i];
+        } else if (!strcmp(argv[i], "-raw") && has_value) {
+            raw_fd = open(argv[++i], O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if (raw_fd < 0) panic("host: cannot create %s", argv[i]);
+        } else if (!strcmp(argv[i], "-dumpevery") && has_value) {
+            dump_every = (uint32_t)strtoul(argv[++i], NULL, 0);
+            if (!dump_every) dump_every = 1;
+        } else if (!strcmp(argv[i], "-wav") && has_value) {
+            wav = argv[++i];
+        } else if (!strcmp(argv[i], "-audio-tic")) {
+            audio_gametic = true;
+        } else if (!strcmp(argv[i], "-psram-latency") && has_value) {
+            char *end;
+            latency_ns = (uint32_t)strtoul(argv[++i], &end, 0);
+            latency_pages = *end == ':' ? (uint32_t)strtoul(end + 1, NULL, 0) : 4;
+        } else if (!strcmp(argv[i], "-h") || !strcmp(argv[i], "-help")) {
+            usage(argv[0]);
+            return 0;
+        } else {
+            doom_argv[doom_argc++] = argv[i];
+        }
+    }
+    if (!sd) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    stdio_init_all();
+    prof_init();
+
+    if (!host_disk_open(sd)) {
+        panic("host: cannot open SD card image or directory %s", sd);
+    }
+    if (wav && !host_audio_open_wav(wav)) {
+        panic("host: cannot create %s", wav);
+    }
+    host_audio_set_gametic_clock(audio_gametic);
+    if (latency_pages) {
+        host_psram_set_latency(latency_ns, latency_pages);
+    }
+    atexit(host_exit);
+
+    // Runs DG_Init(), the start screen (skipped with -iwad) and the first tic.
+    const uint64_t start_us = time_us_64();
+    doomgeneric_Create(doom_argc, doom_argv);
+    run_start_us = time_us_64();
+    printf("host: startup %lu ms\n", (unsigned long)((run_start_us - start_us) / 1000));
+
+    for (;;) {
+        if (audio_gametic) {
+            host_audio_advance_to((uint64_t)gametic * PICO_SOUND_SAMPLE_FREQ / TICRATE);
+        }
+        const uint64_t t0 = time_us_64();
+        doomgeneric_Tick();
+        frame_done((uint32_t)(time_us_64() - t0));
+    }
+}
@@ -0,0 +1,288 @@
+#!/usr/bin/env python3
+"""Slaughter test map for timing the game simulation on the host build.
+
+    host/mkmap.py doom1.wad sd/doom1.wad --rooms 14 --monsters 300
+
+Copies an IWAD with E1M1 replaced by a square grid of rooms, one sector
+and one subsector each, full of monsters, and DEMO1-3 replaced by
+scripted input for that map:
+
+  demo1  standing in the start room, turning and firing
+  demo2  walking back and forth, turning and firing
+  demo3  turning without firing, so the monsters come to the player
+
+Rooms are 192 units square. About 8% are closed off, 14% are raised or
+lowered steps and 8% are lifts that a line of the start room keeps moving
+(special 53, perpetual). With --lights some rooms also get blinking,
+flickering and glowing light specials, and lines around the start room
+get the light-changing specials 17 and 80. The player starts in the
+middle of the second row with three soulspheres and a medkit. Monsters
+are placed at random in the flat, open rooms at least three rooms from
+the start. The default types are zombiemen, shotgun guys, imps and demons;
+see --types. With a Doom 1 IWAD, leave out the Doom 2 monsters: vanilla
+P_LoadThings stops spawning things at the first one.
+
+The output only depends on the arguments and the input IWAD. The thinker
+pool figures in the README come from (and the same with --monsters 800):
+
+    host/mkmap.py doom1.wad sd/doom1.wad --rooms 14 --monsters 300
+    printf 'autostart 1\\niwad doom1.wad\\ndemo demo1\\ndemo demo2\\n'\\
+'demo demo3\\nserial summary\\nnodraw 1\\nnosound 1\\n' > sd/bench.cfg
+    build-host/murmdoom_host -sd sd/ -psram-latency 2000:4
+"""
+import argparse
+import math
+import random
+import struct
+
+ROOM = 192
+
+
+def read_wad(path):
+    data = open(path, 'rb').read()
+    n, off = struct.unpack_from('<ii', data, 4)
+    lumps = []
+    for i in range(n):
+        pos, size, name = struct.unpack_from('<ii8s', data, off + 16 * i)
+        lumps.append((name.rstrip(b'\0').decode(), data[pos:pos + size]))
+    return data[:4], lumps
+
+
+def write_wad(path, ident, lumps):
+    body = b''
+    directory = b''
+    pos = 12
+    for name, data in lumps:
+        directory += struct.pack('<ii8s', pos, len(data), name.encode())
+        body += data
+        pos += len(data)
+    open(path, 'wb').write(ident + struct.pack('<ii', len(lumps), pos) + body + directory)
+
+
+def build_map(g, monsters, types, lights):
+    random.seed(1234)
+    px, py = g // 2, 2          # start room
+
+    # Rooms: floor, ceiling, tag, special.
+    cells = {}
+    for j in range(g):
+        for i in range(g):
+            fl, ce, tag = 0, 160, 0
+            r = random.random()
+            if abs(i - px) <= 1 and abs(j - py) <= 1:
+                pass
+            elif r < 0.08:
+                ce = fl = 64            # closed
+            elif r < 0.22:
+                fl = random.choice([24, 72])
+            elif r < 0.30:
+                fl, tag = 64, 1         # lift
+            special = 0
+            if lights and (i, j) != (px, py):
+                q = random.random()
+                special = 8 if q < 0.06 else 2 if q < 0.09 else 12 if q < 0.11 else 1 if q < 0.13 \
+                    else 17 if q < 0.15 else 0
+                if special and tag == 0 and random.random() < 0.3:
+                    tag = 2
+            cells[(i, j)] = [fl, ce, tag, special]
+
+    order = sorted(cells, key=lambda c: (c[1], c[0]))
+    secnum = {c: k for k, c in enumerate(order)}
+    sectors = b''
+    for c in order:
+        fl, ce, tag, special = cells[c]
+        sectors += struct.pack('<hh8s8shhh', fl, ce, b'FLOOR0', b'CEIL0', 160 if special else 192,
+                               special, tag)
+
+    verts = {}
+    vlist = []
+
+    def vertex(x, y):
+        if (x, y) not in verts:
+            verts[(x, y)] = len(vlist)
+            vlist.append((x, y))
+        return verts[(x, y)]
+
+    lines = []                  # v1, v2, front room, back room, special, tag
+    cellsegs = {c: [] for c in cells}
+    for i in range(g + 1):
+        for j in range(g):
+            y0, y1 = j * ROOM, (j + 1) * ROOM
+            left = (i - 1, j) if i > 0 else None
+            right = (i, j) if i < g else None
+            if right:
+                a, b, front, back = vertex(i * ROOM, y0), vertex(i * ROOM, y1), right, left
+            else:
+                a, b, front, back = vertex(i * ROOM, y1), vertex(i * ROOM, y0), left, None
+            lines.append([a, b, front, back, 0, 0])
+    for j in range(g + 1):
+        for i in range(g):
+            x0, x1 = i * ROOM, (i + 1) * ROOM
+            below = (i, j - 1) if j > 0 else None
+            above = (i, j) if j < g else None
+            if above:
+                a, b, front, back = vertex(x1, j * ROOM), vertex(x0, j * ROOM), above, below
+            else:
+                a, b, front, back = vertex(x0, j * ROOM), vertex(x1, j * ROOM), below, None
+            special = 53 if (i, j) == (px, py + 1) else 0
+            tag = 1 if special else 0
+            if lights and abs(i - px) == 1 and j in (py, py + 1):
+                special, tag = (80, 2) if j == py else (17, 2)
+            lines.append([a, b, front, back, special, tag])
+
+    linedefs = b''
+    sidedefs = b''
+    nsides = 0
+    for k, (a, b, front, back, special, tag) in enumerate(lines):
+        flags = 1 if back is None else 4
+        s0 = nsides
+        sidedefs += struct.pack('<hh8s8s8sh', 0, 0, b'STARTAN3', b'STARTAN3',
+                                b'STARTAN3' if back is None else b'-', secnum[front])
+        nsides += 1
+        s1 = -1
+        if back is not None:
+            s1 = nsides
+            sidedefs += struct.pack('<hh8s8s8sh', 0, 0, b'STARTAN3', b'STARTAN3', b'-', secnum[back])
+            nsides += 1
+            cellsegs[back].append((k, 1))
+        cellsegs[front].append((k, 0))
+        linedefs += struct.pack('<hhhhhhh', a, b, flags, special, tag, s0, s1)
+
+    segs = b''
+    ssectors = b''
+    ssnum = {}
+    segcount = 0
+    for c in order:
+        ssnum[c] = len(ssnum)
+        first = segcount
+        for k, side in cellsegs[c]:
+            a, b = lines[k][0], lines[k][1]
+            if side:
+                a, b = b, a
+            (x0, y0), (x1, y1) = vlist[a], vlist[b]
+            angle = int(math.atan2(y1 - y0, x1 - x0) / (2 * math.pi) * 65536) & 0xffff
+            segs += struct.pack('<hhHhhh', a, b, angle, k, side, 0)
+            segcount += 1
+        ssectors += struct.pack('<hh', segcount - first, first)
+
+    nodes = []
+
+    def build(x0, y0, x1, y1):
+        if x1 - x0 == 1 and y1 - y0 == 1:
+            return 0x8000 | ssnum[(x0, y0)]
+        if x1 - x0 >= y1 - y0:
+            m = (x0 + x1) // 2
+            r = build(m, y0, x1, y1)
+            l = build(x0, y0, m, y1)
+            rb = (y1 * ROOM, y0 * ROOM, m * ROOM, x1 * ROOM)
+            lb = (y1 * ROOM, y0 * ROOM, x0 * ROOM, m * ROOM)
+            nodes.append(struct.pack('<hhhh4h4hHH', m * ROOM, 0, 0, 1, *rb, *lb, r, l))
+        else:
+            m = (y0 + y1) // 2
+            r = build(x0, y0, x1, m)
+            l = build(x0, m, x1, y1)
+            rb = (m * ROOM, y0 * ROOM, x0 * ROOM, x1 * ROOM)
+            lb = (y1 * ROOM, m * ROOM, x0 * ROOM, x1 * ROOM)
+            nodes.append(struct.pack('<hhhh4h4hHH', 0, m * ROOM, 1, 0, *rb, *lb, r, l))
+        return len(nodes) - 1
+
+    build(0, 0, g, g)
+
+    vertexes = b''.join(struct.pack('<hh', x, y) for x, y in vlist)
+    reject = bytes((len(cells) ** 2 + 7) // 8)
+
+    orgx = orgy = -8
+    bw = (g * ROOM + 16) // 128 + 1
+    bh = bw
+    blists = []
+    for by in range(bh):
+        for bx in range(bw):
+            X0, Y0 = orgx + bx * 128, orgy + by * 128
+            X1, Y1 = X0 + 128, Y0 + 128
+            cell = [0]
+            for k, ln in enumerate(lines):
+                (ax, ay), (bx_, by_) = vlist[ln[0]], vlist[ln[1]]
+                if max(ax, bx_) >= X0 and min(ax, bx_) <= X1 and max(ay, by_) >= Y0 and min(ay, by_) <= Y1:
+                    cell.append(k)
+            cell.append(-1)
+            blists.append(cell)
+    offsets = []
+    pos = 4 + bw * bh
+    body = []
+    for cell in blists:
+        offsets.append(pos)
+        body += cell
+        pos += len(cell)
+    if pos >= 32768:
+        raise SystemExit('blockmap too large; use fewer rooms')
+    blockmap = struct.pack('<hhhh', orgx, orgy, bw, bh) + struct.pack('<%dh' % len(offsets), *offsets) + \
+        struct.pack('<%dh' % len(body), *body)
+
+    cx, cy = px * ROOM + ROOM // 2, py * ROOM + ROOM // 2
+    things = struct.pack('<hhhhh', cx, cy, 90, 1, 7)
+    for k in range(3):
+        things += struct.pack('<hhhhh', cx + 20 * k - 20, cy - 40, 0, 2013, 7)
+    things += struct.pack('<hhhhh', cx, cy + 40, 0, 2019, 7)
+    free = [c for c in cells if cells[c][0] == 0 and cells[c][1] > 0 and cells[c][2] == 0
+            and abs(c[0] - px) + abs(c[1] - py) > 3]
+    for k in range(monsters):
+        c = random.choice(free)
+        x = c[0] * ROOM + random.randint(32, ROOM - 32)
+        y = c[1] * ROOM + random.randint(32, ROOM - 32)
+        things += struct.pack('<hhhhh', x, y, random.randint(0, 7) * 45, random.choice(types), 7)
+
+    print('rooms %dx%d: sectors %d, lines %d, nodes %d, blockmap %d bytes, things %d'
+          % (g, g, len(cells), len(lines), len(nodes), len(blockmap), len(things) // 10))
+    return {'THINGS': things, 'LINEDEFS': linedefs, 'SIDEDEFS': sidedefs, 'VERTEXES': vertexes,
+            'SEGS': segs, 'SSECTORS': ssectors, 'NODES': b''.join(nodes), 'SECTORS': sectors,
+            'REJECT': reject, 'BLOCKMAP': blockmap}
+
+
+def demo(walk, tics, shoot):
+    d = bytes([109, 0, 1, 1, 0, 0, 0, 0, 0, 1, 0, 0, 0])     # 1.9, E1M1, skill 2, player 1
+    for t in range(tics):
+        forward = [25, 0, -25, 0][(t // 70) % 4] if walk else 0
+        turn = 2 if (t // 105) % 2 == 0 else -2
+        fire = 1 if shoot and (t % 4) < 2 else 0
+        d += struct.pack('<bbbB', forward, 0, turn, fire)
+    return d + b'\x80'
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    ap.add_argument('iwad')
+    ap.add_argument('out')
+    ap.add_argument('--rooms', type=int, default=16, help='rooms per side (default 16)')
+    ap.add_argument('--monsters', type=int, default=150, help='(default 150)')
+    ap.add_argument('--types', default='3004*5,9*2,3001*3,3002*2',
+                    help='doomednum*weight,... (default zombiemen, shotgun guys, imps, demons)')
+    ap.add_argument('--tics', type=int, default=2100, help='length of each demo (default 2100)')
+    ap.add_argument('--lights', action='store_true', help='add light specials')
+    args = ap.parse_args()
+
+    types = []
+    for item in args.types.split(','):
+        num, _, weight = item.partition('*')
+        types += [int(num)] * int(weight or 1)
+
+    ident, lumps = read_wad(args.iwad)
+    repl = build_map(args.rooms, args.monsters, types, args.lights)
+    repl['DEMO1'] = demo(False, args.tics, True)
+    repl['DEMO2'] = demo(True, args.tics, True)
+    repl['DEMO3'] = demo(False, args.tics, False)
+
+    out = []
+    inmap = False
+    for name, data in lumps:
+        if name == 'E1M1':
+            inmap = True
+        elif inmap and name not in repl:
+            inmap = False
+        if (inmap or name.startswith('DEMO')) and name in repl:
+            data = repl[name]
+        out.append((name, data))
+    write_wad(args.out, ident, out)
+
+
+if __name__ == '__main__':
+    main()
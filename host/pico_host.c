@@ -0,0 +1,327 @@
+/*
+ * Pico SDK primitives for the host build: time, stdio, panic, claims, core 1
+ * and the pheap used by the OPL callback queue.
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "pico/stdlib.h"
+#include "pico/multicore.h"
+#include "pico/util/pheap.h"
+#include "hardware/clocks.h"
+#include "hardware/dma.h"
+#include "hardware/pio.h"
+#include "hardware/structs/sysinfo.h"
+#include "hardware/watchdog.h"
+
+#ifndef CPU_CLOCK_MHZ
+#define CPU_CLOCK_MHZ 252
+#endif
+
+io_ro_32 host_sysinfo_regs[2] = { 0, 0 };
+
+// ---------------------------------------------------------------------------
+// Time
+
+static uint64_t boot_ns;
+
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+uint64_t time_us_64(void) {
+    if (!boot_ns) boot_ns = monotonic_ns();
+    return (monotonic_ns() - boot_ns) / 1000;
+}
+
+void sleep_us(uint64_t us) {
+    struct timespec ts = { (time_t)(us / 1000000), (long)(us % 1000000) * 1000 };
+    while (nanosleep(&ts, &ts) && errno == EINTR) { }
+}
+
+void sleep_ms(uint32_t ms) {
+    sleep_us(ms * 1000ull);
+}
+
+void busy_wait_us(uint64_t us) {
+    const uint64_t end = time_us_64() + us;
+    while (time_us_64() < end) { }
+}
+
+// ---------------------------------------------------------------------------
+// Core 1
+
+__thread uint host_core_num = 0;
+
+#define FIFO_DEPTH 8
+
+// fifos[n] carries words pushed by core n.
+static struct {
+    uint32_t data[FIFO_DEPTH];
+    uint32_t head, count;
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+} fifos[2] = {
+    { .lock = PTHREAD_MUTEX_INITIALIZER, .changed = PTHREAD_COND_INITIALIZER },
+    { .lock = PTHREAD_MUTEX_INITIALIZER, .changed = PTHREAD_COND_INITIALIZER },
+};
+
+static void *core1_thread(void *entry) {
+    host_core_num = 1;
+    ((void (*)(void))entry)();
+    return NULL;
+}
+
+void multicore_launch_core1(void (*entry)(void)) {
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, core1_thread, (void *)entry) != 0) {
+        panic("multicore_launch_core1: cannot start thread");
+    }
+    pthread_detach(thread);
+}
+
+void multicore_fifo_push_blocking(uint32_t data) {
+    __typeof__(fifos[0]) *f = &fifos[host_core_num];
+    pthread_mutex_lock(&f->lock);
+    while (f->count == FIFO_DEPTH) pthread_cond_wait(&f->changed, &f->lock);
+    f->data[(f->head + f->count++) % FIFO_DEPTH] = data;
+    pthread_cond_broadcast(&f->changed);
+    pthread_mutex_unlock(&f->lock);
+}
+
+uint32_t multicore_fifo_pop_blocking(void) {
+    __typeof__(fifos[0]) *f = &fifos[host_core_num ^ 1];
+    pthread_mutex_lock(&f->lock);
+    while (!f->count) pthread_cond_wait(&f->changed, &f->lock);
+    const uint32_t data = f->data[f->head];
+    f->head = (f->head + 1) % FIFO_DEPTH;
+    f->count--;
+    pthread_cond_broadcast(&f->changed);
+    pthread_mutex_unlock(&f->lock);
+    return data;
+}
+
+bool multicore_fifo_rvalid(void) {
+    __typeof__(fifos[0]) *f = &fifos[host_core_num ^ 1];
+    pthread_mutex_lock(&f->lock);
+    const bool valid = f->count != 0;
+    pthread_mutex_unlock(&f->lock);
+    return valid;
+}
+
+// ---------------------------------------------------------------------------
+// stdio
+
+bool stdio_init_all(void) {
+    // Console commands arrive on stdin; never block the game loop on it.
+    const int flags = fcntl(STDIN_FILENO, F_GETFL);
+    if (flags >= 0) fcntl(STDIN_FILENO, F_SETFL, flags | O_NONBLOCK);
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    return true;
+}
+
+void stdio_flush(void) {
+    fflush(stdout);
+}
+
+int getchar_timeout_us(uint32_t timeout_us) {
+    (void)timeout_us;
+    unsigned char c;
+    return read(STDIN_FILENO, &c, 1) == 1 ? c : PICO_ERROR_TIMEOUT;
+}
+
+int putchar_raw(int c) {
+    return putchar(c);
+}
+
+int puts_raw(const char *s) {
+    return fputs(s, stdout);
+}
+
+void panic(const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    fputs("*** PANIC ***\n", stdout);
+    vprintf(fmt, args);
+    va_end(args);
+    putchar('\n');
+    fflush(stdout);
+    exit(1);
+}
+
+void watchdog_reboot(uint32_t pc, uint32_t sp, uint32_t delay_ms) {
+    (void)pc;
+    (void)sp;
+    (void)delay_ms;
+    fflush(stdout);
+    exit(0);
+}
+
+uint32_t clock_get_hz(clock_handle_t clock) {
+    return clock == clk_sys ? CPU_CLOCK_MHZ * 1000000u : 48000000u;
+}
+
+bool set_sys_clock_khz(uint32_t freq_khz, bool required) {
+    (void)freq_khz;
+    (void)required;
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// DMA / PIO claims
+
+static uint32_t dma_claimed;
+static uint8_t pio_claimed[NUM_PIOS];
+
+void dma_channel_claim(uint channel) {
+    if (dma_claimed & (1u << channel)) panic("DMA channel %u already claimed", channel);
+    dma_claimed |= 1u << channel;
+}
+
+void dma_channel_unclaim(uint channel) {
+    dma_claimed &= ~(1u << channel);
+}
+
+bool dma_channel_is_claimed(uint channel) {
+    return (dma_claimed & (1u << channel)) != 0;
+}
+
+int dma_claim_unused_channel(bool required) {
+    for (uint ch = 0; ch < NUM_DMA_CHANNELS; ++ch) {
+        if (!dma_channel_is_claimed(ch)) {
+            dma_channel_claim(ch);
+            return (int)ch;
+        }
+    }
+    if (required) panic("No DMA channels are available");
+    return -1;
+}
+
+void pio_sm_claim(PIO pio, uint sm) {
+    const uint i = pio_get_index(pio);
+    if (pio_claimed[i] & (1u << sm)) panic("PIO %u SM %u already claimed", i, sm);
+    pio_claimed[i] |= (uint8_t)(1u << sm);
+}
+
+void pio_sm_unclaim(PIO pio, uint sm) {
+    pio_claimed[pio_get_index(pio)] &= (uint8_t)~(1u << sm);
+}
+
+int pio_claim_unused_sm(PIO pio, bool required) {
+    const uint i = pio_get_index(pio);
+    for (uint sm = 0; sm < NUM_PIO_STATE_MACHINES; ++sm) {
+        if (!(pio_claimed[i] & (1u << sm))) {
+            pio_sm_claim(pio, sm);
+            return (int)sm;
+        }
+    }
+    if (required) panic("No PIO state machines are available");
+    return -1;
+}
+
+// ---------------------------------------------------------------------------
+// Pairing heap
+
+void ph_clear(pheap_t *heap) {
+    heap->root_id = 0;
+    heap->free_head_id = 1;
+    heap->free_tail_id = heap->max_nodes;
+    for (pheap_node_id_t id = 1; id <= heap->max_nodes; ++id) {
+        pheap_node_t *node = ph_get_node(heap, id);
+        node->child = 0;
+        node->parent = 0;
+        node->sibling = id < heap->max_nodes ? (pheap_node_id_t)(id + 1) : 0;
+    }
+}
+
+void ph_post_alloc_init(pheap_t *heap, uint max_nodes, pheap_comparator comparator, void *user_data) {
+    heap->max_nodes = (pheap_node_id_t)max_nodes;
+    heap->comparator = comparator;
+    heap->user_data = user_data;
+    ph_clear(heap);
+}
+
+pheap_node_id_t ph_new_node(pheap_t *heap) {
+    const pheap_node_id_t id = heap->free_head_id;
+    if (!id) return 0;
+    pheap_node_t *node = ph_get_node(heap, id);
+    heap->free_head_id = node->sibling;
+    if (!heap->free_head_id) heap->free_tail_id = 0;
+    node->child = node->sibling = node->parent = 0;
+    return id;
+}
+
+void ph_free_node(pheap_t *heap, pheap_node_id_t id) {
+    ph_get_node(heap, id)->sibling = 0;
+    if (heap->free_tail_id) {
+        ph_get_node(heap, heap->free_tail_id)->sibling = id;
+    } else {
+        heap->free_head_id = id;
+    }
+    heap->free_tail_id = id;
+}
+
+static pheap_node_id_t ph_merge(pheap_t *heap, pheap_node_id_t a, pheap_node_id_t b) {
+    if (!a) return b;
+    if (!b) return a;
+    if (heap->comparator(heap->user_data, b, a)) {
+        const pheap_node_id_t t = a;
+        a = b;
+        b = t;
+    }
+    pheap_node_t *na = ph_get_node(heap, a);
+    pheap_node_t *nb = ph_get_node(heap, b);
+    nb->sibling = na->child;
+    nb->parent = a;
+    na->child = b;
+    na->sibling = 0;
+    na->parent = 0;
+    return a;
+}
+
+// Standard two-pass merge of a sibling list.
+static pheap_node_id_t ph_merge_pairs(pheap_t *heap, pheap_node_id_t id) {
+    pheap_node_id_t merged = 0;
+    while (id) {
+        const pheap_node_id_t a = id;
+        const pheap_node_id_t b = ph_get_node(heap, a)->sibling;
+        id = b ? ph_get_node(heap, b)->sibling : 0;
+        ph_get_node(heap, a)->sibling = 0;
+        if (b) ph_get_node(heap, b)->sibling = 0;
+        const pheap_node_id_t pair = ph_merge(heap, a, b);
+        // Collect pairs in reverse order through the sibling link.
+        ph_get_node(heap, pair)->sibling = merged;
+        merged = pair;
+    }
+    pheap_node_id_t root = 0;
+    while (merged) {
+        const pheap_node_id_t next = ph_get_node(heap, merged)->sibling;
+        ph_get_node(heap, merged)->sibling = 0;
+        root = ph_merge(heap, root, merged);
+        merged = next;
+    }
+    return root;
+}
+
+void ph_insert_node(pheap_t *heap, pheap_node_id_t id) {
+    pheap_node_t *node = ph_get_node(heap, id);
+    node->child = node->sibling = node->parent = 0;
+    heap->root_id = ph_merge(heap, heap->root_id, id);
+}
+
+pheap_node_id_t ph_remove_head(pheap_t *heap, bool free) {
+    const pheap_node_id_t id = heap->root_id;
+    if (!id) return 0;
+    heap->root_id = ph_merge_pairs(heap, ph_get_node(heap, id)->child);
+    if (free) ph_free_node(heap, id);
+    return id;
+}
@@ -0,0 +1,126 @@
+/*
+ * PSRAM for the host build: an anonymous mapping at the RP2350 XIP address
+ * (0x11000000) so drivers/psram_allocator.c runs unmodified, with optional
+ * miss latency injection (see host.h).
+ */
+#define _GNU_SOURCE
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+
+#include "psram_init.h"
+#include "psram_allocator.h"
+#include "hardware/clocks.h"
+
+#include "host.h"
+
+#define PSRAM_HOST_BASE ((uintptr_t)0x11000000u)
+#define PSRAM_PAGE 4096u
+#define PSRAM_MAX_RESIDENT 4096u
+
+static uint32_t miss_ns = 0;
+static uint32_t resident_max = 0;
+
+// FIFO of resident page indices.
+static uint16_t resident[PSRAM_MAX_RESIDENT];
+static uint32_t resident_head = 0;
+static uint32_t resident_count = 0;
+static volatile uint64_t misses = 0;
+
+static struct sigaction prev_segv;
+
+void host_psram_set_latency(uint32_t ns, uint32_t pages) {
+    miss_ns = ns;
+    if (pages < 4) pages = 4;   // an instruction may touch two pages at once
+    if (pages > PSRAM_MAX_RESIDENT) pages = PSRAM_MAX_RESIDENT;
+    resident_max = pages;
+}
+
+uint64_t host_psram_misses(void) {
+    return misses;
+}
+
+static void spin_ns(uint32_t ns) {
+    struct timespec t0, t;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    do {
+        clock_gettime(CLOCK_MONOTONIC, &t);
+    } while ((uint64_t)(t.tv_sec - t0.tv_sec) * 1000000000ull + (uint64_t)(t.tv_nsec - t0.tv_nsec) < ns);
+}
+
+static void psram_fault(int sig, siginfo_t *info, void *ctx) {
+    const uintptr_t addr = (uintptr_t)info->si_addr;
+    if (addr < PSRAM_HOST_BASE || addr >= PSRAM_HOST_BASE + MURMDOOM_PSRAM_SIZE_BYTES) {
+        // Not ours: hand over to the previous handler or die as usual.
+        if (prev_segv.sa_flags & SA_SIGINFO) {
+            prev_segv.sa_sigaction(sig, info, ctx);
+        } else if (prev_segv.sa_handler != SIG_DFL && prev_segv.sa_handler != SIG_IGN) {
+            prev_segv.sa_handler(sig);
+        } else {
+            signal(sig, SIG_DFL);
+            raise(sig);
+        }
+        return;
+    }
+
+    misses++;
+    if (resident_count == resident_max) {
+        const uint16_t victim = resident[resident_head];
+        mprotect((void *)(PSRAM_HOST_BASE + (uintptr_t)victim * PSRAM_PAGE), PSRAM_PAGE, PROT_NONE);
+        resident_head = (resident_head + 1) % resident_max;
+        resident_count--;
+    }
+    const uint16_t page = (uint16_t)((addr - PSRAM_HOST_BASE) / PSRAM_PAGE);
+    resident[(resident_head + resident_count) % resident_max] = page;
+    resident_count++;
+    mprotect((void *)(PSRAM_HOST_BASE + (uintptr_t)page * PSRAM_PAGE), PSRAM_PAGE, PROT_READ | PROT_WRITE);
+    spin_ns(miss_ns);
+}
+
+// QMI timing is only remembered: host memory runs at whatever speed
+// -psram-latency models, and every setting passes the calibration pattern.
+static psram_timing_t timing;
+
+void psram_init(uint cs_pin) {
+    (void)cs_pin;
+    psram_default_timing(&timing);
+    void *p = mmap((void *)PSRAM_HOST_BASE, MURMDOOM_PSRAM_SIZE_BYTES, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+    if (p != (void *)PSRAM_HOST_BASE) {
+        panic("psram_init: cannot map %u bytes at %p", (unsigned)MURMDOOM_PSRAM_SIZE_BYTES,
+              (void *)PSRAM_HOST_BASE);
+    }
+
+    if (!resident_max) return;
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_sigaction = psram_fault;
+    sa.sa_flags = SA_SIGINFO | SA_NODEFER;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGSEGV, &sa, &prev_segv);
+    mprotect(p, MURMDOOM_PSRAM_SIZE_BYTES, PROT_NONE);
+    printf("psram: %u ns per miss, %u resident 4KB pages\n", (unsigned)miss_ns, (unsigned)resident_max);
+}
+
+void psram_default_timing(psram_timing_t *t) {
+    const uint32_t max_hz = PSRAM_MAX_FREQ_MHZ * 1000000u;
+    const uint32_t clock_hz = clock_get_hz(clk_sys);
+    t->clkdiv = (clock_hz + max_hz - 1) / max_hz;
+    if (t->clkdiv < 2) t->clkdiv = 2;
+    t->rxdelay = t->clkdiv + (clock_hz / t->clkdiv > 100000000u);
+    t->cooldown = 1;
+}
+
+void psram_get_timing(psram_timing_t *t) {
+    *t = timing;
+}
+
+void psram_set_timing(const psram_timing_t *t) {
+    timing = *t;
+}
+
+void psram_reset_device(void) {
+}
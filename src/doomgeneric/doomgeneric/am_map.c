@@ -31,6 +31,7 @@
 #include "m_cheat.h"
 #include "m_controls.h"
 #include "m_misc.h"
+#include "m_bbox.h"
 #include "i_system.h"
 
 // Needs access to LFB.
@@ -45,6 +46,9 @@
 
 #include "am_map.h"
 
+#include "murmdoom_amdraw.h"
+#include "murmdoom_prof.h"
+
 
 // For use if I do walls with outsides/insides
 #define REDS		(256-5*16)
@@ -267,6 +271,12 @@ cheatseq_t cheat_amap = CHEAT("iddt", 0);
 
 static boolean stopped = true;
 
+// Murmdoom: lines the blockmap lists around the window, a bit per line
+// (murmdoom_amdraw.h). NULLed by the zone when the level is freed.
+static uint32_t *visiblelines;
+// The framebuffer holds something other than last frame's map.
+static boolean fullclear = true;
+
 // Calculates the slope and slope according to the x-axis of a line
 // segment in map coordinates (with the upright y-axis n' all) so
 // that it can be used with the brain-dead drawing stuff.
@@ -428,6 +438,7 @@ void AM_initVariables(void)
 
     automapactive = true;
     fb = I_VideoBuffer;
+    fullclear = true;
 
     f_oldloc.x = INT_MAX;
     amclock = 0;
@@ -833,7 +844,13 @@ void AM_Ticker (void)
 //
 void AM_clearFB(int color)
 {
-    memset(fb, color, f_w*f_h);
+    int box[4];
+
+    // Murmdoom: only where the map was drawn last frame, and where anything
+    // else was drawn over it since.
+    V_TakeMarked(box);
+    amdraw_begin(fb, f_w, f_h, color, fullclear, box);
+    fullclear = false;
 }
 
 
@@ -985,16 +1002,6 @@ AM_drawFline
 ( fline_t*	fl,
   int		color )
 {
-    register int x;
-    register int y;
-    register int dx;
-    register int dy;
-    register int sx;
-    register int sy;
-    register int ax;
-    register int ay;
-    register int d;
-    
     static int fuck = 0;
 
     // For debugging only
@@ -1007,51 +1014,12 @@ AM_drawFline
 	return;
     }
 
-#define PUTDOT(xx,yy,cc) fb[(yy)*f_w+(xx)]=(cc)
-
-    dx = fl->b.x - fl->a.x;
-    ax = 2 * (dx<0 ? -dx : dx);
-    sx = dx<0 ? -1 : 1;
-
-    dy = fl->b.y - fl->a.y;
-    ay = 2 * (dy<0 ? -dy : dy);
-    sy = dy<0 ? -1 : 1;
-
-    x = fl->a.x;
-    y = fl->a.y;
-
-    if (ax > ay)
-    {
-	d = ay - ax/2;
-	while (1)
-	{
-	    PUTDOT(x,y,color);
-	    if (x == fl->b.x) return;
-	    if (d>=0)
-	    {
-		y += sy;
-		d -= ax;
-	    }
-	    x += sx;
-	    d += ay;
-	}
-    }
-    else
-    {
-	d = ax - ay/2;
-	while (1)
-	{
-	    PUTDOT(x, y, color);
-	    if (y == fl->b.y) return;
-	    if (d >= 0)
-	    {
-		x += sx;
-		d -= ay;
-	    }
-	    y += sy;
-	    d += ax;
-	}
-    }
+    // Murmdoom: same pixels, from SRAM.
+    amdraw_line(fl->a.x, fl->a.y, fl->b.x, fl->b.y, color);
+    amdraw_mark(fl->a.x < fl->b.x ? fl->a.x : fl->b.x,
+		fl->a.y < fl->b.y ? fl->a.y : fl->b.y,
+		(fl->a.x < fl->b.x ? fl->b.x - fl->a.x : fl->a.x - fl->b.x) + 1,
+		(fl->a.y < fl->b.y ? fl->b.y - fl->a.y : fl->a.y - fl->b.y) + 1);
 }
 
 
@@ -1117,56 +1085,120 @@ void AM_drawGrid(int color)
 }
 
 //
-// Determines visible lines, draws them.
-// This is LineDef based, not LineSeg based.
+// Murmdoom: AM_drawMline for walls, which lie within the map bounds that
+// AM_drawWalls marks, so not marked line by line.
 //
-void AM_drawWalls(void)
+static void AM_drawWallMline(mline_t *ml, int color)
+{
+    static fline_t fl;
+
+    if (AM_clipMline(ml, &fl))
+	amdraw_line(fl.a.x, fl.a.y, fl.b.x, fl.b.y, color);
+}
+
+//
+// Draws one line in the colour for its kind.
+//
+static void AM_drawWall(line_t *line)
 {
-    int i;
     static mline_t l;
 
-    for (i=0;i<numlines;i++)
+    l.a.x = line->v1->x;
+    l.a.y = line->v1->y;
+    l.b.x = line->v2->x;
+    l.b.y = line->v2->y;
+    if (cheating || (line->flags & ML_MAPPED))
     {
-	l.a.x = lines[i].v1->x;
-	l.a.y = lines[i].v1->y;
-	l.b.x = lines[i].v2->x;
-	l.b.y = lines[i].v2->y;
-	if (cheating || (lines[i].flags & ML_MAPPED))
+	if ((line->flags & LINE_NEVERSEE) && !cheating)
+	    return;
+	if (!line->backsector)
 	{
-	    if ((lines[i].flags & LINE_NEVERSEE) && !cheating)
-		continue;
-	    if (!lines[i].backsector)
-	    {
-		AM_drawMline(&l, WALLCOLORS+lightlev);
+	    AM_drawWallMline(&l, WALLCOLORS+lightlev);
+	}
+	else
+	{
+	    if (line->special == 39)
+	    { // teleporters
+		AM_drawWallMline(&l, WALLCOLORS+WALLRANGE/2);
 	    }
-	    else
+	    else if (line->flags & ML_SECRET) // secret door
 	    {
-		if (lines[i].special == 39)
-		{ // teleporters
-		    AM_drawMline(&l, WALLCOLORS+WALLRANGE/2);
-		}
-		else if (lines[i].flags & ML_SECRET) // secret door
-		{
-		    if (cheating) AM_drawMline(&l, SECRETWALLCOLORS + lightlev);
-		    else AM_drawMline(&l, WALLCOLORS+lightlev);
-		}
-		else if (lines[i].backsector->floorheight
-			   != lines[i].frontsector->floorheight) {
-		    AM_drawMline(&l, FDWALLCOLORS + lightlev); // floor level change
-		}
-		else if (lines[i].backsector->ceilingheight
-			   != lines[i].frontsector->ceilingheight) {
-		    AM_drawMline(&l, CDWALLCOLORS+lightlev); // ceiling level change
-		}
-		else if (cheating) {
-		    AM_drawMline(&l, TSWALLCOLORS+lightlev);
-		}
+		if (cheating) AM_drawWallMline(&l, SECRETWALLCOLORS + lightlev);
+		else AM_drawWallMline(&l, WALLCOLORS+lightlev);
+	    }
+	    else if (line->backsector->floorheight
+		       != line->frontsector->floorheight) {
+		AM_drawWallMline(&l, FDWALLCOLORS + lightlev); // floor level change
+	    }
+	    else if (line->backsector->ceilingheight
+		       != line->frontsector->ceilingheight) {
+		AM_drawWallMline(&l, CDWALLCOLORS+lightlev); // ceiling level change
+	    }
+	    else if (cheating) {
+		AM_drawWallMline(&l, TSWALLCOLORS+lightlev);
 	    }
 	}
-	else if (plr->powers[pw_allmap])
-	{
-	    if (!(lines[i].flags & LINE_NEVERSEE)) AM_drawMline(&l, GRAYS+3);
-	}
+    }
+    else if (plr->powers[pw_allmap])
+    {
+	if (!(line->flags & LINE_NEVERSEE)) AM_drawWallMline(&l, GRAYS+3);
+    }
+}
+
+//
+// Determines visible lines, draws them.
+// This is LineDef based, not LineSeg based.
+//
+// Murmdoom: only the lines the blockmap lists in the cells around the
+// window are visited, in line order as before so that lines sharing a
+// vertex overdraw each other the same way.
+//
+void AM_drawWalls(void)
+{
+    int words = (numlines + 31) / 32;
+    int x0, y0, x1, y1;
+    int i;
+    uint32_t bits;
+
+    // The map bounds within the window, a pixel wider for rounding.
+    if (max_x >= m_x && min_x <= m_x2 && max_y >= m_y && min_y <= m_y2)
+    {
+	x0 = CXMTOF(min_x > m_x ? min_x : m_x);
+	x1 = CXMTOF(max_x < m_x2 ? max_x : m_x2);
+	y0 = CYMTOF(max_y < m_y2 ? max_y : m_y2);
+	y1 = CYMTOF(min_y > m_y ? min_y : m_y);
+	amdraw_mark(x0 - 1, y0 - 1, x1 - x0 + 3, y1 - y0 + 3);
+    }
+
+    // Cells of the window, one more on each side for lines on the edge.
+    x0 = ((m_x >> FRACBITS) - (bmaporgx >> FRACBITS)) / MAPBLOCKUNITS - 1;
+    x1 = ((m_x2 >> FRACBITS) - (bmaporgx >> FRACBITS)) / MAPBLOCKUNITS + 1;
+    y0 = ((m_y >> FRACBITS) - (bmaporgy >> FRACBITS)) / MAPBLOCKUNITS - 1;
+    y1 = ((m_y2 >> FRACBITS) - (bmaporgy >> FRACBITS)) / MAPBLOCKUNITS + 1;
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 >= bmapwidth) x1 = bmapwidth - 1;
+    if (y1 >= bmapheight) y1 = bmapheight - 1;
+
+    // Zoomed out over a good part of the map, walking the cells costs more
+    // than clipping every line.
+    if (x0 > x1 || y0 > y1
+     || 4 * (x1 - x0 + 1) * (y1 - y0 + 1) >= bmapwidth * bmapheight)
+    {
+	for (i=0;i<numlines;i++)
+	    AM_drawWall(&lines[i]);
+	return;
+    }
+
+    if (!visiblelines)
+	Z_Malloc(words * sizeof(*visiblelines), PU_LEVEL, &visiblelines);
+    memset(visiblelines, 0, words * sizeof(*visiblelines));
+    amdraw_blocklines(blockmaplump, bmapwidth, x0, y0, x1, y1, numlines, visiblelines);
+
+    for (i=0;i<words;i++)
+    {
+	for (bits = visiblelines[i]; bits; bits &= bits - 1)
+	    AM_drawWall(&lines[i * 32 + __builtin_ctz(bits)]);
     }
 }
 
@@ -1332,13 +1364,18 @@ void AM_drawMarks(void)
 void AM_drawCrosshair(int color)
 {
     fb[(f_w*(f_h+1))/2] = color; // single point for now
+    amdraw_mark(((f_w*(f_h+1))/2) % f_w, ((f_w*(f_h+1))/2) / f_w, 1, 1);
 
 }
 
 void AM_Drawer (void)
 {
+    int box[4];
+
     if (!automapactive) return;
 
+    PROF_SCOPE(PROF_AUTOMAP);
+
     AM_clearFB(BACKGROUND);
     if (grid)
 	AM_drawGrid(GRIDCOLORS);
@@ -1348,8 +1385,14 @@ void AM_Drawer (void)
 	AM_drawThings(THINGCOLORS, THINGRANGE);
     AM_drawCrosshair(XHAIRCOLORS);
 
-    AM_drawMarks();
+    // Murmdoom: mark what changed, then forget this frame's marks so that
+    // the next AM_clearFB sees only what is drawn over the map. The marks
+    // come after, as they mark themselves.
+    if (amdraw_touched(box))
+	V_MarkRect(box[BOXLEFT], box[BOXBOTTOM],
+		   box[BOXRIGHT] - box[BOXLEFT] + 1, box[BOXTOP] - box[BOXBOTTOM] + 1);
+    V_TakeMarked(box);
 
-    V_MarkRect(f_x, f_y, f_w, f_h);
+    AM_drawMarks();
 
 }
@@ -40,6 +40,10 @@
 #include "net_sdl.h"
 #include "net_loop.h"
 
+#include "murmdoom_input.h"
+#include "murmdoom_interp.h"
+#include "murmdoom_prof.h"
+
 // The complete set of data for a particular tic.
 
 typedef struct
@@ -141,6 +145,8 @@ static boolean BuildNewTic(void)
     gameticdiv = gametic/ticdup;
 
     I_StartTic ();
+    // Murmdoom: mouse motion since the last tic as one ev_mouse.
+    input_tic();
     loop_interface->ProcessEvents();
 
     // Always run the menu
@@ -176,6 +182,8 @@ static boolean BuildNewTic(void)
     //printf ("mk:%i ",maketic);
     memset(&cmd, 0, sizeof(ticcmd_t));
     loop_interface->BuildTiccmd(&cmd, maketic);
+    // Murmdoom: the events consumed since the last ticcmd are in this one.
+    input_ticcmd();
 
 #ifdef FEATURE_MULTIPLAYER
 
@@ -712,6 +720,7 @@ void TryRunTics (void)
     int realtics;
     int	availabletics;
     int	counts;
+    PROF_SCOPE(PROF_TRYRUNTICS);
 
     // get real tics
     entertic = I_GetTime() / ticdup;
@@ -781,7 +790,14 @@ void TryRunTics (void)
 	    return;
 	}
 
-        I_Sleep(1);
+        // Uncapped rendering draws an interpolated frame instead of waiting.
+        if (interp_uncapped())
+        {
+            return;
+        }
+
+        // Murmdoom: sleep until the next tic instead of polling every ms.
+        I_SleepUntilNextTic();
     }
 
     // run the count * ticdup dics
@@ -73,6 +73,15 @@
 #include "statdump.h"
 
 #include "d_main.h"
+#include "murmdoom_bench.h"
+#include "murmdoom_framehash.h"
+#include "murmdoom_interp.h"
+#include "murmdoom_levelload.h"
+#include "murmdoom_present.h"
+#include "murmdoom_prof.h"
+#include "murmdoom_sight.h"
+#include "murmdoom_snapshot.h"
+#include "murmdoom_thinkers.h"
 
 //
 // D-DoomLoop()
@@ -181,6 +190,7 @@ void D_Display (void)
     boolean			done;
     boolean			wipe;
     boolean			redrawsbar;
+    PROF_SCOPE(PROF_DISPLAY);
 
     if (nodrawers)
     	return;                    // for comparative timing / profiling
@@ -219,6 +229,10 @@ void D_Display (void)
 		redrawsbar = true;
 	if (inhelpscreensstate && !inhelpscreens)
 		redrawsbar = true;              // just put away the help screen
+	// Murmdoom: status bar numbers are only redrawn when they change, so
+	// repaint it once after the menu, which may have covered part of it.
+	if (menuactivestate && !menuactive)
+		redrawsbar = true;
 	ST_Drawer (screenblocks == 11, redrawsbar );
 	fullscreen = screenblocks == 11;
 	break;      case GS_INTERMISSION:
@@ -239,7 +253,11 @@ void D_Display (void)
     
     // draw the view directly
     if (gamestate == GS_LEVEL && !automapactive && gametic)
+    {
     	R_RenderPlayerView (&players[displayplayer]);
+	// Murmdoom: the view is drawn column by column, unmarked.
+	V_MarkRect (viewwindowx, viewwindowy, scaledviewwidth, viewheight);
+    }
 
     if (gamestate == GS_LEVEL && gametic)
     	HU_Drawer ();
@@ -314,15 +332,22 @@ void D_Display (void)
 	{
 	    nowtime = I_GetTime ();
 	    tics = nowtime - wipestart;
-            I_Sleep(1);
+            if (tics <= 0)
+                I_SleepUntilNextTic();    // Murmdoom: was I_Sleep(1)
 	} while (tics <= 0);
         
 	wipestart = nowtime;
-	done = wipe_ScreenWipe(wipe_Melt
-			       , 0, 0, SCREENWIDTH, SCREENHEIGHT, tics);
-	I_UpdateNoBlit ();
-	M_Drawer ();                            // menu is drawn even on top of wipes
-	I_FinishUpdate ();                      // page flip or blit buffer
+	{
+	    PROF_SCOPE(PROF_WIPE);
+	    done = wipe_ScreenWipe(wipe_Melt
+				   , 0, 0, SCREENWIDTH, SCREENHEIGHT, tics);
+	    I_UpdateNoBlit ();
+	    // Murmdoom: over the melt, not into the end screen (f_wipe.c).
+	    if (M_Drawing ())
+		wipe_ComposeMelt ();
+	    M_Drawer ();                        // menu is drawn even on top of wipes
+	    I_FinishUpdate ();                  // page flip or blit buffer
+	}
     } while (!done);
 }
 
@@ -365,6 +390,8 @@ void D_BindVariables(void)
     M_BindVariable("vanilla_savegame_limit", &vanilla_savegame_limit);
     M_BindVariable("vanilla_demo_limit",     &vanilla_demo_limit);
     M_BindVariable("show_endoom",            &show_endoom);
+    M_BindVariable("murmdoom_uncapped",      &murmdoom_uncapped);
+    M_BindVariable("murmdoom_vsync",         &murmdoom_vsync);
 
     // Multiplayer chat macros
 
@@ -402,6 +429,8 @@ boolean D_GrabMouseCallback(void)
 
 void doomgeneric_Tick()
 {
+    present_frame_start(interp_uncapped());
+
     // frame syncronous IO operations
     I_StartFrame ();
 
@@ -414,6 +443,10 @@ void doomgeneric_Tick()
     {
         D_Display ();
     }
+
+    prof_frame_end();
+    bench_frame_end();
+    framehash_frame_end();
 }
 
 //
@@ -1162,7 +1195,8 @@ void D_DoomMain (void)
 {
     int p;
     char file[256];
-    char demolumpname[9];
+    // Murmdoom: static, G_TimeDemo keeps the pointer after D_DoomMain returns.
+    static char demolumpname[9];
 #if ORIGCODE
     int numiwadlumps;
 #endif
@@ -1356,6 +1390,11 @@ void D_DoomMain (void)
     M_SetConfigFilenames("default.cfg", PROGRAM_PREFIX "doom.cfg");
     D_BindVariables();
     M_LoadDefaults();
+    interp_init();
+    levelload_init();
+    snapshot_init();
+    sight_init();
+    thinkers_init();
 
     // Save configuration at exit.
     I_AtExit(M_SaveDefaults, false);
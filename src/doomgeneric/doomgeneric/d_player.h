@@ -158,6 +158,9 @@ typedef struct player_s
     // True if secret level has been done.
     boolean		didsecret;	
 
+    // Murmdoom: viewz at the start of the last tic (murmdoom_interp.h).
+    fixed_t		oldviewz;
+
 } player_t;
 
 
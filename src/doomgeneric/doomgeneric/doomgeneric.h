@@ -42,6 +42,10 @@ uint32_t DG_GetTicksMs();
 int DG_GetKey(int* pressed, unsigned char* key);
 void DG_SetWindowTitle(const char * title);
 
+// Murmdoom: 5x7 text and solid fills on DG_ScreenBuffer, for debug overlays.
+void DG_DrawText(int x, int y, const char *text, pixel_t color);
+void DG_FillRect(int x, int y, int w, int h, pixel_t color);
+
 #ifdef __cplusplus
 }
 #endif
@@ -78,6 +78,8 @@ typedef bool boolean;
 
 #else
 
+// Murmdoom: false and true are enumerators here, so a file that uses both
+// this and <stdbool.h> includes the engine headers first (murmdoom_*.c).
 typedef enum 
 {
     false	= 0,
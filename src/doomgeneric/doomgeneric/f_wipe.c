@@ -38,28 +38,23 @@ static byte*	wipe_scr_start;
 static byte*	wipe_scr_end;
 static byte*	wipe_scr;
 
+// Murmdoom: the melt never writes the screen. The end screen stays in
+// I_VideoBuffer where it was drawn, and I_FinishUpdate builds each line it
+// copies out from the two screens and the column offsets (wipe_MeltLine),
+// so a wipe tic only moves the offsets. No transposed copies, no end
+// screen copy, and the line is composed in SRAM.
+//
+// The menu is drawn over the melt as vanilla drew it over the wipe screen
+// it kept in I_VideoBuffer. When it shows up during a melt, the end screen
+// is set aside, the melt composed into I_VideoBuffer, and from then on the
+// columns are moved there as vanilla did (wipe_ComposeMelt).
+boolean		wipe_melting = false;
 
-void
-wipe_shittyColMajorXform
-( short*	array,
-  int		width,
-  int		height )
-{
-    int		x;
-    int		y;
-    short*	dest;
-
-    dest = (short*) Z_Malloc(width*height*2, PU_STATIC, 0);
-
-    for(y=0;y<height;y++)
-	for(x=0;x<width;x++)
-	    dest[x*height+y] = array[y*width+x];
-
-    memcpy(array, dest, width*height*2);
-
-    Z_Free(dest);
+static short	melt_y[SCREENWIDTH/2];	// per two-pixel column
+static int	melt_min;		// lowest of melt_y
+static short	melt_line[SCREENWIDTH/2];
+static boolean	melt_composed;		// I_VideoBuffer is the wipe screen
 
-}
 
 int
 wipe_initColorXForm
@@ -67,6 +62,9 @@ wipe_initColorXForm
   int	height,
   int	ticks )
 {
+    // Murmdoom: wipe_EndScreen leaves the end screen in I_VideoBuffer.
+    wipe_scr_end = Z_Malloc(width*height, PU_STATIC, NULL);
+    memcpy(wipe_scr_end, wipe_scr, width*height);
     memcpy(wipe_scr, wipe_scr_start, width*height);
     return 0;
 }
@@ -123,43 +121,70 @@ wipe_exitColorXForm
   int	height,
   int	ticks )
 {
+    Z_Free(wipe_scr_start);
+    Z_Free(wipe_scr_end);
+    wipe_scr_end = NULL;
     return 0;
 }
 
 
-static int*	y;
-
 int
 wipe_initMelt
 ( int	width,
   int	height,
   int	ticks )
 {
-    int i, r;
-    
-    // copy start screen to main screen
-    memcpy(wipe_scr, wipe_scr_start, width*height);
-    
-    // makes this wipe faster (in theory)
-    // to have stuff in column-major format
-    wipe_shittyColMajorXform((short*)wipe_scr_start, width/2, height);
-    wipe_shittyColMajorXform((short*)wipe_scr_end, width/2, height);
+    int i, r, y;
     
     // setup initial column positions
     // (y<0 => not ready to scroll yet)
-    y = (int *) Z_Malloc(width*sizeof(int), PU_STATIC, 0);
-    y[0] = -(M_Random()%16);
+    // Murmdoom: vanilla sets up width columns and moves only the first
+    // width/2. The rest are drawn and dropped, so that M_Random (the status
+    // bar face, the intermission animations) goes on as it did.
+    y = -(M_Random()%16);
+    melt_y[0] = y;
     for (i=1;i<width;i++)
     {
 	r = (M_Random()%3) - 1;
-	y[i] = y[i-1] + r;
-	if (y[i] > 0) y[i] = 0;
-	else if (y[i] == -16) y[i] = -15;
+	y += r;
+	if (y > 0) y = 0;
+	else if (y == -16) y = -15;
+	if (i < width/2)
+	    melt_y[i] = y;
     }
 
+    melt_min = 0;
+    melt_composed = false;
+    wipe_melting = true;
     return 0;
 }
 
+//
+// Murmdoom: vanilla's move of column i from y0 to y1, once I_VideoBuffer
+// is the wipe screen: the end screen down to y1, the start screen below.
+//
+static void
+melt_column
+( int	i,
+  int	y0,
+  int	y1,
+  int	width,
+  int	height )
+{
+    short*		d;
+    const short*	e;
+    const short*	s;
+    int			row;
+
+    d = (short *) wipe_scr + i;
+    e = (const short *) wipe_scr_end + i;
+    s = (const short *) wipe_scr_start + i;
+    for (row=y0;row<y1;row++)
+	d[row*width] = e[row*width];
+    for (row=y1;row<height;row++)
+	d[row*width] = s[(row-y1)*width];
+}
+
 int
 wipe_doMelt
 ( int	width,
@@ -167,12 +192,7 @@ wipe_doMelt
   int	ticks )
 {
     int		i;
-    int		j;
     int		dy;
-    int		idx;
-    
-    short*	s;
-    short*	d;
     boolean	done = true;
 
     width/=2;
@@ -181,36 +201,27 @@ wipe_doMelt
     {
 	for (i=0;i<width;i++)
 	{
-	    if (y[i]<0)
+	    if (melt_y[i]<0)
 	    {
-		y[i]++; done = false;
+		melt_y[i]++; done = false;
 	    }
-	    else if (y[i] < height)
+	    else if (melt_y[i] < height)
 	    {
-		dy = (y[i] < 16) ? y[i]+1 : 8;
-		if (y[i]+dy >= height) dy = height - y[i];
-		s = &((short *)wipe_scr_end)[i*height+y[i]];
-		d = &((short *)wipe_scr)[y[i]*width+i];
-		idx = 0;
-		for (j=dy;j;j--)
-		{
-		    d[idx] = *(s++);
-		    idx += width;
-		}
-		y[i] += dy;
-		s = &((short *)wipe_scr_start)[i*height];
-		d = &((short *)wipe_scr)[y[i]*width+i];
-		idx = 0;
-		for (j=height-y[i];j;j--)
-		{
-		    d[idx] = *(s++);
-		    idx += width;
-		}
+		dy = (melt_y[i] < 16) ? melt_y[i]+1 : 8;
+		if (melt_y[i]+dy >= height) dy = height - melt_y[i];
+		if (melt_composed)
+		    melt_column(i, melt_y[i], melt_y[i]+dy, width, height);
+		melt_y[i] += dy;
 		done = false;
 	    }
 	}
     }
 
+    melt_min = height;
+    for (i=0;i<width;i++)
+	if (melt_y[i] < melt_min)
+	    melt_min = melt_y[i];
+
     return done;
 
 }
@@ -221,12 +232,73 @@ wipe_exitMelt
   int	height,
   int	ticks )
 {
-    Z_Free(y);
+    wipe_melting = false;
     Z_Free(wipe_scr_start);
-    Z_Free(wipe_scr_end);
+    if (wipe_scr_end)
+    {
+	Z_Free(wipe_scr_end);
+	wipe_scr_end = NULL;
+    }
     return 0;
 }
 
+//
+// wipe_MeltLine
+// Murmdoom: line "row" of the screen as the melt shows it. Above a
+// column's offset it is the end screen, below it the start screen slid
+// down by the offset.
+//
+const byte *wipe_MeltLine (int row)
+{
+    const short*	end;
+    int			i;
+    int			dy;
+
+    end = (const short *) (I_VideoBuffer + row*SCREENWIDTH);
+
+    // Every column has melted past this line, or the screen is composed.
+    if (row < melt_min || melt_composed)
+	return (const byte *) end;
+
+    for (i=0;i<SCREENWIDTH/2;i++)
+    {
+	dy = melt_y[i];
+	if (row < dy)
+	    melt_line[i] = end[i];
+	else
+	{
+	    if (dy < 0) dy = 0;
+	    melt_line[i] = ((const short *) (wipe_scr_start + (row-dy)*SCREENWIDTH))[i];
+	}
+    }
+
+    return (const byte *) melt_line;
+}
+
+//
+// wipe_ComposeMelt
+// Murmdoom: the menu is about to be drawn over the melt (D_Display). Keep
+// the end screen aside and compose the melt into I_VideoBuffer, so the
+// menu goes on top of what the melt shows and never into the end screen.
+// Until the melt ends, wipe_doMelt then moves the columns in I_VideoBuffer
+// as vanilla did, and what the menu drew stays where the columns do not
+// move, as it did in vanilla.
+//
+void wipe_ComposeMelt (void)
+{
+    int		row;
+
+    if (!wipe_melting || melt_composed)
+	return;
+
+    wipe_scr_end = Z_Malloc(SCREENWIDTH * SCREENHEIGHT, PU_STATIC, NULL);
+    memcpy(wipe_scr_end, I_VideoBuffer, SCREENWIDTH * SCREENHEIGHT);
+    // Lines above melt_min are the end screen already.
+    for (row=melt_min<0?0:melt_min;row<SCREENHEIGHT;row++)
+	memcpy(I_VideoBuffer + row*SCREENWIDTH, wipe_MeltLine(row), SCREENWIDTH);
+    melt_composed = true;
+}
+
 int
 wipe_StartScreen
 ( int	x,
@@ -246,9 +318,8 @@ wipe_EndScreen
   int	width,
   int	height )
 {
-    wipe_scr_end = Z_Malloc(SCREENWIDTH * SCREENHEIGHT, PU_STATIC, NULL);
-    I_ReadScreen(wipe_scr_end);
-    V_DrawBlock(x, y, width, height, wipe_scr_start); // restore start scr.
+    // Murmdoom: the end screen stays in I_VideoBuffer; the wipes read it
+    // from there rather than from a copy.
     return 0;
 }
 
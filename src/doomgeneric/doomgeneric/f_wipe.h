@@ -20,6 +20,8 @@
 #ifndef __F_WIPE_H__
 #define __F_WIPE_H__
 
+#include "doomtype.h"
+
 //
 //                       SCREEN WIPE PACKAGE
 //
@@ -60,4 +62,11 @@ wipe_ScreenWipe
   int		height,
   int		ticks );
 
+// Murmdoom: while a melt runs, I_FinishUpdate copies out
+// wipe_MeltLine(row) in place of each line of I_VideoBuffer.
+extern boolean wipe_melting;
+const byte *wipe_MeltLine (int row);
+// Murmdoom: call before drawing the menu over a melt.
+void wipe_ComposeMelt (void);
+
 #endif
@@ -72,6 +72,10 @@
 
 #include "g_game.h"
 
+#include "murmdoom_bench.h"
+#include "murmdoom_framehash.h"
+#include "murmdoom_snapshot.h"
+
 
 #define SAVEGAMESIZE	0x2c000
 
@@ -913,6 +917,9 @@ void G_Ticker (void)
 	    break; 
 	} 
     }
+
+    // Murmdoom: snapshots asked for on the console, between tics.
+    snapshot_ticker();
     
     // get commands, check consistancy,
     // and build new consistancy check
@@ -1581,25 +1588,21 @@ void G_LoadGame (char* name)
 #define VERSIONSIZE		16 
 
 
-void G_DoLoadGame (void) 
+// Murmdoom: unarchive a savegame held in memory, as G_DoLoadGame does
+// from the file; also restores the snapshots in murmdoom_snapshot.c.
+// Returns false, with the game untouched, if the header does not match.
+
+boolean G_UnArchiveGame (byte *buffer, int length)
 {
     int savedleveltime;
-	 
-    gameaction = ga_nothing; 
-	 
-    save_stream = fopen(savename, "rb");
-
-    if (save_stream == NULL)
-    {
-    	return;
-    }
 
+    save_stream = mem_fopen_read(buffer, length);
     savegame_error = false;
 
     if (!P_ReadSaveGameHeader())
     {
-        fclose(save_stream);
-        return;
+        mem_fclose(save_stream);
+        return false;
     }
 
     savedleveltime = leveltime;
@@ -1618,13 +1621,35 @@ void G_DoLoadGame (void)
     if (!P_ReadSaveGameEOF())
 	I_Error ("Bad savegame");
 
-    fclose(save_stream);
+    mem_fclose(save_stream);
     
     if (setsizeneeded)
     	R_ExecuteSetViewSize ();
     
     // draw the pattern into the back screen
     R_FillBackScreen (); 
+
+    return true;
+}
+
+void G_DoLoadGame (void) 
+{
+    byte *savebuffer;
+    int length;
+	 
+    gameaction = ga_nothing; 
+	 
+    // Murmdoom: read the whole file at once and unarchive it from memory.
+    // A missing or empty file leaves nothing to free.
+    length = M_ReadFile(savename, &savebuffer);
+
+    if (length == 0)
+    {
+    	return;
+    }
+
+    G_UnArchiveGame(savebuffer, length);
+    Z_Free(savebuffer);
 } 
  
 
@@ -1643,38 +1668,17 @@ G_SaveGame
     sendsave = true;
 }
 
-void G_DoSaveGame (void) 
-{ 
-    char *savegame_file;
-    char *temp_savegame_file;
-    char *recovery_savegame_file;
+// Murmdoom: archive the game into a memory stream, which the caller
+// closes; for G_DoSaveGame and the snapshots in murmdoom_snapshot.c.
 
-    recovery_savegame_file = NULL;
-    temp_savegame_file = P_TempSaveGameFile();
-    savegame_file = P_SaveGameFile(savegameslot);
-
-    // Open the savegame file for writing.  We write to a temporary file
-    // and then rename it at the end if it was successfully written.
-    // This prevents an existing savegame from being overwritten by 
-    // a corrupted one, or if a savegame buffer overrun occurs.
-    save_stream = fopen(temp_savegame_file, "wb");
-
-    if (save_stream == NULL)
-    {
-        // Failed to save the game, so we're going to have to abort. But
-        // to be nice, save to somewhere else before we call I_Error().
-        recovery_savegame_file = M_TempFile("recovery.dsg");
-        save_stream = fopen(recovery_savegame_file, "wb");
-        if (save_stream == NULL)
-        {
-            I_Error("Failed to open either '%s' or '%s' to write savegame.",
-                    temp_savegame_file, recovery_savegame_file);
-        }
-    }
+MEMFILE *G_ArchiveGame (char *description)
+{
+    MEMFILE *stream;
 
+    save_stream = mem_fopen_write();
     savegame_error = false;
 
-    P_WriteSaveGameHeader(savedescription);
+    P_WriteSaveGameHeader(description);
  
     P_ArchivePlayers (); 
     P_ArchiveWorld (); 
@@ -1682,25 +1686,64 @@ void G_DoSaveGame (void)
     P_ArchiveSpecials (); 
 	 
     P_WriteSaveGameEOF();
+
+    stream = save_stream;
+    save_stream = NULL;
+
+    return stream;
+}
+
+void G_DoSaveGame (void) 
+{ 
+    char *savegame_file;
+    char *temp_savegame_file;
+    char *recovery_savegame_file;
+    MEMFILE *stream;
+    void *savebuffer;
+    size_t length;
+
+    recovery_savegame_file = NULL;
+    temp_savegame_file = P_TempSaveGameFile();
+    savegame_file = P_SaveGameFile(savegameslot);
+
+    // Murmdoom: archive into memory, then write the file at once.
+    stream = G_ArchiveGame(savedescription);
 	 
     // Enforce the same savegame size limit as in Vanilla Doom, 
     // except if the vanilla_savegame_limit setting is turned off.
 
-    if (vanilla_savegame_limit && ftell(save_stream) > SAVEGAMESIZE)
+    if (vanilla_savegame_limit && mem_ftell(stream) > SAVEGAMESIZE)
     {
         I_Error ("Savegame buffer overrun");
     }
     
-    // Finish up, close the savegame file.
+    // Write the savegame file.  We write to a temporary file and then
+    // rename it at the end if it was successfully written.  This
+    // prevents an existing savegame from being overwritten by a
+    // corrupted one, or if a savegame buffer overrun occurs.
 
-    fclose(save_stream);
+    mem_get_buf(stream, &savebuffer, &length);
+
+    if (!M_WriteFile(temp_savegame_file, savebuffer, length))
+    {
+        // Failed to save the game, so we're going to have to abort. But
+        // to be nice, save to somewhere else before we call I_Error().
+        recovery_savegame_file = M_TempFile("recovery.dsg");
+        if (!M_WriteFile(recovery_savegame_file, savebuffer, length))
+        {
+            I_Error("Failed to write either '%s' or '%s' to save game.",
+                    temp_savegame_file, recovery_savegame_file);
+        }
+    }
+
+    mem_fclose(stream);
 
     if (recovery_savegame_file != NULL)
     {
         // We failed to save to the normal location, but we wrote a
         // recovery file to the temp directory. Now we can bomb out
         // with an error.
-        I_Error("Failed to open savegame file '%s' for writing.\n"
+        I_Error("Failed to write savegame file '%s'.\n"
                 "But your game has been saved to '%s' for recovery.",
                 temp_savegame_file, recovery_savegame_file);
     }
@@ -2248,6 +2291,12 @@ void G_DoPlayDemo (void)
 
     usergame = false; 
     demoplayback = true; 
+
+    if (timingdemo)
+    {
+        bench_demo_start();
+        framehash_demo_start(defdemoname);
+    }
 } 
 
 //
@@ -2289,11 +2338,24 @@ boolean G_CheckDemoStatus (void)
     { 
         float fps;
         int realtics;
+        char *nextdemo;
 
 	endtime = I_GetTime (); 
         realtics = endtime - starttime;
         fps = ((float) gametic * TICRATE) / realtics;
 
+        framehash_demo_done();
+
+        // Benchmark mode plays its demos back-to-back.
+        nextdemo = bench_demo_done();
+        if (nextdemo != NULL)
+        {
+            W_ReleaseLumpName(defdemoname);
+            demoplayback = false;
+            G_TimeDemo(nextdemo);
+            return true;
+        }
+
         // Prevent recursive calls
         timingdemo = false;
         demoplayback = false;
@@ -23,6 +23,7 @@
 #include "doomdef.h"
 #include "d_event.h"
 #include "d_ticcmd.h"
+#include "memio.h"
 
 
 //
@@ -45,6 +46,10 @@ void G_LoadGame (char* name);
 
 void G_DoLoadGame (void);
 
+// Murmdoom: the savegame body of G_DoSaveGame and G_DoLoadGame, in memory.
+MEMFILE *G_ArchiveGame (char *description);
+boolean G_UnArchiveGame (byte *buffer, int length);
+
 // Called by M_Responder.
 void G_SaveGame (int slot, char* description);
 
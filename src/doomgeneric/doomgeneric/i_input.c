@@ -40,6 +40,7 @@
 #include "z_zone.h"
 
 #include "doomgeneric.h"
+#include "murmdoom_input.h"
 
 int vanilla_keyboard_mapping = 1;
 
@@ -337,5 +338,7 @@ void I_GetEvent(void)
 
 void I_InitInput(void)
 {
+    // Murmdoom: input-to-ticcmd latency is measured from here on.
+    input_init();
 }
 
@@ -445,6 +445,8 @@ void I_BindSoundVariables(void)
     M_BindVariable("snd_musiccmd",      &snd_musiccmd);
     M_BindVariable("snd_samplerate",    &snd_samplerate);
     M_BindVariable("snd_cachesize",     &snd_cachesize);
+    M_BindVariable("murmdoom_opl3",     &murmdoom_opl3);
+    M_BindVariable("murmdoom_music_cache", &murmdoom_music_cache);
 
 #if defined(FEATURE_SOUND) && !defined(NO_USE_LIBSAMPLERATE)
     M_BindVariable("use_libsamplerate",   &use_libsamplerate);
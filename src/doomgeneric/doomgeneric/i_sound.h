@@ -258,6 +258,8 @@ void I_SetOPLDriverVer(opl_driver_ver_t ver);
 // For OPL module:
 
 extern int opl_io_port;
+extern int murmdoom_opl3;
+extern int murmdoom_music_cache;
 
 // For native music module:
 
@@ -20,6 +20,9 @@
 #include "doomtype.h"
 
 #include "doomgeneric.h"
+#include "murmdoom_present.h"
+#include "HDMI.h"
+#include "opl.h"
 
 #include <stdarg.h>
 
@@ -81,9 +84,34 @@ void I_Sleep(int ms)
 	DG_SleepMs(ms);
 }
 
+// Murmdoom: sleep until the next tic is due rather than polling every ms.
+// Music is rendered ahead into the cache first, if it is on.
+
+void I_SleepUntilNextTic(void)
+{
+    int now = I_GetTimeMS();
+    int next = ((now * TICRATE) / 1000 + 1) * 1000;
+    int ms = (next + TICRATE - 1) / TICRATE - now;
+
+    if (ms > 0)
+    {
+        OPL_Pico_RenderAhead(ms * 1000);
+        ms = (next + TICRATE - 1) / TICRATE - I_GetTimeMS();
+    }
+
+    if (ms > 0)
+        I_Sleep(ms);
+}
+
+// Murmdoom: count is in 70 Hz VGA refreshes; wait for the equivalent
+// number of real ones.
+
 void I_WaitVBL(int count)
 {
-    //I_Sleep((count * 1000) / 70);
+    struct video_mode_t mode = graphics_get_video_mode(0);
+    int hz = mode.freq ? mode.freq : 60;
+
+    present_wait_vblanks((count * hz + 69) / 70);
 }
 
 
@@ -32,6 +32,9 @@ int I_GetTimeMS (void);
 // Pause for a specified number of ms
 void I_Sleep(int ms);
 
+// Murmdoom: pause until I_GetTime() advances
+void I_SleepUntilNextTic(void);
+
 // Initialize timer
 void I_InitTimer(void);
 
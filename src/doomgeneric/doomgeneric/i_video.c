@@ -30,15 +30,22 @@ rcsid[] = "$Id: i_x.c,v 1.6 1997/02/03 22:45:10 b1 Exp $";
 #include "m_argv.h"
 #include "d_event.h"
 #include "d_main.h"
+#include "d_loop.h"
 #include "i_video.h"
 #include "i_system.h"
 #include "z_zone.h"
 #include "doomstat.h"
+#include "f_wipe.h"
+#include "m_bbox.h"
 
 #include "tables.h"
 #include "doomkeys.h"
 
 #include "doomgeneric.h"
+#include "murmdoom_prof.h"
+#include "murmdoom_console.h"
+#include "murmdoom_interp.h"
+#include "murmdoom_present.h"
 
 #include <stdbool.h>
 #include <stdlib.h>
@@ -203,6 +210,100 @@ void cmap_to_fb(uint8_t *out, uint8_t *in, int in_pixels)
     }
 }
 
+// Murmdoom: dirty lines. Everything that draws into I_VideoBuffer marks
+// what it touched through V_MarkRect (the view, which is drawn column by
+// column, is marked by D_Display), and I_FinishUpdate copies out only the
+// lines between the top and bottom of dirtybox. With vsync the framebuffer
+// written was last written two frames ago, so the lines marked in the frame
+// between are copied as well. A static status bar and border are then not
+// copied at all.
+
+// Framebuffers written one and two frames ago.
+static void *dirty_buffer[2];
+// Lines marked in the last frame; first > last if none.
+static int dirty_prev_first = 0, dirty_prev_last = -1;
+// The profiler overlay is drawn over the copied frame.
+static boolean dirty_overlay = false;
+// A melt is composed as it is copied and marks nothing; both framebuffers
+// are rewritten in full after it.
+static int dirty_wipe = 0;
+#ifndef CMAP256
+// Every pixel is converted through the palette.
+static boolean dirty_palette = true;
+#endif
+
+// "dirty" on the serial console
+static uint32_t dirty_frames;
+static uint64_t dirty_bytes_copied;
+static uint64_t dirty_bytes_skipped;
+
+static void dirty_command(int argc, char **argv)
+{
+    char line[96];
+    uint64_t total;
+
+    if (argc > 1 && !strcmp(argv[1], "reset"))
+    {
+        dirty_frames = 0;
+        dirty_bytes_copied = dirty_bytes_skipped = 0;
+        fputs("dirty: reset\n", stdout);
+        return;
+    }
+
+    total = dirty_bytes_copied + dirty_bytes_skipped;
+    snprintf(line, sizeof(line), "dirty: %lu frames, %lu KB copied and %lu KB skipped per frame (%lu%% skipped)\n",
+             (unsigned long) dirty_frames,
+             (unsigned long) (dirty_frames ? dirty_bytes_copied / dirty_frames / 1024 : 0),
+             (unsigned long) (dirty_frames ? dirty_bytes_skipped / dirty_frames / 1024 : 0),
+             (unsigned long) (total ? dirty_bytes_skipped * 100 / total : 0));
+    fputs(line, stdout);
+}
+
+// Lines first..last of the `lines` copied out that have to be written to
+// DG_ScreenBuffer this frame. Clears dirtybox.
+static void dirty_lines(int lines, boolean layout_changed, int *first, int *last)
+{
+    int marked_first, marked_last;
+    boolean full;
+
+    marked_first = dirtybox[BOXBOTTOM] < 0 ? 0 : dirtybox[BOXBOTTOM];
+    marked_last = dirtybox[BOXTOP] >= lines ? lines - 1 : dirtybox[BOXTOP];
+    M_ClearBox(dirtybox);
+
+    if (wipe_melting)
+        dirty_wipe = 2;
+    full = layout_changed || dirty_overlay || dirty_wipe > 0;
+    if (dirty_wipe > 0 && !wipe_melting)
+        dirty_wipe--;
+#ifndef CMAP256
+    full = full || dirty_palette;
+    dirty_palette = false;
+#endif
+
+    if (full || (DG_ScreenBuffer != dirty_buffer[0] && DG_ScreenBuffer != dirty_buffer[1]))
+    {
+        *first = 0;
+        *last = lines - 1;
+    }
+    else
+    {
+        *first = marked_first;
+        *last = marked_last;
+        if (DG_ScreenBuffer != dirty_buffer[0] && dirty_prev_first <= dirty_prev_last)
+        {
+            if (*first > *last || dirty_prev_first < *first)
+                *first = dirty_prev_first;
+            if (*last < dirty_prev_last || marked_first > marked_last)
+                *last = dirty_prev_last;
+        }
+    }
+
+    dirty_prev_first = marked_first;
+    dirty_prev_last = marked_last;
+    dirty_buffer[1] = dirty_buffer[0];
+    dirty_buffer[0] = DG_ScreenBuffer;
+}
+
 void I_InitGraphics (void)
 {
     int i, gfxmodeparm;
@@ -294,6 +395,9 @@ void I_InitGraphics (void)
 
 	screenvisible = true;
 
+    M_ClearBox(dirtybox);
+    murmdoom_console_register("dirty", "[reset] framebuffer bytes copied and skipped per frame", dirty_command);
+
     extern void I_InitInput(void);
     I_InitInput();
 }
@@ -305,16 +409,11 @@ void I_ShutdownGraphics (void)
 
 void I_StartFrame (void)
 {
-
+    murmdoom_console_poll();
 }
 
 void I_StartTic (void)
 {
-	// Process USB HID mouse events (keyboard events flow through DG_GetKey)
-#ifdef USB_HID_ENABLED
-	extern void usbhid_wrapper_mouse_tick(void);
-	usbhid_wrapper_mouse_tick();
-#endif
 	I_GetEvent();
 }
 
@@ -324,6 +423,8 @@ void I_UpdateNoBlit (void)
 
 // Track previous game state for detecting transitions
 static gamestate_t prev_gamestate = GS_LEVEL;
+// Margin fills left to do; one per framebuffer (see murmdoom_present.h).
+static int margin_fills = 0;
 
 // Fill a region of the output buffer with black (using palette color 0)
 static void fill_output_black(unsigned char *dest, int num_lines)
@@ -356,7 +457,13 @@ void I_FinishUpdate (void)
 {
     int y;
     int x_offset, y_offset, x_offset_end;
+    int lines, first, last, out_line_bytes;
+    boolean layout_changed;
     unsigned char *line_in, *line_out;
+    PROF_SCOPE(PROF_FINISH);
+
+    // Timedemos (singletics) never wait for a refresh.
+    present_begin_update(interp_uncapped() || (murmdoom_vsync && !singletics));
 
     /* Offsets in case FB is bigger than DOOM */
     /* 600 = s_Fb heigt, 200 screenheight */
@@ -375,6 +482,10 @@ void I_FinishUpdate (void)
     if (gamestate != GS_LEVEL) {
         // On transition from gameplay, fill the top and bottom margins with black
         if (prev_gamestate == GS_LEVEL) {
+            margin_fills = 2;
+        }
+        if (margin_fills > 0) {
+            margin_fills--;
             // Fill top 20 lines with black
             fill_output_black((unsigned char *)DG_ScreenBuffer, 20);
             // Fill bottom 20 lines with black (starting at line 220)
@@ -383,39 +494,59 @@ void I_FinishUpdate (void)
         
         // Offset output by 20 lines to center the content
         line_out += (20 * SCREENWIDTH * s_Fb.bits_per_pixel / 8);
-        y = 200;  // Only copy Doom's 200 rendered lines
+        lines = 200;  // Only copy Doom's 200 rendered lines
     } else {
-        y = SCREENHEIGHT;  // Copy all 240 lines during gameplay (includes status bar)
+        lines = SCREENHEIGHT;  // Copy all 240 lines during gameplay (includes status bar)
     }
+    layout_changed = gamestate != prev_gamestate;
     prev_gamestate = gamestate;
 
-    while (y--)
+    dirty_lines(lines, layout_changed, &first, &last);
+    out_line_bytes = (x_offset + SCREENWIDTH * fb_scaling * (s_Fb.bits_per_pixel/8) + x_offset_end) * fb_scaling;
+    dirty_frames++;
+    dirty_bytes_copied += (uint64_t) (first <= last ? last - first + 1 : 0) * out_line_bytes;
+    dirty_bytes_skipped += (uint64_t) (lines - (first <= last ? last - first + 1 : 0)) * out_line_bytes;
+
+    for (y = 0; y < lines; y++)
     {
         int i;
+        if (y < first || y > last)
+        {
+            line_out += out_line_bytes;
+            line_in += SCREENWIDTH;
+            continue;
+        }
+        // Murmdoom: a melt is composed here, one line at a time (f_wipe.c).
+        const unsigned char *src = wipe_melting
+            ? wipe_MeltLine((int)(line_in - I_VideoBuffer) / SCREENWIDTH)
+            : line_in;
         for (i = 0; i < fb_scaling; i++) {
             line_out += x_offset;
 #ifdef CMAP256
             if (fb_scaling == 1) {
-                memcpy(line_out, line_in, SCREENWIDTH); /* fb_width is bigger than Doom SCREENWIDTH... */
+                memcpy(line_out, src, SCREENWIDTH); /* fb_width is bigger than Doom SCREENWIDTH... */
             } else {
                 int j;
 
                 for (j = 0; j < SCREENWIDTH; j++) {
                     int k;
                     for (k = 0; k < fb_scaling; k++) {
-                        line_out[j * fb_scaling + k] = line_in[j];
+                        line_out[j * fb_scaling + k] = src[j];
                     }
                 }
             }
 #else
             //cmap_to_rgb565((void*)line_out, (void*)line_in, SCREENWIDTH);
-            cmap_to_fb((void*)line_out, (void*)line_in, SCREENWIDTH);
+            cmap_to_fb((void*)line_out, (void*)src, SCREENWIDTH);
 #endif
             line_out += (SCREENWIDTH * fb_scaling * (s_Fb.bits_per_pixel/8)) + x_offset_end;
         }
         line_in += SCREENWIDTH;
     }
 
+    dirty_overlay = prof_overlay_busy();
+    prof_overlay_draw();
+
 	DG_DrawFrame();
 }
 
@@ -466,6 +597,10 @@ void I_SetPalette (byte* palette)
 
     palette_changed = true;
 
+#else
+
+    dirty_palette = true;
+
 #endif  // CMAP256
 }
 
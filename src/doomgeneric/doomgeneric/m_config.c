@@ -818,6 +818,20 @@ static default_t extra_defaults_list[] =
 
     CONFIG_VARIABLE_INT_HEX(opl_io_port),
 
+    //!
+    // If non-zero, play music with 18 OPL3 voices instead of 9, rendering
+    // the second register bank on the second core (Murmdoom).
+    //
+
+    CONFIG_VARIABLE_INT(murmdoom_opl3),
+
+    //!
+    // Milliseconds of music to render ahead into PSRAM while the game loop
+    // is idle, played back decode-only; 0 synthesizes it live (Murmdoom).
+    //
+
+    CONFIG_VARIABLE_INT(murmdoom_music_cache),
+
     //!
     // @game doom heretic strife
     //
@@ -827,6 +841,20 @@ static default_t extra_defaults_list[] =
 
     CONFIG_VARIABLE_INT(show_endoom),
 
+    //!
+    // If non-zero, render interpolated frames between tics at the display
+    // refresh rate (Murmdoom).
+    //
+
+    CONFIG_VARIABLE_INT(murmdoom_uncapped),
+
+    //!
+    // If non-zero, frames are presented at the vertical blank so they
+    // never tear (Murmdoom).
+    //
+
+    CONFIG_VARIABLE_INT(murmdoom_vsync),
+
     //!
     // If non-zero, save screenshots in PNG format.
     //
@@ -2035,6 +2035,16 @@ void M_Drawer (void)
 }
 
 
+//
+// M_Drawing
+// Murmdoom: whether M_Drawer draws anything, a message or the menu.
+//
+boolean M_Drawing (void)
+{
+    return messageToPrint || menuactive;
+}
+
+
 //
 // M_ClearMenus
 //
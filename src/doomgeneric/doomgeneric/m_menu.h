@@ -43,6 +43,9 @@ void M_Ticker (void);
 // draws the menus directly into the screen buffer.
 void M_Drawer (void);
 
+// Murmdoom: whether M_Drawer draws anything.
+boolean M_Drawing (void);
+
 // Called by D_DoomMain,
 // loads the config file.
 void M_Init (void);
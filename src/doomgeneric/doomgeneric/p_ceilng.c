@@ -30,6 +30,8 @@
 // Data.
 #include "sounds.h"
 
+#include "murmdoom_thinkers.h"
+
 //
 // CEILINGS
 //
@@ -189,7 +191,7 @@ EV_DoCeiling
 	
 	// new door thinker
 	rtn = 1;
-	ceiling = Z_Malloc (sizeof(*ceiling), PU_LEVSPEC, 0);
+	ceiling = thinker_alloc(THINKER_CEILING);
 	P_AddThinker (&ceiling->thinker);
 	sec->specialdata = ceiling;
 	ceiling->thinker.function.acp1 = (actionf_p1)T_MoveCeiling;
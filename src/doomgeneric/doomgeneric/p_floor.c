@@ -30,6 +30,9 @@
 // Data.
 #include "sounds.h"
 
+#include "murmdoom_sight.h"
+#include "murmdoom_thinkers.h"
+
 
 //
 // FLOORS
@@ -37,9 +40,10 @@
 
 //
 // Move a plane (floor or ceiling) and check for crushing
+// Murmdoom: as vanilla's T_MovePlane; see the one below.
 //
-result_e
-T_MovePlane
+static result_e
+MovePlane
 ( sector_t*	sector,
   fixed_t	speed,
   fixed_t	dest,
@@ -195,6 +199,31 @@ T_MovePlane
     return ok;
 }
 
+result_e
+T_MovePlane
+( sector_t*	sector,
+  fixed_t	speed,
+  fixed_t	dest,
+  boolean	crush,
+  int		floorOrCeiling,
+  int		direction )
+{
+    fixed_t	floorheight = sector->floorheight;
+    fixed_t	ceilingheight = sector->ceilingheight;
+    result_e	res;
+
+    res = MovePlane(sector, speed, dest, crush, floorOrCeiling, direction);
+
+    // Murmdoom: sight checks through this sector may now go otherwise, if
+    // it ended up at another height. A plane put back because something
+    // was in the way, or one already at its destination, changes nothing.
+    if (sector->floorheight != floorheight
+     || sector->ceilingheight != ceilingheight)
+	sight_cache_invalidate();
+
+    return res;
+}
+
 
 //
 // MOVE A FLOOR TO IT'S DESTINATION (UP OR DOWN)
@@ -270,7 +299,7 @@ EV_DoFloor
 	
 	// new floor thinker
 	rtn = 1;
-	floor = Z_Malloc (sizeof(*floor), PU_LEVSPEC, 0);
+	floor = thinker_alloc(THINKER_FLOOR);
 	P_AddThinker (&floor->thinker);
 	sec->specialdata = floor;
 	floor->thinker.function.acp1 = (actionf_p1) T_MoveFloor;
@@ -473,7 +502,7 @@ EV_BuildStairs
 	
 	// new floor thinker
 	rtn = 1;
-	floor = Z_Malloc (sizeof(*floor), PU_LEVSPEC, 0);
+	floor = thinker_alloc(THINKER_FLOOR);
 	P_AddThinker (&floor->thinker);
 	sec->specialdata = floor;
 	floor->thinker.function.acp1 = (actionf_p1) T_MoveFloor;
@@ -526,7 +555,7 @@ EV_BuildStairs
 					
 		sec = tsec;
 		secnum = newsecnum;
-		floor = Z_Malloc (sizeof(*floor), PU_LEVSPEC, 0);
+		floor = thinker_alloc(THINKER_FLOOR);
 
 		P_AddThinker (&floor->thinker);
 
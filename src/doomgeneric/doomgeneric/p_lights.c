@@ -29,6 +29,8 @@
 // State.
 #include "r_state.h"
 
+#include "murmdoom_thinkers.h"
+
 //
 // FIRELIGHT FLICKER
 //
@@ -66,7 +68,7 @@ void P_SpawnFireFlicker (sector_t*	sector)
     // Nothing special about it during gameplay.
     sector->special = 0; 
 	
-    flick = Z_Malloc ( sizeof(*flick), PU_LEVSPEC, 0);
+    flick = thinker_alloc(THINKER_FLICKER);
 
     P_AddThinker (&flick->thinker);
 
@@ -121,7 +123,7 @@ void P_SpawnLightFlash (sector_t*	sector)
     // nothing special about it during gameplay
     sector->special = 0;	
 	
-    flash = Z_Malloc ( sizeof(*flash), PU_LEVSPEC, 0);
+    flash = thinker_alloc(THINKER_FLASH);
 
     P_AddThinker (&flash->thinker);
 
@@ -178,7 +180,7 @@ P_SpawnStrobeFlash
 {
     strobe_t*	flash;
 	
-    flash = Z_Malloc ( sizeof(*flash), PU_LEVSPEC, 0);
+    flash = thinker_alloc(THINKER_STROBE);
 
     P_AddThinker (&flash->thinker);
 
@@ -335,7 +337,7 @@ void P_SpawnGlowingLight(sector_t*	sector)
 {
     glow_t*	g;
 	
-    g = Z_Malloc( sizeof(*g), PU_LEVSPEC, 0);
+    g = thinker_alloc(THINKER_GLOW);
 
     P_AddThinker(&g->thinker);
 
@@ -39,6 +39,9 @@
 // Data.
 #include "sounds.h"
 
+#include "murmdoom_interp.h"
+#include "murmdoom_sight.h"
+
 // Spechit overrun magic value.
 //
 // This is the value used by PrBoom-plus.  I think the value below is 
@@ -188,6 +191,9 @@ P_TeleportMove
     thing->y = y;
 
     P_SetThingPosition (thing);
+
+    // Don't draw the teleport as a slide across the map.
+    interp_reset_mobj(thing);
 	
     return true;
 }
@@ -449,10 +455,18 @@ P_CheckPosition
     yl = (tmbbox[BOXBOTTOM] - bmaporgy - MAXRADIUS)>>MAPBLOCKSHIFT;
     yh = (tmbbox[BOXTOP] - bmaporgy + MAXRADIUS)>>MAPBLOCKSHIFT;
 
+    // Murmdoom: a sight check made from here (a missile waking up the
+    // monster it hits) marks lines that the line checks below then skip,
+    // so it must walk the BSP rather than come from the cache.
+    sight_cache_hold();
     for (bx=xl ; bx<=xh ; bx++)
 	for (by=yl ; by<=yh ; by++)
 	    if (!P_BlockThingsIterator(bx,by,PIT_CheckThing))
+	    {
+		sight_cache_release();
 		return false;
+	    }
+    sight_cache_release();
     
     // check lines
     xl = (tmbbox[BOXLEFT] - bmaporgx)>>MAPBLOCKSHIFT;
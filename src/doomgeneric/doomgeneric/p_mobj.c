@@ -33,6 +33,8 @@
 
 #include "doomstat.h"
 
+#include "murmdoom_thinkers.h"
+
 
 void G_PlayerReborn (int player);
 void P_SpawnMapThing (mapthing_t*	mthing);
@@ -513,7 +515,8 @@ P_SpawnMobj
     state_t*	st;
     mobjinfo_t*	info;
 	
-    mobj = Z_Malloc (sizeof(*mobj), PU_LEVEL, NULL);
+    // Murmdoom: from the mobj pool, next to the mobjs spawned before it.
+    mobj = thinker_alloc(THINKER_MOBJ);
     memset (mobj, 0, sizeof (*mobj));
     info = &mobjinfo[type];
 	
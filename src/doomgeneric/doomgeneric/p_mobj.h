@@ -276,6 +276,14 @@ typedef struct mobj_s
 
     // Thing being chased/attacked for tracers.
     struct mobj_s*	tracer;	
+
+    // Murmdoom: position at the start of the last tic, for uncapped
+    // rendering (murmdoom_interp.h). Valid while interp_tic matches.
+    fixed_t		oldx;
+    fixed_t		oldy;
+    fixed_t		oldz;
+    angle_t		oldangle;
+    int			interp_tic;
     
 } mobj_t;
 
@@ -34,6 +34,8 @@
 // Data.
 #include "sounds.h"
 
+#include "murmdoom_thinkers.h"
+
 
 plat_t*		activeplats[MAXPLATS];
 
@@ -160,7 +162,7 @@ EV_DoPlat
 	
 	// Find lowest & highest floors around sector
 	rtn = 1;
-	plat = Z_Malloc( sizeof(*plat), PU_LEVSPEC, 0);
+	plat = thinker_alloc(THINKER_PLAT);
 	P_AddThinker(&plat->thinker);
 		
 	plat->type = type;
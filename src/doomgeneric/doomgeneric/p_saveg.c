@@ -33,10 +33,13 @@
 #include "m_misc.h"
 #include "r_state.h"
 
+#include "murmdoom_sight.h"
+#include "murmdoom_thinkers.h"
+
 #define SAVEGAME_EOF 0x1d
 #define VERSIONSIZE 16 
 
-FILE *save_stream;
+MEMFILE *save_stream;
 int savegamelength;
 boolean savegame_error;
 
@@ -82,7 +85,7 @@ static byte saveg_read8(void)
 {
     byte result;
 
-    if (fread(&result, 1, 1, save_stream) < 1)
+    if (mem_fread(&result, 1, 1, save_stream) < 1)
     {
         if (!savegame_error)
         {
@@ -98,7 +101,7 @@ static byte saveg_read8(void)
 
 static void saveg_write8(byte value)
 {
-    if (fwrite(&value, 1, 1, save_stream) < 1)
+    if (mem_fwrite(&value, 1, 1, save_stream) < 1)
     {
         if (!savegame_error)
         {
@@ -153,7 +156,7 @@ static void saveg_read_pad(void)
     int padding;
     int i;
 
-    pos = ftell(save_stream);
+    pos = mem_ftell(save_stream);
 
     padding = (4 - (pos & 3)) & 3;
 
@@ -169,7 +172,7 @@ static void saveg_write_pad(void)
     int padding;
     int i;
 
-    pos = ftell(save_stream);
+    pos = mem_ftell(save_stream);
 
     padding = (4 - (pos & 3)) & 3;
 
@@ -1537,6 +1540,9 @@ void P_UnArchiveWorld (void)
     line_t*		li;
     side_t*		si;
     
+    // Murmdoom: the sectors may now have other heights.
+    sight_cache_invalidate();
+
     // do sectors
     for (i=0, sec = sectors ; i<numsectors ; i++,sec++)
     {
@@ -1631,9 +1637,13 @@ void P_UnArchiveThinkers (void)
 	next = currentthinker->next;
 	
 	if (currentthinker->function.acp1 == (actionf_p1)P_MobjThinker)
+	{
 	    P_RemoveMobj ((mobj_t *)currentthinker);
+	    // Murmdoom: back to the pool, not left until the level ends.
+	    thinker_free (currentthinker);
+	}
 	else
-	    Z_Free (currentthinker);
+	    thinker_free (currentthinker);
 
 	currentthinker = next;
     }
@@ -1650,7 +1660,7 @@ void P_UnArchiveThinkers (void)
 			
 	  case tc_mobj:
 	    saveg_read_pad();
-	    mobj = Z_Malloc (sizeof(*mobj), PU_LEVEL, NULL);
+	    mobj = thinker_alloc(THINKER_MOBJ);
             saveg_read_mobj_t(mobj);
 
 	    mobj->target = NULL;
@@ -1814,7 +1824,7 @@ void P_UnArchiveSpecials (void)
 			
 	  case tc_ceiling:
 	    saveg_read_pad();
-	    ceiling = Z_Malloc (sizeof(*ceiling), PU_LEVEL, NULL);
+	    ceiling = thinker_alloc(THINKER_CEILING);
             saveg_read_ceiling_t(ceiling);
 	    ceiling->sector->specialdata = ceiling;
 
@@ -1827,7 +1837,7 @@ void P_UnArchiveSpecials (void)
 				
 	  case tc_door:
 	    saveg_read_pad();
-	    door = Z_Malloc (sizeof(*door), PU_LEVEL, NULL);
+	    door = thinker_alloc(THINKER_DOOR);
             saveg_read_vldoor_t(door);
 	    door->sector->specialdata = door;
 	    door->thinker.function.acp1 = (actionf_p1)T_VerticalDoor;
@@ -1836,7 +1846,7 @@ void P_UnArchiveSpecials (void)
 				
 	  case tc_floor:
 	    saveg_read_pad();
-	    floor = Z_Malloc (sizeof(*floor), PU_LEVEL, NULL);
+	    floor = thinker_alloc(THINKER_FLOOR);
             saveg_read_floormove_t(floor);
 	    floor->sector->specialdata = floor;
 	    floor->thinker.function.acp1 = (actionf_p1)T_MoveFloor;
@@ -1845,7 +1855,7 @@ void P_UnArchiveSpecials (void)
 				
 	  case tc_plat:
 	    saveg_read_pad();
-	    plat = Z_Malloc (sizeof(*plat), PU_LEVEL, NULL);
+	    plat = thinker_alloc(THINKER_PLAT);
             saveg_read_plat_t(plat);
 	    plat->sector->specialdata = plat;
 
@@ -1858,7 +1868,7 @@ void P_UnArchiveSpecials (void)
 				
 	  case tc_flash:
 	    saveg_read_pad();
-	    flash = Z_Malloc (sizeof(*flash), PU_LEVEL, NULL);
+	    flash = thinker_alloc(THINKER_FLASH);
             saveg_read_lightflash_t(flash);
 	    flash->thinker.function.acp1 = (actionf_p1)T_LightFlash;
 	    P_AddThinker (&flash->thinker);
@@ -1866,7 +1876,7 @@ void P_UnArchiveSpecials (void)
 				
 	  case tc_strobe:
 	    saveg_read_pad();
-	    strobe = Z_Malloc (sizeof(*strobe), PU_LEVEL, NULL);
+	    strobe = thinker_alloc(THINKER_STROBE);
             saveg_read_strobe_t(strobe);
 	    strobe->thinker.function.acp1 = (actionf_p1)T_StrobeFlash;
 	    P_AddThinker (&strobe->thinker);
@@ -1874,7 +1884,7 @@ void P_UnArchiveSpecials (void)
 				
 	  case tc_glow:
 	    saveg_read_pad();
-	    glow = Z_Malloc (sizeof(*glow), PU_LEVEL, NULL);
+	    glow = thinker_alloc(THINKER_GLOW);
             saveg_read_glow_t(glow);
 	    glow->thinker.function.acp1 = (actionf_p1)T_Glow;
 	    P_AddThinker (&glow->thinker);
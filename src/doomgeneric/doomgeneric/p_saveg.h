@@ -22,6 +22,8 @@
 
 #include <stdio.h>
 
+#include "memio.h"
+
 // maximum size of a savegame description
 
 #define SAVESTRINGSIZE 24
@@ -55,7 +57,10 @@ void P_UnArchiveThinkers (void);
 void P_ArchiveSpecials (void);
 void P_UnArchiveSpecials (void);
 
-extern FILE *save_stream;
+// Murmdoom: the savegame is serialized in memory (the zone, in PSRAM) and
+// read or written in one go by G_DoLoadGame and G_DoSaveGame, rather than a
+// FatFs call per byte.
+extern MEMFILE *save_stream;
 extern boolean savegame_error;
 
 
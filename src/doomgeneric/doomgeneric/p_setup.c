@@ -40,6 +40,10 @@
 
 #include "doomstat.h"
 
+#include "murmdoom_levelload.h"
+#include "murmdoom_sight.h"
+#include "murmdoom_thinkers.h"
+
 
 void	P_SpawnMapThing (mapthing_t*	mthing);
 
@@ -506,12 +510,24 @@ void P_LoadBlockMap (int lump)
     int i;
     int count;
     int lumplen;
+    short *sramblockmap;
 
     lumplen = W_LumpLength(lump);
     count = lumplen / 2;
 	
+    // Murmdoom: copy from the lump cache if the lump was read ahead during
+    // the intermission, and give it back to the cache straight away. If it
+    // was not, read it as before, so the zone never holds it twice.
     blockmaplump = Z_Malloc(lumplen, PU_LEVEL, NULL);
-    W_ReadLump(lump, blockmaplump);
+    if (lumpinfo[lump].cache)
+    {
+        memcpy(blockmaplump, W_CacheLumpNum(lump, PU_STATIC), lumplen);
+        W_ReleaseLumpNum(lump);
+    }
+    else
+    {
+        W_ReadLump(lump, blockmaplump);
+    }
     blockmap = blockmaplump + 4;
 
     // Swap all short integers to native byte ordering.
@@ -527,6 +543,18 @@ void P_LoadBlockMap (int lump)
     bmaporgy = blockmaplump[1]<<FRACBITS;
     bmapwidth = blockmaplump[2];
     bmapheight = blockmaplump[3];
+
+    // Murmdoom: keep the blockmap and the mobj chains in SRAM if they fit
+    // (murmdoom_sight.h), and give the zone copy back.
+    sramblockmap = sight_blockmap_sram(blockmaplump, count, bmapwidth * bmapheight,
+                                       (void ***) &blocklinks);
+    if (sramblockmap)
+    {
+        Z_Free(blockmaplump);
+        blockmaplump = sramblockmap;
+        blockmap = blockmaplump + 4;
+        return;
+    }
 	
     // Clear out mobj chains
 
@@ -767,6 +795,10 @@ P_SetupLevel
     S_Start ();			
 
     Z_FreeTags (PU_LEVEL, PU_PURGELEVEL-1);
+    // Murmdoom: no sight check of the last level holds for this one, and
+    // the thinker pools went with it.
+    sight_cache_invalidate();
+    thinkers_reset();
 
     // UNUSED W_Profile ();
     P_InitThinkers ();
@@ -789,26 +821,40 @@ P_SetupLevel
     }
 
     lumpnum = W_GetNumForName (lumpname);
+
+    // Murmdoom: time each part; ends any read-ahead from the intermission.
+    levelload_begin (lumpname);
 	
     leveltime = 0;
 	
     // note: most of this ordering is important	
     P_LoadBlockMap (lumpnum+ML_BLOCKMAP);
+    levelload_mark (LL_BLOCKMAP);
     P_LoadVertexes (lumpnum+ML_VERTEXES);
+    levelload_mark (LL_VERTEXES);
     P_LoadSectors (lumpnum+ML_SECTORS);
+    levelload_mark (LL_SECTORS);
     P_LoadSideDefs (lumpnum+ML_SIDEDEFS);
+    levelload_mark (LL_SIDEDEFS);
 
     P_LoadLineDefs (lumpnum+ML_LINEDEFS);
+    levelload_mark (LL_LINEDEFS);
     P_LoadSubsectors (lumpnum+ML_SSECTORS);
+    levelload_mark (LL_SSECTORS);
     P_LoadNodes (lumpnum+ML_NODES);
+    levelload_mark (LL_NODES);
     P_LoadSegs (lumpnum+ML_SEGS);
+    levelload_mark (LL_SEGS);
 
     P_GroupLines ();
+    levelload_mark (LL_GROUPLINES);
     P_LoadReject (lumpnum+ML_REJECT);
+    levelload_mark (LL_REJECT);
 
     bodyqueslot = 0;
     deathmatch_p = deathmatchstarts;
     P_LoadThings (lumpnum+ML_THINGS);
+    levelload_mark (LL_THINGS);
     
     // if deathmatch, randomly spawn the active players
     if (deathmatch)
@@ -827,6 +873,7 @@ P_SetupLevel
 	
     // set up world state
     P_SpawnSpecials ();
+    levelload_mark (LL_SPECIALS);
 	
     // build subsector connect matrix
     //	UNUSED P_ConnectSubsectors ();
@@ -835,6 +882,8 @@ P_SetupLevel
     if (precache)
 	R_PrecacheLevel ();
 
+    levelload_end ();
+
     //printf ("free memory: 0x%x\n", Z_FreeMemory());
 
 }
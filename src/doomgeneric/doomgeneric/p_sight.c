@@ -26,6 +26,8 @@
 // State.
 #include "r_state.h"
 
+#include "murmdoom_sight.h"
+
 //
 // P_CheckSight
 //
@@ -307,6 +309,8 @@ P_CheckSight
     int		pnum;
     int		bytenum;
     int		bitnum;
+    int		cached;
+    boolean	visible;
     
     // First check for trivial rejection.
 
@@ -330,6 +334,12 @@ P_CheckSight
     // Now look from eyes of t1 to any part of t2.
     sightcounts[1]++;
 
+    // Murmdoom: the same check since the last sector moved has the same
+    // answer (murmdoom_sight.h).
+    cached = sight_cache_lookup(t1, t2);
+    if (cached >= 0)
+	return cached;
+
     validcount++;
 	
     sightzstart = t1->z + t1->height - (t1->height>>2);
@@ -344,7 +354,9 @@ P_CheckSight
     strace.dy = t2->y - t1->y;
 
     // the head node is the last node output
-    return P_CrossBSPNode (numnodes-1);	
+    visible = P_CrossBSPNode (numnodes-1);
+    sight_cache_store(visible);
+    return visible;
 }
 
 
@@ -23,6 +23,10 @@
 
 #include "doomstat.h"
 
+#include "murmdoom_interp.h"
+#include "murmdoom_prof.h"
+#include "murmdoom_thinkers.h"
+
 
 int	leveltime;
 
@@ -32,6 +36,8 @@ int	leveltime;
 // so they can be operated on uniformly.
 // The actual structures will vary in size,
 // but the first element must be thinker_t.
+// Murmdoom: they come from thinker_alloc, one pool per kind
+// (murmdoom_thinkers.h).
 //
 
 
@@ -103,7 +109,7 @@ void P_RunThinkers (void)
 	    // time to remove it
 	    currentthinker->next->prev = currentthinker->prev;
 	    currentthinker->prev->next = currentthinker->next;
-	    Z_Free (currentthinker);
+	    thinker_free (currentthinker);
 	}
 	else
 	{
@@ -123,6 +129,7 @@ void P_RunThinkers (void)
 void P_Ticker (void)
 {
     int		i;
+    PROF_SCOPE(PROF_TICKER);
     
     // run the tic
     if (paused)
@@ -136,7 +143,8 @@ void P_Ticker (void)
     {
 	return;
     }
-    
+
+    interp_store_tic();
 		
     for (i=0 ; i<MAXPLAYERS ; i++)
 	if (playeringame[i])
@@ -32,6 +32,7 @@
 // State.
 #include "doomstat.h"
 #include "r_state.h"
+#include "murmdoom_hot.h"
 
 //#include "r_local.h"
 
@@ -94,7 +95,7 @@ cliprange_t	solidsegs[MAXSEGS];
 //  that entirely block the view.
 // 
 void
-R_ClipSolidWallSegment
+__murmdoom_hot(R_ClipSolidWallSegment)
 ( int			first,
   int			last )
 {
@@ -187,7 +188,7 @@ R_ClipSolidWallSegment
 //  e.g. LineDefs with upper and lower texture.
 //
 void
-R_ClipPassWallSegment
+__murmdoom_hot(R_ClipPassWallSegment)
 ( int	first,
   int	last )
 {
@@ -249,7 +250,7 @@ void R_ClearClipSegs (void)
 // Clips the given segment
 // and adds any visible pieces to the line list.
 //
-void R_AddLine (seg_t*	line)
+void __murmdoom_hot(R_AddLine) (seg_t*	line)
 {
     int			x1;
     int			x2;
@@ -371,7 +372,7 @@ int	checkcoord[12][4] =
 };
 
 
-boolean R_CheckBBox (fixed_t*	bspcoord)
+boolean __murmdoom_hot(R_CheckBBox) (fixed_t*	bspcoord)
 {
     int			boxx;
     int			boxy;
@@ -487,7 +488,7 @@ boolean R_CheckBBox (fixed_t*	bspcoord)
 // Add sprites of things in sector.
 // Draw one or more line segments.
 //
-void R_Subsector (int num)
+void __murmdoom_hot(R_Subsector) (int num)
 {
     int			count;
     seg_t*		line;
@@ -542,7 +543,7 @@ void R_Subsector (int num)
 // Renders all subsectors below a given node,
 //  traversing subtree recursively.
 // Just call with BSP root.
-void R_RenderBSPNode (int bspnum)
+void __murmdoom_hot(R_RenderBSPNode) (int bspnum)
 {
     node_t*	bsp;
     int		side;
@@ -37,6 +37,7 @@
 
 
 #include "r_data.h"
+#include "murmdoom_levelload.h"
 
 //
 // Graphics.
@@ -789,6 +790,20 @@ int	R_TextureNumForName (char* name)
 
 
 
+//
+// R_TexturePatchLump
+// Murmdoom: lets the level loader walk a texture's patches without
+// texture_t, which is private to this file.
+//
+int R_TexturePatchLump (int tex, int patch)
+{
+    if (patch >= textures[tex]->patchcount)
+	return -1;
+    return textures[tex]->patches[patch].patch;
+}
+
+
+
 //
 // R_PrecacheLevel
 // Preloads all relevant graphics for the level.
@@ -838,6 +853,7 @@ void R_PrecacheLevel (void)
     }
 
     Z_Free(flatpresent);
+    levelload_mark (LL_FLATS);
     
     // Precache textures.
     texturepresent = Z_Malloc(numtextures, PU_STATIC, NULL);
@@ -875,6 +891,7 @@ void R_PrecacheLevel (void)
     }
 
     Z_Free(texturepresent);
+    levelload_mark (LL_TEXTURES);
     
     // Precache sprites.
     spritepresent = Z_Malloc(numsprites, PU_STATIC, NULL);
@@ -905,6 +922,7 @@ void R_PrecacheLevel (void)
     }
 
     Z_Free(spritepresent);
+    levelload_mark (LL_SPRITES);
 }
 
 
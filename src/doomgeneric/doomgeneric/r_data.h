@@ -48,4 +48,10 @@ int R_FlatNumForName (char* name);
 int R_TextureNumForName (char *name);
 int R_CheckTextureNumForName (char *name);
 
+// Murmdoom: for reading a level's graphics ahead (murmdoom_levelload.c).
+extern int numflats;
+extern int numtextures;
+// WAD lump of patch number "patch" of texture "tex", or -1 past the last.
+int R_TexturePatchLump (int tex, int patch);
+
 #endif
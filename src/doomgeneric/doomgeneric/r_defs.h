@@ -127,6 +127,13 @@ typedef	struct
 
     int			linecount;
     struct line_s**	lines;	// [linecount] size
+
+    // Murmdoom: plane heights at the start of the last tic, and the real
+    // ones while an interpolated frame is drawn (murmdoom_interp.h).
+    fixed_t	oldfloorheight;
+    fixed_t	oldceilingheight;
+    fixed_t	tickfloorheight;
+    fixed_t	tickceilingheight;
     
 } sector_t;
 
@@ -35,6 +35,7 @@
 
 // State.
 #include "doomstat.h"
+#include "murmdoom_hot.h"
 
 
 // ?
@@ -99,7 +100,7 @@ int			dccount;
 // Thus a special case loop for very fast rendering can
 //  be used. It has also been used with Wolfenstein 3D.
 // 
-void R_DrawColumn (void) 
+void __murmdoom_hot(R_DrawColumn) (void) 
 { 
     int			count; 
     byte*		dest; 
@@ -205,7 +206,7 @@ void R_DrawColumn (void)
 #endif
 
 
-void R_DrawColumnLow (void) 
+void __murmdoom_hot(R_DrawColumnLow) (void) 
 { 
     int			count; 
     byte*		dest; 
@@ -280,7 +281,7 @@ int	fuzzpos = 0;
 //  could create the SHADOW effect,
 //  i.e. spectres and invisible players.
 //
-void R_DrawFuzzColumn (void) 
+void __murmdoom_hot(R_DrawFuzzColumn) (void) 
 { 
     int			count; 
     byte*		dest; 
@@ -421,7 +422,7 @@ void R_DrawFuzzColumnLow (void)
 byte*	dc_translation;
 byte*	translationtables;
 
-void R_DrawTranslatedColumn (void) 
+void __murmdoom_hot(R_DrawTranslatedColumn) (void) 
 { 
     int			count; 
     byte*		dest; 
@@ -587,7 +588,7 @@ int			dscount;
 
 //
 // Draws the actual span.
-void R_DrawSpan (void) 
+void __murmdoom_hot(R_DrawSpan) (void) 
 { 
     unsigned int position, step;
     byte *dest;
@@ -716,7 +717,7 @@ void R_DrawSpan (void)
 //
 // Again..
 //
-void R_DrawSpanLow (void)
+void __murmdoom_hot(R_DrawSpanLow) (void)
 {
     unsigned int position, step;
     unsigned int xtemp, ytemp;
@@ -929,6 +930,10 @@ R_VideoErase
     if (background_buffer != NULL)
     {
         memcpy(I_VideoBuffer + ofs, background_buffer + ofs, count); 
+
+        // Murmdoom: the lines touched, for I_FinishUpdate.
+        V_MarkRect(0, ofs / SCREENWIDTH, SCREENWIDTH,
+                   (ofs + count - 1) / SCREENWIDTH - ofs / SCREENWIDTH + 1);
     }
 } 
 
@@ -34,6 +34,8 @@
 
 #include "r_local.h"
 #include "r_sky.h"
+#include "murmdoom_interp.h"
+#include "murmdoom_prof.h"
 
 
 
@@ -823,14 +825,17 @@ R_PointInSubsector
 void R_SetupFrame (player_t* player)
 {		
     int		i;
+    fixed_t	mo_z;
     
     viewplayer = player;
-    viewx = player->mo->x;
-    viewy = player->mo->y;
-    viewangle = player->mo->angle + viewangleoffset;
+    interp_mobj(player->mo, &viewx, &viewy, &mo_z, &viewangle);
+    viewangle += viewangleoffset;
     extralight = player->extralight;
 
-    viewz = player->viewz;
+    if (interp_frac != FRACUNIT && player->mo->interp_tic == interp_valid_tic)
+	viewz = interp_fixed(player->oldviewz, player->viewz);
+    else
+	viewz = player->viewz;
     
     viewsin = finesine[viewangle>>ANGLETOFINESHIFT];
     viewcos = finecosine[viewangle>>ANGLETOFINESHIFT];
@@ -862,6 +867,7 @@ void R_SetupFrame (player_t* player)
 //
 void R_RenderPlayerView (player_t* player)
 {	
+    interp_begin_frame ();
     R_SetupFrame (player);
 
     // Clear buffers.
@@ -874,17 +880,28 @@ void R_RenderPlayerView (player_t* player)
     NetUpdate ();
 
     // The head node is the last node output.
-    R_RenderBSPNode (numnodes-1);
+    {
+        PROF_SCOPE(PROF_BSP);
+        R_RenderBSPNode (numnodes-1);
+    }
     
     // Check for new console commands.
     NetUpdate ();
     
-    R_DrawPlanes ();
+    {
+        PROF_SCOPE(PROF_PLANES);
+        R_DrawPlanes ();
+    }
     
     // Check for new console commands.
     NetUpdate ();
     
-    R_DrawMasked ();
+    {
+        PROF_SCOPE(PROF_MASKED);
+        R_DrawMasked ();
+    }
+
+    interp_end_frame ();
 
     // Check for new console commands.
     NetUpdate ();				
@@ -31,6 +31,7 @@
 
 #include "r_local.h"
 #include "r_sky.h"
+#include "murmdoom_hot.h"
 
 
 
@@ -111,7 +112,7 @@ void R_InitPlanes (void)
 // BASIC PRIMITIVE
 //
 void
-R_MapPlane
+__murmdoom_hot(R_MapPlane)
 ( int		y,
   int		x1,
   int		x2 )
@@ -321,7 +322,7 @@ R_CheckPlane
 // R_MakeSpans
 //
 void
-R_MakeSpans
+__murmdoom_hot(R_MakeSpans)
 ( int		x,
   int		t1,
   int		b1,
@@ -31,6 +31,8 @@
 
 #include "r_local.h"
 #include "r_sky.h"
+#include "murmdoom_hot.h"
+#include "murmdoom_prof.h"
 
 
 // OPTIMIZE: closed two sided lines as single sided
@@ -196,7 +198,7 @@ R_RenderMaskedSegRange
 #define HEIGHTBITS		12
 #define HEIGHTUNIT		(1<<HEIGHTBITS)
 
-void R_RenderSegLoop (void)
+void __murmdoom_hot(R_RenderSegLoop) (void)
 {
     angle_t		angle;
     unsigned		index;
@@ -369,7 +371,7 @@ void R_RenderSegLoop (void)
 //  between start and stop pixels (inclusive).
 //
 void
-R_StoreWallRange
+__murmdoom_hot(R_StoreWallRange)
 ( int	start,
   int	stop )
 {
@@ -382,6 +384,8 @@ R_StoreWallRange
     // don't overflow and crash
     if (ds_p == &drawsegs[MAXDRAWSEGS])
 	return;		
+
+    PROF_SCOPE(PROF_SEGS);
 		
 #ifdef RANGECHECK
     if (start >=viewwidth || start > stop)
@@ -19,6 +19,8 @@
 
 #include <stdio.h>
 #include <ctype.h>
+#include <limits.h>
+#include <string.h>
 
 #include "deh_main.h"
 #include "doomdef.h"
@@ -54,6 +56,113 @@ void STlib_init(void)
 }
 
 
+//
+// Murmdoom: STlib_drawNum leaves an unchanged number alone, so the status
+// bar rows are neither redrawn nor copied out (see I_FinishUpdate). Vanilla
+// redrew every number every frame, which also put back what other widgets
+// had drawn over it: the small ammo digits reach two rows into the number
+// below. So every widget draw is noted, and a number that is not changing
+// is still redrawn when vanilla's redraw would show something else:
+//  - something updated before it (in this frame) drew over it, or
+//  - a number updated after it changed and left pixels over it outside
+//    the area it clears, or
+//  - an icon drew over it.
+// A number drawn again unchanged writes the same pixels as before, so it
+// only makes the numbers after it that it overlaps draw again too, in the
+// same frame: a status bar that stops changing settles in a frame.
+//
+#define ST_NOTED	16
+
+typedef struct
+{
+    int			box[4];		// x0, y0, x1, y1
+    int			cleared[4];	// what a number clears first
+    int			turn;		// -1 for icons
+    boolean		same;		// an unchanged number, drawn again
+} st_noted_t;
+
+static st_noted_t	st_noted[ST_NOTED];
+static unsigned int	st_seq;
+static int		st_turn;
+
+void STlib_startFrame(void)
+{
+    st_turn = 0;
+}
+
+static void STlib_emptyBox(int *box)
+{
+    box[0] = box[1] = INT_MAX;
+    box[2] = box[3] = INT_MIN;
+}
+
+static void STlib_addRect(int *box, int x, int y, int w, int h)
+{
+    if (x < box[0]) box[0] = x;
+    if (y < box[1]) box[1] = y;
+    if (x + w > box[2]) box[2] = x + w;
+    if (y + h > box[3]) box[3] = y + h;
+}
+
+static void STlib_addPatch(int *box, int x, int y, patch_t *p)
+{
+    STlib_addRect(box, x - SHORT(p->leftoffset), y - SHORT(p->topoffset),
+                  SHORT(p->width), SHORT(p->height));
+}
+
+static void STlib_note(const int *box, const int *cleared, int turn, boolean same)
+{
+    st_noted_t *e = &st_noted[++st_seq % ST_NOTED];
+
+    memcpy(e->box, box, sizeof(e->box));
+    if (cleared)
+        memcpy(e->cleared, cleared, sizeof(e->cleared));
+    else
+        STlib_emptyBox(e->cleared);
+    e->turn = turn;
+    e->same = same;
+}
+
+static void STlib_noteIcon(const int *box)
+{
+    STlib_note(box, NULL, -1, false);
+}
+
+// Whether vanilla, redrawing n now, would show something other than what
+// n drew last.
+static boolean STlib_drawnOver(const st_number_t *n)
+{
+    unsigned int seq;
+
+    // Too many draws since to tell.
+    if (st_seq - n->seen >= ST_NOTED)
+        return true;
+
+    for (seq = n->seen + 1; seq != st_seq + 1; seq++)
+    {
+        const st_noted_t *e = &st_noted[seq % ST_NOTED];
+        int i[4];
+
+        i[0] = e->box[0] > n->drawn[0] ? e->box[0] : n->drawn[0];
+        i[1] = e->box[1] > n->drawn[1] ? e->box[1] : n->drawn[1];
+        i[2] = e->box[2] < n->drawn[2] ? e->box[2] : n->drawn[2];
+        i[3] = e->box[3] < n->drawn[3] ? e->box[3] : n->drawn[3];
+        if (i[0] >= i[2] || i[1] >= i[3])
+            continue;
+
+        // A number after n draws over it in vanilla too.
+        if (e->turn > n->turn
+         && (e->same
+          || (i[0] >= e->cleared[0] && i[1] >= e->cleared[1]
+           && i[2] <= e->cleared[2] && i[3] <= e->cleared[3])))
+            continue;
+
+        return true;
+    }
+    return false;
+}
+
+
 // ?
 void
 STlib_initNum
@@ -72,6 +181,9 @@ STlib_initNum
     n->num	= num;
     n->on	= on;
     n->p	= pl;
+    STlib_emptyBox(n->drawn);
+    n->turn	= 0;
+    n->seen	= st_seq;
 }
 
 
@@ -94,6 +206,17 @@ STlib_drawNum
     int		x = n->x;
     
     int		neg;
+    boolean	same;
+    int		cleared[4];
+
+    // Murmdoom: leave an unchanged number alone unless vanilla's redraw
+    // would change what is on screen (see STlib_drawnOver).
+    same = !refresh && n->oldnum == num;
+    if (same && !STlib_drawnOver(n))
+    {
+	n->seen = st_seq;
+	return;
+    }
 
     n->oldnum = *n->num;
 
@@ -116,28 +239,41 @@ STlib_drawNum
 	I_Error("drawNum: n->y - ST_Y < 0");
 
     V_CopyRect(x, n->y - ST_Y, st_backing_screen, w*numdigits, h, x, n->y);
+    STlib_emptyBox(cleared);
+    STlib_addRect(cleared, x, n->y, w*numdigits, h);
+    memcpy(n->drawn, cleared, sizeof(cleared));
 
     // if non-number, do not draw it
-    if (num == 1994)
-	return;
+    if (num != 1994)
+    {
+	x = n->x;
 
-    x = n->x;
+	// in the special case of 0, you draw 0
+	if (!num)
+	{
+	    V_DrawPatch(x - w, n->y, n->p[ 0 ]);
+	    STlib_addPatch(n->drawn, x - w, n->y, n->p[ 0 ]);
+	}
 
-    // in the special case of 0, you draw 0
-    if (!num)
-	V_DrawPatch(x - w, n->y, n->p[ 0 ]);
+	// draw the new number
+	while (num && numdigits--)
+	{
+	    x -= w;
+	    V_DrawPatch(x, n->y, n->p[ num % 10 ]);
+	    STlib_addPatch(n->drawn, x, n->y, n->p[ num % 10 ]);
+	    num /= 10;
+	}
 
-    // draw the new number
-    while (num && numdigits--)
-    {
-	x -= w;
-	V_DrawPatch(x, n->y, n->p[ num % 10 ]);
-	num /= 10;
+	// draw a minus sign if necessary
+	if (neg)
+	{
+	    V_DrawPatch(x - 8, n->y, sttminus);
+	    STlib_addPatch(n->drawn, x - 8, n->y, sttminus);
+	}
     }
 
-    // draw a minus sign if necessary
-    if (neg)
-	V_DrawPatch(x - 8, n->y, sttminus);
+    STlib_note(n->drawn, cleared, n->turn, same);
+    n->seen = st_seq;
 }
 
 
@@ -147,6 +283,7 @@ STlib_updateNum
 ( st_number_t*		n,
   boolean		refresh )
 {
+    n->turn = ++st_turn;	// Murmdoom: see STlib_drawnOver
     if (*n->on) STlib_drawNum(n, refresh);
 }
 
@@ -174,8 +311,15 @@ STlib_updatePercent
 ( st_percent_t*		per,
   int			refresh )
 {
+    int			box[4];
+
     if (refresh && *per->n.on)
+    {
 	V_DrawPatch(per->n.x, per->n.y, per->p);
+	STlib_emptyBox(box);
+	STlib_addPatch(box, per->n.x, per->n.y, per->p);
+	STlib_noteIcon(box);
+    }
     
     STlib_updateNum(&per->n, refresh);
 }
@@ -210,9 +354,11 @@ STlib_updateMultIcon
     int			h;
     int			x;
     int			y;
+    int			box[4];
 
     if (*mi->on && (mi->oldinum != *mi->inum || refresh) && (*mi->inum != -1))
     {
+	STlib_emptyBox(box);
 	if (mi->oldinum != -1)
 	{
 	    x = mi->x - SHORT(mi->p[mi->oldinum]->leftoffset);
@@ -224,8 +370,11 @@ STlib_updateMultIcon
 		I_Error("updateMultIcon: y - ST_Y < 0");
 
 	    V_CopyRect(x, y-ST_Y, st_backing_screen, w, h, x, y);
+	    STlib_addRect(box, x, y, w, h);
 	}
 	V_DrawPatch(mi->x, mi->y, mi->p[*mi->inum]);
+	STlib_addPatch(box, mi->x, mi->y, mi->p[*mi->inum]);
+	STlib_noteIcon(box);
 	mi->oldinum = *mi->inum;
     }
 }
@@ -260,6 +409,7 @@ STlib_updateBinIcon
     int			y;
     int			w;
     int			h;
+    int			box[4];
 
     if (*bi->on
      && (bi->oldval != *bi->val || refresh))
@@ -276,6 +426,9 @@ STlib_updateBinIcon
 	    V_DrawPatch(bi->x, bi->y, bi->p);
 	else
 	    V_CopyRect(x, y-ST_Y, st_backing_screen, w, h, x, y);
+	STlib_emptyBox(box);
+	STlib_addRect(box, x, y, w, h);
+	STlib_noteIcon(box);
 
 	bi->oldval = *bi->val;
     }
@@ -54,6 +54,13 @@ typedef struct
 
     // user data
     int data;
+
+    // Murmdoom: what it drew last (x0, y0, x1, y1), its place in the
+    // order the widgets are updated in, and the last noted draw it has
+    // seen (st_lib.c).
+    int			drawn[4];
+    int			turn;
+    unsigned int	seen;
     
 } st_number_t;
 
@@ -139,6 +146,10 @@ void STlib_init(void);
 
 
 
+// Murmdoom: called before the widgets are updated for a frame.
+void STlib_startFrame(void);
+
+
 // Number widget routines
 void
 STlib_initNum
@@ -905,6 +905,8 @@ void ST_updateWidgets(void)
 
     // used by w_frags widget
     st_fragson = deathmatch && st_statusbaron; 
+
+    STlib_startFrame();		// Murmdoom: see st_lib.c
     st_fragscount = 0;
 
     for (i=0 ; i<MAXPLAYERS ; i++)
@@ -38,6 +38,8 @@
 #include "w_wad.h"
 #include "z_zone.h"
 
+#include "murmdoom_patchspan.h"
+
 #include "config.h"
 #ifdef HAVE_LIBPNG
 #include <png.h>
@@ -61,6 +63,10 @@ static byte *dest_screen = NULL;
 
 int dirtybox[4]; 
 
+// Murmdoom: everything marked since the last V_TakeMarked (the automap
+// clears what was drawn over it).
+static int markedbox[4] = { INT_MIN, INT_MAX, INT_MAX, INT_MIN };
+
 // haleyjd 08/28/10: clipping callback function for patches.
 // This is needed for Chocolate Strife, which clips patches to the screen.
 static vpatchclipfunc_t patchclip_callback = NULL;
@@ -77,8 +83,20 @@ void V_MarkRect(int x, int y, int width, int height)
     {
         M_AddToBox (dirtybox, x, y); 
         M_AddToBox (dirtybox, x + width-1, y + height-1); 
+        M_AddToBox (markedbox, x, y);
+        M_AddToBox (markedbox, x + width-1, y + height-1);
     }
 } 
+
+//
+// V_TakeMarked
+// Copy out what has been marked since the last call, and start again.
+//
+void V_TakeMarked(int *box)
+{
+    memcpy(box, markedbox, sizeof(markedbox));
+    M_ClearBox(markedbox);
+}
  
 
 //
@@ -143,6 +161,128 @@ void V_SetPatchClipCallback(vpatchclipfunc_t func)
     patchclip_callback = func;
 }
 
+//
+// Murmdoom: span forms of the patches drawn (murmdoom_patchspan.h), found
+// by patch address and zone owner, so that a purged lump whose memory now
+// holds another lump is not mistaken for it. The spans are at PU_CACHE: the
+// zone clears an entry's spans when it purges them, and the next draw builds
+// them again.
+//
+
+#define SPAN_CACHE_BITS 9
+#define SPAN_CACHE_SIZE (1 << SPAN_CACHE_BITS)
+
+typedef struct
+{
+    patch_t *patch;
+    void **owner;
+    byte *spans;
+    boolean columns;            // no span form, draw by columns
+} span_entry_t;
+
+static span_entry_t span_cache[SPAN_CACHE_SIZE];
+static int span_cache_count;
+
+static void V_FlushSpanCache(void)
+{
+    int i;
+
+    for (i = 0; i < SPAN_CACHE_SIZE; ++i)
+    {
+        if (span_cache[i].spans != NULL)
+        {
+            Z_Free(span_cache[i].spans);
+        }
+    }
+
+    memset(span_cache, 0, sizeof(span_cache));
+    span_cache_count = 0;
+}
+
+static span_entry_t *V_SpanEntry(patch_t *patch)
+{
+    unsigned int i;
+
+    i = ((unsigned int) ((uintptr_t) patch >> 3) * 2654435761u) >> (32 - SPAN_CACHE_BITS);
+
+    while (span_cache[i].patch != NULL && span_cache[i].patch != patch)
+    {
+        i = (i + 1) & (SPAN_CACHE_SIZE - 1);
+    }
+
+    return &span_cache[i];
+}
+
+// Span form of patch, built if need be; NULL to draw it by columns.
+
+static byte *V_PatchSpans(patch_t *patch)
+{
+    span_entry_t *entry;
+    void **owner;
+    int size;
+    int tag;
+
+    owner = Z_GetUser(patch);
+
+    if (owner == NULL)
+    {
+        return NULL;
+    }
+
+    entry = V_SpanEntry(patch);
+
+    if (entry->patch == NULL)
+    {
+        if (span_cache_count >= SPAN_CACHE_SIZE * 3 / 4)
+        {
+            V_FlushSpanCache();
+            entry = V_SpanEntry(patch);
+        }
+
+        entry->patch = patch;
+        ++span_cache_count;
+    }
+    else if (entry->owner == owner)
+    {
+        if (entry->spans != NULL || entry->columns)
+        {
+            return entry->spans;
+        }
+    }
+    else if (entry->spans != NULL)
+    {
+        Z_Free(entry->spans);
+    }
+
+    entry->owner = owner;
+    size = patchspan_size(patch);
+    entry->columns = size == 0;
+
+    if (entry->columns)
+    {
+        return NULL;
+    }
+
+    // Do not let the patch itself be purged to make room for its spans.
+
+    tag = Z_GetTag(patch);
+
+    if (tag >= PU_PURGELEVEL)
+    {
+        Z_ChangeTag(patch, PU_STATIC);
+    }
+
+    Z_Malloc(size, PU_CACHE, &entry->spans);
+    patchspan_build(patch, entry->spans);
+
+    if (tag >= PU_PURGELEVEL)
+    {
+        Z_ChangeTag(patch, tag);
+    }
+
+    return entry->spans;
+}
+
 //
 // V_DrawPatch
 // Masks a column based masked pic to the screen. 
@@ -157,6 +297,7 @@ void V_DrawPatch(int x, int y, patch_t *patch)
     byte *dest;
     byte *source;
     int w;
+    byte *spans;
 
     y -= SHORT(patch->topoffset);
     x -= SHORT(patch->leftoffset);
@@ -192,6 +333,15 @@ void V_DrawPatch(int x, int y, patch_t *patch)
     col = 0;
     desttop = dest_screen + y * SCREENWIDTH + x;
 
+    // Murmdoom: row by row where the patch has a span form.
+    spans = V_PatchSpans(patch);
+
+    if (spans != NULL)
+    {
+        patchspan_draw(spans, desttop, SCREENWIDTH);
+        return;
+    }
+
     w = SHORT(patch->width);
 
     for ( ; col<w ; x++, col++, desttop++)
@@ -552,6 +702,9 @@ void V_DrawFilledBox(int x, int y, int w, int h, int c)
     uint8_t *buf, *buf1;
     int x1, y1;
 
+    // Murmdoom: I_FinishUpdate only copies out the marked lines.
+    V_MarkRect(x, y, w, h);
+
     buf = I_VideoBuffer + SCREENWIDTH * y + x;
 
     for (y1 = 0; y1 < h; ++y1)
@@ -572,6 +725,8 @@ void V_DrawHorizLine(int x, int y, int w, int c)
     uint8_t *buf;
     int x1;
 
+    V_MarkRect(x, y, w, 1);
+
     buf = I_VideoBuffer + SCREENWIDTH * y + x;
 
     for (x1 = 0; x1 < w; ++x1)
@@ -585,6 +740,8 @@ void V_DrawVertLine(int x, int y, int h, int c)
     uint8_t *buf;
     int y1;
 
+    V_MarkRect(x, y, 1, h);
+
     buf = I_VideoBuffer + SCREENWIDTH * y + x;
 
     for (y1 = 0; y1 < h; ++y1)
@@ -67,6 +67,7 @@ void V_DrawPatchDirect(int x, int y, patch_t *patch);
 void V_DrawBlock(int x, int y, int width, int height, byte *src);
 
 void V_MarkRect(int x, int y, int width, int height);
+void V_TakeMarked(int *box);
 
 void V_DrawFilledBox(int x, int y, int w, int h, int c);
 void V_DrawHorizLine(int x, int y, int w, int c);
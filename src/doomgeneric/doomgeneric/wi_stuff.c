@@ -45,6 +45,8 @@
 
 #include "wi_stuff.h"
 
+#include "murmdoom_levelload.h"
+
 //
 // Data needed to add patches to full screen intermission pics.
 // Patches are statistics messages, and animations.
@@ -1576,6 +1578,8 @@ void WI_Ticker(void)
 	break;
     }
 
+    // Murmdoom: read the next level ahead while the intermission runs.
+    levelload_prefetch_step();
 }
 
 typedef void (*load_callback_t)(char *lumpname, patch_t **variable);
@@ -1821,6 +1825,8 @@ void WI_Drawer (void)
 	WI_drawNoState();
 	break;
     }
+
+    levelload_drawer();
 }
 
 
@@ -1881,4 +1887,7 @@ void WI_Start(wbstartstruct_t* wbstartstruct)
 	WI_initNetgameStats();
     else
 	WI_initStats();
+
+    // Murmdoom: wbs->epsd and wbs->next are 0-based.
+    levelload_prefetch_start(wbs->epsd + 1, wbs->next + 1);
 }
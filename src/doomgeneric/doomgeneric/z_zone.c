@@ -461,6 +461,27 @@ void Z_ChangeUser(void *ptr, void **user)
 }
 
 
+// Murmdoom: owner and tag of the block starting at ptr, for caches of data
+// derived from a lump (see V_DrawPatch). NULL and -1 if ptr does not start
+// a zone block.
+
+void **Z_GetUser(void *ptr)
+{
+    memblock_t*	block;
+
+    block = (memblock_t *) ((byte *)ptr - sizeof(memblock_t));
+
+    return block->id == ZONEID ? block->user : NULL;
+}
+
+int Z_GetTag(void *ptr)
+{
+    memblock_t*	block;
+
+    block = (memblock_t *) ((byte *)ptr - sizeof(memblock_t));
+
+    return block->id == ZONEID ? block->tag : -1;
+}
 
 //
 // Z_FreeMemory
@@ -59,6 +59,8 @@ void    Z_FileDumpHeap (FILE *f);
 void    Z_CheckHeap (void);
 void    Z_ChangeTag2 (void *ptr, int tag, char *file, int line);
 void    Z_ChangeUser(void *ptr, void **user);
+void  **Z_GetUser(void *ptr);
+int     Z_GetTag(void *ptr);
 int     Z_FreeMemory (void);
 unsigned int Z_ZoneSize(void);
 
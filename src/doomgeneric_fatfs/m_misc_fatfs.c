@@ -59,6 +59,9 @@ boolean M_WriteFile(char *name, void *source, int length)
     return (fr == FR_OK && bw == length);
 }
 
+// Returns 0, with nothing allocated, if the file is missing, empty or
+// can't be read; otherwise the caller frees *buffer with Z_Free.
+
 int M_ReadFile(char *name, byte **buffer)
 {
     FIL file;
@@ -71,8 +74,14 @@ int M_ReadFile(char *name, byte **buffer)
     if (fr != FR_OK) return 0;
 
     length = f_size(&file);
+    if (length == 0)
+    {
+        f_close(&file);
+        return 0;
+    }
+
     buf = Z_Malloc(length, PU_STATIC, NULL);
-    
+
     fr = f_read(&file, buf, length, &br);
     f_close(&file);
 
@@ -3,42 +3,104 @@
 #include <errno.h>
 #include <string.h>
 
+#include "pico/stdlib.h"
+#include "psram_allocator.h"
+#include "murmdoom_console.h"
+
 // Map FILE* to FIL* for FatFS
 // We'll use a simple array of file handles
 #define MAX_OPEN_FILES 8
 
+// Each handle has a buffer of MURMDOOM_STDIO_BUFFER bytes in PSRAM (a CMake
+// setting; 0 turns buffering off). Reads are served from it, and an empty
+// buffer is refilled with one f_read of its full size, so the small reads
+// and fgetc of midifile.c read ahead. Writes collect in it and reach FatFs
+// in one f_write when it fills, on a seek and on fclose. A transfer as big
+// as the buffer bypasses it.
+#ifndef MURMDOOM_STDIO_BUFFER
+#define MURMDOOM_STDIO_BUFFER 4096
+#endif
+
 typedef struct {
-    FIL fil;
+    FIL fil;                // first, so that a FILE* points at both
     int in_use;
+    unsigned char *buf;     // NULL if unbuffered
+    UINT len;               // bytes in buf: read ahead, or not yet written
+    UINT pos;               // next byte of buf to read
+    int writing;            // buf holds writes
 } file_handle_t;
 
 static file_handle_t file_handles[MAX_OPEN_FILES];
 
+// Calls from the game, and the FatFs calls they turned into.
+static struct {
+    uint32_t freads, fgetcs, fwrites;
+    uint32_t f_reads, f_writes;
+    uint64_t read_bytes, write_bytes;
+    uint64_t read_us, write_us;
+} stats;
+
 // Convert FIL* back to FILE* (just cast the address)
 static FILE* fil_to_file(FIL *fil) {
     return (FILE*)fil;
 }
 
-// Convert FILE* to FIL*
-static FIL* file_to_fil(FILE *fp) {
-    return (FIL*)fp;
+static file_handle_t *file_to_handle(FILE *fp) {
+    return (file_handle_t *)fp;
+}
+
+static FRESULT timed_read(file_handle_t *h, void *dst, UINT n, UINT *br) {
+    const uint32_t t0 = time_us_32();
+    const FRESULT fr = f_read(&h->fil, dst, n, br);
+    stats.read_us += time_us_32() - t0;
+    stats.f_reads++;
+    stats.read_bytes += *br;
+    return fr;
+}
+
+static FRESULT timed_write(file_handle_t *h, const void *src, UINT n, UINT *bw) {
+    const uint32_t t0 = time_us_32();
+    const FRESULT fr = f_write(&h->fil, src, n, bw);
+    stats.write_us += time_us_32() - t0;
+    stats.f_writes++;
+    stats.write_bytes += *bw;
+    return fr;
+}
+
+// Write out pending writes, or drop what was read ahead and put the file
+// pointer back where the caller is. Returns 0 on success.
+static int sync_handle(file_handle_t *h) {
+    FRESULT fr = FR_OK;
+
+    if (h->writing) {
+        if (h->len) {
+            UINT bw;
+            fr = timed_write(h, h->buf, h->len, &bw);
+            if (fr == FR_OK && bw < h->len) fr = FR_DISK_ERR;
+        }
+        h->writing = 0;
+    } else if (h->pos < h->len) {
+        fr = f_lseek(&h->fil, f_tell(&h->fil) - (h->len - h->pos));
+    }
+    h->len = h->pos = 0;
+    return fr == FR_OK ? 0 : -1;
 }
 
 FILE *__wrap_fopen(const char *filename, const char *mode) {
     BYTE fatfs_mode = 0;
     FRESULT fr;
     int i;
-    
+
     // Find free handle
     for (i = 0; i < MAX_OPEN_FILES; i++) {
         if (!file_handles[i].in_use) break;
     }
-    
+
     if (i >= MAX_OPEN_FILES) {
         errno = ENOMEM;
         return NULL;
     }
-    
+
     // Parse mode
     if (strchr(mode, 'r')) {
         fatfs_mode = FA_READ;
@@ -50,78 +112,129 @@ FILE *__wrap_fopen(const char *filename, const char *mode) {
         fatfs_mode = FA_WRITE | FA_OPEN_APPEND;
         if (strchr(mode, '+')) fatfs_mode |= FA_READ;
     }
-    
+
     fr = f_open(&file_handles[i].fil, filename, fatfs_mode);
-    
+
     if (fr != FR_OK) {
         errno = EIO;
         return NULL;
     }
-    
+
     file_handles[i].in_use = 1;
+    file_handles[i].len = file_handles[i].pos = 0;
+    file_handles[i].writing = 0;
     return fil_to_file(&file_handles[i].fil);
 }
 
 int __wrap_fclose(FILE *fp) {
-    FIL *fil = file_to_fil(fp);
+    file_handle_t *h = file_to_handle(fp);
     int i;
-    
+
     // Find the handle
     for (i = 0; i < MAX_OPEN_FILES; i++) {
-        if (file_handles[i].in_use && &file_handles[i].fil == fil) {
-            f_close(fil);
+        if (file_handles[i].in_use && &file_handles[i] == h) {
+            const int flushed = sync_handle(h);
+            const FRESULT fr = f_close(&h->fil);
             file_handles[i].in_use = 0;
-            return 0;
+            return flushed == 0 && fr == FR_OK ? 0 : EOF;
         }
     }
-    
+
     return EOF;
 }
 
-size_t __wrap_fread(const void *ptr, size_t size, size_t nmemb, FILE *fp) {
-    FIL *fil = file_to_fil(fp);
+static size_t buffered_read(file_handle_t *h, unsigned char *dst, size_t total) {
+    size_t copied = 0;
     UINT br;
-    FRESULT fr;
-    
-    fr = f_read(fil, (void*)ptr, size * nmemb, &br);
-    if (fr != FR_OK) return 0;
-    
-    return br / size;
+
+    if (h->writing && sync_handle(h)) return 0;
+
+    while (copied < total) {
+        const size_t remaining = total - copied;
+        if (h->pos < h->len) {
+            const size_t n = remaining < h->len - h->pos ? remaining : h->len - h->pos;
+            memcpy(dst + copied, h->buf + h->pos, n);
+            h->pos += n;
+            copied += n;
+            continue;
+        }
+        if (!h->buf || remaining >= MURMDOOM_STDIO_BUFFER) {
+            if (timed_read(h, dst + copied, remaining, &br) == FR_OK) copied += br;
+            break;
+        }
+        // Read ahead
+        if (timed_read(h, h->buf, MURMDOOM_STDIO_BUFFER, &br) != FR_OK || br == 0) break;
+        h->len = br;
+        h->pos = 0;
+    }
+    return copied;
+}
+
+size_t __wrap_fread(const void *ptr, size_t size, size_t nmemb, FILE *fp) {
+    stats.freads++;
+    if (size == 0 || nmemb == 0) return 0;
+    return buffered_read(file_to_handle(fp), (unsigned char *)ptr, size * nmemb) / size;
 }
 
 int __wrap_fgetc(FILE *fp) {
-    FIL *fil = file_to_fil(fp);
-    UINT br;
-    FRESULT fr;
+    file_handle_t *h = file_to_handle(fp);
     unsigned char c;
-    
-    fr = f_read(fil, &c, 1, &br);
-    if (fr != FR_OK || br == 0) return EOF;
-    
-    return (int)c;
+
+    stats.fgetcs++;
+    if (h->pos < h->len && !h->writing) return h->buf[h->pos++];
+    return buffered_read(h, &c, 1) == 1 ? (int)c : EOF;
 }
 
+size_t __real_fwrite(const void *ptr, size_t size, size_t nmemb, FILE *fp);
+
 size_t __wrap_fwrite(const void *ptr, size_t size, size_t nmemb, FILE *fp) {
-    FIL *fil = file_to_fil(fp);
+    file_handle_t *h = file_to_handle(fp);
+    const size_t total = size * nmemb;
     UINT bw;
-    FRESULT fr;
-    
-    fr = f_write(fil, ptr, size * nmemb, &bw);
-    if (fr != FR_OK) return 0;
-    
+
+    // The compiler turns fputs() of a string literal into fwrite(), so the
+    // console still comes through here.
+    if (fp == stdout || fp == stderr) {
+        return __real_fwrite(ptr, size, nmemb, fp);
+    }
+
+    stats.fwrites++;
+    if (total == 0) return 0;
+    if (!h->writing) {
+        if (sync_handle(h)) return 0;
+        h->writing = 1;
+    }
+
+    if (h->buf && h->len + total < MURMDOOM_STDIO_BUFFER) {
+        memcpy(h->buf + h->len, ptr, total);
+        h->len += total;
+        return nmemb;
+    }
+    if (sync_handle(h)) return 0;
+    h->writing = 1;
+    if (h->buf && total < MURMDOOM_STDIO_BUFFER) {
+        memcpy(h->buf, ptr, total);
+        h->len = total;
+        return nmemb;
+    }
+    if (timed_write(h, ptr, total, &bw) != FR_OK) return 0;
+
     return bw / size;
 }
 
 int __wrap_fseek(FILE *fp, long offset, int whence) {
-    FIL *fil = file_to_fil(fp);
+    file_handle_t *h = file_to_handle(fp);
+    FIL *fil = &h->fil;
     FSIZE_t pos;
-    
+
+    if (h->writing && sync_handle(h)) return -1;
+
     switch (whence) {
         case SEEK_SET:
             pos = offset;
             break;
         case SEEK_CUR:
-            pos = f_tell(fil) + offset;
+            pos = f_tell(fil) - (h->len - h->pos) + offset;
             break;
         case SEEK_END:
             pos = f_size(fil) + offset;
@@ -129,13 +242,21 @@ int __wrap_fseek(FILE *fp, long offset, int whence) {
         default:
             return -1;
     }
-    
+
+    // Within what was read ahead: just move in the buffer.
+    if (pos <= f_tell(fil) && pos >= f_tell(fil) - h->len) {
+        h->pos = h->len - (UINT)(f_tell(fil) - pos);
+        return 0;
+    }
+    h->len = h->pos = 0;
     return (f_lseek(fil, pos) == FR_OK) ? 0 : -1;
 }
 
 long __wrap_ftell(FILE *fp) {
-    FIL *fil = file_to_fil(fp);
-    return (long)f_tell(fil);
+    file_handle_t *h = file_to_handle(fp);
+    FIL *fil = &h->fil;
+    if (h->writing) return (long)(f_tell(fil) + h->len);
+    return (long)(f_tell(fil) - (h->len - h->pos));
 }
 
 int __wrap_remove(const char *filename) {
@@ -148,10 +269,48 @@ int __wrap_rename(const char *oldname, const char *newname) {
     return (fr == FR_OK) ? 0 : -1;
 }
 
-// Initialize file handles
+// MB/s from bytes and microseconds, in tenths.
+static unsigned long tenths_mb_s(uint64_t bytes, uint64_t us) {
+    return us ? (unsigned long)(bytes * 10 / us) : 0;
+}
+
+static void stdio_command(int argc, char **argv) {
+    char line[112];
+
+    if (argc > 1 && !strcmp(argv[1], "reset")) {
+        memset(&stats, 0, sizeof(stats));
+        fputs("stdio: counts reset\n", stdout);
+        return;
+    }
+    snprintf(line, sizeof(line), "stdio: %d x %d byte buffers; game calls: %lu fread, %lu fgetc, %lu fwrite\n",
+             file_handles[0].buf ? MAX_OPEN_FILES : 0, MURMDOOM_STDIO_BUFFER, (unsigned long)stats.freads,
+             (unsigned long)stats.fgetcs, (unsigned long)stats.fwrites);
+    fputs(line, stdout);
+    snprintf(line, sizeof(line), "stdio: f_read  %7lu calls %8lu KB %8lu ms %4lu.%lu MB/s\n",
+             (unsigned long)stats.f_reads, (unsigned long)(stats.read_bytes / 1024),
+             (unsigned long)(stats.read_us / 1000), tenths_mb_s(stats.read_bytes, stats.read_us) / 10,
+             tenths_mb_s(stats.read_bytes, stats.read_us) % 10);
+    fputs(line, stdout);
+    snprintf(line, sizeof(line), "stdio: f_write %7lu calls %8lu KB %8lu ms %4lu.%lu MB/s\n",
+             (unsigned long)stats.f_writes, (unsigned long)(stats.write_bytes / 1024),
+             (unsigned long)(stats.write_us / 1000), tenths_mb_s(stats.write_bytes, stats.write_us) / 10,
+             tenths_mb_s(stats.write_bytes, stats.write_us) % 10);
+    fputs(line, stdout);
+}
+
+// Initialize file handles. PSRAM must be set up: the buffers live there,
+// allocated once here rather than at fopen, which may run in the temporary
+// PSRAM mode of the music loader.
 void stdio_fatfs_init(void) {
     int i;
+    unsigned char *buffers = NULL;
+
+    if (MURMDOOM_STDIO_BUFFER > 0) {
+        buffers = psram_malloc((size_t)MAX_OPEN_FILES * MURMDOOM_STDIO_BUFFER);
+    }
     for (i = 0; i < MAX_OPEN_FILES; i++) {
         file_handles[i].in_use = 0;
+        file_handles[i].buf = buffers ? buffers + (size_t)i * MURMDOOM_STDIO_BUFFER : NULL;
     }
+    murmdoom_console_register("stdio", "[reset] SD file calls, FatFs calls and throughput", stdio_command);
 }
@@ -11,17 +11,23 @@
 #include "HDMI.h"
 #include "psram_init.h"
 #include "psram_allocator.h"
+#include "murmdoom_psramcal.h"
 #include "sdcard.h"
 #include "ff.h"
 #include "ps2kbd_wrapper.h"
 #include "ps2mouse_wrapper.h"
 #include "usbhid_wrapper.h"
 #include "murmdoom_log.h"
+#include "murmdoom_bench.h"
+#include "murmdoom_input.h"
+#include "murmdoom_present.h"
+#include "murmdoom_prof.h"
 #include "doomkeys.h"
 #include "m_argv.h"
 #include <stdio.h>
 #include <stdarg.h>
 #include <string.h>
+#include <strings.h>
 
 static void draw_text_5x7(int x, int y, const char *text, pixel_t color);
 static void fill_rect(int x, int y, int w, int h, pixel_t color);
@@ -616,8 +622,23 @@ void DG_Init() {
     // Initialize PSRAM (pin auto-detected based on chip package)
     uint psram_pin = get_psram_pin();
     psram_init(psram_pin);
+
+    // Mount SD Card
+    FRESULT fr = f_mount(&fs, "", 1);
+    if (fr != FR_OK) {
+        panic("Failed to mount SD card");
+    }
+    
+    // Set current directory to doom folder (required for relative paths)
+    f_chdir("/doom");
+    
+    // Tune PSRAM timing (or reuse psram.cal) while nothing lives in it yet
+    psramcal_boot();
     psram_set_sram_mode(0); // Use PSRAM
 
+    // Initialize stdio wrapper for FatFS (its buffers are in PSRAM)
+    stdio_fatfs_init();
+
     // Allocate screen buffer in PSRAM
     DG_ScreenBuffer = (pixel_t*)psram_malloc(DOOMGENERIC_RESX * DOOMGENERIC_RESY * sizeof(pixel_t));
     if (!DG_ScreenBuffer) {
@@ -631,18 +652,7 @@ void DG_Init() {
     graphics_init(g_out_HDMI);
     graphics_set_res(320, 240);
     graphics_set_buffer((uint8_t*)DG_ScreenBuffer);
-
-    // Mount SD Card
-    FRESULT fr = f_mount(&fs, "", 1);
-    if (fr != FR_OK) {
-        panic("Failed to mount SD card");
-    }
-    
-    // Set current directory to doom folder (required for relative paths)
-    f_chdir("/doom");
-    
-    // Initialize stdio wrapper for FatFS
-    stdio_fatfs_init();
+    present_init();
 
     // Initialize PS/2 Keyboard
     ps2kbd_init();
@@ -655,6 +665,11 @@ void DG_Init() {
 }
 
 void DG_StartScreen(void) {
+    // An explicit -iwad (host runs, scripted benchmarks) skips the picker.
+    if (M_CheckParm("-iwad")) {
+        return;
+    }
+
     // Solid black background using palette index 0.
     graphics_set_palette(0, 0x000000);
     graphics_set_palette(1, 0xFFFFFF);
@@ -723,6 +738,18 @@ void DG_StartScreen(void) {
 
     int selected = 0;
 
+    // Optional /doom/bench.cfg: may preselect an IWAD and start the benchmark unattended.
+    bool autostart_bench = false;
+    if (bench_load_config()) {
+        const char *bench_iwad = bench_config_iwad();
+        for (int i = 0; bench_iwad && i < available_count; ++i) {
+            if (!strcasecmp(available[i]->filename, bench_iwad)) {
+                selected = i;
+            }
+        }
+        autostart_bench = bench_config_autostart() && available_count > 0;
+    }
+
 #ifndef MURMDOOM_VERSION
 #define MURMDOOM_VERSION "?"
 #endif
@@ -767,7 +794,7 @@ void DG_StartScreen(void) {
     const uint32_t psram_cs = get_psram_pin();
     char status1[96];
     char status2[96];
-    snprintf(status1, sizeof(status1), "Up/Down: select, Enter: confirm");
+    snprintf(status1, sizeof(status1), "Up/Down: select, Enter: play, B: benchmark");
     snprintf(status2, sizeof(status2), "%s, FREQ: %lu MHz, PSRAM: %d MHz, CS: %lu",
              cfg,
              (unsigned long)cpu_mhz,
@@ -824,8 +851,14 @@ void DG_StartScreen(void) {
 
         int pressed = 0;
         unsigned char key = 0;
-        while (DG_GetKey(&pressed, &key)) {
-            if (pressed && key == KEY_ENTER) {
+        while (autostart_bench || DG_GetKey(&pressed, &key)) {
+            if (autostart_bench) {
+                autostart_bench = false;
+                pressed = 1;
+                key = 'b';
+            }
+            const bool bench = (key == 'b' || key == 'B') && available_count > 0;
+            if (pressed && (key == KEY_ENTER || bench)) {
                 if (available_count > 0) {
                     // Make all existing UI text dark grey (palette index 1) so it's readable
                     // on the fading background, but keep the loading window text bright.
@@ -842,7 +875,8 @@ void DG_StartScreen(void) {
                     fade_start_screen_bg_to_black(doom_bg_pal, title_hl_rgb, 10, 20);
 
                     char msg[96];
-                    snprintf(msg, sizeof(msg), "Loading WAD: %s...", available[selected]->filename);
+                    snprintf(msg, sizeof(msg), "%s: %s...", bench ? "Benchmark" : "Loading WAD",
+                             available[selected]->filename);
 
                     const int pad_x = 10;
                     const int pad_y = 8;
@@ -862,12 +896,15 @@ void DG_StartScreen(void) {
 
                     draw_text_5x7(win_x + pad_x, win_y + pad_y, msg, 20);
 
-                    static char *new_argv[4];
+                    static char *new_argv[10];
                     new_argv[0] = (char *)"doom";
                     new_argv[1] = (char *)"-iwad";
                     new_argv[2] = (char *)available[selected]->filename;
                     new_argv[3] = NULL;
                     myargc = 3;
+                    if (bench) {
+                        myargc = bench_start(new_argv, myargc, (int)(sizeof(new_argv) / sizeof(new_argv[0])));
+                    }
                     myargv = new_argv;
                 }
                 return;
@@ -893,6 +930,7 @@ void DG_DrawFrame() {
         }
         palette_changed = false;
     }
+    present_end_update();
 }
 
 void DG_SleepMs(uint32_t ms) {
@@ -904,17 +942,17 @@ uint32_t DG_GetTicksMs() {
 }
 
 int DG_GetKey(int* pressed, unsigned char* key) {
-    ps2kbd_tick();
-    ps2mouse_wrapper_tick();  // Process PS/2 mouse events
-    // Note: usbhid_wrapper_tick() is called from I_StartTic() during Doom gameplay
-    
-    // Check PS/2 keyboard first
-    if (ps2kbd_get_key(pressed, key)) {
-        return 1;
-    }
-    
-    // Then check USB HID keyboard directly (for pre-Doom screens like WAD selection)
-    if (usbhid_wrapper_get_key(pressed, key)) {
+    // PS/2 keyboard and mouse feed the input ring from their interrupts; USB
+    // reports arrive through the TinyUSB callbacks run here. Mouse motion is
+    // posted once per tic by input_tic().
+    usbhid_wrapper_task();
+
+    while (input_get_key(pressed, key)) {
+        // ` toggles the profiler overlay and never reaches the game.
+        if (*key == '`') {
+            if (*pressed) prof_overlay_toggle();
+            continue;
+        }
         return 1;
     }
     
@@ -924,6 +962,14 @@ int DG_GetKey(int* pressed, unsigned char* key) {
 void DG_SetWindowTitle(const char * title) {
 }
 
+void DG_DrawText(int x, int y, const char *text, pixel_t color) {
+    draw_text_5x7(x, y, text, color);
+}
+
+void DG_FillRect(int x, int y, int w, int h, pixel_t color) {
+    fill_rect(x, y, w, h, color);
+}
+
 // I_System implementations
 
 void I_Error(char *error, ...) {
@@ -932,7 +978,11 @@ void I_Error(char *error, ...) {
     vprintf(error, argptr);
     va_end(argptr);
     putchar_raw('\n');
+#if PICO_ON_DEVICE
     while(1) tight_loop_contents();
+#else
+    exit(1);
+#endif
 }
 
 void *I_Realloc(void *ptr, size_t size) {
@@ -7,10 +7,14 @@
 #include "hardware/vreg.h"
 #include "hardware/clocks.h"
 #include "hardware/structs/qmi.h"
+#include "hardware/sync.h"
 #include <stdio.h>
+#include <string.h>
 
 #include "board_config.h"
 #include "murmdoom_log.h"
+#include "murmdoom_hot.h"
+#include "murmdoom_prof.h"
 
 // Flash timing configuration for overclocking
 // Must be called BEFORE changing system clock
@@ -35,7 +39,27 @@ static void __no_inline_not_in_flash_func(set_flash_timings)(int cpu_mhz) {
                         divisor << QMI_M0_TIMING_CLKDIV_LSB;
 }
 
+#if MURMDOOM_HOT_SRAM
+// Provided by src/murmdoom_hot.ld
+extern char __murmdoom_hot_start__[];
+extern char __murmdoom_hot_end__[];
+extern char __murmdoom_hot_source__[];
+#endif
+
+void murmdoom_hot_init(void) {
+#if MURMDOOM_HOT_SRAM
+    const size_t size = (size_t)(__murmdoom_hot_end__ - __murmdoom_hot_start__);
+    memcpy(__murmdoom_hot_start__, __murmdoom_hot_source__, size);
+    // Make sure the copied instructions are visible before anything jumps there.
+    __dsb();
+    __isb();
+#endif
+}
+
 int main() {
+    // Hot renderer/mixer/IRQ code must be in SRAM before anything can call it.
+    murmdoom_hot_init();
+
     // Overclock support: For speeds > 252 MHz, increase voltage first
 #if CPU_CLOCK_MHZ > 252
     vreg_disable_voltage_limit();
@@ -54,6 +78,9 @@ int main() {
     }
 
     stdio_init_all();
+
+    // Cycle counter for the hot-path profiler (needs the final clk_sys).
+    prof_init();
     
     // Brief startup delay for USB serial connection
     for (int i = 0; i < 3; i++) {
@@ -62,6 +89,9 @@ int main() {
     
     MURMDOOM_LOG("murmdoom - DOOM for RP2350\n");
     MURMDOOM_LOG("System Clock: %lu MHz\n", clock_get_hz(clk_sys) / 1000000);
+#if MURMDOOM_HOT_SRAM
+    MURMDOOM_LOG("Hot code in SRAM: %u bytes\n", (unsigned)(__murmdoom_hot_end__ - __murmdoom_hot_start__));
+#endif
     MURMDOOM_LOG("Starting Doom...\n");
 
     char *argv[] = {"doom", NULL};
@@ -0,0 +1,152 @@
+/*
+ * Automap drawing helpers (see murmdoom_amdraw.h).
+ */
+#include "murmdoom_amdraw.h"
+
+#include <string.h>
+
+#include "i_video.h"
+#include "m_bbox.h"
+#include "murmdoom_hot.h"
+
+#define BANDS ((SCREENHEIGHT + AMDRAW_BAND - 1) / AMDRAW_BAND)
+
+static byte *frame;
+static int frame_w, frame_h;
+// Columns drawn on in each band this frame; x0 > x1 if none.
+static int band_x0[BANDS], band_x1[BANDS];
+// What amdraw_begin cleared.
+static int cleared[4];
+
+void amdraw_blocklines(const short *blockmaplump, int bmapwidth, int x0, int y0, int x1, int y1,
+                       int numlines, uint32_t *lines) {
+    const short *blockmap = blockmaplump + 4;
+
+    for (int y = y0; y <= y1; y++) {
+        for (int x = x0; x <= x1; x++) {
+            // As P_BlockLinesIterator walks a cell.
+            for (const short *list = blockmaplump + blockmap[y * bmapwidth + x]; *list != -1; list++) {
+                const int n = (unsigned short)*list;
+                if (n < numlines) {
+                    lines[n >> 5] |= 1u << (n & 31);
+                }
+            }
+        }
+    }
+}
+
+void amdraw_mark(int x, int y, int w, int h) {
+    const int x1 = x + w > frame_w ? frame_w - 1 : x + w - 1;
+    const int y1 = y + h > frame_h ? frame_h - 1 : y + h - 1;
+
+    if (x < 0) x = 0;
+    if (y < 0) y = 0;
+    if (x > x1 || y > y1) {
+        return;
+    }
+    for (int b = y / AMDRAW_BAND; b <= y1 / AMDRAW_BAND; b++) {
+        if (x < band_x0[b]) band_x0[b] = x;
+        if (x1 > band_x1[b]) band_x1[b] = x1;
+    }
+}
+
+void amdraw_begin(byte *fb, int w, int h, int color, boolean full, const int *box) {
+    M_ClearBox(cleared);
+
+    if (full || fb != frame || w != frame_w || h != frame_h) {
+        memset(fb, color, (size_t)w * h);
+        M_AddToBox(cleared, 0, 0);
+        M_AddToBox(cleared, w - 1, h - 1);
+    } else {
+        // Whatever was drawn over the map since goes with it.
+        if (box[BOXBOTTOM] <= box[BOXTOP]) {
+            amdraw_mark(box[BOXLEFT], box[BOXBOTTOM], box[BOXRIGHT] - box[BOXLEFT] + 1,
+                        box[BOXTOP] - box[BOXBOTTOM] + 1);
+        }
+        for (int b = 0; b * AMDRAW_BAND < h; b++) {
+            const int x0 = band_x0[b], x1 = band_x1[b];
+            if (x0 > x1) {
+                continue;
+            }
+            const int y0 = b * AMDRAW_BAND;
+            const int y1 = y0 + AMDRAW_BAND > h ? h : y0 + AMDRAW_BAND;
+            for (int y = y0; y < y1; y++) {
+                memset(fb + y * w + x0, color, (size_t)(x1 - x0 + 1));
+            }
+            M_AddToBox(cleared, x0, y0);
+            M_AddToBox(cleared, x1, y1 - 1);
+        }
+    }
+
+    frame = fb;
+    frame_w = w;
+    frame_h = h;
+    for (int b = 0; b < BANDS; b++) {
+        band_x0[b] = w;
+        band_x1[b] = -1;
+    }
+}
+
+// The loop of AM_drawFline, pixel for pixel. Not marked: the caller knows
+// the bounds of a whole batch of lines.
+void __murmdoom_hot(amdraw_line)(int ax, int ay, int bx, int by, int color) {
+    const int pitch = frame_w;
+    const int dx = bx - ax, dy = by - ay;
+    byte *p = frame + ay * pitch + ax;
+
+    if (dy == 0 && (dx > 16 || dx < -16)) {
+        memset(dx < 0 ? p + dx : p, color, (size_t)(dx < 0 ? -dx : dx) + 1);
+        return;
+    }
+
+    const int sy = dy < 0 ? -pitch : pitch;
+    const int ady = dy < 0 ? -dy : dy;
+
+    if (dx == 0) {
+        for (int n = ady; n >= 0; n--, p += sy) {
+            *p = (byte)color;
+        }
+        return;
+    }
+
+    const int sx = dx < 0 ? -1 : 1;
+    const int adx = dx < 0 ? -dx : dx;
+
+    if (adx > ady) {
+        int d = 2 * ady - adx;
+        for (int n = adx;; n--) {
+            *p = (byte)color;
+            if (!n) return;
+            if (d >= 0) {
+                p += sy;
+                d -= 2 * adx;
+            }
+            p += sx;
+            d += 2 * ady;
+        }
+    } else {
+        int d = 2 * adx - ady;
+        for (int n = ady;; n--) {
+            *p = (byte)color;
+            if (!n) return;
+            if (d >= 0) {
+                p += sx;
+                d -= 2 * ady;
+            }
+            p += sy;
+            d += 2 * adx;
+        }
+    }
+}
+
+boolean amdraw_touched(int *box) {
+    memcpy(box, cleared, sizeof(cleared));
+    for (int b = 0; b * AMDRAW_BAND < frame_h; b++) {
+        if (band_x0[b] <= band_x1[b]) {
+            const int y1 = b * AMDRAW_BAND + AMDRAW_BAND - 1;
+            M_AddToBox(box, band_x0[b], b * AMDRAW_BAND);
+            M_AddToBox(box, band_x1[b], y1 >= frame_h ? frame_h - 1 : y1);
+        }
+    }
+    return box[BOXBOTTOM] <= box[BOXTOP];
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+// Automap drawing helpers for am_map.c.
+//
+// AM_drawWalls used to transform and clip every linedef of the map each
+// frame, and AM_clearFB to clear the whole map window in PSRAM before it.
+// Three pieces make both cost what is on screen instead:
+//
+//   - amdraw_blocklines marks the lines the blockmap lists in the cells
+//     around the window, so AM_drawWalls visits those only (zoomed out over
+//     a quarter of the map or more, it clips every line as before). They are
+//     kept in a bitmap by line number and drawn in line order, which keeps
+//     the overdraw at shared vertices (and so the picture) as it was.
+//   - amdraw_line is the Bresenham loop of AM_drawFline stepping a pointer
+//     through the frame instead of multiplying per pixel, with straight runs
+//     for the axis-aligned grid and walls. It runs from SRAM.
+//   - the frame is cleared where the automap drew last frame (tracked per
+//     band of AMDRAW_BAND rows) and where anything else was drawn over it
+//     since (menus, messages; V_TakeMarked), rather than in full. The walls
+//     are marked once a frame as the bounds of the map on screen; a mark per
+//     line would cost more than it saves.
+//
+// host/bench_automap times a large synthetic map both ways.
+
+#include "doomtype.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define AMDRAW_BAND 8
+
+// Set bit n of lines (a bit per linedef, numlines of them) for each line the
+// blockmap lists in cells x0..x1, y0..y1, which must lie inside the blockmap.
+void amdraw_blocklines(const short *blockmaplump, int bmapwidth, int x0, int y0, int x1, int y1,
+                       int numlines, uint32_t *lines);
+
+// Start a frame of w x h pixels at fb, rows w bytes apart, by clearing it to
+// color: in full, or what the last frame drew plus box (a dirtybox of what
+// else was drawn into fb since).
+void amdraw_begin(byte *fb, int w, int h, int color, boolean full, const int *box);
+// Line between two points inside the frame, as AM_drawFline draws it.
+void amdraw_line(int ax, int ay, int bx, int by, int color);
+// Pixels were drawn at x, y (w x h, clipped to the frame) this frame.
+void amdraw_mark(int x, int y, int w, int h);
+// What this frame cleared or drew, as a dirtybox; false if nothing.
+boolean amdraw_touched(int *box);
+
+#ifdef __cplusplus
+}
+#endif
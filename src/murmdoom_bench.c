@@ -0,0 +1,402 @@
+/*
+ * Timedemo benchmark mode (see murmdoom_bench.h).
+ */
+#include "doomstat.h"
+#include "d_loop.h"
+#include "w_wad.h"
+
+#include "murmdoom_bench.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "pico/time.h"
+#include "ff.h"
+#include "psram_allocator.h"
+#include "murmdoom_prof.h"
+
+#define BENCH_CONFIG_FILE "bench.cfg"
+#define BENCH_DIR "bench"
+
+#define BENCH_MAX_DEMOS 8
+// Per-frame rows kept for the CSV dump and the p99. Frames past the cap still
+// count towards min/avg/max and the histogram.
+#define BENCH_MAX_FRAMES 4096
+// Histogram buckets are 1ms wide; the last one collects everything slower.
+#define BENCH_HIST_BUCKETS 100
+
+enum {
+    BENCH_BSP,
+    BENCH_SEGS,
+    BENCH_PLANES,
+    BENCH_MASKED,
+    BENCH_FINISH,
+    BENCH_SOUND,
+    BENCH_TICKER,
+    BENCH_SPLIT_COUNT
+};
+
+// Profiler record behind each split. Without the profiler
+// (MURMDOOM_PROF=OFF) there are no splits: the CSVs have frame times only.
+#define BENCH_SPLITS (MURMDOOM_PROF ? BENCH_SPLIT_COUNT : 0)
+static const prof_id_t split_prof[BENCH_SPLIT_COUNT] = {
+    PROF_BSP, PROF_SEGS, PROF_PLANES, PROF_MASKED, PROF_FINISH, PROF_MIX, PROF_TICKER,
+};
+
+typedef struct {
+    uint32_t tic;
+    uint32_t frame_us;
+    uint32_t split_us[BENCH_SPLIT_COUNT];
+} bench_frame_t;
+
+static const char *const split_names[BENCH_SPLIT_COUNT] = {
+    "bsp", "segs", "planes", "masked", "finish", "sound", "ticker",
+};
+
+// True only while a benchmark demo is being recorded.
+static bool bench_active = false;
+
+// bench.cfg
+static bool cfg_present = false;
+static bool cfg_autostart = false;
+static char cfg_iwad[32];
+static char cfg_demos[BENCH_MAX_DEMOS][9];
+static int cfg_demo_count = 0;
+static int cfg_runs = 1;
+static bool cfg_serial_frames = true;
+static bool cfg_nodraw = false;
+static bool cfg_nosound = false;
+static char cfg_framehash[8];
+
+// Run state
+static bool bench_armed = false;
+static int queue_pos = 0;           // index into runs * demos
+static bench_frame_t *frames = NULL;
+static uint32_t *sorted = NULL;
+static uint32_t frame_count = 0;    // all frames of the current demo
+static int start_tic = 0;
+static uint32_t last_us = 0;
+static uint32_t min_us, max_us;
+static uint64_t total_us;
+static uint64_t split_total[BENCH_SPLIT_COUNT];
+static uint16_t hist[BENCH_HIST_BUCKETS];
+
+static FIL out_file;
+static bool out_open = false;
+
+static char *skip_space(char *s) {
+    while (*s == ' ' || *s == '\t') s++;
+    return s;
+}
+
+static void trim_end(char *s) {
+    size_t n = strlen(s);
+    while (n > 0 && (s[n - 1] == '\n' || s[n - 1] == '\r' || s[n - 1] == ' ' || s[n - 1] == '\t')) {
+        s[--n] = '\0';
+    }
+}
+
+static bool parse_bool(const char *v) {
+    return !strcmp(v, "1") || !strcasecmp(v, "yes") || !strcasecmp(v, "on") || !strcasecmp(v, "true");
+}
+
+bool bench_load_config(void) {
+    FIL f;
+    if (f_open(&f, BENCH_CONFIG_FILE, FA_READ) != FR_OK) {
+        return false;
+    }
+
+    char line[80];
+    while (f_gets(line, sizeof(line), &f)) {
+        char *hash = strchr(line, '#');
+        if (hash) *hash = '\0';
+        trim_end(line);
+        char *key = skip_space(line);
+        if (!*key) continue;
+
+        char *value = key;
+        while (*value && *value != ' ' && *value != '\t') value++;
+        if (*value) *value++ = '\0';
+        value = skip_space(value);
+
+        if (!strcasecmp(key, "autostart")) {
+            cfg_autostart = parse_bool(value);
+        } else if (!strcasecmp(key, "iwad")) {
+            snprintf(cfg_iwad, sizeof(cfg_iwad), "%s", value);
+        } else if (!strcasecmp(key, "demo")) {
+            if (cfg_demo_count < BENCH_MAX_DEMOS && *value) {
+                snprintf(cfg_demos[cfg_demo_count++], sizeof(cfg_demos[0]), "%s", value);
+            }
+        } else if (!strcasecmp(key, "runs")) {
+            cfg_runs = atoi(value);
+            if (cfg_runs < 1) cfg_runs = 1;
+        } else if (!strcasecmp(key, "serial")) {
+            cfg_serial_frames = strcasecmp(value, "summary") != 0;
+        } else if (!strcasecmp(key, "nodraw")) {
+            cfg_nodraw = parse_bool(value);
+        } else if (!strcasecmp(key, "nosound")) {
+            cfg_nosound = parse_bool(value);
+        } else if (!strcasecmp(key, "framehash")) {
+            snprintf(cfg_framehash, sizeof(cfg_framehash), "%s", value);
+        } else {
+            printf("bench.cfg: unknown key '%s'\n", key);
+        }
+    }
+    f_close(&f);
+
+    cfg_present = true;
+    return true;
+}
+
+bool bench_config_autostart(void) {
+    return cfg_present && cfg_autostart;
+}
+
+const char *bench_config_iwad(void) {
+    return cfg_iwad[0] ? cfg_iwad : NULL;
+}
+
+int bench_start(char **argv, int argc, int max_argc) {
+    if (cfg_demo_count == 0) {
+        static const char *const default_demos[] = {"demo1", "demo2", "demo3"};
+        for (size_t i = 0; i < sizeof(default_demos) / sizeof(default_demos[0]); ++i) {
+            snprintf(cfg_demos[cfg_demo_count++], sizeof(cfg_demos[0]), "%s", default_demos[i]);
+        }
+    }
+
+    // Allocate before the zone so the buffers never compete with level data.
+    frames = psram_malloc(BENCH_MAX_FRAMES * sizeof(*frames));
+    sorted = psram_malloc(BENCH_MAX_FRAMES * sizeof(*sorted));
+    if (!frames || !sorted) {
+        printf("bench: no PSRAM for frame log, only summaries will be reported\n");
+        frames = NULL;
+        sorted = NULL;
+    }
+
+    if (argc + 2 < max_argc) {
+        argv[argc++] = (char *)"-timedemo";
+        argv[argc++] = cfg_demos[0];
+    }
+    if (cfg_nodraw && argc + 1 < max_argc) argv[argc++] = (char *)"-nodraw";
+    if (cfg_nosound && argc + 1 < max_argc) argv[argc++] = (char *)"-nosound";
+    if (cfg_framehash[0] && argc + 2 < max_argc) {
+        argv[argc++] = (char *)"-framehash";
+        argv[argc++] = cfg_framehash;
+    }
+    argv[argc] = NULL;
+
+    bench_armed = true;
+    queue_pos = 0;
+    f_mkdir(BENCH_DIR);
+
+    printf("bench: %d demo(s) x %d run(s)%s%s%s%s%s\n", cfg_demo_count, cfg_runs,
+           cfg_nodraw ? ", nodraw" : "", cfg_nosound ? ", nosound" : "",
+           cfg_framehash[0] ? ", framehash " : "", cfg_framehash,
+           BENCH_SPLITS ? "" : ", profiling disabled: frame times only");
+    return argc;
+}
+
+void bench_demo_start(void) {
+    if (!bench_armed) return;
+
+    frame_count = 0;
+    start_tic = gametic;
+    min_us = UINT32_MAX;
+    max_us = 0;
+    total_us = 0;
+    memset(split_total, 0, sizeof(split_total));
+    memset(hist, 0, sizeof(hist));
+
+    bench_active = true;
+    // Level load is not part of the first frame.
+    last_us = time_us_32();
+}
+
+void bench_frame_end(void) {
+    if (!bench_active) return;
+
+    const uint32_t now = time_us_32();
+    const uint32_t dt = now - last_us;
+    last_us = now;
+
+    uint32_t split_acc[BENCH_SPLIT_COUNT] = {0};
+    for (int i = 0; i < BENCH_SPLITS; ++i) {
+        split_acc[i] = prof_frame_us(split_prof[i]);
+    }
+
+    // Walls are drawn from inside the BSP walk; report BSP exclusive of them.
+    if (split_acc[BENCH_BSP] >= split_acc[BENCH_SEGS]) {
+        split_acc[BENCH_BSP] -= split_acc[BENCH_SEGS];
+    } else {
+        split_acc[BENCH_BSP] = 0;
+    }
+
+    if (frames && frame_count < BENCH_MAX_FRAMES) {
+        bench_frame_t *f = &frames[frame_count];
+        f->tic = (uint32_t)(gametic - start_tic);
+        f->frame_us = dt;
+        memcpy(f->split_us, split_acc, sizeof(split_acc));
+    }
+    frame_count++;
+
+    if (dt < min_us) min_us = dt;
+    if (dt > max_us) max_us = dt;
+    total_us += dt;
+    for (int i = 0; i < BENCH_SPLIT_COUNT; ++i) {
+        split_total[i] += split_acc[i];
+    }
+    uint32_t bucket = dt / 1000;
+    if (bucket >= BENCH_HIST_BUCKETS) bucket = BENCH_HIST_BUCKETS - 1;
+    if (hist[bucket] != UINT16_MAX) hist[bucket]++;
+}
+
+static void emit(bool serial, const char *fmt, ...) {
+    char line[160];
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(line, sizeof(line), fmt, ap);
+    va_end(ap);
+    if (n <= 0) return;
+    if (n >= (int)sizeof(line)) n = (int)sizeof(line) - 1;
+
+    if (serial) {
+        fputs(line, stdout);
+    }
+    if (out_open) {
+        UINT bw;
+        f_write(&out_file, line, (UINT)n, &bw);
+    }
+}
+
+static bool open_out(const char *path, BYTE mode) {
+    out_open = f_open(&out_file, path, mode) == FR_OK;
+    if (!out_open) {
+        printf("bench: cannot write %s\n", path);
+    }
+    return out_open;
+}
+
+static void close_out(void) {
+    if (out_open) {
+        f_close(&out_file);
+        out_open = false;
+    }
+}
+
+static int cmp_u32(const void *a, const void *b) {
+    const uint32_t x = *(const uint32_t *)a;
+    const uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static void report_demo(const char *demo, int run) {
+    const uint32_t stored = frame_count < BENCH_MAX_FRAMES ? frame_count : BENCH_MAX_FRAMES;
+    const uint32_t tics = (uint32_t)(gametic - start_tic);
+    const uint32_t frames_n = frame_count ? frame_count : 1;
+    const uint32_t avg_us = (uint32_t)(total_us / frames_n);
+    const uint32_t fps_x10 = total_us ? (uint32_t)((uint64_t)frame_count * 10000000u / total_us) : 0;
+
+    uint32_t p99_us = max_us;
+    if (frames && stored > 0) {
+        for (uint32_t i = 0; i < stored; ++i) sorted[i] = frames[i].frame_us;
+        qsort(sorted, stored, sizeof(sorted[0]), cmp_u32);
+        p99_us = sorted[(stored * 99) / 100 < stored ? (stored * 99) / 100 : stored - 1];
+    }
+    if (frame_count == 0) min_us = 0;
+
+    char path[48];
+    if (cfg_runs > 1) {
+        snprintf(path, sizeof(path), BENCH_DIR "/%s_%d.csv", demo, run + 1);
+    } else {
+        snprintf(path, sizeof(path), BENCH_DIR "/%s.csv", demo);
+    }
+
+    // Per-frame rows.
+    if (frames) {
+        open_out(path, FA_WRITE | FA_CREATE_ALWAYS);
+        char row[160];
+        int len = snprintf(row, sizeof(row), "frame,tic,frame_us");
+        for (int k = 0; k < BENCH_SPLITS; ++k) {
+            len += snprintf(row + len, sizeof(row) - len, ",%s_us", split_names[k]);
+        }
+        emit(cfg_serial_frames, "%s\n", row);
+        for (uint32_t i = 0; i < stored; ++i) {
+            const bench_frame_t *f = &frames[i];
+            len = snprintf(row, sizeof(row), "%lu,%lu,%lu",
+                           (unsigned long)i, (unsigned long)f->tic, (unsigned long)f->frame_us);
+            for (int k = 0; k < BENCH_SPLITS; ++k) {
+                len += snprintf(row + len, sizeof(row) - len, ",%lu", (unsigned long)f->split_us[k]);
+            }
+            emit(cfg_serial_frames, "%s\n", row);
+        }
+        close_out();
+        if (stored < frame_count) {
+            printf("bench: %s: only the first %u of %lu frames logged\n",
+                   demo, BENCH_MAX_FRAMES, (unsigned long)frame_count);
+        }
+    }
+
+    // Histogram, 1ms buckets; only non-empty ones.
+    open_out(BENCH_DIR "/hist.csv", FA_WRITE | FA_OPEN_APPEND);
+    if (out_open && f_size(&out_file) == 0) {
+        emit(false, "demo,run,ms,frames\n");
+    }
+    for (int i = 0; i < BENCH_HIST_BUCKETS; ++i) {
+        if (!hist[i]) continue;
+        // The tag picks these lines out of the serial log; the file
+        // has a column less.
+        fputs("hist,", stdout);
+        emit(true, "%s,%d,%d%s,%u\n", demo, run + 1, i,
+             i == BENCH_HIST_BUCKETS - 1 ? "+" : "", hist[i]);
+    }
+    close_out();
+
+    // Summary row.
+    open_out(BENCH_DIR "/summary.csv", FA_WRITE | FA_OPEN_APPEND);
+    if (out_open && f_size(&out_file) == 0) {
+        emit(false, "demo,run,frames,tics,fps,min_us,avg_us,p99_us,max_us");
+        for (int i = 0; i < BENCH_SPLITS; ++i) {
+            emit(false, ",%s_us", split_names[i]);
+        }
+        emit(false, BENCH_SPLITS ? ",sim_tics_s\n" : "\n");
+    }
+    fputs("summary,", stdout);
+    emit(true, "%s,%d,%lu,%lu,%lu.%lu,%lu,%lu,%lu,%lu",
+         demo, run + 1, (unsigned long)frame_count, (unsigned long)tics,
+         (unsigned long)(fps_x10 / 10), (unsigned long)(fps_x10 % 10),
+         (unsigned long)min_us, (unsigned long)avg_us, (unsigned long)p99_us, (unsigned long)max_us);
+    for (int i = 0; i < BENCH_SPLITS; ++i) {
+        emit(true, ",%lu", (unsigned long)(split_total[i] / frames_n));
+    }
+    if (BENCH_SPLITS) {
+        // Tics per second if the game did nothing but run P_Ticker.
+        const uint64_t ticker_us = split_total[BENCH_TICKER];
+        emit(true, ",%lu\n", ticker_us ? (unsigned long)(tics * 1000000ull / ticker_us) : 0ul);
+    } else {
+        emit(true, "\n");
+    }
+    close_out();
+}
+
+char *bench_demo_done(void) {
+    if (!bench_armed || !bench_active) return NULL;
+    bench_active = false;
+
+    const int total = cfg_demo_count * cfg_runs;
+    report_demo(cfg_demos[queue_pos % cfg_demo_count], queue_pos / cfg_demo_count);
+
+    // Next demo whose lump actually exists in this IWAD.
+    while (++queue_pos < total) {
+        char *next = cfg_demos[queue_pos % cfg_demo_count];
+        if (W_CheckNumForName(next) >= 0) {
+            return next;
+        }
+        printf("bench: no %s lump, skipped\n", next);
+    }
+
+    printf("bench: done, results in /doom/" BENCH_DIR "/\n");
+    return NULL;
+}
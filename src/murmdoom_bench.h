@@ -0,0 +1,59 @@
+#pragma once
+
+// Timedemo benchmark mode.
+//
+// Selected with 'B' on the start screen, or automatically when /doom/bench.cfg
+// contains "autostart 1". The selected IWAD is started with -timedemo and the
+// configured demos are played back-to-back as fast as the engine can run them.
+// Every rendered frame is timed, together with a per-subsystem split taken
+// from the profiler's per-frame totals (murmdoom_prof.h; all zero when built
+// with MURMDOOM_PROF=OFF):
+//
+//   bsp      R_RenderBSPNode, excluding the wall drawing below
+//   segs     R_StoreWallRange (wall columns)
+//   planes   R_DrawPlanes
+//   masked   R_DrawMasked (sprites, masked mid-textures, player weapon)
+//   finish   I_FinishUpdate (zone -> PSRAM framebuffer copy)
+//   sound    mix_audio_buffer (SFX mix + OPL music)
+//   ticker   P_Ticker, the game simulation (all that runs with nodraw)
+//
+// Results go out as CSV over the serial console and to bench/<demo>.csv on
+// the SD card; one summary row per demo is appended to bench/summary.csv.
+//
+// bench.cfg (all keys optional, '#' starts a comment):
+//
+//   autostart 1          skip the start screen menu
+//   iwad doom2.wad       IWAD to benchmark (default: the one selected)
+//   demo demo1           demo lump to play; repeat for more (default demo1..3)
+//   runs 3               play the whole demo list this many times
+//   serial summary       "frames" (default) also prints every frame row
+//   nodraw 1             pass -nodraw (simulation only)
+//   nosound 1            pass -nosound
+//   framehash check      pass -framehash record|check (murmdoom_framehash.h)
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Read /doom/bench.cfg. Returns true if the file exists.
+bool bench_load_config(void);
+bool bench_config_autostart(void);
+// IWAD requested by bench.cfg, or NULL.
+const char *bench_config_iwad(void);
+
+// Arm the benchmark and append its arguments (-timedemo <first demo> ...) to
+// argv[argc..]. Returns the new argc; argv[argc] is set to NULL.
+int bench_start(char **argv, int argc, int max_argc);
+
+// Engine hooks.
+void bench_demo_start(void);   // G_DoPlayDemo, once the level is loaded
+void bench_frame_end(void);    // after D_Display and prof_frame_end()
+// G_CheckDemoStatus: report the finished demo, return the next one or NULL.
+char *bench_demo_done(void);
+
+#ifdef __cplusplus
+}
+#endif
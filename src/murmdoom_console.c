@@ -0,0 +1,95 @@
+/*
+ * Serial command console (see murmdoom_console.h).
+ */
+#include "murmdoom_console.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+
+#define CONSOLE_MAX_COMMANDS 16
+#define CONSOLE_MAX_ARGS 8
+#define CONSOLE_LINE_LEN 96
+
+typedef struct {
+    const char *name;
+    const char *help;
+    murmdoom_console_fn fn;
+} console_cmd_t;
+
+static console_cmd_t commands[CONSOLE_MAX_COMMANDS];
+static int command_count = 0;
+
+static char line[CONSOLE_LINE_LEN];
+static int line_len = 0;
+
+void murmdoom_console_register(const char *name, const char *help, murmdoom_console_fn fn) {
+    for (int i = 0; i < command_count; ++i) {
+        if (!strcmp(commands[i].name, name)) {
+            commands[i].help = help;
+            commands[i].fn = fn;
+            return;
+        }
+    }
+    if (command_count >= CONSOLE_MAX_COMMANDS) {
+        printf("console: no room for command '%s'\n", name);
+        return;
+    }
+    commands[command_count].name = name;
+    commands[command_count].help = help;
+    commands[command_count].fn = fn;
+    command_count++;
+}
+
+static void print_help(void) {
+    printf("commands:\n");
+    printf("  help              this list\n");
+    for (int i = 0; i < command_count; ++i) {
+        printf("  %-17s %s\n", commands[i].name, commands[i].help);
+    }
+}
+
+static void dispatch(char *text) {
+    char *argv[CONSOLE_MAX_ARGS];
+    int argc = 0;
+
+    char *p = text;
+    while (*p && argc < CONSOLE_MAX_ARGS) {
+        while (*p == ' ' || *p == '\t') p++;
+        if (!*p) break;
+        argv[argc++] = p;
+        while (*p && *p != ' ' && *p != '\t') p++;
+        if (*p) *p++ = '\0';
+    }
+    if (argc == 0) return;
+
+    if (!strcmp(argv[0], "help")) {
+        print_help();
+        return;
+    }
+    for (int i = 0; i < command_count; ++i) {
+        if (!strcmp(commands[i].name, argv[0])) {
+            commands[i].fn(argc, argv);
+            return;
+        }
+    }
+    printf("unknown command '%s' (try help)\n", argv[0]);
+}
+
+void murmdoom_console_poll(void) {
+    int c;
+    while ((c = getchar_timeout_us(0)) != PICO_ERROR_TIMEOUT) {
+        if (c == '\r' || c == '\n') {
+            if (line_len > 0) {
+                line[line_len] = '\0';
+                line_len = 0;
+                dispatch(line);
+            }
+        } else if (c == '\b' || c == 0x7f) {
+            if (line_len > 0) line_len--;
+        } else if (c >= ' ' && line_len < CONSOLE_LINE_LEN - 1) {
+            line[line_len++] = (char)c;
+        }
+    }
+}
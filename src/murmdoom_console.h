@@ -0,0 +1,20 @@
+#pragma once
+
+// Line-based command console on the stdio serial port (USB CDC or UART).
+//
+// Input is polled without blocking once per frame from I_StartFrame(); a
+// complete line is split on spaces and dispatched to the registered command
+// whose name matches the first word. "help" lists everything registered.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void (*murmdoom_console_fn)(int argc, char **argv);
+
+void murmdoom_console_register(const char *name, const char *help, murmdoom_console_fn fn);
+void murmdoom_console_poll(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,252 @@
+/*
+ * Frame-hash regression harness (see murmdoom_framehash.h).
+ */
+#include "doomstat.h"
+#include "i_video.h"
+#include "m_argv.h"
+#include "sha1.h"
+
+#include "murmdoom_framehash.h"
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+
+#include "ff.h"
+
+#define GOLDEN_DIR "golden"
+#define RESULT_DIR "bench"
+
+#define FRAME_BYTES (SCREENWIDTH * SCREENHEIGHT)
+// "<40 hex digits>\n"
+#define DIGEST_HEX 40
+
+typedef enum {
+    FRAMEHASH_OFF,
+    FRAMEHASH_RECORD,
+    FRAMEHASH_CHECK,
+} framehash_mode_t;
+
+static framehash_mode_t mode = FRAMEHASH_OFF;
+static bool mode_parsed = false;
+
+static bool active = false;
+static char demo_name[9];
+static uint32_t frame_count;
+static uint32_t mismatch_count;
+static int32_t first_mismatch;
+static bool golden_short;           // golden list ended before the demo did
+
+static FIL hash_file;               // record: golden list, check: this run's list
+static bool hash_open = false;
+static FIL raw_file;                // record: golden frames
+static bool raw_open = false;
+static FIL golden_file;             // check: golden list
+static bool golden_open = false;
+
+static void report(const char *fmt, ...) {
+    char line[128];
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(line, sizeof(line), fmt, ap);
+    va_end(ap);
+    fputs(line, stdout);
+}
+
+static void parse_mode(void) {
+    mode_parsed = true;
+    const int p = M_CheckParmWithArgs("-framehash", 1);
+    if (!p) return;
+
+    if (!strcasecmp(myargv[p + 1], "record")) {
+        mode = FRAMEHASH_RECORD;
+    } else if (!strcasecmp(myargv[p + 1], "check")) {
+        mode = FRAMEHASH_CHECK;
+    } else {
+        report("framehash: unknown mode '%s' (record|check)\n", myargv[p + 1]);
+    }
+}
+
+static void to_hex(const sha1_digest_t digest, char *out) {
+    static const char hex[] = "0123456789abcdef";
+    for (int i = 0; i < (int)sizeof(sha1_digest_t); ++i) {
+        out[i * 2] = hex[digest[i] >> 4];
+        out[i * 2 + 1] = hex[digest[i] & 15];
+    }
+    out[DIGEST_HEX] = '\n';
+    out[DIGEST_HEX + 1] = '\0';
+}
+
+static bool open_file(FIL *f, const char *dir, const char *ext, BYTE flags) {
+    char path[40];
+    snprintf(path, sizeof(path), "%s/%s%s", dir, demo_name, ext);
+    if (f_open(f, path, flags) != FR_OK) {
+        report("framehash: cannot open %s\n", path);
+        return false;
+    }
+    return true;
+}
+
+static void close_all(void) {
+    if (hash_open) f_close(&hash_file);
+    if (raw_open) f_close(&raw_file);
+    if (golden_open) f_close(&golden_file);
+    hash_open = raw_open = golden_open = false;
+}
+
+void framehash_demo_start(const char *demo) {
+    if (!mode_parsed) parse_mode();
+    if (mode == FRAMEHASH_OFF) return;
+
+    close_all();
+    snprintf(demo_name, sizeof(demo_name), "%s", demo);
+    frame_count = 0;
+    mismatch_count = 0;
+    first_mismatch = -1;
+    golden_short = false;
+
+    if (mode == FRAMEHASH_RECORD) {
+        f_mkdir(GOLDEN_DIR);
+        hash_open = open_file(&hash_file, GOLDEN_DIR, ".sha1", FA_WRITE | FA_CREATE_ALWAYS);
+        raw_open = open_file(&raw_file, GOLDEN_DIR, ".raw", FA_WRITE | FA_CREATE_ALWAYS);
+        active = hash_open;
+    } else {
+        golden_open = open_file(&golden_file, GOLDEN_DIR, ".sha1", FA_READ);
+        f_mkdir(RESULT_DIR);
+        hash_open = open_file(&hash_file, RESULT_DIR, ".sha1", FA_WRITE | FA_CREATE_ALWAYS);
+        active = golden_open;
+    }
+    if (!active) {
+        close_all();
+    }
+}
+
+// Golden, actual and diff panels side by side, RGB. Golden rows are streamed
+// from golden/<demo>.raw, so nothing frame-sized is buffered.
+static void write_diff(uint32_t frame) {
+    FIL raw, out;
+    if (!open_file(&raw, GOLDEN_DIR, ".raw", FA_READ)) return;
+    if (f_lseek(&raw, (FSIZE_t)frame * FRAME_BYTES) != FR_OK ||
+        f_size(&raw) < (FSIZE_t)(frame + 1) * FRAME_BYTES) {
+        report("framehash: golden/%s.raw has no frame %lu\n", demo_name, (unsigned long)frame);
+        f_close(&raw);
+        return;
+    }
+    if (!open_file(&out, RESULT_DIR, "_diff.ppm", FA_WRITE | FA_CREATE_ALWAYS)) {
+        f_close(&raw);
+        return;
+    }
+
+    char header[32];
+    UINT bw;
+    const int n = snprintf(header, sizeof(header), "P6\n%d %d\n255\n", SCREENWIDTH * 3, SCREENHEIGHT);
+    f_write(&out, header, (UINT)n, &bw);
+
+    static byte golden_row[SCREENWIDTH];
+    static byte rgb_row[SCREENWIDTH * 3 * 3];
+    int x0 = SCREENWIDTH, y0 = SCREENHEIGHT, x1 = -1, y1 = -1;
+    uint32_t differing = 0;
+
+    for (int y = 0; y < SCREENHEIGHT; ++y) {
+        UINT br;
+        if (f_read(&raw, golden_row, SCREENWIDTH, &br) != FR_OK || br != SCREENWIDTH) break;
+        const byte *actual = I_VideoBuffer + y * SCREENWIDTH;
+        byte *g = rgb_row;
+        byte *a = rgb_row + SCREENWIDTH * 3;
+        byte *d = rgb_row + SCREENWIDTH * 6;
+        for (int x = 0; x < SCREENWIDTH; ++x) {
+            const struct color cg = colors[golden_row[x]];
+            const struct color ca = colors[actual[x]];
+            *g++ = cg.r; *g++ = cg.g; *g++ = cg.b;
+            *a++ = ca.r; *a++ = ca.g; *a++ = ca.b;
+            if (golden_row[x] != actual[x]) {
+                *d++ = 255; *d++ = 0; *d++ = 0;
+                differing++;
+                if (x < x0) x0 = x;
+                if (x > x1) x1 = x;
+                if (y < y0) y0 = y;
+                y1 = y;
+            } else {
+                // Dimmed grey of the unchanged picture for orientation.
+                const byte grey = (byte)((ca.r * 77 + ca.g * 150 + ca.b * 29) >> 10);
+                *d++ = grey; *d++ = grey; *d++ = grey;
+            }
+        }
+        f_write(&out, rgb_row, sizeof(rgb_row), &bw);
+    }
+    f_close(&out);
+    f_close(&raw);
+
+    if (differing) {
+        report("framehash: frame %lu: %lu pixels differ in (%d,%d)-(%d,%d), see " RESULT_DIR "/%s_diff.ppm\n",
+               (unsigned long)frame, (unsigned long)differing, x0, y0, x1, y1, demo_name);
+    } else {
+        // Same pixels, different digest: the golden list and frames disagree.
+        report("framehash: frame %lu: pixels match golden/%s.raw, list is stale\n",
+               (unsigned long)frame, demo_name);
+    }
+}
+
+void framehash_frame_end(void) {
+    if (!active) return;
+
+    sha1_context_t ctx;
+    sha1_digest_t digest;
+    char hex[DIGEST_HEX + 2];
+    SHA1_Init(&ctx);
+    SHA1_Update(&ctx, I_VideoBuffer, FRAME_BYTES);
+    SHA1_Final(digest, &ctx);
+    to_hex(digest, hex);
+
+    UINT bw;
+    if (hash_open) {
+        f_write(&hash_file, hex, DIGEST_HEX + 1, &bw);
+    }
+    if (raw_open && (f_write(&raw_file, I_VideoBuffer, FRAME_BYTES, &bw) != FR_OK || bw != FRAME_BYTES)) {
+        report("framehash: golden/%s.raw is full at frame %lu, no more frames stored\n",
+               demo_name, (unsigned long)frame_count);
+        f_close(&raw_file);
+        raw_open = false;
+    }
+
+    if (golden_open && !golden_short) {
+        char line[DIGEST_HEX + 8];
+        if (!f_gets(line, sizeof(line), &golden_file)) {
+            golden_short = true;
+            if (first_mismatch < 0) first_mismatch = (int32_t)frame_count;
+        } else if (strncmp(line, hex, DIGEST_HEX) != 0) {
+            if (first_mismatch < 0) {
+                first_mismatch = (int32_t)frame_count;
+                write_diff(frame_count);
+            }
+            mismatch_count++;
+        }
+    }
+    frame_count++;
+}
+
+void framehash_demo_done(void) {
+    if (!active) return;
+    active = false;
+
+    if (mode == FRAMEHASH_RECORD) {
+        report("framehash,%s,%lu,recorded\n", demo_name, (unsigned long)frame_count);
+    } else {
+        char line[DIGEST_HEX + 8];
+        const bool golden_long = !golden_short && f_gets(line, sizeof(line), &golden_file) != NULL;
+        if (golden_short || golden_long) {
+            report("framehash: %s: golden list has %s frames than the demo\n",
+                   demo_name, golden_short ? "fewer" : "more");
+            if (first_mismatch < 0) first_mismatch = (int32_t)frame_count;
+        }
+        if (first_mismatch < 0) {
+            report("framehash,%s,%lu,match\n", demo_name, (unsigned long)frame_count);
+        } else {
+            report("framehash,%s,%lu,diverged,%ld,%lu\n", demo_name, (unsigned long)frame_count,
+                   (long)first_mismatch, (unsigned long)mismatch_count);
+        }
+    }
+    close_all();
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+// Frame-hash regression harness for renderer changes.
+//
+// Runs alongside a timedemo (-timedemo, or benchmark mode), where singletics
+// gives exactly one D_Display per game tic. After every D_Display the 8-bit
+// I_VideoBuffer is hashed with SHA-1 (sha1.c), so two builds that draw the
+// same pixels produce the same list whatever their speed. Selected with
+// "-framehash <mode>" on the command line or "framehash <mode>" in bench.cfg:
+//
+//   record   write golden/<demo>.sha1 (one hex digest per frame) and
+//            golden/<demo>.raw (every frame, SCREENWIDTH*SCREENHEIGHT bytes)
+//   check    compare against golden/<demo>.sha1, report the first diverging
+//            frame and write bench/<demo>_diff.ppm: golden | actual | diff,
+//            with differing pixels in red. The digests of the run go to
+//            bench/<demo>.sha1 for a plain text diff.
+//
+// Results are printed over the serial console as
+//   framehash,<demo>,<frames>,match
+//   framehash,<demo>,<frames>,diverged,<first frame>,<frames differing>
+// The diff image uses the palette current at the diverging frame for both
+// panels. Keep the profiler overlay hidden while recording or checking.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Engine hooks, all no-ops unless -framehash was given.
+void framehash_demo_start(const char *demo);   // G_DoPlayDemo, timedemo only
+void framehash_frame_end(void);                 // after D_Display
+void framehash_demo_done(void);                 // G_CheckDemoStatus
+
+#ifdef __cplusplus
+}
+#endif
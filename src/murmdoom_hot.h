@@ -0,0 +1,37 @@
+#pragma once
+
+// SRAM placement for the profiled hot set.
+//
+// Code normally executes from QSPI flash through the 16KB XIP cache, which is
+// shared with everything we keep in PSRAM (zone, framebuffer, WAD lumps). The
+// renderer inner loops, the sound mixer and the HDMI scanline IRQ thrash that
+// cache every frame, so they are tagged with __murmdoom_hot() and moved into
+// SRAM at boot:
+//
+//   void __murmdoom_hot(R_DrawColumn) (void) { ... }
+//
+// Each tagged function lands in its own .murmdoom_hot.<name> section.
+// src/murmdoom_hot.ld gathers them into one RAM output section loaded from
+// flash, and murmdoom_hot_init() copies it into place before the engine runs.
+//
+// Configure with -DMURMDOOM_HOT_SRAM=OFF to keep everything in flash (A/B
+// timing), and build the murmdoom_sram_report target to see the SRAM code
+// budget and the list of functions that were copied.
+
+#if defined(MURMDOOM_HOT_SRAM) && (MURMDOOM_HOT_SRAM)
+#define __murmdoom_hot(func) __attribute__((section(".murmdoom_hot." #func))) func
+#else
+#define __murmdoom_hot(func) func
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Copy the hot set from its flash load address into SRAM. Must run before
+// any __murmdoom_hot() function is called (first thing in main()).
+void murmdoom_hot_init(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,205 @@
+/*
+ * Input events between the device drivers and the game loop (see
+ * murmdoom_input.h).
+ */
+#include "d_event.h"
+
+#include "murmdoom_input.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include "murmdoom_console.h"
+
+#define RING_SIZE 64                    // power of two
+
+// Per tic, as the PS/2 and USB wrappers applied them per poll.
+#define MOUSE_SENSITIVITY_MULT 2
+#define MOUSE_MAX_DELTA 40
+
+// Latency buckets: under 0.5 ms, then doubling up to 128 ms and over.
+#define LATENCY_BUCKETS 10
+#define LATENCY_FIRST_US 500
+
+typedef struct {
+    uint32_t time_us;
+    uint8_t pressed;
+    uint8_t key;
+} input_event_t;
+
+static input_event_t ring[RING_SIZE];
+static volatile uint32_t ring_head;     // producers
+static volatile uint32_t ring_tail;     // game loop
+static volatile uint32_t ring_dropped;
+
+// Mouse accumulator, producers and input_tic.
+static volatile int32_t mouse_dx;
+static volatile int32_t mouse_dy;
+static volatile uint8_t mouse_buttons;
+static volatile uint8_t mouse_pressed;  // went down since the last tic
+static volatile uint32_t mouse_time_us; // first report since the last tic
+static volatile bool mouse_pending;
+static uint8_t posted_buttons;
+
+// Events consumed since the last ticcmd, by timestamp.
+static bool measuring;
+static uint32_t waiting[RING_SIZE + 1];
+static uint32_t waiting_count;
+
+static uint32_t latency_hist[LATENCY_BUCKETS];
+static uint32_t latency_count;
+static uint64_t latency_sum_us;
+static uint32_t latency_max_us;
+
+static void latency_reset(void) {
+    memset(latency_hist, 0, sizeof(latency_hist));
+    latency_count = 0;
+    latency_sum_us = 0;
+    latency_max_us = 0;
+    ring_dropped = 0;
+}
+
+static void latency_record(uint32_t us) {
+    uint32_t bucket = 0;
+    while (bucket < LATENCY_BUCKETS - 1 && us >= (uint32_t)LATENCY_FIRST_US << bucket) {
+        bucket++;
+    }
+    latency_hist[bucket]++;
+    latency_count++;
+    latency_sum_us += us;
+    if (us > latency_max_us) latency_max_us = us;
+}
+
+static void input_report(void) {
+    char line[80];
+    const uint32_t avg = latency_count ? (uint32_t)(latency_sum_us / latency_count) : 0;
+    snprintf(line, sizeof(line), "input: %lu events to ticcmd, avg %lu us, max %lu us, %lu dropped\n",
+             (unsigned long)latency_count, (unsigned long)avg, (unsigned long)latency_max_us,
+             (unsigned long)ring_dropped);
+    fputs(line, stdout);
+    for (uint32_t i = 0; i < LATENCY_BUCKETS; i++) {
+        const uint32_t hi_us = (uint32_t)LATENCY_FIRST_US << i;
+        const uint32_t pct = latency_count ? latency_hist[i] * 100u / latency_count : 0;
+        if (i < LATENCY_BUCKETS - 1) {
+            snprintf(line, sizeof(line), "input:   < %6lu us %8lu %3lu%%\n", (unsigned long)hi_us,
+                     (unsigned long)latency_hist[i], (unsigned long)pct);
+        } else {
+            snprintf(line, sizeof(line), "input:  >= %6lu us %8lu %3lu%%\n", (unsigned long)(hi_us / 2),
+                     (unsigned long)latency_hist[i], (unsigned long)pct);
+        }
+        fputs(line, stdout);
+    }
+}
+
+static void input_command(int argc, char **argv) {
+    if (argc > 1 && !strcmp(argv[1], "reset")) {
+        latency_reset();
+        fputs("input: reset\n", stdout);
+    } else {
+        input_report();
+    }
+}
+
+void input_init(void) {
+    latency_reset();
+    waiting_count = 0;
+    measuring = true;
+    murmdoom_console_register("input", "[reset] input-to-ticcmd latency histogram", input_command);
+}
+
+void __not_in_flash_func(input_key)(int pressed, unsigned char key) {
+    const uint32_t now = time_us_32();
+    const uint32_t save = save_and_disable_interrupts();
+    const uint32_t head = ring_head;
+    if (head - ring_tail < RING_SIZE) {
+        input_event_t *e = &ring[head & (RING_SIZE - 1)];
+        e->time_us = now;
+        e->pressed = (uint8_t)pressed;
+        e->key = key;
+        __dmb();
+        ring_head = head + 1;
+    } else {
+        ring_dropped++;
+    }
+    restore_interrupts(save);
+}
+
+void __not_in_flash_func(input_mouse)(int dx, int dy, int buttons) {
+    buttons &= 0x07;
+    if (!dx && !dy && buttons == mouse_buttons) return;
+    const uint32_t now = time_us_32();
+    const uint32_t save = save_and_disable_interrupts();
+    if (!mouse_pending) {
+        mouse_time_us = now;
+        mouse_pending = true;
+    }
+    mouse_dx += dx;
+    mouse_dy += dy;
+    mouse_pressed |= buttons & ~mouse_buttons;
+    mouse_buttons = (uint8_t)buttons;
+    restore_interrupts(save);
+}
+
+int input_get_key(int *pressed, unsigned char *key) {
+    const uint32_t tail = ring_tail;
+    if (tail == ring_head) return 0;
+    __dmb();
+    const input_event_t e = ring[tail & (RING_SIZE - 1)];
+    __dmb();
+    ring_tail = tail + 1;
+
+    *pressed = e.pressed;
+    *key = e.key;
+    if (measuring && waiting_count < count_of(waiting)) {
+        waiting[waiting_count++] = e.time_us;
+    }
+    return 1;
+}
+
+static inline int clamp_delta(int32_t v) {
+    return v > MOUSE_MAX_DELTA ? MOUSE_MAX_DELTA : v < -MOUSE_MAX_DELTA ? -MOUSE_MAX_DELTA : (int)v;
+}
+
+void input_tic(void) {
+    const uint32_t save = save_and_disable_interrupts();
+    const bool pending = mouse_pending;
+    const int32_t dx = mouse_dx;
+    const int32_t dy = mouse_dy;
+    const uint8_t buttons = mouse_buttons | mouse_pressed;
+    const uint32_t time_us = mouse_time_us;
+    mouse_dx = 0;
+    mouse_dy = 0;
+    mouse_pressed = 0;
+    mouse_pending = false;
+    restore_interrupts(save);
+
+    // Nothing moved and the buttons are as posted. A click shorter than a
+    // tic went out as down, so its release still gets a tic of its own.
+    if (!pending && buttons == posted_buttons) return;
+
+    // DOOM expects: data1 = buttons, data2 = X motion (turn), data3 = Y
+    // motion (forward); both drivers report Y positive away from the user.
+    event_t ev;
+    ev.type = ev_mouse;
+    ev.data1 = buttons;
+    ev.data2 = clamp_delta(dx) * MOUSE_SENSITIVITY_MULT;
+    ev.data3 = clamp_delta(dy) * MOUSE_SENSITIVITY_MULT;
+    ev.data4 = 0;
+    D_PostEvent(&ev);
+    posted_buttons = buttons;
+
+    if (pending && measuring && waiting_count < count_of(waiting)) {
+        waiting[waiting_count++] = time_us;
+    }
+}
+
+void input_ticcmd(void) {
+    if (!waiting_count) return;
+    const uint32_t now = time_us_32();
+    for (uint32_t i = 0; i < waiting_count; i++) {
+        latency_record(now - waiting[i]);
+    }
+    waiting_count = 0;
+}
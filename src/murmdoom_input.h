@@ -0,0 +1,42 @@
+#pragma once
+
+// Input events between the device drivers and the game loop.
+//
+// Key events go into a fixed ring as they arrive, stamped with time_us_32():
+// the PS/2 keyboard from its PIO RX interrupt, USB keyboards from the
+// TinyUSB report callback (which runs inside tuh_task(), still polled from
+// DG_GetKey). I_GetEvent drains the ring through DG_GetKey. Nothing
+// allocates. All producers run on core 0 and mask interrupts for the few
+// instructions a push takes, so a callback in thread context and the PS/2
+// interrupt can share the ring; the game loop pops without locking.
+//
+// Mouse motion is not queued. The PS/2 mouse (from its clock-line GPIO
+// interrupt) and USB mice add their deltas to one accumulator, and
+// BuildNewTic turns it into a single ev_mouse per tic (input_tic), clamped
+// and scaled as the drivers used to do per poll. A button pressed and
+// released within one tic is still seen down for that tic.
+//
+// Latency is measured from each event's timestamp to the ticcmd built after
+// it was consumed (input_ticcmd): key events from the interrupt or callback
+// that queued them, mouse motion from the first report that went into the
+// tic. "input" on the serial console prints the histogram, "input reset"
+// clears it.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void input_init(void);                  // I_InitInput; starts measuring
+
+// Producers, from interrupt or thread context on core 0.
+void input_key(int pressed, unsigned char key);
+void input_mouse(int dx, int dy, int buttons);
+
+// Game loop.
+int input_get_key(int *pressed, unsigned char *key);
+void input_tic(void);                   // BuildNewTic, after I_StartTic
+void input_ticcmd(void);                // BuildNewTic, ticcmd built
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,115 @@
+/*
+ * Uncapped, interpolated rendering (see murmdoom_interp.h).
+ */
+#include "doomstat.h"
+#include "d_loop.h"
+#include "i_timer.h"
+#include "m_argv.h"
+#include "p_local.h"
+#include "r_state.h"
+
+#include "murmdoom_interp.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+
+#include "murmdoom_console.h"
+
+int murmdoom_uncapped = 0;
+// -uncapped: for this session only, not written back to the config.
+static boolean uncapped_param = false;
+
+fixed_t interp_frac = FRACUNIT;
+int interp_valid_tic = -1;
+
+static void uncapped_command(int argc, char **argv) {
+    if (argc > 1) {
+        if (!strcasecmp(argv[1], "on") || !strcmp(argv[1], "1")) {
+            murmdoom_uncapped = 1;
+        } else if (!strcasecmp(argv[1], "off") || !strcmp(argv[1], "0")) {
+            murmdoom_uncapped = 0;
+            uncapped_param = false;
+        } else {
+            fputs("usage: uncapped [on|off]\n", stdout);
+            return;
+        }
+    }
+    fputs(murmdoom_uncapped || uncapped_param ? "uncapped: on\n" : "uncapped: off\n", stdout);
+}
+
+void interp_init(void) {
+    uncapped_param = M_CheckParm("-uncapped") > 0;
+    murmdoom_console_register("uncapped", "[on|off] interpolated rendering at the refresh rate",
+                              uncapped_command);
+}
+
+boolean interp_uncapped(void) {
+    return (murmdoom_uncapped || uncapped_param) && !singletics;
+}
+
+void interp_store_tic(void) {
+    if (!interp_uncapped()) return;
+
+    // gametic is incremented once this tic has run.
+    interp_valid_tic = gametic + 1;
+
+    for (thinker_t *th = thinkercap.next; th != &thinkercap; th = th->next) {
+        if (th->function.acp1 != (actionf_p1)P_MobjThinker) continue;
+        mobj_t *mo = (mobj_t *)th;
+        mo->oldx = mo->x;
+        mo->oldy = mo->y;
+        mo->oldz = mo->z;
+        mo->oldangle = mo->angle;
+        mo->interp_tic = interp_valid_tic;
+    }
+
+    for (int i = 0; i < MAXPLAYERS; ++i) {
+        if (playeringame[i]) {
+            players[i].oldviewz = players[i].viewz;
+        }
+    }
+
+    for (int i = 0; i < numsectors; ++i) {
+        sectors[i].oldfloorheight = sectors[i].floorheight;
+        sectors[i].oldceilingheight = sectors[i].ceilingheight;
+    }
+}
+
+void interp_begin_frame(void) {
+    interp_frac = FRACUNIT;
+
+    // Only straight after a tic that stored its start state; not while the
+    // game is paused or a menu holds it.
+    if (!interp_uncapped() || interp_valid_tic != gametic || paused ||
+        (!netgame && menuactive && !demoplayback)) {
+        return;
+    }
+
+    // I_GetTime() counts tics as ms * TICRATE / 1000; the remainder is how
+    // far real time has moved into the next one.
+    const uint64_t ms = (uint32_t)I_GetTimeMS();
+    interp_frac = (fixed_t)(((ms * TICRATE) % 1000) * FRACUNIT / 1000);
+
+    for (int i = 0; i < numsectors; ++i) {
+        sector_t *sec = &sectors[i];
+        sec->tickfloorheight = sec->floorheight;
+        sec->tickceilingheight = sec->ceilingheight;
+        if (sec->oldfloorheight != sec->floorheight) {
+            sec->floorheight = interp_fixed(sec->oldfloorheight, sec->floorheight);
+        }
+        if (sec->oldceilingheight != sec->ceilingheight) {
+            sec->ceilingheight = interp_fixed(sec->oldceilingheight, sec->ceilingheight);
+        }
+    }
+}
+
+void interp_end_frame(void) {
+    if (interp_frac == FRACUNIT) return;
+
+    for (int i = 0; i < numsectors; ++i) {
+        sectors[i].floorheight = sectors[i].tickfloorheight;
+        sectors[i].ceilingheight = sectors[i].tickceilingheight;
+    }
+    interp_frac = FRACUNIT;
+}
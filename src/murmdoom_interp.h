@@ -0,0 +1,79 @@
+#pragma once
+
+// Uncapped, interpolated rendering.
+//
+// The game still simulates at TICRATE (35 Hz). With uncapped rendering on,
+// TryRunTics returns instead of sleeping when no tic is due, so D_Display
+// runs as often as the frame can be drawn, and frames are presented on vsync
+// (murmdoom_present.h). Each frame is drawn at the sub-tic position of real
+// time between the state before and after the last tic:
+//
+//   - mobjs: x, y, z and angle (R_ProjectSprite, and the view in R_SetupFrame)
+//   - the view height of the displayed player
+//   - sector floor and ceiling heights, swapped in for the duration of
+//     R_RenderPlayerView and restored afterwards
+//
+// The start-of-tic state is copied at the top of every P_Ticker that runs.
+// Things spawned or teleported during the tic have no valid copy and are
+// drawn where they are. Paused games, menus, wipes and timedemos (singletics)
+// render the current state exactly as before.
+//
+// Enabled by the config variable murmdoom_uncapped, "-uncapped" on the
+// command line or "uncapped on|off" on the serial console.
+
+#include "m_fixed.h"
+#include "p_mobj.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern int murmdoom_uncapped;
+
+// Fraction of a tic that real time has advanced past the last tic, while
+// the frame being drawn is interpolated.
+extern fixed_t interp_frac;
+// Stamp of the last start-of-tic copy; a mobj's old position is valid if its
+// interp_tic matches and interp_frac is in use.
+extern int interp_valid_tic;
+
+void interp_init(void);             // D_DoomMain, after the config is loaded
+// True when uncapped rendering is on and allowed (not a timedemo).
+boolean interp_uncapped(void);
+
+void interp_store_tic(void);        // P_Ticker, before anything moves
+void interp_begin_frame(void);      // R_RenderPlayerView, before R_SetupFrame
+void interp_end_frame(void);        // R_RenderPlayerView, after drawing
+
+// Forget the old position, e.g. after a teleport.
+static inline void interp_reset_mobj(mobj_t *mo) {
+    mo->interp_tic = 0;
+}
+
+static inline fixed_t interp_fixed(fixed_t old, fixed_t cur) {
+    return old + FixedMul(cur - old, interp_frac);
+}
+
+// Shortest way round; angle_t wraps, so plain subtraction does the right thing.
+static inline angle_t interp_angle(angle_t old, angle_t cur) {
+    return old + (angle_t)FixedMul((fixed_t)(cur - old), interp_frac);
+}
+
+// Position of `mo` for the frame being drawn.
+static inline void interp_mobj(const mobj_t *mo, fixed_t *x, fixed_t *y, fixed_t *z, angle_t *angle) {
+    if (mo->interp_tic == interp_valid_tic && interp_frac != FRACUNIT) {
+        *x = interp_fixed(mo->oldx, mo->x);
+        *y = interp_fixed(mo->oldy, mo->y);
+        *z = interp_fixed(mo->oldz, mo->z);
+        *angle = interp_angle(mo->oldangle, mo->angle);
+    } else {
+        *x = mo->x;
+        *y = mo->y;
+        *z = mo->z;
+        *angle = mo->angle;
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,381 @@
+/*
+ * Level loading ahead of P_SetupLevel (see murmdoom_levelload.h).
+ */
+#include "doomdata.h"
+#include "doomstat.h"
+#include "i_swap.h"
+#include "i_video.h"
+#include "info.h"
+#include "r_data.h"
+#include "v_video.h"
+#include "w_wad.h"
+#include "z_zone.h"
+
+#include "murmdoom_levelload.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+
+#include "pico/stdlib.h"
+#include "murmdoom_console.h"
+
+// Read-ahead per intermission tic; one lump may overrun it.
+#define SLICE_US 8000
+// THINGS to BLOCKMAP.
+#define MAP_LUMPS (ML_BLOCKMAP - ML_THINGS + 1)
+// Left free for the new level's own allocations.
+#define ZONE_MARGIN (512 * 1024)
+// Progress bar along the bottom of the intermission.
+#define BAR_HEIGHT 2
+#define BAR_COLOR 4
+
+typedef enum {
+    PF_IDLE,
+    PF_MAPLUMPS,
+    PF_SCAN_SECTORS,
+    PF_SCAN_SIDEDEFS,
+    PF_SCAN_THINGS,
+    PF_FLATS,
+    PF_TEXTURES,
+    PF_SPRITES,
+    PF_DONE
+} prefetch_state_t;
+
+typedef struct {
+    uint32_t setup_us;
+    uint32_t ahead_us;
+    uint32_t ahead_bytes;
+} part_stats_t;
+
+static const char *const part_names[LL_NUMPARTS] = {
+    "things", "linedefs", "sidedefs", "vertexes", "segs", "ssectors", "nodes", "sectors",
+    "reject", "blockmap", "grouplines", "specials", "flats", "textures", "sprites",
+};
+
+// Read-ahead
+static prefetch_state_t pf_state = PF_IDLE;
+static char pf_name[9];
+static int pf_map;                  // lump of the map's label
+static int pf_i, pf_j;              // cursors of the current state
+static byte *flat_present;
+static byte *texture_present;
+static byte *sprite_present;
+static uint32_t pf_budget;          // bytes the zone can spare
+static uint32_t pf_bytes;           // ... and read so far
+static uint32_t pf_total;           // graphics lumps found by the scans
+static uint32_t pf_done;            // ... and walked so far
+static uint32_t pf_start_us;
+
+// The last level
+static char level_name[9];
+static part_stats_t stats[LL_NUMPARTS];
+static uint32_t ahead_total_us;     // intermission time the read-ahead covered
+static uint32_t setup_us;
+static uint32_t begin_us;
+static uint32_t mark_us;
+
+static void free_present(void) {
+    if (flat_present) Z_Free(flat_present);
+    if (texture_present) Z_Free(texture_present);
+    if (sprite_present) Z_Free(sprite_present);
+    flat_present = texture_present = sprite_present = NULL;
+}
+
+static void prefetch_stop(void) {
+    if (pf_state != PF_IDLE && pf_state != PF_DONE) {
+        ahead_total_us = time_us_32() - pf_start_us;
+    }
+    free_present();
+    pf_state = PF_DONE;
+}
+
+static void level_name_for(char *name, int episode, int map) {
+    if (gamemode == commercial) {
+        snprintf(name, 9, "MAP%02d", map);
+    } else {
+        snprintf(name, 9, "E%dM%d", episode, map);
+    }
+}
+
+void levelload_prefetch_start(int episode, int map) {
+    free_present();
+    pf_state = PF_IDLE;
+    level_name_for(pf_name, episode, map);
+    pf_map = W_CheckNumForName(pf_name);
+    if (pf_map < 0 || pf_map + ML_BLOCKMAP >= (int)numlumps) return;
+
+    memset(stats, 0, sizeof(stats));
+    ahead_total_us = 0;
+    // P_LoadBlockMap copies the blockmap out of its cached lump, so both are
+    // in the zone for a moment on top of the margin.
+    const int free_bytes = Z_FreeMemory();
+    const int margin = ZONE_MARGIN + W_LumpLength(pf_map + ML_BLOCKMAP);
+    pf_budget = free_bytes > margin ? (uint32_t)(free_bytes - margin) : 0;
+    pf_i = ML_THINGS;
+    pf_bytes = pf_total = pf_done = 0;
+    pf_start_us = time_us_32();
+    pf_state = PF_MAPLUMPS;
+}
+
+// Reads lump into the cache. Returns false once the zone has no room left.
+static boolean fetch(int lump, levelload_part_t part) {
+    if (lumpinfo[lump].cache) return true;
+    part_stats_t *s = &stats[part];
+    const uint32_t size = W_LumpLength(lump);
+    if (pf_bytes + size > pf_budget) return false;
+
+    const uint32_t t0 = time_us_32();
+    W_CacheLumpNum(lump, PU_CACHE);
+    s->ahead_us += time_us_32() - t0;
+    s->ahead_bytes += size;
+    pf_bytes += size;
+    return true;
+}
+
+static void scan_sectors(void) {
+    const int lump = pf_map + ML_SECTORS;
+    const int count = W_LumpLength(lump) / sizeof(mapsector_t);
+    const mapsector_t *ms = W_CacheLumpNum(lump, PU_STATIC);
+    flat_present = Z_Malloc(numflats, PU_STATIC, NULL);
+    memset(flat_present, 0, numflats);
+    for (int i = 0; i < count; i++, ms++) {
+        const int floor = W_CheckNumForName((char *)ms->floorpic) - firstflat;
+        const int ceiling = W_CheckNumForName((char *)ms->ceilingpic) - firstflat;
+        if (floor >= 0 && floor < numflats) flat_present[floor] = 1;
+        if (ceiling >= 0 && ceiling < numflats) flat_present[ceiling] = 1;
+    }
+    W_ReleaseLumpNum(lump);
+    for (int i = 0; i < numflats; i++) pf_total += flat_present[i];
+}
+
+static void scan_sidedefs(void) {
+    const int lump = pf_map + ML_SIDEDEFS;
+    const int count = W_LumpLength(lump) / sizeof(mapsidedef_t);
+    const mapsidedef_t *msd = W_CacheLumpNum(lump, PU_STATIC);
+    texture_present = Z_Malloc(numtextures, PU_STATIC, NULL);
+    memset(texture_present, 0, numtextures);
+    for (int i = 0; i < count; i++, msd++) {
+        const int top = R_CheckTextureNumForName((char *)msd->toptexture);
+        const int mid = R_CheckTextureNumForName((char *)msd->midtexture);
+        const int bottom = R_CheckTextureNumForName((char *)msd->bottomtexture);
+        if (top >= 0) texture_present[top] = 1;
+        if (mid >= 0) texture_present[mid] = 1;
+        if (bottom >= 0) texture_present[bottom] = 1;
+    }
+    W_ReleaseLumpNum(lump);
+    for (int i = 0; i < numtextures; i++) {
+        if (!texture_present[i]) continue;
+        for (int j = 0; R_TexturePatchLump(i, j) >= 0; j++) pf_total++;
+    }
+}
+
+// Sprites of the things' spawn states; the player is always there.
+static void scan_things(void) {
+    const int lump = pf_map + ML_THINGS;
+    const int count = W_LumpLength(lump) / sizeof(mapthing_t);
+    const mapthing_t *mt = W_CacheLumpNum(lump, PU_STATIC);
+    sprite_present = Z_Malloc(numsprites, PU_STATIC, NULL);
+    memset(sprite_present, 0, numsprites);
+    sprite_present[states[mobjinfo[MT_PLAYER].spawnstate].sprite] = 1;
+    for (int i = 0; i < count; i++, mt++) {
+        const int type = SHORT(mt->type);
+        for (int j = 0; j < NUMMOBJTYPES; j++) {
+            if (mobjinfo[j].doomednum == type) {
+                sprite_present[states[mobjinfo[j].spawnstate].sprite] = 1;
+                break;
+            }
+        }
+    }
+    W_ReleaseLumpNum(lump);
+    for (int i = 0; i < numsprites; i++) {
+        if (sprite_present[i]) pf_total += sprites[i].numframes * 8;
+    }
+}
+
+// Next graphics lump of the current state, or -1 when it has none left.
+static int next_lump(void) {
+    switch (pf_state) {
+    case PF_FLATS:
+        while (pf_i < numflats && !flat_present[pf_i]) pf_i++;
+        return pf_i < numflats ? firstflat + pf_i++ : -1;
+
+    case PF_TEXTURES:
+        for (; pf_i < numtextures; pf_i++, pf_j = 0) {
+            if (!texture_present[pf_i]) continue;
+            const int lump = R_TexturePatchLump(pf_i, pf_j);
+            if (lump >= 0) {
+                pf_j++;
+                return lump;
+            }
+        }
+        return -1;
+
+    case PF_SPRITES:
+        for (; pf_i < numsprites; pf_i++, pf_j = 0) {
+            if (!sprite_present[pf_i]) continue;
+            while (pf_j < sprites[pf_i].numframes * 8) {
+                const spriteframe_t *sf = &sprites[pf_i].spriteframes[pf_j / 8];
+                const int lump = sf->lump[pf_j++ % 8];
+                if (lump >= 0) return firstspritelump + lump;
+                pf_done++;
+            }
+        }
+        return -1;
+
+    default:
+        return -1;
+    }
+}
+
+// One lump read or one scan. Returns false when there is nothing left.
+static boolean prefetch_one(void) {
+    uint32_t t0;
+
+    switch (pf_state) {
+    case PF_MAPLUMPS:
+        if (!fetch(pf_map + pf_i, (levelload_part_t)(LL_THINGS + pf_i - ML_THINGS))) break;
+        if (++pf_i > ML_BLOCKMAP) pf_state = PF_SCAN_SECTORS;
+        return true;
+
+    case PF_SCAN_SECTORS:
+        t0 = time_us_32();
+        scan_sectors();
+        stats[LL_FLATS].ahead_us += time_us_32() - t0;
+        pf_state = PF_SCAN_SIDEDEFS;
+        return true;
+
+    case PF_SCAN_SIDEDEFS:
+        t0 = time_us_32();
+        scan_sidedefs();
+        stats[LL_TEXTURES].ahead_us += time_us_32() - t0;
+        pf_state = PF_SCAN_THINGS;
+        return true;
+
+    case PF_SCAN_THINGS:
+        t0 = time_us_32();
+        scan_things();
+        stats[LL_SPRITES].ahead_us += time_us_32() - t0;
+        pf_state = PF_FLATS;
+        pf_i = pf_j = 0;
+        return true;
+
+    case PF_FLATS:
+    case PF_TEXTURES:
+    case PF_SPRITES: {
+        // Lumps already in the cache (shared patches, unrotated sprite
+        // frames) cost nothing; carry on until one is actually read.
+        const levelload_part_t part = pf_state == PF_FLATS      ? LL_FLATS
+                                      : pf_state == PF_TEXTURES ? LL_TEXTURES
+                                                                : LL_SPRITES;
+        int lump;
+        while ((lump = next_lump()) >= 0) {
+            pf_done++;
+            const boolean cached = lumpinfo[lump].cache != NULL;
+            if (!fetch(lump, part)) return false;
+            if (!cached) return true;
+        }
+        if (pf_state == PF_SPRITES) break;
+        pf_state = pf_state == PF_FLATS ? PF_TEXTURES : PF_SPRITES;
+        pf_i = pf_j = 0;
+        return true;
+    }
+
+    default:
+        break;
+    }
+    return false;
+}
+
+void levelload_prefetch_step(void) {
+    if (pf_state == PF_IDLE || pf_state == PF_DONE) return;
+    const uint32_t start = time_us_32();
+    do {
+        if (!prefetch_one()) {
+            prefetch_stop();
+            return;
+        }
+    } while (time_us_32() - start < SLICE_US);
+}
+
+void levelload_drawer(void) {
+    if (pf_state == PF_IDLE || pf_state == PF_DONE) return;
+    // A quarter for the map lumps and scans, the rest for the graphics.
+    int progress;
+    if (pf_state < PF_FLATS) {
+        const int steps = pf_state == PF_MAPLUMPS ? pf_i - ML_THINGS : MAP_LUMPS + pf_state - PF_SCAN_SECTORS;
+        progress = steps * (SCREENWIDTH / 4) / (MAP_LUMPS + 3);
+    } else {
+        progress = SCREENWIDTH / 4 + (int)((uint64_t)pf_done * (SCREENWIDTH * 3 / 4) / (pf_total ? pf_total : 1));
+    }
+    if (progress > 0) {
+        V_DrawFilledBox(0, SCREENHEIGHT - BAR_HEIGHT, progress, BAR_HEIGHT, BAR_COLOR);
+    }
+}
+
+void levelload_begin(const char *lumpname) {
+    // Whatever was read ahead stays in the cache for this load.
+    prefetch_stop();
+    if (strcasecmp(lumpname, pf_name)) {
+        memset(stats, 0, sizeof(stats));
+        ahead_total_us = 0;
+    }
+    pf_name[0] = '\0';
+    for (int i = 0; i < LL_NUMPARTS; i++) stats[i].setup_us = 0;
+    snprintf(level_name, sizeof(level_name), "%s", lumpname);
+    begin_us = mark_us = time_us_32();
+}
+
+void levelload_mark(levelload_part_t part) {
+    const uint32_t now = time_us_32();
+    stats[part].setup_us += now - mark_us;
+    mark_us = now;
+}
+
+static uint32_t ahead_bytes_total(void) {
+    uint32_t total = 0;
+    for (int i = 0; i < LL_NUMPARTS; i++) total += stats[i].ahead_bytes;
+    return total;
+}
+
+// Tenths of a millisecond, for the table.
+static void format_ms(char *buf, size_t size, uint32_t us) {
+    snprintf(buf, size, "%lu.%lu", (unsigned long)(us / 1000), (unsigned long)(us / 100 % 10));
+}
+
+void levelload_end(void) {
+    char line[96];
+    setup_us = time_us_32() - begin_us;
+    snprintf(line, sizeof(line), "levelload: %s set up in %lu ms, %lu KB read ahead\n", level_name,
+             (unsigned long)(setup_us / 1000), (unsigned long)(ahead_bytes_total() / 1024));
+    fputs(line, stdout);
+}
+
+static void levelload_command(int argc, char **argv) {
+    (void)argc;
+    (void)argv;
+    char line[96];
+    if (!level_name[0]) {
+        fputs("levelload: no level loaded yet\n", stdout);
+        return;
+    }
+    snprintf(line, sizeof(line), "levelload: %s set up in %lu ms; %lu KB read ahead in %lu ms\n", level_name,
+             (unsigned long)(setup_us / 1000), (unsigned long)(ahead_bytes_total() / 1024),
+             (unsigned long)(ahead_total_us / 1000));
+    fputs(line, stdout);
+    fputs("levelload:   part         setup ms  ahead ms  ahead KB\n", stdout);
+    for (int i = 0; i < LL_NUMPARTS; i++) {
+        const part_stats_t *s = &stats[i];
+        char setup[16], ahead[16];
+        format_ms(setup, sizeof(setup), s->setup_us);
+        format_ms(ahead, sizeof(ahead), s->ahead_us);
+        snprintf(line, sizeof(line), "levelload:   %-10s %10s %9s %9lu\n", part_names[i], setup, ahead,
+                 (unsigned long)(s->ahead_bytes / 1024));
+        fputs(line, stdout);
+    }
+}
+
+void levelload_init(void) {
+    murmdoom_console_register("levelload", "level load time per lump type, and what was read ahead",
+                              levelload_command);
+}
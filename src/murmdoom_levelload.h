@@ -0,0 +1,68 @@
+#pragma once
+
+// Level loading ahead of P_SetupLevel, and where its time goes.
+//
+// The WAD is read from the SD card through FatFs, one lump at a time, and
+// P_SetupLevel followed by R_PrecacheLevel would otherwise read the whole
+// next map and every flat, wall patch and sprite it uses in one go, with the
+// screen frozen on the last intermission frame. Instead, WI_Start names the
+// next map (levelload_prefetch_start) and every intermission tic spends up to
+// a slice of its time (levelload_prefetch_step) reading ahead, one lump per
+// step, into the zone at PU_CACHE:
+//
+//   1. the map lumps, THINGS to BLOCKMAP
+//   2. SECTORS, SIDEDEFS and THINGS are scanned for the flats, wall
+//      textures and sprites the map uses
+//   3. those flats, the patches of those textures and every frame of those
+//      sprites
+//
+// A thin bar along the bottom of the intermission shows how far it got.
+// P_SetupLevel itself is unchanged and still runs in one tic, but its
+// W_CacheLumpNum calls (and R_PrecacheLevel's) find the lumps in the cache
+// instead of on the card. Skipping the intermission early just leaves more
+// to read then. Prefetching stops short of the zone's free and purgeable
+// memory, so it never pushes out the lumps it read itself.
+//
+// P_SetupLevel and R_PrecacheLevel time each part (levelload_mark) and
+// "levelload" on the serial console prints the breakdown for the last
+// level: setup time per lump type, and what was read ahead for it.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Parts of a level load; the map lumps are in ML_THINGS order.
+typedef enum {
+    LL_THINGS,
+    LL_LINEDEFS,
+    LL_SIDEDEFS,
+    LL_VERTEXES,
+    LL_SEGS,
+    LL_SSECTORS,
+    LL_NODES,
+    LL_SECTORS,
+    LL_REJECT,
+    LL_BLOCKMAP,
+    LL_GROUPLINES,
+    LL_SPECIALS,
+    LL_FLATS,
+    LL_TEXTURES,
+    LL_SPRITES,
+    LL_NUMPARTS
+} levelload_part_t;
+
+void levelload_init(void);                          // D_DoomMain
+
+// Intermission.
+void levelload_prefetch_start(int episode, int map); // WI_Start, 1-based
+void levelload_prefetch_step(void);                  // WI_Ticker
+void levelload_drawer(void);                         // WI_Drawer
+
+// P_SetupLevel and R_PrecacheLevel. begin() ends any prefetch still running.
+void levelload_begin(const char *lumpname);
+void levelload_mark(levelload_part_t part);          // part just finished
+void levelload_end(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,144 @@
+/*
+ * Row-major copies of patches (see murmdoom_patchspan.h).
+ */
+#include "murmdoom_patchspan.h"
+
+#include <string.h>
+
+#include "i_swap.h"
+#include "i_video.h"
+
+#define SPAN_END 0xffff
+
+static const column_t *first_post(const patch_t *patch, int col) {
+    return (const column_t *)((const byte *)patch + LONG(patch->columnofs[col]));
+}
+
+static const column_t *next_post(const column_t *post) {
+    return (const column_t *)((const byte *)post + post->length + 4);
+}
+
+static byte *put16(byte *out, int v) {
+    out[0] = (byte)v;
+    out[1] = (byte)(v >> 8);
+    return out + 2;
+}
+
+// Rows down to the bottom of the lowest post, or 0 if the span form cannot
+// reproduce the column loop.
+static int span_rows(const patch_t *patch) {
+    const int w = SHORT(patch->width);
+    int rows = 0;
+
+    if (w <= 0 || w > SCREENWIDTH) {
+        return 0;
+    }
+    for (int col = 0; col < w; col++) {
+        int bottom = 0;
+        for (const column_t *post = first_post(patch, col); post->topdelta != 0xff; post = next_post(post)) {
+            if (post->topdelta < bottom) {
+                return 0;
+            }
+            bottom = post->topdelta + post->length;
+        }
+        if (bottom > rows) {
+            rows = bottom;
+        }
+    }
+    return rows;
+}
+
+// Walk the patch row by row with one post cursor per column. Returns the
+// size of the span form; writes it too if out is not NULL.
+static int walk(const patch_t *patch, int rows, byte *out) {
+    const column_t *post[SCREENWIDTH];
+    const int w = SHORT(patch->width);
+    int size = 2;
+
+    for (int col = 0; col < w; col++) {
+        post[col] = first_post(patch, col);
+    }
+    if (out) {
+        out = put16(out, rows);
+    }
+
+    for (int y = 0; y < rows; y++) {
+        int col = 0;
+        while (col < w) {
+            // Skip to the next column with a post covering this row.
+            const column_t *p = post[col];
+            while (p->topdelta != 0xff && p->topdelta + p->length <= y) {
+                p = next_post(p);
+            }
+            post[col] = p;
+            if (p->topdelta == 0xff || p->topdelta > y) {
+                col++;
+                continue;
+            }
+
+            const int start = col;
+            byte *pixels = out ? out + 4 : NULL;
+            do {
+                if (pixels) {
+                    *pixels++ = ((const byte *)p)[3 + y - p->topdelta];
+                }
+                if (++col == w) {
+                    break;
+                }
+                p = post[col];
+                while (p->topdelta != 0xff && p->topdelta + p->length <= y) {
+                    p = next_post(p);
+                }
+                post[col] = p;
+            } while (p->topdelta != 0xff && p->topdelta <= y);
+
+            size += 4 + (col - start);
+            if (out) {
+                put16(out, start);
+                put16(out + 2, col - start);
+                out = pixels;
+            }
+        }
+        size += 2;
+        if (out) {
+            out = put16(out, SPAN_END);
+        }
+    }
+    return size;
+}
+
+int patchspan_size(const patch_t *patch) {
+    const int rows = span_rows(patch);
+    return rows ? walk(patch, rows, NULL) : 0;
+}
+
+void patchspan_build(const patch_t *patch, byte *spans) {
+    walk(patch, span_rows(patch), spans);
+}
+
+void patchspan_draw(const byte *spans, byte *dest, int pitch) {
+    int rows = spans[0] | spans[1] << 8;
+    const byte *p = spans + 2;
+
+    for (; rows > 0; rows--, dest += pitch) {
+        for (;;) {
+            const int x = p[0] | p[1] << 8;
+            if (x == SPAN_END) {
+                p += 2;
+                break;
+            }
+            int length = p[2] | p[3] << 8;
+            const byte *src = p + 4;
+            p = src + length;
+            // Glyph strokes are a few pixels wide; a call costs more.
+            if (length < 8) {
+                byte *d = dest + x;
+                while (length--) {
+                    *d++ = *src++;
+                }
+            } else {
+                memcpy(dest + x, src, length);
+            }
+        }
+    }
+}
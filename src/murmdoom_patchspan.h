@@ -0,0 +1,41 @@
+#pragma once
+
+// Row-major copies of patches for V_DrawPatch.
+//
+// A patch is stored column by column, so drawing it walks down the screen one
+// byte per line: every byte lands on a different PSRAM cache line, and a
+// full-screen picture touches each line of the framebuffer 320 times over.
+// The span form holds the same pixels row by row, as runs of opaque pixels
+// with the transparent gaps left out:
+//
+//   u16 rows
+//   per row:  { u16 x, u16 length, length pixels } ... u16 0xffff
+//
+// Drawing is then one memcpy per run, left to right, top to bottom. Rows run
+// to the bottom of the lowest post, which may lie below the patch height, as
+// the column loop draws it.
+//
+// Patches whose posts overlap or are out of order (where the column loop's
+// last post wins) and patches wider than the screen have no span form.
+//
+// V_DrawPatch keeps the span forms in the zone at PU_CACHE, keyed by patch
+// (v_video.c). host/bench_patch_draw times menu and intermission frames
+// drawn both ways.
+
+#include "doomtype.h"
+#include "v_patch.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Bytes of the span form of patch, or 0 if it has none.
+int patchspan_size(const patch_t *patch);
+// Fill spans (patchspan_size bytes).
+void patchspan_build(const patch_t *patch, byte *spans);
+// Draw with the top left at dest, rows pitch bytes apart.
+void patchspan_draw(const byte *spans, byte *dest, int pitch);
+
+#ifdef __cplusplus
+}
+#endif
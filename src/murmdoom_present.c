@@ -0,0 +1,246 @@
+/*
+ * Frame presentation and pacing (see murmdoom_present.h).
+ */
+#include "murmdoom_present.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+
+#include "pico/stdlib.h"
+#include "HDMI.h"
+#include "doomgeneric.h"
+#include "psram_allocator.h"
+#include "murmdoom_console.h"
+
+#define SCREEN_BYTES (DOOMGENERIC_RESX * DOOMGENERIC_RESY * sizeof(pixel_t))
+
+// Cost estimate: EWMA weights of 1/8 for the mean and the mean deviation.
+#define COST_SHIFT 3
+// Slack on top of mean + 2 deviations before a just-in-time start.
+#define SCHED_MARGIN_US 500
+
+int murmdoom_vsync = 1;
+
+static pixel_t *buffers[2];
+static bool frame_vsync = false;
+
+// Scheduler
+static uint32_t cost_us;            // EWMA of the frame cost
+static uint32_t cost_dev_us;        // EWMA of |cost - cost_us|
+static bool have_cost = false;
+
+// Pacing
+static uint32_t frame_start_us;
+static uint32_t wait_us;            // spent waiting for a flip this frame
+static uint32_t budget_us;
+static uint32_t window_start_us;
+static uint32_t frames;
+static uint32_t dropped;
+static uint32_t over_budget;
+static uint64_t render_total_us;
+static uint32_t render_max_us;
+static uint32_t last_flip_vsync;
+static bool have_flip;
+static uint64_t sched_idle_us;      // slept before just-in-time starts
+// Present-to-present interval, for the frame-time variance.
+static uint32_t last_present_us;
+static bool have_present;
+static uint32_t intervals;
+static uint64_t interval_sum;
+static uint64_t interval_sq_sum;
+
+static void pacing_reset(void) {
+    window_start_us = time_us_32();
+    frames = 0;
+    dropped = 0;
+    over_budget = 0;
+    render_total_us = 0;
+    render_max_us = 0;
+    have_flip = false;
+    sched_idle_us = 0;
+    have_present = false;
+    intervals = 0;
+    interval_sum = 0;
+    interval_sq_sum = 0;
+}
+
+static uint32_t isqrt64(uint64_t v) {
+    uint64_t r = 0;
+    uint64_t bit = (uint64_t)1 << 62;
+    while (bit > v) bit >>= 2;
+    while (bit) {
+        if (v >= r + bit) {
+            v -= r + bit;
+            r = (r >> 1) + bit;
+        } else {
+            r >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)r;
+}
+
+// Any interrupt, or the SEV from the vsync handler, ends a WFE; the HDMI
+// line interrupt alone bounds the oversleep to a few tens of microseconds.
+static void wait_until_us(uint32_t t) {
+    while ((int32_t)(t - time_us_32()) > 0) {
+        __wfe();
+    }
+}
+
+void present_report(void) {
+    const uint32_t elapsed_us = time_us_32() - window_start_us;
+    const uint32_t fps_x10 = elapsed_us ? (uint32_t)((uint64_t)frames * 10000000u / elapsed_us) : 0;
+    printf("pacing: %s, %lu frames in %lu ms, %lu.%lu fps, %lu vblanks dropped\n",
+           frame_vsync ? "vsync" : "immediate", (unsigned long)frames,
+           (unsigned long)(elapsed_us / 1000), (unsigned long)(fps_x10 / 10),
+           (unsigned long)(fps_x10 % 10), (unsigned long)dropped);
+    printf("pacing: render avg %lu us, max %lu us, %lu frames over the %lu us budget\n",
+           (unsigned long)(frames ? render_total_us / frames : 0), (unsigned long)render_max_us,
+           (unsigned long)over_budget, (unsigned long)budget_us);
+
+    uint32_t mean = 0, stddev = 0;
+    if (intervals) {
+        mean = (uint32_t)(interval_sum / intervals);
+        const uint64_t mean_sq = interval_sq_sum / intervals;
+        const uint64_t sq_mean = (uint64_t)mean * mean;
+        stddev = mean_sq > sq_mean ? isqrt64(mean_sq - sq_mean) : 0;
+    }
+    printf("pacing: frame time avg %lu us, stddev %lu us; cost estimate %lu +- %lu us, %lu ms idle\n",
+           (unsigned long)mean, (unsigned long)stddev, (unsigned long)cost_us,
+           (unsigned long)cost_dev_us, (unsigned long)(sched_idle_us / 1000));
+}
+
+static void pacing_command(int argc, char **argv) {
+    if (argc > 1 && !strcmp(argv[1], "reset")) {
+        pacing_reset();
+        printf("pacing: reset\n");
+    } else {
+        present_report();
+    }
+}
+
+static void vsync_command(int argc, char **argv) {
+    if (argc > 1) {
+        if (!strcasecmp(argv[1], "on") || !strcmp(argv[1], "1")) {
+            murmdoom_vsync = 1;
+        } else if (!strcasecmp(argv[1], "off") || !strcmp(argv[1], "0")) {
+            murmdoom_vsync = 0;
+        } else {
+            printf("usage: vsync [on|off]\n");
+            return;
+        }
+    }
+    printf("vsync: %s\n", murmdoom_vsync ? "on" : "off");
+}
+
+void present_init(void) {
+    buffers[0] = DG_ScreenBuffer;
+    buffers[1] = (pixel_t *)psram_malloc(SCREEN_BYTES);
+    if (buffers[1]) {
+        memset(buffers[1], 0, SCREEN_BYTES);
+    } else {
+        printf("present: no PSRAM for a second framebuffer, vsync presentation off\n");
+    }
+
+    const struct video_mode_t mode = graphics_get_video_mode(0);
+    budget_us = 1000000u / (uint32_t)(mode.freq ? mode.freq : 60);
+    pacing_reset();
+    murmdoom_console_register("pacing", "[reset] presented fps, dropped vblanks, frame-time variance", pacing_command);
+    murmdoom_console_register("vsync", "[on|off] present frames at vertical blank", vsync_command);
+}
+
+void present_frame_start(bool just_in_time) {
+    // Start late enough that the frame is finished shortly before the
+    // refresh it can first be shown at (one after a flip still pending), so
+    // input and interpolation are as fresh as possible when it appears.
+    if (just_in_time && frame_vsync && have_cost) {
+        const uint32_t now = time_us_32();
+        const uint32_t refreshes = graphics_present_pending() ? 2 : 1;
+        const uint32_t target = graphics_get_vsync_time_us() + refreshes * budget_us;
+        const uint32_t lead = cost_us + 2 * cost_dev_us + SCHED_MARGIN_US;
+        const int32_t idle = (int32_t)(target - lead - now);
+        if (idle > 0 && (uint32_t)idle < 2 * budget_us) {
+            wait_until_us(now + (uint32_t)idle);
+            sched_idle_us += (uint32_t)idle;
+        }
+    }
+    frame_start_us = time_us_32();
+    wait_us = 0;
+}
+
+void present_begin_update(bool vsync) {
+    // The buffer about to be written may still be queued for the next flip.
+    if (graphics_present_pending()) {
+        const uint32_t t0 = time_us_32();
+        while (graphics_present_pending()) {
+            __wfe();
+        }
+        wait_us += time_us_32() - t0;
+    }
+
+    if (frame_vsync) {
+        const uint32_t flip = graphics_get_present_vsync();
+        if (have_flip && flip - last_flip_vsync > 1) {
+            dropped += flip - last_flip_vsync - 1;
+        }
+        last_flip_vsync = flip;
+        have_flip = true;
+    }
+
+    frame_vsync = vsync && buffers[1];
+    if (!frame_vsync) {
+        have_flip = false;
+    }
+    pixel_t *front = (pixel_t *)graphics_get_buffer();
+    if (frame_vsync) {
+        DG_ScreenBuffer = front == buffers[0] ? buffers[1] : buffers[0];
+    } else {
+        DG_ScreenBuffer = front;
+    }
+}
+
+void present_end_update(void) {
+    if (frame_vsync) {
+        graphics_present_buffer((uint8_t *)DG_ScreenBuffer);
+    }
+
+    const uint32_t now = time_us_32();
+    const uint32_t render_us = now - frame_start_us - wait_us;
+    // Wipes present several frames per doomgeneric_Tick.
+    frame_start_us = now;
+    wait_us = 0;
+
+    frames++;
+    render_total_us += render_us;
+    if (render_us > render_max_us) render_max_us = render_us;
+    if (render_us > budget_us) over_budget++;
+
+    if (!have_cost) {
+        cost_us = render_us;
+        cost_dev_us = 0;
+        have_cost = true;
+    } else {
+        const int32_t err = (int32_t)(render_us - cost_us);
+        const uint32_t dev = (uint32_t)(err < 0 ? -err : err);
+        cost_us = (uint32_t)((int32_t)cost_us + (err >> COST_SHIFT));
+        cost_dev_us = (uint32_t)((int32_t)cost_dev_us + (((int32_t)dev - (int32_t)cost_dev_us) >> COST_SHIFT));
+    }
+
+    if (have_present) {
+        const uint32_t interval = now - last_present_us;
+        intervals++;
+        interval_sum += interval;
+        interval_sq_sum += (uint64_t)interval * interval;
+    }
+    last_present_us = now;
+    have_present = true;
+}
+
+void present_wait_vblanks(uint32_t count) {
+    const uint32_t start = graphics_get_vsync_count();
+    while (graphics_get_vsync_count() - start < count) {
+        __wfe();
+    }
+}
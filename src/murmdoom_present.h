@@ -0,0 +1,55 @@
+#pragma once
+
+// Frame presentation and pacing.
+//
+// Without vsync I_FinishUpdate copies every frame straight into the buffer
+// the HDMI scanout is reading, as it always did. With vsync (uncapped
+// rendering, murmdoom_interp.h) a second PSRAM framebuffer is used: the frame
+// is copied into whichever buffer is off screen and handed to
+// graphics_present_buffer(), which flips it in at the next vsync interrupt.
+// Only that copy waits for the flip; drawing into I_VideoBuffer does not.
+// Capped 35 Hz play is presented on vsync as well unless murmdoom_vsync is 0
+// ("vsync off" on the console); timedemos never wait for a refresh.
+//
+// When uncapped, each frame is started just in time rather than as soon as
+// the last one is queued: the scheduler keeps a running estimate of the frame
+// cost (mean plus deviation) and sleeps in WFE until that long before the
+// refresh the frame can first be shown at. The view is then sampled as late
+// as possible and the core idles instead of waiting for the flip.
+//
+// Pacing counters cover every presented frame:
+//
+//   fps        frames presented per second of wall time
+//   dropped    vblanks a presented frame stayed on screen beyond the first
+//   render     doomgeneric_Tick entry to present, less the wait for the
+//              flip and the scheduler's sleep, against the budget of one
+//              refresh (16.7 ms at 60 Hz)
+//   frame time present-to-present interval, mean and standard deviation
+//   cost       the scheduler's current estimate, and total time it slept
+//
+// "pacing" on the serial console prints them, "pacing reset" clears them.
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern int murmdoom_vsync;
+
+void present_init(void);                // DG_Init, after DG_ScreenBuffer
+// doomgeneric_Tick entry; with just_in_time, first sleeps until the frame
+// needs to start to make the next refresh.
+void present_frame_start(bool just_in_time);
+// I_FinishUpdate, before DG_ScreenBuffer is written; points it at the buffer
+// to draw into.
+void present_begin_update(bool vsync);
+void present_end_update(void);          // DG_DrawFrame, frame complete
+void present_report(void);
+// Sleep until `count` more refreshes have started.
+void present_wait_vblanks(uint32_t count);
+
+#ifdef __cplusplus
+}
+#endif
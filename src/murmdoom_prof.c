@@ -0,0 +1,221 @@
+/*
+ * Hot-path cycle profiling (see murmdoom_prof.h).
+ */
+#include "murmdoom_prof.h"
+
+#if MURMDOOM_PROF
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+#if PICO_ON_DEVICE
+#include "hardware/clocks.h"
+#include "hardware/structs/m33.h"
+#else
+#include <time.h>
+#endif
+
+#include "doomgeneric.h"
+#include "murmdoom_console.h"
+#include "murmdoom_hot.h"
+
+// Bucket b counts samples in [2^(b-1), 2^b) cycles; bucket 0 is zero cycles.
+#define PROF_HIST_BUCKETS 32
+
+typedef struct {
+    uint32_t calls;
+    uint32_t min;
+    uint32_t max;
+    uint64_t total;
+    uint32_t frame_acc;     // cycles in the frame being built
+    uint32_t frame_last;    // cycles in the last completed frame
+    uint32_t frame_avg;     // running average of frame_last (1/16 weight)
+    uint32_t frame_max;
+    uint32_t hist[PROF_HIST_BUCKETS];
+} prof_stat_t;
+
+static const char *const prof_names[PROF_COUNT] = {
+    "tics", "ticker", "display", "bsp", "segs", "planes",
+    "masked", "finish", "mix", "opl", "disk", "wipe",
+    "automap",
+};
+
+static prof_stat_t stats[PROF_COUNT];
+static uint32_t frames = 0;
+static uint32_t cycles_per_us = 1;
+
+static bool overlay_visible = false;
+// Frames left in which to wipe the hidden overlay; one per framebuffer.
+static int overlay_clear = 0;
+
+// Overlay placement and colours (game palette: 0 black, 4 white).
+#define OVERLAY_X 2
+#define OVERLAY_Y 2
+#define OVERLAY_LINE_H 8
+#define OVERLAY_W (29 * 6 + 4)
+#define OVERLAY_H ((PROF_COUNT + 1) * OVERLAY_LINE_H + 4)
+#define OVERLAY_BG 0
+#define OVERLAY_FG 4
+
+void __murmdoom_hot(prof_record)(prof_id_t id, uint32_t cycles) {
+    prof_stat_t *s = &stats[id];
+    s->calls++;
+    s->total += cycles;
+    if (cycles < s->min) s->min = cycles;
+    if (cycles > s->max) s->max = cycles;
+    s->frame_acc += cycles;
+    uint32_t bucket = cycles ? 32u - (uint32_t)__builtin_clz(cycles) : 0;
+    if (bucket >= PROF_HIST_BUCKETS) bucket = PROF_HIST_BUCKETS - 1;
+    s->hist[bucket]++;
+}
+
+static uint32_t to_us(uint64_t cycles) {
+    return (uint32_t)(cycles / cycles_per_us);
+}
+
+void prof_reset(void) {
+    memset(stats, 0, sizeof(stats));
+    for (int i = 0; i < PROF_COUNT; ++i) {
+        stats[i].min = UINT32_MAX;
+    }
+    frames = 0;
+}
+
+void prof_frame_end(void) {
+    for (int i = 0; i < PROF_COUNT; ++i) {
+        prof_stat_t *s = &stats[i];
+        s->frame_last = s->frame_acc;
+        s->frame_acc = 0;
+        if (s->frame_last > s->frame_max) s->frame_max = s->frame_last;
+        if (frames == 0) {
+            s->frame_avg = s->frame_last;
+        } else {
+            s->frame_avg = s->frame_avg - (s->frame_avg >> 4) + (s->frame_last >> 4);
+        }
+    }
+    frames++;
+}
+
+uint32_t prof_frame_us(prof_id_t id) {
+    return to_us(stats[id].frame_last);
+}
+
+void prof_dump(void) {
+    printf("prof: %lu frames, %lu MHz\n", (unsigned long)frames, (unsigned long)cycles_per_us);
+    printf("%-8s %8s %8s %8s %8s | %8s %8s %8s\n",
+           "name", "calls", "avg_us", "min_us", "max_us", "frame", "f_avg", "f_max");
+    for (int i = 0; i < PROF_COUNT; ++i) {
+        const prof_stat_t *s = &stats[i];
+        if (!s->calls) {
+            printf("%-8s %8s\n", prof_names[i], "-");
+            continue;
+        }
+        printf("%-8s %8lu %8lu %8lu %8lu | %8lu %8lu %8lu\n", prof_names[i],
+               (unsigned long)s->calls,
+               (unsigned long)to_us(s->total / s->calls),
+               (unsigned long)to_us(s->min),
+               (unsigned long)to_us(s->max),
+               (unsigned long)to_us(s->frame_last),
+               (unsigned long)to_us(s->frame_avg),
+               (unsigned long)to_us(s->frame_max));
+    }
+}
+
+static void dump_hist(void) {
+    for (int i = 0; i < PROF_COUNT; ++i) {
+        const prof_stat_t *s = &stats[i];
+        if (!s->calls) continue;
+        printf("%s:", prof_names[i]);
+        for (int b = 0; b < PROF_HIST_BUCKETS; ++b) {
+            if (!s->hist[b]) continue;
+            // Upper bound of the bucket, in microseconds.
+            const uint64_t hi = (uint64_t)1 << b;
+            if (hi < cycles_per_us) {
+                printf(" <1us:%lu", (unsigned long)s->hist[b]);
+            } else {
+                printf(" <%luus:%lu", (unsigned long)to_us(hi), (unsigned long)s->hist[b]);
+            }
+        }
+        printf("\n");
+    }
+}
+
+static void prof_command(int argc, char **argv) {
+    const char *sub = argc > 1 ? argv[1] : "dump";
+    if (!strcmp(sub, "dump")) {
+        prof_dump();
+    } else if (!strcmp(sub, "hist")) {
+        dump_hist();
+    } else if (!strcmp(sub, "reset")) {
+        prof_reset();
+        printf("prof: reset\n");
+    } else if (!strcmp(sub, "overlay")) {
+        prof_overlay_toggle();
+    } else {
+        printf("usage: prof [dump|hist|reset|overlay]\n");
+    }
+}
+
+#if !PICO_ON_DEVICE
+uint32_t prof_cycles(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec);
+}
+#endif
+
+void prof_init(void) {
+#if PICO_ON_DEVICE
+    m33_hw->demcr |= M33_DEMCR_TRCENA_BITS;
+    m33_hw->dwt_cyccnt = 0;
+    m33_hw->dwt_ctrl |= M33_DWT_CTRL_CYCCNTENA_BITS;
+
+    cycles_per_us = clock_get_hz(clk_sys) / 1000000;
+    if (cycles_per_us == 0) cycles_per_us = 1;
+#else
+    cycles_per_us = 1000;
+#endif
+
+    prof_reset();
+    murmdoom_console_register("prof", "[dump|hist|reset|overlay] cycle profile", prof_command);
+}
+
+void prof_overlay_toggle(void) {
+    overlay_visible = !overlay_visible;
+    if (!overlay_visible) {
+        overlay_clear = 2;
+    }
+}
+
+bool prof_overlay_busy(void) {
+    return overlay_visible || overlay_clear > 0;
+}
+
+void prof_overlay_draw(void) {
+    if (overlay_clear > 0) {
+        // Outside GS_LEVEL the top rows are never recopied; wipe what we drew.
+        DG_FillRect(OVERLAY_X, OVERLAY_Y, OVERLAY_W, OVERLAY_H, OVERLAY_BG);
+        overlay_clear--;
+    }
+    if (!overlay_visible) return;
+
+    DG_FillRect(OVERLAY_X, OVERLAY_Y, OVERLAY_W, OVERLAY_H, OVERLAY_BG);
+
+    char text[40];
+    int y = OVERLAY_Y + 2;
+    snprintf(text, sizeof(text), "%-8s %6s %6s %6s", "us", "last", "avg", "max");
+    DG_DrawText(OVERLAY_X + 2, y, text, OVERLAY_FG);
+    for (int i = 0; i < PROF_COUNT; ++i) {
+        const prof_stat_t *s = &stats[i];
+        y += OVERLAY_LINE_H;
+        snprintf(text, sizeof(text), "%-8s %6lu %6lu %6lu", prof_names[i],
+                 (unsigned long)to_us(s->frame_last),
+                 (unsigned long)to_us(s->frame_avg),
+                 (unsigned long)to_us(s->frame_max));
+        DG_DrawText(OVERLAY_X + 2, y, text, OVERLAY_FG);
+    }
+}
+
+#endif // MURMDOOM_PROF
@@ -0,0 +1,114 @@
+#pragma once
+
+// Cycle-counter profiling of the hot paths.
+//
+// Scoped timers read the Cortex-M33 DWT cycle counter and aggregate into one
+// fixed-size record per subsystem: call count, total/min/max cycles, a log2
+// histogram and the total of the last completed frame. There is no allocation
+// and no locking; all probes are expected to run on core 0.
+//
+//   void P_Ticker (void)
+//   {
+//       PROF_SCOPE(PROF_TICKER);   // stops when the enclosing block exits
+//       ...
+//   }
+//
+// Results are shown by the on-screen overlay (toggled with the ` key) and
+// printed over serial with the "prof" console command. Build with
+// -DMURMDOOM_PROF=OFF to compile every probe out.
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef MURMDOOM_PROF
+#define MURMDOOM_PROF 0
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    PROF_TRYRUNTICS,    // TryRunTics, including any wait for the next tic
+    PROF_TICKER,        // P_Ticker
+    PROF_DISPLAY,       // D_Display
+    PROF_BSP,           // R_RenderBSPNode, including walls
+    PROF_SEGS,          // R_StoreWallRange
+    PROF_PLANES,        // R_DrawPlanes
+    PROF_MASKED,        // R_DrawMasked
+    PROF_FINISH,        // I_FinishUpdate
+    PROF_MIX,           // mix_audio_buffer, including music
+    PROF_OPL,           // OPL_calc_buffer_stereo
+    PROF_DISK,          // disk_read
+    PROF_WIPE,          // one screen-wipe frame in D_Display, without the wait
+    PROF_AUTOMAP,       // AM_Drawer
+    PROF_COUNT
+} prof_id_t;
+
+#if MURMDOOM_PROF
+
+#if PICO_ON_DEVICE
+static inline uint32_t prof_cycles(void) {
+    return *(volatile uint32_t *)0xE0001004u;   // DWT_CYCCNT
+}
+#else
+// Host build: monotonic nanoseconds stand in for cycles (1000 per us).
+uint32_t prof_cycles(void);
+#endif
+
+void prof_record(prof_id_t id, uint32_t cycles);
+
+typedef struct {
+    prof_id_t id;
+    uint32_t start;
+} prof_scope_t;
+
+static inline void prof_scope_end(prof_scope_t *scope) {
+    prof_record(scope->id, prof_cycles() - scope->start);
+}
+
+#define PROF_CAT_(a, b) a##b
+#define PROF_CAT(a, b) PROF_CAT_(a, b)
+
+#define PROF_SCOPE(id) \
+    prof_scope_t PROF_CAT(prof_scope_, __LINE__) \
+        __attribute__((cleanup(prof_scope_end))) = { (id), prof_cycles() }
+
+// Explicit pair for a region that is not a block of its own.
+#define PROF_BEGIN(id) const uint32_t prof_t0_##id = prof_cycles()
+#define PROF_END(id) prof_record(id, prof_cycles() - prof_t0_##id)
+
+// Enable the cycle counter. Call once the system clock is final.
+void prof_init(void);
+// Close the current frame: latch per-frame totals, update the overlay.
+void prof_frame_end(void);
+// Total time spent in `id` during the last completed frame.
+uint32_t prof_frame_us(prof_id_t id);
+void prof_reset(void);
+void prof_dump(void);
+void prof_overlay_toggle(void);
+// Draw the overlay into DG_ScreenBuffer (no-op while hidden).
+void prof_overlay_draw(void);
+// True if prof_overlay_draw will draw, or wipe what it drew.
+bool prof_overlay_busy(void);
+
+#else
+
+#define PROF_SCOPE(id) do { } while (0)
+#define PROF_BEGIN(id) do { } while (0)
+#define PROF_END(id) do { } while (0)
+
+static inline void prof_init(void) { }
+static inline void prof_frame_end(void) { }
+static inline uint32_t prof_frame_us(prof_id_t id) { (void)id; return 0; }
+static inline void prof_reset(void) { }
+static inline void prof_dump(void) { }
+static inline void prof_overlay_toggle(void) { }
+static inline void prof_overlay_draw(void) { }
+static inline bool prof_overlay_busy(void) { return false; }
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
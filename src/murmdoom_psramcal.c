@@ -0,0 +1,309 @@
+/*
+ * PSRAM timing calibration and bandwidth measurement (see murmdoom_psramcal.h).
+ */
+#include "murmdoom_psramcal.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "ff.h"
+#include "psram_init.h"
+#include "psram_allocator.h"
+#include "murmdoom_console.h"
+#include "murmdoom_log.h"
+
+#define CAL_FILE "psram.cal"
+// First field of psram.cal; a file from an older sweep is swept again.
+#define CAL_VERSION 2
+
+// Fastest SCK the sweep tries; the top of the PSRAM_SPEED build options.
+#ifndef PSRAM_CAL_MAX_MHZ
+#define PSRAM_CAL_MAX_MHZ 166
+#endif
+
+// Pattern test: the start of the allocator's scratch area, which nothing
+// uses before psram_malloc and only the benchmark uses later.
+#define CAL_TEST_BYTES (16 * 1024)
+#define CAL_VERIFY_BYTES (128 * 1024)
+#define CAL_PATTERNS 5
+// Passing read delays in a row needed to accept a divisor: the middle one
+// then has a passing delay on either side.
+#define CAL_MIN_WINDOW 3
+// Uncached bytes streamed to compare cooldowns.
+#define CAL_SPEED_BYTES (64 * 1024)
+
+// psram bench
+#define BENCH_SEQ_BYTES (1024 * 1024)
+#define BENCH_WRITE_BYTES (128 * 1024)
+#define BENCH_RANDOM_READS 16384
+
+typedef enum {
+    SOURCE_DEFAULT,
+    SOURCE_CACHED,
+    SOURCE_CALIBRATED,
+} cal_source_t;
+
+static const char *const source_names[] = {
+    "build default", "psram.cal", "calibrated at boot",
+};
+
+static cal_source_t source = SOURCE_DEFAULT;
+static uint32_t cal_us;
+static volatile uint32_t sink;
+
+static uint32_t pattern_word(int pattern, uint32_t i) {
+    switch (pattern) {
+    case 0: return (i & 1) ? 0xFFFFFFFFu : 0x00000000u;
+    case 1: return (i & 1) ? 0x55555555u : 0xAAAAAAAAu;
+    case 2: return 1u << (i & 31);
+    case 3: return ~(1u << (i & 31));
+    default: return (i * 2654435761u) ^ (i >> 5);
+    }
+}
+
+// Write and read back every pattern through the uncached window. The last
+// pattern is written a byte at a time, as the renderer does.
+static bool pattern_ok(uint32_t bytes) {
+    volatile uint32_t *words = (volatile uint32_t *)PSRAM_UNCACHED_BASE;
+    volatile uint8_t *bytes8 = (volatile uint8_t *)PSRAM_UNCACHED_BASE;
+    const uint32_t count = bytes / 4;
+
+    for (int pattern = 0; pattern < CAL_PATTERNS; pattern++) {
+        if (pattern == CAL_PATTERNS - 1) {
+            for (uint32_t i = 0; i < count; i++) {
+                const uint32_t v = pattern_word(pattern, i);
+                bytes8[i * 4 + 0] = (uint8_t)v;
+                bytes8[i * 4 + 1] = (uint8_t)(v >> 8);
+                bytes8[i * 4 + 2] = (uint8_t)(v >> 16);
+                bytes8[i * 4 + 3] = (uint8_t)(v >> 24);
+            }
+        } else {
+            for (uint32_t i = 0; i < count; i++) {
+                words[i] = pattern_word(pattern, i);
+            }
+        }
+        for (int pass = 0; pass < 2; pass++) {
+            for (uint32_t i = 0; i < count; i++) {
+                if (words[i] != pattern_word(pattern, i)) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// Try a timing; a failure may leave the chip out of QPI mode, so it is reset.
+static bool timing_ok(const psram_timing_t *t, uint32_t bytes) {
+    psram_set_timing(t);
+    if (pattern_ok(bytes)) {
+        return true;
+    }
+    psram_reset_device();
+    return false;
+}
+
+static uint32_t read_us(const volatile uint32_t *words, uint32_t bytes) {
+    uint32_t sum = 0;
+    const uint32_t start = time_us_32();
+    for (uint32_t i = 0; i < bytes / 4; i++) {
+        sum += words[i];
+    }
+    const uint32_t us = time_us_32() - start;
+    sink = sum;
+    return us ? us : 1;
+}
+
+// The timing and the read delays either side of it pass the longer test,
+// so what is saved is not on the edge of what works.
+static bool margin_ok(const psram_timing_t *t) {
+    psram_timing_t early = *t, late = *t;
+    early.rxdelay--;
+    late.rxdelay++;
+    return timing_ok(&early, CAL_VERIFY_BYTES) && timing_ok(&late, CAL_VERIFY_BYTES) &&
+           timing_ok(t, CAL_VERIFY_BYTES);
+}
+
+static bool sweep(psram_timing_t *best) {
+    psram_timing_t def;
+    psram_default_timing(&def);
+
+    const uint32_t clock_hz = clock_get_hz(clk_sys);
+    const uint32_t max_hz = PSRAM_CAL_MAX_MHZ * 1000000u;
+    uint32_t first = (clock_hz + max_hz - 1) / max_hz;
+    if (first < 2) first = 2;
+
+    bool found = false;
+    for (uint32_t div = first; div <= def.clkdiv && !found; div++) {
+        int run = 0, best_run = 0, best_end = 0;
+        for (int rx = 0; rx <= PSRAM_RXDELAY_MAX; rx++) {
+            psram_timing_t t = { (uint8_t)div, (uint8_t)rx, def.cooldown };
+            run = timing_ok(&t, CAL_TEST_BYTES) ? run + 1 : 0;
+            if (run > best_run) {
+                best_run = run;
+                best_end = rx;
+            }
+        }
+        if (best_run < CAL_MIN_WINDOW) {
+            continue;
+        }
+        best->clkdiv = (uint8_t)div;
+        best->rxdelay = (uint8_t)(best_end - best_run + 1 + (best_run - 1) / 2);
+        best->cooldown = def.cooldown;
+        // Else back off to the next divisor.
+        found = margin_ok(best);
+    }
+    if (!found) {
+        return false;
+    }
+
+    // Keep the cooldown that streams fastest among those with the same
+    // margin.
+    uint32_t best_us = UINT32_MAX;
+    psram_timing_t t = *best;
+    for (int cd = 0; cd <= PSRAM_COOLDOWN_MAX; cd++) {
+        t.cooldown = (uint8_t)cd;
+        if (!margin_ok(&t)) continue;
+        const uint32_t us = read_us((const volatile uint32_t *)PSRAM_UNCACHED_BASE, CAL_SPEED_BYTES);
+        if (us < best_us) {
+            best_us = us;
+            best->cooldown = (uint8_t)cd;
+        }
+    }
+    return margin_ok(best);
+}
+
+static bool load_cached(psram_timing_t *t) {
+    FIL f;
+    char line[64];
+    unsigned long hz;
+    unsigned version, clkdiv, rxdelay, cooldown;
+
+    if (f_open(&f, CAL_FILE, FA_READ) != FR_OK) {
+        return false;
+    }
+    const bool ok = f_gets(line, sizeof(line), &f) &&
+                    sscanf(line, "%u %lu %u %u %u", &version, &hz, &clkdiv, &rxdelay, &cooldown) == 5;
+    f_close(&f);
+
+    if (!ok || version != CAL_VERSION || hz != clock_get_hz(clk_sys) || clkdiv < 1 || clkdiv > 255 ||
+        rxdelay > PSRAM_RXDELAY_MAX || cooldown > PSRAM_COOLDOWN_MAX) {
+        return false;
+    }
+    t->clkdiv = (uint8_t)clkdiv;
+    t->rxdelay = (uint8_t)rxdelay;
+    t->cooldown = (uint8_t)cooldown;
+    return true;
+}
+
+static void save_cached(const psram_timing_t *t) {
+    FIL f;
+    UINT bw;
+    char line[64];
+
+    if (f_open(&f, CAL_FILE, FA_WRITE | FA_CREATE_ALWAYS) != FR_OK) {
+        return;
+    }
+    const int n = snprintf(line, sizeof(line), "%u %lu %u %u %u\n", CAL_VERSION, (unsigned long)clock_get_hz(clk_sys),
+                           t->clkdiv, t->rxdelay, t->cooldown);
+    f_write(&f, line, (UINT)n, &bw);
+    f_close(&f);
+}
+
+static void print_timing(void) {
+    psram_timing_t t;
+    psram_get_timing(&t);
+    const uint32_t clock_khz = clock_get_hz(clk_sys) / 1000;
+    printf("psram: clk_sys %lu MHz, SCK %lu.%lu MHz (clkdiv %u), rxdelay %u, cooldown %u; %s",
+           (unsigned long)(clock_khz / 1000), (unsigned long)(clock_khz / t.clkdiv / 1000),
+           (unsigned long)(clock_khz / t.clkdiv % 1000 / 100), t.clkdiv, t.rxdelay, t.cooldown,
+           source_names[source]);
+    if (source == SOURCE_CALIBRATED) {
+        printf(" in %lu ms", (unsigned long)(cal_us / 1000));
+    }
+    printf("\n");
+}
+
+// MB/s with one decimal.
+static void print_rate(const char *name, uint32_t bytes, uint32_t us) {
+    const uint64_t tenths = (uint64_t)bytes * 10 / us;
+    printf("psram: %-14s %5lu.%lu MB/s\n", name, (unsigned long)(tenths / 10), (unsigned long)(tenths % 10));
+}
+
+static void bench(void) {
+    // Reads go through memory in use; the uncached ones start past the
+    // scratch area, the cached ones cover far more than the 16 KB cache.
+    const volatile uint32_t *uncached = (const volatile uint32_t *)(PSRAM_UNCACHED_BASE + 512 * 1024);
+    const volatile uint32_t *cached = (const volatile uint32_t *)(PSRAM_CACHED_BASE + 512 * 1024);
+
+    print_rate("seq read", BENCH_SEQ_BYTES, read_us(uncached, BENCH_SEQ_BYTES));
+    print_rate("cached read", BENCH_SEQ_BYTES, read_us(cached, BENCH_SEQ_BYTES));
+
+    // Writes only touch scratch 2, which nothing else uses.
+    volatile uint32_t *scratch = (volatile uint32_t *)(PSRAM_UNCACHED_BASE +
+        ((uintptr_t)psram_get_scratch_2(BENCH_WRITE_BYTES) - PSRAM_CACHED_BASE));
+    uint32_t start = time_us_32();
+    for (uint32_t i = 0; i < BENCH_WRITE_BYTES / 4; i++) {
+        scratch[i] = i;
+    }
+    uint32_t us = time_us_32() - start;
+    print_rate("seq write", BENCH_WRITE_BYTES, us ? us : 1);
+
+    // Word reads at random addresses, each a separate QMI transfer.
+    const volatile uint8_t *base = (const volatile uint8_t *)PSRAM_UNCACHED_BASE;
+    uint32_t x = 0x12345678u, sum = 0;
+    start = time_us_32();
+    for (uint32_t i = 0; i < BENCH_RANDOM_READS; i++) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        sum += *(const volatile uint32_t *)(base + (x & (MURMDOOM_PSRAM_SIZE_BYTES - 4)));
+    }
+    us = time_us_32() - start;
+    sink = sum;
+    if (!us) us = 1;
+    print_rate("random read", BENCH_RANDOM_READS * 4, us);
+    printf("psram: %lu ns per random read\n", (unsigned long)((uint64_t)us * 1000 / BENCH_RANDOM_READS));
+}
+
+static void psram_command(int argc, char **argv) {
+    if (argc > 1 && !strcmp(argv[1], "bench")) {
+        print_timing();
+        bench();
+    } else if (argc > 1 && !strcmp(argv[1], "recal")) {
+        const FRESULT fr = f_unlink(CAL_FILE);
+        printf("psram: %s\n", fr == FR_OK || fr == FR_NO_FILE ? "calibrating again at next boot"
+                                                            : "cannot delete " CAL_FILE);
+    } else {
+        print_timing();
+    }
+}
+
+void psramcal_boot(void) {
+    psram_timing_t def, t;
+    psram_default_timing(&def);
+
+    if (load_cached(&t) && timing_ok(&t, CAL_TEST_BYTES)) {
+        source = SOURCE_CACHED;
+    } else {
+        const uint32_t start = time_us_32();
+        if (sweep(&t)) {
+            source = SOURCE_CALIBRATED;
+            save_cached(&t);
+        } else {
+            psram_reset_device();
+            psram_set_timing(&def);
+            source = SOURCE_DEFAULT;
+        }
+        cal_us = time_us_32() - start;
+    }
+
+    if (source == SOURCE_DEFAULT) {
+        MURMDOOM_WARN("psram: calibration found nothing that passes; using the build default\n");
+    }
+
+    murmdoom_console_register("psram", "[bench|recal] PSRAM timing, bandwidth, calibrate at next boot", psram_command);
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+// PSRAM timing calibration and bandwidth measurement.
+//
+// psram_init starts PSRAM at the build's PSRAM_MAX_FREQ_MHZ, which is only a
+// guess at what the chip on a given board can do. Once the SD card is
+// mounted, and before anything lives in PSRAM, psramcal_boot sweeps the QMI
+// timing instead:
+//
+//   1. clock divisors from the fastest that keeps SCK within
+//      PSRAM_CAL_MAX_MHZ up to the build default; for each, every read
+//      delay is tried with a write/read-back pattern test, and the first
+//      divisor with at least three passing delays in a row takes the
+//      middle one, if it and the delays either side of it also pass a
+//      longer test; else the next divisor is tried
+//   2. each chip-select cooldown with that timing and the same margin,
+//      keeping the one that streams uncached reads fastest
+//
+// The result is stored in psram.cal on the card, keyed by clk_sys, and reused
+// (after one pattern test) on later boots. If nothing faster passes, the
+// build default stays.
+//
+// "psram" on the serial console prints the timing in use and where it came
+// from, "psram bench" measures sequential, cached and random reads and
+// sequential writes, and "psram recal" deletes psram.cal so the next boot
+// sweeps again.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void psramcal_boot(void);           // DG_Init, after f_mount, before psram_malloc
+
+#ifdef __cplusplus
+}
+#endif
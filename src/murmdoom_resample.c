@@ -0,0 +1,66 @@
+/*
+ * SFX rate conversion (see murmdoom_resample.h).
+ */
+#include "murmdoom_resample.h"
+
+#include "murmdoom_hot.h"
+
+#if defined(__ARM_FEATURE_SIMD32) && __ARM_FEATURE_SIMD32
+#include <arm_acle.h>
+
+static inline uint32_t pack16(int32_t lo, int32_t hi) {
+    return (uint16_t)lo | (uint32_t)hi << 16;
+}
+
+// One output sample: src[k-1] and src[k] weighted by the fraction of offset,
+// then scaled to each channel as a packed left/right pair.
+static inline uint32_t sample_lr(const int8_t *src, uint32_t offset, int voll, int volr) {
+    const int32_t k = (int32_t)(offset >> 16);
+    const int32_t f = (offset >> 8) & 0xff;
+    const int32_t y = __smuad((int16x2_t)pack16(src[k - 1], src[k]), (int16x2_t)pack16(256 - f, f));
+    return pack16((y * voll) >> 8, (y * volr) >> 8);
+}
+
+static inline uint32_t qadd16(uint32_t a, uint32_t b) {
+    return (uint32_t)__qadd16((int16x2_t)a, (int16x2_t)b);
+}
+
+uint32_t __murmdoom_hot(resample_mix_s8)(int16_t *out, uint32_t count, const int8_t *src, uint32_t offset,
+                                         uint32_t step, int voll, int volr) {
+    uint32_t *lr = (uint32_t *)out;
+
+    for (; count >= 2; count -= 2) {
+        const uint32_t a = sample_lr(src, offset, voll, volr);
+        const uint32_t b = sample_lr(src, offset + step, voll, volr);
+        lr[0] = qadd16(lr[0], a);
+        lr[1] = qadd16(lr[1], b);
+        lr += 2;
+        offset += 2 * step;
+    }
+    if (count) {
+        lr[0] = qadd16(lr[0], sample_lr(src, offset, voll, volr));
+        offset += step;
+    }
+    return offset;
+}
+#else
+// Without the DSP extension, packing costs more than it saves: the same
+// arithmetic one sample at a time.
+static inline int16_t sat16(int32_t v) {
+    return v > INT16_MAX ? INT16_MAX : v < INT16_MIN ? INT16_MIN : (int16_t)v;
+}
+
+uint32_t resample_mix_s8(int16_t *out, uint32_t count, const int8_t *src, uint32_t offset, uint32_t step,
+                         int voll, int volr) {
+    for (; count; count--) {
+        const int32_t k = (int32_t)(offset >> 16);
+        const int32_t f = (offset >> 8) & 0xff;
+        const int32_t y = src[k - 1] * (256 - f) + src[k] * f;
+        out[0] = sat16(out[0] + ((y * voll) >> 8));
+        out[1] = sat16(out[1] + ((y * volr) >> 8));
+        out += 2;
+        offset += step;
+    }
+    return offset;
+}
+#endif
@@ -0,0 +1,222 @@
+/*
+ * Sight check cache and SRAM blockmap (see murmdoom_sight.h).
+ */
+#include "doomstat.h"
+#include "p_mobj.h"
+#include "z_zone.h"
+
+#include "murmdoom_sight.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "murmdoom_console.h"
+
+#define KEY_WORDS 8
+
+typedef struct {
+    fixed_t key[KEY_WORDS];
+    uint32_t answer;            // epoch << 1 | visible
+} entry_t;
+
+static entry_t cache[SIGHT_CACHE_SIZE];
+// Entries of an earlier epoch are stale.
+static uint32_t epoch = 1;
+static int hold;
+
+// Where the last lookup would store.
+static entry_t *last_entry;
+static fixed_t last_key[KEY_WORDS];
+
+// SRAM reserved at init for the blockmap and the mobj chains.
+static byte *blockmap_sram;
+static int blockmap_lump_bytes;
+static int blockmap_sram_bytes;     // 0 if the level's blockmap is in the zone
+
+static struct {
+    uint32_t hits, walks, held, invalidations;
+    int rejected_base;
+} stats;
+
+extern int sightcounts[2];
+
+static uint32_t hash_key(const fixed_t *key) {
+    uint32_t h = 0;
+    for (int i = 0; i < KEY_WORDS; i++) {
+        h = (h ^ (uint32_t)key[i]) * 0x9e3779b1u;
+        h ^= h >> 15;
+    }
+    return h;
+}
+
+int sight_cache_lookup(const mobj_t *t1, const mobj_t *t2) {
+    if (hold) {
+        stats.held++;
+        last_entry = NULL;
+        return -1;
+    }
+
+    last_key[0] = t1->x;
+    last_key[1] = t1->y;
+    last_key[2] = t1->z;
+    last_key[3] = t1->height;
+    last_key[4] = t2->x;
+    last_key[5] = t2->y;
+    last_key[6] = t2->z;
+    last_key[7] = t2->height;
+
+    entry_t *e = &cache[hash_key(last_key) & (SIGHT_CACHE_SIZE - 1)];
+    if (e->answer >> 1 == epoch && !memcmp(e->key, last_key, sizeof(last_key))) {
+        stats.hits++;
+        return e->answer & 1;
+    }
+    stats.walks++;
+    last_entry = e;
+    return -1;
+}
+
+void sight_cache_store(boolean visible) {
+    if (last_entry) {
+        memcpy(last_entry->key, last_key, sizeof(last_key));
+        last_entry->answer = epoch << 1 | (visible != false);
+        last_entry = NULL;
+    }
+}
+
+void sight_cache_invalidate(void) {
+    epoch++;
+    stats.invalidations++;
+    last_entry = NULL;
+}
+
+void sight_cache_hold(void) {
+    hold++;
+}
+
+void sight_cache_release(void) {
+    hold--;
+}
+
+// Shorts from offset up to and including the -1 ending the list, or 0 if
+// there is no such list in the lump.
+static int list_length(const short *lump, int count, int offset) {
+    if (offset < 0 || offset >= count) {
+        return 0;
+    }
+    for (int i = offset; i < count; i++) {
+        if (lump[i] == -1) {
+            return i - offset + 1;
+        }
+    }
+    return 0;
+}
+
+static uint32_t hash_list(const short *list, int length) {
+    uint32_t h = 2166136261u;
+    for (int i = 0; i < length; i++) {
+        h = (h ^ (uint16_t)list[i]) * 16777619u;
+    }
+    return h;
+}
+
+short *sight_blockmap_sram(const short *lump, int count, int cells, void ***links) {
+    const int links_bytes = cells * (int)sizeof(void *);
+    // Shorts of the copy that fit after the links.
+    const int room = (MURMDOOM_BLOCKMAP_SRAM - links_bytes) / (int)sizeof(short);
+    const short *offsets = lump + 4;
+
+    blockmap_lump_bytes = count * (int)sizeof(short);
+    blockmap_sram_bytes = 0;
+    if (!blockmap_sram || count < 4 + cells || room < 4 + cells) {
+        return NULL;
+    }
+
+    short *copy = (short *)(blockmap_sram + links_bytes);
+    int size = 4 + cells;
+    memcpy(copy, lump, 4 * sizeof(short));
+
+    // Cells seen so far by the hash of their list, to store each list once.
+    int table_size = 1;
+    while (table_size < 2 * cells) {
+        table_size <<= 1;
+    }
+    int *table = Z_Malloc(table_size * (int)sizeof(int), PU_STATIC, NULL);
+    memset(table, 0, table_size * sizeof(int));
+
+    for (int cell = 0; cell < cells; cell++) {
+        const int length = list_length(lump, count, offsets[cell]);
+        if (!length) {
+            size = -1;
+            break;
+        }
+        const short *list = lump + offsets[cell];
+        uint32_t slot = hash_list(list, length) & (table_size - 1);
+        int same = -1;
+
+        for (; table[slot]; slot = (slot + 1) & (table_size - 1)) {
+            const int other = table[slot] - 1;
+            if (list_length(lump, count, offsets[other]) == length &&
+                !memcmp(lump + offsets[other], list, length * sizeof(short))) {
+                same = other;
+                break;
+            }
+        }
+        if (same >= 0) {
+            copy[4 + cell] = copy[4 + same];
+            continue;
+        }
+        if (size + length > room || size + length > 0x8000) {
+            size = -1;
+            break;
+        }
+        table[slot] = cell + 1;
+        copy[4 + cell] = (short)size;
+        memcpy(copy + size, list, length * sizeof(short));
+        size += length;
+    }
+    Z_Free(table);
+
+    if (size < 0) {
+        return NULL;
+    }
+    *links = (void **)blockmap_sram;
+    memset(*links, 0, links_bytes);
+    blockmap_sram_bytes = links_bytes + size * (int)sizeof(short);
+    return copy;
+}
+
+static void sight_command(int argc, char **argv) {
+    char line[112];
+    const uint32_t rejected = (uint32_t)(sightcounts[0] - stats.rejected_base);
+    const uint32_t checks = rejected + stats.hits + stats.walks + stats.held;
+
+    if (argc > 1 && !strcmp(argv[1], "reset")) {
+        memset(&stats, 0, sizeof(stats));
+        stats.rejected_base = sightcounts[0];
+        fputs("sight: counts reset\n", stdout);
+        return;
+    }
+    snprintf(line, sizeof(line), "sight: %lu checks: %lu rejected, %lu cached, %lu walked, %lu walked while held\n",
+             (unsigned long)checks, (unsigned long)rejected, (unsigned long)stats.hits,
+             (unsigned long)stats.walks, (unsigned long)stats.held);
+    fputs(line, stdout);
+    snprintf(line, sizeof(line), "sight: %d entries, emptied %lu times\n", SIGHT_CACHE_SIZE,
+             (unsigned long)stats.invalidations);
+    fputs(line, stdout);
+    if (blockmap_sram_bytes) {
+        snprintf(line, sizeof(line), "sight: blockmap %d bytes, in SRAM with its mobj chains in %d of %d bytes\n",
+                 blockmap_lump_bytes, blockmap_sram_bytes, MURMDOOM_BLOCKMAP_SRAM);
+    } else {
+        snprintf(line, sizeof(line), "sight: blockmap %d bytes, in the zone\n", blockmap_lump_bytes);
+    }
+    fputs(line, stdout);
+}
+
+void sight_init(void) {
+    if (MURMDOOM_BLOCKMAP_SRAM > 0) {
+        blockmap_sram = malloc(MURMDOOM_BLOCKMAP_SRAM);
+    }
+    murmdoom_console_register("sight", "[reset] sight checks answered by the cache, blockmap placement",
+                              sight_command);
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+// Sight check cache and SRAM blockmap for the game simulation.
+//
+// P_CheckSight walks the BSP from one thing to the other, through segs,
+// lines and vertexes in the zone (PSRAM), for every monster that looks for
+// or at its target. P_CheckPosition and P_PathTraverse go through the
+// blockmap and the mobj chains of each cell they touch. Two pieces make
+// both cheaper without changing what they return, so demos stay in sync:
+//
+//   - the answer of each BSP walk is kept in a table of SIGHT_CACHE_SIZE
+//     entries, keyed by the positions and heights of both things. The walk
+//     only depends on those and on the floor and ceiling heights along the
+//     way, so a check with the same key gives the same answer until a
+//     floor or ceiling ends a tic at another height (T_MovePlane) or a
+//     level is set up or loaded, which empty the table. A monster standing still keeps hitting it while it
+//     looks for a player who does not move, or checks melee and missile
+//     range in one tic. Checks made while P_CheckPosition goes through the
+//     things of its cells always walk: a line the walk marks is then
+//     skipped by the line checks that follow, as in vanilla.
+//   - the blockmap is copied to SRAM at level load with each distinct cell
+//     list stored once, followed by the mobj chains (blocklinks), if both
+//     fit in the MURMDOOM_BLOCKMAP_SRAM bytes reserved for them. Cells
+//     still list the same lines in the same order.
+//
+// The "sight" console command reports the checks and where the blockmap
+// went. Run a timedemo with "nodraw 1" in bench.cfg (or -nodraw on the host
+// build) for the simulation alone; the ticker column is P_Ticker.
+
+#include "doomtype.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SIGHT_CACHE_SIZE 256     // entries, a power of two
+
+#ifndef MURMDOOM_BLOCKMAP_SRAM
+#define MURMDOOM_BLOCKMAP_SRAM 32768
+#endif
+
+struct mobj_s;
+
+void sight_init(void);          // D_DoomMain
+
+// Answer of an earlier walk from t1 to t2: 1 visible, 0 not, -1 not known.
+// sight_cache_store then keeps the answer of the walk for these two.
+int sight_cache_lookup(const struct mobj_s *t1, const struct mobj_s *t2);
+void sight_cache_store(boolean visible);
+// Forget every answer: a sector moved, or a level was set up or loaded.
+void sight_cache_invalidate(void);
+// While held (it nests), lookups miss and nothing is stored.
+void sight_cache_hold(void);
+void sight_cache_release(void);
+
+// Copy a blockmap lump of count shorts (header first, byte-swapped) to SRAM,
+// after room for the mobj chains of its cells. Returns the copy and sets
+// *links to the cleared chains, or returns NULL to keep both in the zone:
+// too big, or an offset that does not lead to a list ending in -1.
+short *sight_blockmap_sram(const short *lump, int count, int cells, void ***links);
+
+#ifdef __cplusplus
+}
+#endif
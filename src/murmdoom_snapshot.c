@@ -0,0 +1,320 @@
+/*
+ * Game state snapshots (see murmdoom_snapshot.h).
+ */
+#include "doomstat.h"
+#include "g_game.h"
+#include "m_misc.h"
+#include "memio.h"
+#include "p_saveg.h"
+#include "z_zone.h"
+
+#include "murmdoom_snapshot.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "murmdoom_console.h"
+
+// Left free in the zone for the level a restore sets up.
+#define ZONE_MARGIN (512 * 1024)
+// Savegame slots of the menu.
+#define SAVE_SLOTS 6
+
+typedef enum {
+    OP_NONE,
+    OP_SAVE,
+    OP_LOAD,
+    OP_PERSIST
+} snapshot_op_t;
+
+typedef struct {
+    MEMFILE *stream;                // NULL if empty
+    char name[9];                   // level
+    int leveltime;
+    uint32_t capture_us;
+} slot_t;
+
+static slot_t slots[SNAPSHOT_SLOTS];
+static int next_slot;               // oldest, taken over by the next snapshot
+static int newest = -1;
+
+// Asked for on the console, done at the start of the next tic.
+static snapshot_op_t pending = OP_NONE;
+static int pending_slot;
+static int pending_target;
+
+static int restored = -1;
+static uint32_t restore_us;
+
+// Writing a slot to the card
+static FILE *persist_file;
+static int persist_slot = -1;
+static int persist_target;
+static size_t persist_pos;
+static int persist_tics;
+static uint32_t persist_us;         // time spent in fwrite
+static char *persist_temp;
+
+static char message[40];
+
+static void level_name_for(char *name, int episode, int map) {
+    if (gamemode == commercial) {
+        snprintf(name, 9, "MAP%02d", map);
+    } else {
+        snprintf(name, 9, "E%dM%d", episode, map);
+    }
+}
+
+static size_t slot_bytes(const slot_t *s, byte **data) {
+    void *buf = NULL;
+    size_t length = 0;
+    if (s->stream) {
+        mem_get_buf(s->stream, &buf, &length);
+    }
+    if (data) {
+        *data = buf;
+    }
+    return length;
+}
+
+static void notify(const char *text) {
+    char line[64];
+    snprintf(line, sizeof(line), "snap: %s\n", text);
+    fputs(line, stdout);
+    M_StringCopy(message, text, sizeof(message));
+    players[consoleplayer].message = message;
+}
+
+// Tenths of a millisecond, for the table.
+static void format_ms(char *buf, size_t size, uint32_t us) {
+    snprintf(buf, size, "%lu.%lu", (unsigned long)(us / 1000), (unsigned long)(us / 100 % 10));
+}
+
+static void persist_stop(void) {
+    if (persist_file) {
+        fclose(persist_file);
+        remove(persist_temp);
+    }
+    persist_file = NULL;
+    persist_slot = -1;
+}
+
+static void persist_step(void) {
+    byte *data;
+    const size_t length = slot_bytes(&slots[persist_slot], &data);
+    size_t n = length - persist_pos;
+    char text[40];
+
+    if (n > SNAPSHOT_CHUNK) {
+        n = SNAPSHOT_CHUNK;
+    }
+    const uint32_t t0 = time_us_32();
+    const size_t written = fwrite(data + persist_pos, 1, n, persist_file);
+    persist_us += time_us_32() - t0;
+    persist_tics++;
+
+    if (written < n) {
+        persist_stop();
+        notify("write to card failed");
+        return;
+    }
+    persist_pos += n;
+    if (persist_pos < length) {
+        return;
+    }
+
+    // As G_DoSaveGame: only a complete file replaces the savegame.
+    fclose(persist_file);
+    persist_file = NULL;
+    remove(P_SaveGameFile(persist_target));
+    rename(persist_temp, P_SaveGameFile(persist_target));
+    snprintf(text, sizeof(text), "snapshot %d saved to slot %d", persist_slot, persist_target);
+    persist_slot = -1;
+    notify(text);
+}
+
+static void take(void) {
+    slot_t *s = &slots[next_slot];
+    size_t largest = 0;
+    char description[SAVESTRINGSIZE];
+    char text[40];
+
+    if (!usergame || gamestate != GS_LEVEL) {
+        notify("no game to take a snapshot of");
+        return;
+    }
+    for (int i = 0; i < SNAPSHOT_SLOTS; i++) {
+        const size_t length = slot_bytes(&slots[i], NULL);
+        if (length > largest) largest = length;
+    }
+    // memio doubles its buffer as it grows, so a new snapshot may briefly
+    // take about twice its size on top of the one it replaces.
+    if ((size_t)Z_FreeMemory() < ZONE_MARGIN + 3 * largest) {
+        notify("zone too full for a snapshot");
+        return;
+    }
+    if (persist_slot == next_slot) {
+        persist_stop();
+        fputs("snap: slot being persisted taken over, not saved\n", stdout);
+    }
+    if (s->stream) {
+        mem_fclose(s->stream);
+        s->stream = NULL;
+    }
+
+    level_name_for(s->name, gameepisode, gamemap);
+    s->leveltime = leveltime;
+    snprintf(description, sizeof(description), "SNAP%d %s %d:%02d", next_slot, s->name,
+             leveltime / TICRATE / 60, leveltime / TICRATE % 60);
+
+    const uint32_t t0 = time_us_32();
+    s->stream = G_ArchiveGame(description);
+    s->capture_us = time_us_32() - t0;
+
+    newest = next_slot;
+    next_slot = (next_slot + 1) % SNAPSHOT_SLOTS;
+    snprintf(text, sizeof(text), "snapshot %d taken", newest);
+    notify(text);
+}
+
+static void restore(int slot) {
+    byte *data;
+    const size_t length = slot_bytes(&slots[slot], &data);
+    char text[40];
+
+    if (netgame || demoplayback || demorecording) {
+        notify("cannot restore in a netgame or demo");
+        return;
+    }
+    if (!length) {
+        notify("snapshot slot is empty");
+        return;
+    }
+
+    const uint32_t t0 = time_us_32();
+    const boolean ok = G_UnArchiveGame(data, (int)length);
+    restore_us = time_us_32() - t0;
+    restored = slot;
+
+    snprintf(text, sizeof(text), ok ? "snapshot %d restored" : "snapshot %d is not for this game", slot);
+    notify(text);
+}
+
+static void persist_start(int slot, int target) {
+    if (!slot_bytes(&slots[slot], NULL)) {
+        notify("snapshot slot is empty");
+        return;
+    }
+    persist_stop();
+    if (!persist_temp) {
+        persist_temp = M_StringJoin(savegamedir, "snaptemp.dsg", NULL);
+    }
+    persist_file = fopen(persist_temp, "wb");
+    if (!persist_file) {
+        notify("cannot open a file on the card");
+        return;
+    }
+    persist_slot = slot;
+    persist_target = target;
+    persist_pos = 0;
+    persist_tics = 0;
+    persist_us = 0;
+}
+
+void snapshot_ticker(void) {
+    const snapshot_op_t op = pending;
+
+    pending = OP_NONE;
+    switch (op) {
+        case OP_SAVE:
+            take();
+            break;
+        case OP_LOAD:
+            restore(pending_slot);
+            break;
+        case OP_PERSIST:
+            persist_start(pending_slot, pending_target);
+            break;
+        case OP_NONE:
+            break;
+    }
+    if (persist_file) {
+        persist_step();
+    }
+}
+
+static void snap_list(void) {
+    char line[96];
+    char ms[16];
+
+    fputs("snap:   slot  level  time     KB  take ms\n", stdout);
+    for (int i = 0; i < SNAPSHOT_SLOTS; i++) {
+        const slot_t *s = &slots[i];
+        const size_t length = slot_bytes(s, NULL);
+        if (!length) {
+            snprintf(line, sizeof(line), "snap:   %4d  -\n", i);
+        } else {
+            format_ms(ms, sizeof(ms), s->capture_us);
+            snprintf(line, sizeof(line), "snap:   %4d%s %-5s %3d:%02d %6lu %8s\n", i, i == newest ? "*" : " ",
+                     s->name, s->leveltime / TICRATE / 60, s->leveltime / TICRATE % 60,
+                     (unsigned long)((length + 1023) / 1024), ms);
+        }
+        fputs(line, stdout);
+    }
+    if (restored >= 0) {
+        format_ms(ms, sizeof(ms), restore_us);
+        snprintf(line, sizeof(line), "snap: last restore (slot %d) took %s ms\n", restored, ms);
+        fputs(line, stdout);
+    }
+    if (persist_slot >= 0) {
+        snprintf(line, sizeof(line), "snap: persisting slot %d to savegame %d: %lu of %lu KB\n", persist_slot,
+                 persist_target, (unsigned long)(persist_pos / 1024),
+                 (unsigned long)(slot_bytes(&slots[persist_slot], NULL) / 1024));
+        fputs(line, stdout);
+    } else if (persist_tics) {
+        format_ms(ms, sizeof(ms), persist_us);
+        snprintf(line, sizeof(line), "snap: last persist took %d tics, %s ms writing\n", persist_tics, ms);
+        fputs(line, stdout);
+    }
+}
+
+static int parse_slot(const char *arg, int count) {
+    char *end;
+    const long n = strtol(arg, &end, 10);
+    return *end || n < 0 || n >= count ? -1 : (int)n;
+}
+
+static void snap_command(int argc, char **argv) {
+    if (argc < 2) {
+        snap_list();
+    } else if (!strcmp(argv[1], "save")) {
+        pending = OP_SAVE;
+    } else if (!strcmp(argv[1], "load")) {
+        pending_slot = argc > 2 ? parse_slot(argv[2], SNAPSHOT_SLOTS) : newest;
+        if (pending_slot < 0) {
+            fputs("snap: no such snapshot\n", stdout);
+            return;
+        }
+        pending = OP_LOAD;
+    } else if (!strcmp(argv[1], "persist") && argc > 3) {
+        pending_slot = parse_slot(argv[2], SNAPSHOT_SLOTS);
+        pending_target = parse_slot(argv[3], SAVE_SLOTS);
+        if (pending_slot < 0 || pending_target < 0) {
+            char line[64];
+            snprintf(line, sizeof(line), "snap: persist <snapshot 0-%d> <savegame slot 0-%d>\n",
+                     SNAPSHOT_SLOTS - 1, SAVE_SLOTS - 1);
+            fputs(line, stdout);
+            return;
+        }
+        pending = OP_PERSIST;
+    } else {
+        fputs("snap: [save|load [n]|persist <n> <slot>]\n", stdout);
+    }
+}
+
+void snapshot_init(void) {
+    murmdoom_console_register("snap", "[save|load [n]|persist <n> <slot>] game state snapshots in PSRAM",
+                              snap_command);
+}
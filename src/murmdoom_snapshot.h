@@ -0,0 +1,37 @@
+#pragma once
+
+// Game state snapshots held in memory.
+//
+// A savegame goes through the SD card both ways, and the menu does it. The
+// serial console can instead keep the game state in a ring of
+// SNAPSHOT_SLOTS snapshots in the zone (PSRAM):
+//
+//   snap                    the slots, and how long taking and restoring took
+//   snap save               take a snapshot into the oldest slot
+//   snap load [n]           restore slot n, or the newest
+//   snap persist <n> <s>    write slot n to savegame slot s (0-5)
+//
+// A snapshot is the savegame format (G_ArchiveGame) and is taken and
+// restored at the start of the next tic, in G_Ticker after the game
+// actions, so never in the middle of one. Restoring is a load without the
+// file: G_InitNew still sets up the level, but its lumps are mostly still in
+// the zone cache. Persisting writes SNAPSHOT_CHUNK bytes a tic to a
+// temporary file and renames it over the savegame when done, so the game
+// does not stop for it and the menu can load it. Snapshots are taken where
+// the menu could save, and restored where it could load except while a demo
+// plays or records, which would go out of sync.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SNAPSHOT_SLOTS 4
+// Bytes written to the card per tic while persisting; whole sectors.
+#define SNAPSHOT_CHUNK 4096
+
+void snapshot_init(void);       // D_DoomMain
+void snapshot_ticker(void);     // G_Ticker
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,158 @@
+/*
+ * Thinker pools (see murmdoom_thinkers.h).
+ */
+#include "doomstat.h"
+#include "p_local.h"
+#include "p_spec.h"
+#include "z_zone.h"
+
+#include "murmdoom_thinkers.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "murmdoom_console.h"
+
+#define ALIGN8(n) (((n) + 7) & ~7)
+
+typedef struct chunk_s {
+    struct chunk_s *next;
+} chunk_t;
+
+typedef struct {
+    const char *name;
+    int size;                   // of the thinker
+    int per_chunk;              // slots
+    int hold;                   // freed slots kept before the oldest is reused
+
+    int stride;                 // slot header and thinker
+    chunk_t *chunks;
+    struct slot_s *fresh;       // never handed out, in address order
+    struct slot_s *freed;       // oldest first
+    struct slot_s *freed_last;
+    int freed_count;
+    int live, peak, chunk_count;
+} pool_t;
+
+// In front of each thinker. A freed thinker is left as it was, as Z_Free
+// would: P_RunThinkers still follows its next, and vanilla code reads a
+// removed mobj through the target and tracer of others (A_Chase checks
+// target->health). Freed slots are reused oldest first, and only once
+// more than hold of them wait, so that, like a freed zone block, one is
+// not handed out again soon after.
+typedef struct slot_s {
+    pool_t *pool;
+    struct slot_s *next_free;
+} slot_t;
+
+#define SLOT_HEADER ALIGN8((int)sizeof(slot_t))
+
+static pool_t pools[NUM_THINKER_POOLS] = {
+    [THINKER_MOBJ] = {"mobj", sizeof(mobj_t), 64, 256},
+    [THINKER_CEILING] = {"ceiling", sizeof(ceiling_t), 16, 16},
+    [THINKER_DOOR] = {"door", sizeof(vldoor_t), 16, 16},
+    [THINKER_FLOOR] = {"floor", sizeof(floormove_t), 16, 16},
+    [THINKER_PLAT] = {"plat", sizeof(plat_t), 16, 16},
+    [THINKER_FLICKER] = {"flicker", sizeof(fireflicker_t), 16, 16},
+    [THINKER_FLASH] = {"flash", sizeof(lightflash_t), 16, 16},
+    [THINKER_STROBE] = {"strobe", sizeof(strobe_t), 16, 16},
+    [THINKER_GLOW] = {"glow", sizeof(glow_t), 16, 16},
+};
+
+static slot_t *slot_of(thinker_t *thinker) {
+    return (slot_t *)((byte *)thinker - SLOT_HEADER);
+}
+
+static thinker_t *thinker_of(slot_t *slot) {
+    return (thinker_t *)((byte *)slot + SLOT_HEADER);
+}
+
+void thinkers_reset(void) {
+    for (int i = 0; i < NUM_THINKER_POOLS; i++) {
+        pool_t *p = &pools[i];
+        p->stride = SLOT_HEADER + ALIGN8(p->size);
+        p->chunks = NULL;
+        p->fresh = p->freed = p->freed_last = NULL;
+        p->freed_count = 0;
+        p->live = p->peak = p->chunk_count = 0;
+    }
+}
+
+static void add_chunk(pool_t *p) {
+    chunk_t *chunk = Z_Malloc(ALIGN8((int)sizeof(chunk_t)) + p->per_chunk * p->stride, PU_LEVEL, NULL);
+    byte *slots = (byte *)chunk + ALIGN8((int)sizeof(chunk_t));
+
+    chunk->next = p->chunks;
+    p->chunks = chunk;
+    p->chunk_count++;
+    // Pushed last first, so that slots go out in address order.
+    for (int i = p->per_chunk - 1; i >= 0; i--) {
+        slot_t *slot = (slot_t *)(slots + i * p->stride);
+        slot->pool = p;
+        slot->next_free = p->fresh;
+        p->fresh = slot;
+    }
+}
+
+void *thinker_alloc(thinkerpool_t pool) {
+    pool_t *p = &pools[pool];
+
+    slot_t *slot;
+
+    if (!p->fresh && p->freed_count <= p->hold) {
+        add_chunk(p);
+    }
+    if (p->fresh) {
+        slot = p->fresh;
+        p->fresh = slot->next_free;
+    } else {
+        slot = p->freed;
+        p->freed = slot->next_free;
+        if (!p->freed) {
+            p->freed_last = NULL;
+        }
+        p->freed_count--;
+    }
+    if (++p->live > p->peak) {
+        p->peak = p->live;
+    }
+    return thinker_of(slot);
+}
+
+void thinker_free(thinker_t *thinker) {
+    slot_t *slot = slot_of(thinker);
+    pool_t *p = slot->pool;
+
+    slot->next_free = NULL;
+    if (p->freed_last) {
+        p->freed_last->next_free = slot;
+    } else {
+        p->freed = slot;
+    }
+    p->freed_last = slot;
+    p->freed_count++;
+    p->live--;
+}
+
+static void thinkers_command(int argc, char **argv) {
+    char line[112];
+    (void)argc;
+    (void)argv;
+
+    for (int i = 0; i < NUM_THINKER_POOLS; i++) {
+        const pool_t *p = &pools[i];
+        if (!p->chunk_count) {
+            continue;
+        }
+        snprintf(line, sizeof(line), "thinkers: %-7s %5d live, %5d peak, %3d chunks of %d, %6d bytes",
+                 p->name, p->live, p->peak, p->chunk_count, p->per_chunk,
+                 p->chunk_count * (ALIGN8((int)sizeof(chunk_t)) + p->per_chunk * p->stride));
+        fputs(line, stdout);
+        fputs("\n", stdout);
+    }
+}
+
+void thinkers_init(void) {
+    thinkers_reset();
+    murmdoom_console_register("thinkers", "thinker pools: live, peak and zone bytes per kind", thinkers_command);
+}
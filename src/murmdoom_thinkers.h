@@ -0,0 +1,54 @@
+#pragma once
+
+// Thinker pools.
+//
+// Every thinker used to be a Z_Malloc block of its own in the zone (PSRAM),
+// so P_RunThinkers went from one scattered block to the next through the
+// XIP cache. Each kind of thinker (mobjs, the four sector movers, the four
+// light effects) now comes from a pool of its own: chunks of slots, in one
+// zone block per chunk (PU_LEVEL), handed out in address order. Mobjs
+// spawned together sit next to each other. A freed slot keeps what was in
+// it and waits behind those freed before it, as a freed zone block would
+// until the rover came round: vanilla reads removed mobjs through target
+// and tracer, so handing one out at once would change demos.
+//
+// The thinker list and its order stay as they were: monsters, projectiles,
+// flickers and flashes call P_Random and sector movers crush things, so the
+// order they run in is part of every demo and savegame.
+//
+// The "thinkers" console command reports the pools. Run a timedemo with
+// "nodraw 1" in bench.cfg for the simulation alone; the summary gives the
+// tics per second P_Ticker would manage.
+
+#include "d_think.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    THINKER_MOBJ,
+    THINKER_CEILING,
+    THINKER_DOOR,
+    THINKER_FLOOR,
+    THINKER_PLAT,
+    THINKER_FLICKER,
+    THINKER_FLASH,
+    THINKER_STROBE,
+    THINKER_GLOW,
+    NUM_THINKER_POOLS
+} thinkerpool_t;
+
+void thinkers_init(void);       // D_DoomMain
+// The zone blocks of the pools were freed with the level (P_SetupLevel).
+void thinkers_reset(void);
+
+// A thinker of the given kind, as Z_Malloc (sizeof(...), PU_LEVEL, NULL)
+// would return it: not cleared, not linked.
+void *thinker_alloc(thinkerpool_t pool);
+// Back to its pool.
+void thinker_free(thinker_t *thinker);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1244,6 +1244,23 @@ OPL *OPL_new(uint32_t clk, uint32_t rate) {
     if (opl == NULL)
         return NULL;
 
+#if EMU8950_LINEAR
+    // Render scratch, per instance so that instances can render concurrently
+    // on both cores.
+#if EMU8950_SLOT_RENDER
+    opl->lfo_am_buffer_lsl3 = (uint8_t *) malloc(SAMPLE_BUF_SIZE);
+    opl->mod_buffer = (int16_t *) malloc(SAMPLE_BUF_SIZE * sizeof(int16_t));
+    if (!opl->lfo_am_buffer_lsl3 || !opl->mod_buffer) {
+#else
+    opl->lfo_am_buffer = (uint8_t *) malloc(SAMPLE_BUF_SIZE);
+    opl->mod_buffer = (int16_t *) malloc(SAMPLE_BUF_SIZE * sizeof(int16_t));
+    if (!opl->lfo_am_buffer || !opl->mod_buffer) {
+#endif
+        OPL_delete(opl);
+        return NULL;
+    }
+#endif
+
     opl->clk = clk;
     opl->rate = rate;
 //    opl->mask = 0;
@@ -1270,6 +1287,14 @@ void OPL_delete(OPL *opl) {
         OPL_RateConv_delete(opl->conv);
         opl->conv = NULL;
     }
+#endif
+#if EMU8950_LINEAR
+#if EMU8950_SLOT_RENDER
+    free(opl->lfo_am_buffer_lsl3);
+#else
+    free(opl->lfo_am_buffer);
+#endif
+    free(opl->mod_buffer);
 #endif
     free(opl);
 }
@@ -1305,8 +1330,25 @@ void OPL_reset(OPL *opl) {
         return;
 
 #if EMU8950_NO_RATECONV
+#if EMU8950_LINEAR
+    // only the render scratch buffers, allocated by OPL_new
+#if EMU8950_SLOT_RENDER
+    uint8_t *lfo_am_scratch = opl->lfo_am_buffer_lsl3;
+#else
+    uint8_t *lfo_am_scratch = opl->lfo_am_buffer;
+#endif
+    int16_t *mod_scratch = opl->mod_buffer;
+    memset(opl, 0, sizeof(*opl));
+#if EMU8950_SLOT_RENDER
+    opl->lfo_am_buffer_lsl3 = lfo_am_scratch;
+#else
+    opl->lfo_am_buffer = lfo_am_scratch;
+#endif
+    opl->mod_buffer = mod_scratch;
+#else
     // no useful fields to preserve
     memset(opl, 0, sizeof(*opl));
+#endif
 #else
     // some fields are not reset
     opl->adr = 0;
@@ -1395,6 +1437,8 @@ void OPL_calc_buffer(OPL *opl, int16_t *buffer, uint32_t nsamples) {
 #if !LIB_PICO_PLATFORM
 #define __not_in_flash_func(x) x
 #endif
+#include "murmdoom_hot.h"
+#include "murmdoom_prof.h"
 
 #if EMU8950_LINEAR
 
@@ -1731,23 +1775,18 @@ uint32_t __not_in_flash_func(slot_car_linear_alg0)(OPL *opl, OPL_SLOT *slot, uin
 
 static_assert(EMU8950_NO_PERCUSSION_MODE, "");
 // this produces stereo
-void OPL_calc_buffer_linear(OPL *opl, int32_t *buffer, uint32_t nsamples) {
+void __murmdoom_hot(OPL_calc_buffer_linear)(OPL *opl, int32_t *buffer, uint32_t nsamples) {
     int i;
+    assert(nsamples <= SAMPLE_BUF_SIZE);
 #if EMU8950_SLOT_RENDER
     // kind of a nit pick, but so cheap - saves a bug every 24 hours due to an optimization
     // (we require that incrementing eg_counter is never zero during the rendering loop)
     opl->eg_counter = (opl->eg_counter & 0x3fffffffu) | 0x80000000u;
-    static uint8_t lfo_am_buffer_lsl3[SAMPLE_BUF_SIZE];
-    assert(nsamples <= sizeof(lfo_am_buffer_lsl3));
-    opl->lfo_am_buffer_lsl3 = lfo_am_buffer_lsl3;
+    uint8_t *lfo_am_buffer_lsl3 = opl->lfo_am_buffer_lsl3;
 #else
-    static uint8_t lfo_am_buffer[SAMPLE_BUF_SIZE];
-    assert(nsamples <= sizeof(lfo_am_buffer));
-    opl->lfo_am_buffer = lfo_am_buffer;
+    uint8_t *lfo_am_buffer = opl->lfo_am_buffer;
 #endif
-    static int16_t mod_buffer[SAMPLE_BUF_SIZE];
 
-    opl->mod_buffer = mod_buffer;
     opl->buffer = buffer;
 
     // todo achievable by memcpy
@@ -1858,7 +1897,8 @@ void OPL_calc_buffer_linear(OPL *opl, int32_t *buffer, uint32_t nsamples) {
 }
 #endif
 
-void OPL_calc_buffer_stereo(OPL *opl, int32_t *buffer, uint32_t nsamples) {
+void __murmdoom_hot(OPL_calc_buffer_stereo)(OPL *opl, int32_t *buffer, uint32_t nsamples) {
+    PROF_SCOPE(PROF_OPL);
     assert(opl->out_step == opl->inp_step);
 #if DUMPO
     bc++;
@@ -1897,6 +1937,40 @@ void OPL_calc_buffer_stereo(OPL *opl, int32_t *buffer, uint32_t nsamples) {
 #endif
 }
 
+static INLINE uint32_t pack_s16_stereo(int32_t v) {
+    if (v > INT16_MAX) v = INT16_MAX;
+    if (v < INT16_MIN) v = INT16_MIN;
+    return ((uint32_t)(uint16_t)v << 16u) | (uint16_t)v;
+}
+
+void __murmdoom_hot(OPL_mix_stereo_s16)(int16_t *out, const int32_t *other, uint32_t nsamples, uint32_t gain_shift) {
+    int32_t *buffer = (int32_t *)out;
+    for (unsigned i = 0; i < nsamples; i++) {
+        buffer[i] = (int32_t)pack_s16_stereo(((buffer[i] >> 1) + (other[i] >> 1)) * (1 << gain_shift));
+    }
+}
+
+// The channel accumulators are rendered straight into the output buffer (one
+// int32 per stereo int16 pair), then a second pass scales, saturates and
+// duplicates each to both channels in place. No scratch buffer, and one pass
+// fewer than rendering, unpacking and applying the gain separately.
+void __murmdoom_hot(OPL_calc_buffer_stereo_s16)(OPL *opl, int16_t *out, uint32_t nsamples, uint32_t gain_shift) {
+    PROF_SCOPE(PROF_OPL);
+    assert(opl->out_step == opl->inp_step);
+    int32_t *buffer = (int32_t *)out;
+#if !EMU8950_LINEAR
+    for (unsigned i = 0; i < nsamples; i++) {
+        update_output(opl);
+        buffer[i] = pack_s16_stereo((int16_t)mix_output_raw(opl) * (1 << gain_shift));
+    }
+#else
+    OPL_calc_buffer_linear(opl, buffer, nsamples);
+    for (unsigned i = 0; i < nsamples; i++) {
+        buffer[i] = (int32_t)pack_s16_stereo((buffer[i] >> 1) * (1 << gain_shift));
+    }
+#endif
+}
+
 void OPL_writeReg(OPL *opl, uint32_t reg, uint8_t data) {
 
 //    printf("WR %04x %2x\n", reg, data);
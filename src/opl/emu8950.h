@@ -219,6 +219,17 @@ int16_t OPL_calc(OPL *opl);
 void OPL_calc_buffer(OPL *opl, int16_t *buffer, uint32_t nsamples);
 // LE left/right channels int16:int16
 void OPL_calc_buffer_stereo(OPL *opl, int32_t *buffer, uint32_t nsamples);
+// Interleaved int16 left/right, multiplied by 1 << gain_shift and saturated.
+// out must be 4-byte aligned; it holds the accumulators while rendering.
+void OPL_calc_buffer_stereo_s16(OPL *opl, int16_t *out, uint32_t nsamples, uint32_t gain_shift);
+#if EMU8950_LINEAR
+// Raw channel accumulators, one int32 per sample. Instances render
+// independently, so two can run on the two cores at once.
+void OPL_calc_buffer_linear(OPL *opl, int32_t *buffer, uint32_t nsamples);
+// Sum the accumulators already in out (as left by OPL_calc_buffer_linear)
+// with other and convert in place, as OPL_calc_buffer_stereo_s16 does.
+void OPL_mix_stereo_s16(int16_t *out, const int32_t *other, uint32_t nsamples, uint32_t gain_shift);
+#endif
 
 /**
  *  Set channel mask 
@@ -49,6 +49,7 @@ typedef enum
 #define OPL_REG_TIMER_CTRL        0x04
 #define OPL_REG_FM_MODE           0x08
 #define OPL_REG_NEW               0x105
+#define OPL_REG_4OP               0x104  // Murmdoom: OPL3 4-operator select
 
 // Operator registers (21 of each):
 
@@ -150,5 +151,15 @@ void OPL_Delay(uint64_t us);
 
 void OPL_SetPaused(int paused);
 
+// Murmdoom: print the voice count and per-core render time per audio
+// buffer of the Pico driver ("opl" on the serial console).
+
+void OPL_Pico_ReportStats(void);
+
+// Murmdoom: with the music cache on, render music ahead for up to budget_us
+// (time the caller would otherwise sleep).
+
+void OPL_Pico_RenderAhead(uint32_t budget_us);
+
 #endif
 
@@ -139,7 +139,12 @@ opl_init_result_t OPL_Init(unsigned int port_base)
 #if PICO_BUILD
     driver = drivers[0];
     driver->init_func(0);
+#if USE_EMU8950_OPL
+    // Murmdoom: the second register bank is emulated (opl_pico.c).
+    return OPL_INIT_OPL3;
+#else
     return OPL_INIT_OPL2;
+#endif
 #else
     char *driver_name;
     int i;
@@ -0,0 +1,105 @@
+/*
+ * IMA ADPCM for rendered music (see opl_ima.h). The tables are the standard
+ * ones the SFX decoder in i_picosound.c uses.
+ */
+#include "opl_ima.h"
+
+#include "murmdoom_hot.h"
+
+static const uint16_t step_table[89] = {
+    7, 8, 9, 10, 11, 12, 13, 14,
+    16, 17, 19, 21, 23, 25, 28, 31,
+    34, 37, 41, 45, 50, 55, 60, 66,
+    73, 80, 88, 97, 107, 118, 130, 143,
+    157, 173, 190, 209, 230, 253, 279, 307,
+    337, 371, 408, 449, 494, 544, 598, 658,
+    724, 796, 876, 963, 1060, 1166, 1282, 1411,
+    1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024,
+    3327, 3660, 4026, 4428, 4871, 5358, 5894, 6484,
+    7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794,
+    32767
+};
+
+static const int8_t index_table[8] = { -1, -1, -1, -1, 2, 4, 6, 8 };
+
+static inline int32_t clamp(int32_t v, int32_t lo, int32_t hi) {
+    return v < lo ? lo : v > hi ? hi : v;
+}
+
+// Apply one code to the state, exactly as the decoder does.
+static inline void step(opl_ima_state_t *s, uint32_t code) {
+    const int32_t st = step_table[s->index];
+    int32_t delta = st >> 3;
+    if (code & 4) delta += st;
+    if (code & 2) delta += st >> 1;
+    if (code & 1) delta += st >> 2;
+    s->predictor = clamp(code & 8 ? s->predictor - delta : s->predictor + delta, -32768, 32767);
+    s->index = clamp(s->index + index_table[code & 7], 0, 88);
+}
+
+static inline uint32_t encode(opl_ima_state_t *s, int32_t sample) {
+    int32_t st = step_table[s->index];
+    int32_t diff = sample - s->predictor;
+    uint32_t code = 0;
+    if (diff < 0) {
+        code = 8;
+        diff = -diff;
+    }
+    if (diff >= st) {
+        code |= 4;
+        diff -= st;
+    }
+    st >>= 1;
+    if (diff >= st) {
+        code |= 2;
+        diff -= st;
+    }
+    st >>= 1;
+    if (diff >= st) {
+        code |= 1;
+    }
+    step(s, code);
+    return code;
+}
+
+static void put_header(uint8_t *p, const opl_ima_state_t *s) {
+    p[0] = (uint8_t)s->predictor;
+    p[1] = (uint8_t)(s->predictor >> 8);
+    p[2] = (uint8_t)s->index;
+    p[3] = 0;
+}
+
+static void get_header(opl_ima_state_t *s, const uint8_t *p) {
+    s->predictor = (int16_t)(p[0] | p[1] << 8);
+    s->index = p[2] > 88 ? 88 : p[2];
+}
+
+void opl_ima_reset(opl_ima_state_t *state) {
+    state->predictor = 0;
+    state->index = 0;
+}
+
+void opl_ima_encode(opl_ima_state_t *state, uint8_t *block, const int16_t *stereo, uint32_t samples) {
+    put_header(block, state);
+    block += 4;
+    for (uint32_t i = 0; i + 1 < samples; i += 2) {
+        const uint32_t lo = encode(state, stereo[i * 2]);
+        const uint32_t hi = encode(state, stereo[i * 2 + 2]);
+        *block++ = (uint8_t)(lo | hi << 4);
+    }
+    if (samples & 1) {
+        *block = (uint8_t)encode(state, stereo[(samples - 1) * 2]);
+    }
+}
+
+void __murmdoom_hot(opl_ima_decode)(int16_t *stereo, const uint8_t *block, uint32_t samples) {
+    opl_ima_state_t s;
+    get_header(&s, block);
+    block += 4;
+    for (uint32_t i = 0; i < samples; i++) {
+        const uint32_t b = block[i >> 1];
+        step(&s, i & 1 ? b >> 4 : b & 0xf);
+        stereo[i * 2] = stereo[i * 2 + 1] = (int16_t)s.predictor;
+    }
+}
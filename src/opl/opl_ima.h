@@ -0,0 +1,32 @@
+#pragma once
+
+// IMA ADPCM for rendered music, 4 bits per sample.
+//
+// OPL music is mono (OPL3 panning is not emulated), so only the left channel
+// of the interleaved stereo buffers is encoded and decoding writes it to
+// both. A block is independently decodable: a 4-byte header holding the
+// predictor and step index at its start, then two samples per byte, the
+// earlier one in the low nibble. The encoder carries its state from block to
+// block, so consecutive blocks decode seamlessly; the header only lets a
+// block be decoded on its own.
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define OPL_IMA_BLOCK_BYTES(samples) (4 + ((samples) + 1) / 2)
+
+typedef struct {
+    int32_t predictor;
+    int32_t index;
+} opl_ima_state_t;
+
+void opl_ima_reset(opl_ima_state_t *state);
+void opl_ima_encode(opl_ima_state_t *state, uint8_t *block, const int16_t *stereo, uint32_t samples);
+void opl_ima_decode(int16_t *stereo, const uint8_t *block, uint32_t samples);
+
+#ifdef __cplusplus
+}
+#endif
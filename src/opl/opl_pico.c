@@ -20,11 +20,11 @@
 #include "config.h"
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <errno.h>
 #include <assert.h>
 
-#include "pico/mutex.h"
 #include "pico/audio_i2s.h"
 #include "pico/util/pheap.h"
 #include "hardware/gpio.h"
@@ -42,6 +42,17 @@
 #include "opl_internal.h"
 
 #include "opl_queue.h"
+#include "opl_ring.h"
+#include "opl_ima.h"
+#include "psram_allocator.h"
+#include "murmdoom_console.h"
+#include "murmdoom_hot.h"
+#include "murmdoom_prof.h"
+
+#if USE_EMU8950_OPL
+#include "pico/multicore.h"
+#include "pico/time.h"
+#endif
 
 #define MAX_SOUND_SLICE_TIME 100 /* ms */
 
@@ -53,23 +64,30 @@ typedef struct
     uint64_t expire_time;     // Calculated time that timer will expire.
 } opl_timer_t;
 
-// When the callback mutex is locked using OPL_Lock, callback functions
-// are not invoked.
-
-static mutex_t callback_mutex;
+// The sequencer (the callback queue and everything the callbacks and the
+// music API do) and the synth only share reg_ring: register writes are
+// stamped with the output sample they are due at and applied by the synth
+// between render segments. Callbacks run at the start of each audio buffer,
+// for every one due before its end, on the core that mixes audio, which is
+// also the one calling the music API; there is nothing to lock.
 
 // Queue of callbacks waiting to be invoked.
 
 static opl_callback_queue_t *callback_queue;
 
-// Mutex used to control access to the callback queue.
-
-static mutex_t callback_queue_mutex;
+static opl_ring_t reg_ring;
 
-// Current time, in us since startup:
+// Sequencer time, in us since startup: the time the running callback was
+// due, or the end of the last buffer sequenced.
 
 static uint64_t current_time;
 
+// Next sample the synth renders, and the sample register writes made now are
+// stamped with.
+
+static uint64_t synth_sample;
+static uint64_t write_sample;
+
 // If non-zero, playback is currently paused.
 
 static int opl_pico_paused;
@@ -87,6 +105,34 @@ static uint64_t pause_offset;
 #elif USE_EMU8950_OPL
 #define opl_op3mode 0
 static OPL *emu8950_opl;
+
+// OPL3's second register bank (0x100-0x1ff) is a second emulator instance,
+// created when the OPL3 mode bit (OPL_REG_NEW) is first set, and rendered on
+// core 1 in parallel with the first bank on core 0. Registers are only
+// written between render segments, while core 1 is idle, so the instance
+// needs no locking. Each bank accumulates the whole audio buffer, then one
+// pass sums, scales and saturates them into the I2S buffer. OPL3 stereo
+// panning and 4-operator voices are not emulated.
+
+// emu8950's render scratch holds this many samples.
+#define OPL_MAX_BUFFER_SAMPLES 2048
+#define OPL_CLOCK 3579552
+
+static OPL *emu8950_opl_bank2;
+static int32_t *bank2_buffer;
+static bool bank2_enabled;
+static bool core1_launched;
+
+// Render time of the current audio buffer on each core; core 1 adds to
+// [1] and core 0 reads it once core 1 has signalled completion.
+static volatile uint32_t buffer_render_us[2];
+
+static struct {
+    uint32_t buffers;
+    uint32_t buffer_samples;
+    uint64_t total_us[2];
+    uint32_t max_us[2];
+} render_stats;
 #else
 static opl3_chip opl_chip;
 static int opl_opl3mode;
@@ -107,65 +153,166 @@ static opl_timer_t timer2 = { 3125, 0, 0, 0 };
 
 static bool audio_was_initialized = 0;
 
-static inline void Pico_LockMutex(mutex_t *mutex) {
-    
+// Render-ahead depth in ms, 0 for live synthesis only (see RenderBuffer).
+int murmdoom_music_cache = 0;
+
+static void CacheReport(void);
+
+#if USE_EMU8950_OPL
+// Core 1: render a segment of the second bank, given as offset << 16 | count.
+static void OPL_Pico_Core1(void)
+{
+    for (;;)
+    {
+        const uint32_t job = multicore_fifo_pop_blocking();
+        const uint32_t t0 = time_us_32();
+        OPL_calc_buffer_linear(emu8950_opl_bank2, bank2_buffer + (job >> 16), job & 0xffff);
+        buffer_render_us[1] += time_us_32() - t0;
+        __dmb();
+        multicore_fifo_push_blocking(job);
+    }
+}
+
+static void SetBank2Enabled(bool enabled)
+{
+    if (enabled && !emu8950_opl_bank2)
+    {
+        emu8950_opl_bank2 = OPL_new(OPL_CLOCK, PICO_SOUND_SAMPLE_FREQ);
+        bank2_buffer = malloc(OPL_MAX_BUFFER_SAMPLES * sizeof(int32_t));
+        if (!emu8950_opl_bank2 || !bank2_buffer)
+        {
+            printf("OPL: no memory for the second register bank, OPL3 voices 10-18 are silent\n");
+            if (emu8950_opl_bank2) OPL_delete(emu8950_opl_bank2);
+            free(bank2_buffer);
+            emu8950_opl_bank2 = NULL;
+            bank2_buffer = NULL;
+            return;
+        }
+    }
+    if (enabled && !core1_launched)
+    {
+        multicore_launch_core1(OPL_Pico_Core1);
+        core1_launched = true;
+    }
+    bank2_enabled = enabled && emu8950_opl_bank2;
+    memset(&render_stats, 0, sizeof(render_stats));
 }
 
-static inline void Pico_UnlockMutex(mutex_t *mutex) {
+void OPL_Pico_ReportStats(void)
+{
+    const uint32_t budget_us = (uint32_t)((uint64_t)render_stats.buffer_samples * 1000000 / PICO_SOUND_SAMPLE_FREQ);
+    const uint32_t n = render_stats.buffers ? render_stats.buffers : 1;
+    printf("opl: %s, %lu buffers, %lu us of audio each\n",
+           bank2_enabled ? "OPL3, 18 voices on cores 0 and 1" : "OPL2, 9 voices on core 0",
+           (unsigned long)render_stats.buffers, (unsigned long)budget_us);
+    for (int core = 0; core < (bank2_enabled ? 2 : 1); ++core)
+    {
+        printf("opl: core %d render avg %lu us, max %lu us per buffer\n", core,
+               (unsigned long)(render_stats.total_us[core] / n),
+               (unsigned long)render_stats.max_us[core]);
+    }
+    if (murmdoom_music_cache > 0)
+    {
+        CacheReport();
+    }
+}
 
+static void OPL_Pico_StatsCommand(int argc, char **argv)
+{
+    if (argc > 1 && !strcmp(argv[1], "reset"))
+    {
+        memset(&render_stats, 0, sizeof(render_stats));
+    }
+    OPL_Pico_ReportStats();
 }
+#else
+void OPL_Pico_ReportStats(void)
+{
+    if (murmdoom_music_cache > 0)
+    {
+        CacheReport();
+    }
+}
+#endif
 
-// Advance time by the specified number of samples, invoking any
-// callback functions as appropriate.
+static uint64_t SampleToTime(uint64_t sample)
+{
+    return sample * OPL_SECOND / PICO_SOUND_SAMPLE_FREQ;
+}
 
-static void AdvanceTime(unsigned int nsamples)
+static uint64_t TimeToSample(uint64_t us)
+{
+    return (us * PICO_SOUND_SAMPLE_FREQ + OPL_SECOND - 1) / OPL_SECOND;
+}
+
+// Invoke every callback due before end_sample. The register writes each one
+// makes are stamped with the sample it was due at.
+
+static void RunSequencer(uint64_t end_sample)
 {
     opl_callback_t callback;
     void *callback_data;
-    uint64_t us;
 
-    Pico_LockMutex(&callback_queue_mutex);
+    while (!opl_pico_paused && !OPL_Queue_IsEmpty(callback_queue))
+    {
+        const uint64_t due_time = OPL_Queue_Peek(callback_queue) + pause_offset;
+        uint64_t due = TimeToSample(due_time);
+
+        if (due >= end_sample)
+        {
+            break;
+        }
 
-    // Advance time.
+        if (!OPL_Queue_Pop(callback_queue, &callback, &callback_data))
+        {
+            break;
+        }
 
-    us = ((uint64_t) nsamples * OPL_SECOND) / PICO_SOUND_SAMPLE_FREQ;
-    current_time += us;
+        if (due < synth_sample)
+        {
+            due = synth_sample;
+        }
+
+        // The callback sees the exact time it was due, so the delays it
+        // schedules from it do not pick up the rounding to samples.
+        write_sample = due;
+        current_time = due_time;
+        callback(callback_data);
+    }
 
     if (opl_pico_paused)
     {
-        pause_offset += us;
+        pause_offset += SampleToTime(end_sample) - SampleToTime(synth_sample);
     }
 
-    // Are there callbacks to invoke now?  Keep invoking them
-    // until there are no more left.
+    // Writes made from now until the next buffer land at its start.
+    current_time = SampleToTime(end_sample);
+    write_sample = end_sample;
+}
+
+static void ApplyRegister(unsigned int reg_num, unsigned int value);
+
+// Apply the writes due at synth_sample; returns how many samples can be
+// rendered before the next one.
+
+static unsigned int ApplyDueWrites(unsigned int max_samples)
+{
+    uint32_t reg, value;
 
-    while (!OPL_Queue_IsEmpty(callback_queue)
-        && current_time >= OPL_Queue_Peek(callback_queue) + pause_offset)
+    while (!opl_ring_empty(&reg_ring))
     {
-        // Pop the callback from the queue to invoke it.
+        const uint32_t due_in = opl_ring_due_in(&reg_ring, (uint32_t) synth_sample);
 
-        if (!OPL_Queue_Pop(callback_queue, &callback, &callback_data))
+        if (due_in)
         {
-            break;
+            return due_in < max_samples ? due_in : max_samples;
         }
 
-        // The mutex stuff here is a bit complicated.  We must
-        // hold callback_mutex when we invoke the callback (so that
-        // the control thread can use OPL_Lock() to prevent callbacks
-        // from being invoked), but we must not be holding
-        // callback_queue_mutex, as the callback must be able to
-        // call OPL_SetCallback to schedule new callbacks.
-
-        Pico_UnlockMutex(&callback_queue_mutex);
-        
-        Pico_LockMutex(&callback_mutex);
-        callback(callback_data);
-        Pico_UnlockMutex(&callback_mutex);
-
-        Pico_LockMutex(&callback_queue_mutex);
+        opl_ring_pop(&reg_ring, &reg, &value);
+        ApplyRegister(reg, value);
     }
 
-    Pico_UnlockMutex(&callback_queue_mutex);
+    return max_samples;
 }
 
 // Call the OPL emulator code to fill the specified buffer.
@@ -183,138 +330,272 @@ extern void TrackTimerCallback(void *track);
 extern uint8_t restart_song_state;
 #endif
 
-// Temp buffer for OPL 32-bit to 16-bit conversion (moved to file scope to avoid any stack issues)
-#if USE_EMU8950_OPL
-static int32_t opl_temp_buffer[2048 * 2]; // stereo, max samples
-#endif
+// Output gain, as a left shift: the emulator's output is quiet next to SFX.
+#define OPL_GAIN_SHIFT 3
 
-void OPL_Pico_Mix_callback(audio_buffer_t *audio_buffer)
+// Render-ahead music cache. With murmdoom_music_cache set to a number of ms,
+// OPL_Pico_RenderAhead runs the sequencer and the synth ahead of playback in
+// time the game loop would otherwise sleep, and keeps up to that much music
+// IMA ADPCM compressed in a PSRAM ring, one block per audio buffer. The mix
+// callback then only decodes; it synthesizes live, as without the cache,
+// whenever the ring has run dry.
+//
+// The music API writes registers at the render position, so volume changes
+// are heard up to the cache depth late. A song change drops what was
+// rendered of the old song, and a paused song holds its rendered music
+// (silent, rather than letting percussion and releases ring on).
+
+#define CACHE_MAX_MS 2000
+// Smallest buffer the slots are sized for: one tic at 35 Hz.
+#define CACHE_MIN_SAMPLES (PICO_SOUND_SAMPLE_FREQ / 35)
+#define CACHE_SLOTS ((CACHE_MAX_MS * PICO_SOUND_SAMPLE_FREQ / 1000 + CACHE_MIN_SAMPLES - 1) / CACHE_MIN_SAMPLES)
+#define CACHE_BLOCK_BYTES OPL_IMA_BLOCK_BYTES(OPL_MAX_BUFFER_SAMPLES)
+// Slack left before the budget runs out, on top of the cost of a block.
+#define CACHE_MARGIN_US 300
+
+static uint8_t *cache_blocks;           // PSRAM, CACHE_SLOTS blocks
+static int16_t *cache_scratch;          // one buffer, rendered before encoding
+static opl_ima_state_t cache_ima;
+static uint32_t cache_head;             // blocks rendered
+static uint32_t cache_tail;             // blocks played
+static unsigned int cache_samples;      // samples per block: the mix buffer size
+static uint32_t cache_block_us;         // EWMA of the cost of rendering a block
+
+// Since the song started.
+static struct {
+    uint32_t start_us;
+    uint32_t rendered;                  // blocks rendered ahead
+    uint32_t played;                    // of those, decoded by the mixer
+    uint32_t live;                      // buffers synthesized in the mixer
+    uint32_t peak_blocks;
+    uint64_t synth_us;
+    uint64_t encode_us;
+    uint64_t decode_us;
+} cache_stats;
+
+static uint32_t CacheDepth(void)
 {
-    if (!audio_buffer || !audio_buffer->buffer) {
+    uint32_t blocks;
+
+    if (murmdoom_music_cache <= 0 || !cache_samples)
+    {
+        return 0;
+    }
+    blocks = (uint32_t) murmdoom_music_cache * PICO_SOUND_SAMPLE_FREQ / 1000 / cache_samples;
+    return blocks < CACHE_SLOTS ? blocks : CACHE_SLOTS;
+}
+
+static uint8_t *CacheBlock(uint32_t index)
+{
+    return cache_blocks + (index % CACHE_SLOTS) * CACHE_BLOCK_BYTES;
+}
+
+static void CacheAllocate(void)
+{
+    if (cache_blocks || murmdoom_music_cache <= 0)
+    {
         return;
     }
-    
-    unsigned int filled, buffer_samples;
-#if DOOM_TINY
-    if (restart_song_state == 2) {
-        RestartSong(0);
+    cache_scratch = malloc(OPL_MAX_BUFFER_SAMPLES * 4);
+    cache_blocks = cache_scratch ? psram_malloc(CACHE_SLOTS * CACHE_BLOCK_BYTES) : NULL;
+    if (!cache_blocks)
+    {
+        printf("OPL: no memory for the music cache, music is synthesized live\n");
+        free(cache_scratch);
+        cache_scratch = NULL;
+        murmdoom_music_cache = 0;
     }
-#endif
+}
 
-        // Repeatedly call the OPL emulator update function until the buffer is
-        // full.
-        filled = 0;
-        buffer_samples = audio_buffer->max_sample_count;
-
-//#if PICO_ON_DEVICE
-//        absolute_time_t t0 = get_absolute_time();
-//        gpio_set_mask(1);
-//#endif
-        while (filled < buffer_samples) {
-//#if PICO_ON_DEVICE
-//            gpio_set_mask(32);
-//#endif
-            uint64_t next_callback_time;
-            uint64_t nsamples;
-
-            Pico_LockMutex(&callback_queue_mutex);
-
-            // Work out the time until the next callback waiting in
-            // the callback queue must be invoked.  We can then fill the
-            // buffer with this many samples.
-
-            if (opl_pico_paused || OPL_Queue_IsEmpty(callback_queue)) {
-                nsamples = buffer_samples - filled;
-            } else {
-                next_callback_time = OPL_Queue_Peek(callback_queue) + pause_offset;
+static void CacheStatsReset(void)
+{
+    memset(&cache_stats, 0, sizeof(cache_stats));
+    cache_stats.start_us = time_us_32();
+}
 
-                nsamples = (next_callback_time - current_time) * PICO_SOUND_SAMPLE_FREQ;
-                nsamples = (nsamples + OPL_SECOND - 1) / OPL_SECOND;
+static void CacheReport(void)
+{
+    const uint32_t elapsed_ms = (time_us_32() - cache_stats.start_us) / 1000;
+    const uint32_t rendered = cache_stats.rendered ? cache_stats.rendered : 1;
+    const uint32_t synth_us = (uint32_t)(cache_stats.synth_us / rendered);
+    const uint32_t encode_us = (uint32_t)(cache_stats.encode_us / rendered);
+    const uint32_t decode_us = (uint32_t)(cache_stats.decode_us / (cache_stats.played ? cache_stats.played : 1));
+    // Synthesis the mixer did not have to do, less the decoding it did.
+    const int64_t saved_us = (int64_t) cache_stats.played * ((int64_t) synth_us - decode_us);
+
+    printf("opl: music cache %d ms, %lu blocks (%lu KB of PSRAM) peak this song\n",
+           murmdoom_music_cache, (unsigned long)cache_stats.peak_blocks,
+           (unsigned long)(cache_stats.peak_blocks * OPL_IMA_BLOCK_BYTES(cache_samples) / 1024));
+    printf("opl: %lu buffers decoded, %lu live; ahead %lu us synth + %lu us encode, decode %lu us per buffer\n",
+           (unsigned long)cache_stats.played, (unsigned long)cache_stats.live,
+           (unsigned long)synth_us, (unsigned long)encode_us, (unsigned long)decode_us);
+    printf("opl: mixer saved %ld us per second over %lu s\n",
+           (long)(elapsed_ms ? saved_us * 1000 / elapsed_ms : 0), (unsigned long)(elapsed_ms / 1000));
+}
 
-                if (nsamples > buffer_samples - filled) {
-                    nsamples = buffer_samples - filled;
-                }
-            }
+static void OPL_Pico_CacheCommand(int argc, char **argv)
+{
+    if (argc > 1)
+    {
+        murmdoom_music_cache = strcmp(argv[1], "off") ? atoi(argv[1]) : 0;
+        if (murmdoom_music_cache > CACHE_MAX_MS)
+        {
+            murmdoom_music_cache = CACHE_MAX_MS;
+        }
+        CacheAllocate();
+    }
+    if (murmdoom_music_cache > 0)
+    {
+        CacheReport();
+    }
+    else
+    {
+        printf("opl: music cache off\n");
+    }
+}
+
+// Run the sequencer and the synth for the next buffer_samples samples.
 
-            Pico_UnlockMutex(&callback_queue_mutex);
+static void RenderBuffer(int16_t *out, unsigned int buffer_samples)
+{
+    unsigned int filled;
 
-            // Add emulator output to buffer.
+    // Sequence the whole buffer, then render it in segments split at the
+    // register writes.
+    RunSequencer(synth_sample + buffer_samples);
 
-            //OPL3_GenerateStream(&opl_chip, (Bit16s *) (audio_buffer->buffer->bytes + filled * 4), nsamples);
+    filled = 0;
+    while (filled < buffer_samples) {
+        const unsigned int nsamples = ApplyDueWrites(buffer_samples - filled);
+
+        // Add emulator output to buffer.
+
+        //OPL3_GenerateStream(&opl_chip, (Bit16s *) (out + filled * 2), nsamples);
 #if USE_WOODY_OPL
-            int16_t *sndptr = (int16_t *) (audio_buffer->buffer->bytes + filled * 4);
-            // todo store in stereo?
-            adlib_getsample(sndptr, nsamples);
-            for(int i=nsamples-1; i>=0; i--) {
-                sndptr[i*2] = sndptr[i*2 + 1] = sndptr[i];
-            }
+        int16_t *sndptr = out + filled * 2;
+        // todo store in stereo?
+        adlib_getsample(sndptr, nsamples);
+        for(int i=nsamples-1; i>=0; i--) {
+            sndptr[i*2] = sndptr[i*2 + 1] = sndptr[i];
+        }
 #elif USE_EMU8950_OPL
-            if (nsamples) {
-                // Safety check
-                if (filled + nsamples > buffer_samples) {
-                    nsamples = buffer_samples - filled;
-                }
-                
-                // OPL outputs 32-bit samples but audio buffer expects 16-bit
-                // Use file-scope buffer to avoid any stack/corruption issues
-                OPL_calc_buffer_stereo(emu8950_opl, opl_temp_buffer, nsamples);
-                
-                // Convert 32-bit packed stereo to 16-bit separate L/R channels
-                // OPL_calc_buffer_stereo writes: buffer[i] = (left << 16) | right
-                // where left and right are the same (mono duplicated to stereo)
-                int16_t *buffer_start = (int16_t *)audio_buffer->buffer->bytes;
-                int16_t *sndptr16 = buffer_start + (filled * 2); // filled samples × 2 channels
-                for (unsigned int i = 0; i < nsamples; i++) {
-                    // Each opl_temp_buffer[i] contains both channels packed
-                    int32_t packed = opl_temp_buffer[i];
-                    int16_t left = (int16_t)(packed >> 16);
-                    int16_t right = (int16_t)(packed & 0xFFFF);
-                    sndptr16[i * 2] = left;
-                    sndptr16[i * 2 + 1] = right;
-                }
-            }
+        int16_t *sndptr16 = out + filled * 2;
+        const uint32_t t0 = time_us_32();
+        if (bank2_enabled) {
+            // Both banks accumulate; converted once the buffer is full.
+            PROF_SCOPE(PROF_OPL);
+            __dmb();
+            multicore_fifo_push_blocking(filled << 16 | nsamples);
+            OPL_calc_buffer_linear(emu8950_opl, (int32_t *)sndptr16, nsamples);
+            buffer_render_us[0] += time_us_32() - t0;
+            multicore_fifo_pop_blocking();
+            __dmb();
+        } else {
+            // Rendered, amplified and saturated in place in the I2S buffer.
+            OPL_calc_buffer_stereo_s16(emu8950_opl, sndptr16, nsamples, OPL_GAIN_SHIFT);
+            buffer_render_us[0] += time_us_32() - t0;
+        }
 #else
-            int16_t *sndptr = (int16_t *) (audio_buffer->buffer->bytes + filled * 4);
-            for(int i = 0; i < nsamples; i++)
-            {
-                OPL3_GenerateResampled(&opl_chip, sndptr);
-                sndptr += 2;
-            }
+        int16_t *sndptr = out + filled * 2;
+        for(int i = 0; i < nsamples; i++)
+        {
+            OPL3_GenerateResampled(&opl_chip, sndptr);
+            sndptr += 2;
+        }
+#endif
+        filled += nsamples;
+        synth_sample += nsamples;
+    }
+#if USE_EMU8950_OPL
+    if (bank2_enabled) {
+        const uint32_t t0 = time_us_32();
+        OPL_mix_stereo_s16(out, bank2_buffer, buffer_samples, OPL_GAIN_SHIFT);
+        buffer_render_us[0] += time_us_32() - t0;
+    }
+    render_stats.buffers++;
+    render_stats.buffer_samples = buffer_samples;
+    for (int core = 0; core < 2; ++core) {
+        const uint32_t us = buffer_render_us[core];
+        render_stats.total_us[core] += us;
+        if (us > render_stats.max_us[core]) render_stats.max_us[core] = us;
+        buffer_render_us[core] = 0;
+    }
 #endif
-            filled += nsamples;
+#if !USE_WOODY_OPL && !USE_EMU8950_OPL
+    // Amplify by 8x for audible output
+    for(uint i=0;i<buffer_samples * 2; i++) {
+        out[i] <<= OPL_GAIN_SHIFT;
+    }
+#endif
+}
 
-            // Invoke callbacks for this point in time.
+void OPL_Pico_RenderAhead(uint32_t budget_us)
+{
+    const uint32_t start = time_us_32();
 
-//#if PICO_ON_DEVICE
-//            gpio_clr_mask(32);
-//#endif
-            AdvanceTime(nsamples);
-        }
-        audio_buffer->sample_count = audio_buffer->max_sample_count;
-#if !USE_WOODY_OPL
-        // Amplify by 8x for audible output
-        int16_t *samples = (int16_t *)audio_buffer->buffer->bytes;
-        for(uint i=0;i<audio_buffer->sample_count * 2; i++) {
-            samples[i] <<= 3;
+    if (!audio_was_initialized || !cache_blocks || opl_pico_paused || !cache_samples)
+    {
+        return;
+    }
+
+    while (cache_head - cache_tail < CacheDepth()
+        && time_us_32() - start + cache_block_us + CACHE_MARGIN_US <= budget_us)
+    {
+        const uint32_t t0 = time_us_32();
+        RenderBuffer(cache_scratch, cache_samples);
+        const uint32_t t1 = time_us_32();
+        opl_ima_encode(&cache_ima, CacheBlock(cache_head), cache_scratch, cache_samples);
+        const uint32_t t2 = time_us_32();
+
+        cache_head++;
+        cache_stats.rendered++;
+        cache_stats.synth_us += t1 - t0;
+        cache_stats.encode_us += t2 - t1;
+        if (cache_head - cache_tail > cache_stats.peak_blocks)
+        {
+            cache_stats.peak_blocks = cache_head - cache_tail;
         }
+        cache_block_us = cache_block_us ? cache_block_us + ((int32_t)(t2 - t0 - cache_block_us) >> 3) : t2 - t0;
+    }
+}
+
+void __murmdoom_hot(OPL_Pico_Mix_callback)(audio_buffer_t *audio_buffer)
+{
+    if (!audio_buffer || !audio_buffer->buffer) {
+        return;
+    }
+    
+    int16_t *out = (int16_t *)audio_buffer->buffer->bytes;
+    const unsigned int buffer_samples = audio_buffer->max_sample_count;
+    audio_buffer->sample_count = buffer_samples;
+#if DOOM_TINY
+    if (restart_song_state == 2) {
+        RestartSong(0);
+    }
 #endif
-//#if PICO_ON_DEVICE
-//        gpio_clr_mask(1);
-//        int32_t t = (int32_t)absolute_time_diff_us(t0, get_absolute_time());
-//        static int max_t;
-//        static int ii;
-//        static int total;
-//        total += t;
-//        if (t > max_t) {
-//            max_t = t;
-//        }
-//        ii++;
-//        if (!(ii &127)) {
-//            printf("AVG %d MAX %d\n", total / 128, max_t);
-//            max_t = 0;
-//            total = 0;
-//        }
-//#endif
+
+    if (cache_head != cache_tail && buffer_samples == cache_samples) {
+        if (opl_pico_paused) {
+            // Hold the rendered music until the song resumes.
+            memset(out, 0, buffer_samples * 4);
+            return;
+        }
+        const uint32_t t0 = time_us_32();
+        opl_ima_decode(out, CacheBlock(cache_tail), buffer_samples);
+        cache_stats.decode_us += time_us_32() - t0;
+        cache_stats.played++;
+        cache_tail++;
+        return;
+    }
+
+    // Nothing rendered ahead: synthesize live. Anything queued for another
+    // buffer size is dropped.
+    cache_tail = cache_head;
+    cache_samples = buffer_samples;
+    if (cache_blocks) {
+        cache_stats.live++;
+    }
+    RenderBuffer(out, buffer_samples);
 }
 
 static void OPL_Pico_Shutdown(void)
@@ -336,13 +617,20 @@ static int OPL_Pico_Init(unsigned int port_base)
         // Queue structure of callbacks to invoke.
 
         callback_queue = OPL_Queue_Create();
+        opl_ring_init(&reg_ring);
+        CacheAllocate();
+        CacheStatsReset();
         current_time = 0;
+        synth_sample = 0;
+        write_sample = 0;
 
 
 #if USE_WOODY_OPL
         adlib_init(mixing_freq);
 #elif USE_EMU8950_OPL
-        emu8950_opl = OPL_new(3579552, PICO_SOUND_SAMPLE_FREQ); // todo check rate
+        emu8950_opl = OPL_new(OPL_CLOCK, PICO_SOUND_SAMPLE_FREQ); // todo check rate
+        murmdoom_console_register("opl", "[reset] OPL voices and render time per audio buffer on each core",
+                                  OPL_Pico_StatsCommand);
 #else
         OPL3_Reset(&opl_chip, PICO_SOUND_SAMPLE_FREQ);
         opl_opl3mode = 0;
@@ -352,6 +640,8 @@ static int OPL_Pico_Init(unsigned int port_base)
         //    // as a postmix and not using Mix_HookMusic() as the latter disables
         //    // normal Pico_mixer music mixing.
         //    Mix_SetPostMix(OPL_Mix_Callback, NULL);
+        murmdoom_console_register("musiccache", "[ms|off] render music ahead into PSRAM; decoded, saved CPU",
+                                  OPL_Pico_CacheCommand);
         I_PicoSoundSetMusicGenerator(OPL_Pico_Mix_callback);
         audio_was_initialized = 1;
     } else {
@@ -439,15 +729,51 @@ static void WriteRegister(unsigned int reg_num, unsigned int value)
 
             break;
 #endif
+        default:
+            if (!opl_ring_push(&reg_ring, (uint32_t) write_sample, reg_num, value))
+            {
+                // Full: only possible with the synth behind on this same
+                // core, so the oldest write is already due. Make room by
+                // applying it now.
+                uint32_t old_reg, old_value;
+                opl_ring_pop(&reg_ring, &old_reg, &old_value);
+                ApplyRegister(old_reg, old_value);
+                opl_ring_push(&reg_ring, (uint32_t) write_sample, reg_num, value);
+            }
+            break;
+    }
+}
+
+// Synth side of WriteRegister, called between render segments.
+
+static void ApplyRegister(unsigned int reg_num, unsigned int value)
+{
+    switch (reg_num)
+    {
+#if USE_EMU8950_OPL
         case OPL_REG_NEW:
-#if !USE_WOODY_OPL && !USE_EMU8950_OPL
+            SetBank2Enabled((value & 0x01) != 0);
+            break;
+
+        case OPL_REG_4OP:
+            break;
+#else
+        case OPL_REG_NEW:
+#if !USE_WOODY_OPL
             opl_opl3mode = value & 0x01;
+#endif
 #endif
         default:
 #if USE_WOODY_OPL
             adlib_write(reg_num, value);
 #elif USE_EMU8950_OPL
-            OPL_writeReg(emu8950_opl, reg_num, value);
+            if (reg_num & 0x100) {
+                if (bank2_enabled) {
+                    OPL_writeReg(emu8950_opl_bank2, reg_num & 0xff, value);
+                }
+            } else {
+                OPL_writeReg(emu8950_opl, reg_num, value);
+            }
 #else
             OPL3_WriteRegBuffered(&opl_chip, reg_num, value);
 #endif
@@ -474,27 +800,29 @@ static void OPL_Pico_PortWrite(opl_port_t port, unsigned int value)
 static void OPL_Pico_SetCallback(uint64_t us, opl_callback_t callback,
                                 void *data)
 {
-    Pico_LockMutex(&callback_queue_mutex);
     OPL_Queue_Push(callback_queue, callback, data,
                    current_time - pause_offset + us);
-    Pico_UnlockMutex(&callback_queue_mutex);
 }
 
 static void OPL_Pico_ClearCallbacks(void)
 {
-    Pico_LockMutex(&callback_queue_mutex);
     OPL_Queue_Clear(callback_queue);
-    Pico_UnlockMutex(&callback_queue_mutex);
+
+    // The song is stopping: drop what was rendered ahead of it.
+    cache_tail = cache_head;
+    opl_ima_reset(&cache_ima);
+    CacheStatsReset();
 }
 
+// Callbacks only run from the mix callback, on the core making these calls,
+// and the synth only sees reg_ring; nothing to lock.
+
 static void OPL_Pico_Lock(void)
 {
-    Pico_LockMutex(&callback_mutex);
 }
 
 static void OPL_Pico_Unlock(void)
 {
-    Pico_UnlockMutex(&callback_mutex);
 }
 
 static void OPL_Pico_SetPaused(int paused)
@@ -504,9 +832,7 @@ static void OPL_Pico_SetPaused(int paused)
 
 static void OPL_Pico_AdjustCallbacks(unsigned int old_tempo, unsigned int new_tempo)
 {
-    Pico_LockMutex(&callback_queue_mutex);
     OPL_Queue_AdjustCallbacks(callback_queue, current_time, old_tempo, new_tempo);
-    Pico_UnlockMutex(&callback_queue_mutex);
 }
 
 const opl_driver_t opl_pico_driver =
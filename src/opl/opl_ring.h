@@ -0,0 +1,82 @@
+#pragma once
+
+// Timestamped OPL register writes, single producer / single consumer.
+//
+// The music sequencer (TrackTimerCallback, RestartSong and the music API)
+// produces writes stamped with the output sample they take effect at; the
+// synth consumes them between render segments, splitting the buffer so each
+// lands on its exact sample. Producer and consumer share nothing but the
+// head and tail indices, each written by one side only, so the two can run
+// on different cores without a lock.
+//
+// An entry packs the low 15 bits of the sample stamp, the 9-bit register
+// (0x100 set for the second bank) and the value into one word. Writes are
+// never stamped more than one audio buffer ahead of the synth, so the
+// 32768-sample window is unambiguous.
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "pico.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define OPL_RING_SIZE 1024u                 // power of two
+#define OPL_RING_STAMP_BITS 15
+
+typedef struct {
+    uint32_t entries[OPL_RING_SIZE];
+    volatile uint32_t head;                 // written by the producer
+    volatile uint32_t tail;                 // written by the consumer
+} opl_ring_t;
+
+static inline void opl_ring_init(opl_ring_t *ring) {
+    ring->head = ring->tail = 0;
+}
+
+static inline bool opl_ring_empty(const opl_ring_t *ring) {
+    return ring->head == ring->tail;
+}
+
+static inline bool opl_ring_full(const opl_ring_t *ring) {
+    return ring->head - ring->tail == OPL_RING_SIZE;
+}
+
+// Producer. False when full.
+static inline bool opl_ring_push(opl_ring_t *ring, uint32_t sample, uint32_t reg, uint32_t value) {
+    const uint32_t head = ring->head;
+    if (head - ring->tail == OPL_RING_SIZE) return false;
+    ring->entries[head & (OPL_RING_SIZE - 1)] =
+        sample << (32 - OPL_RING_STAMP_BITS) | (reg & 0x1ff) << 8 | (value & 0xff);
+    __dmb();                                // entry visible before the index
+    ring->head = head + 1;
+    return true;
+}
+
+// Consumer: samples from `now` until the oldest write is due (0 when it is
+// due now or late). Only valid when the ring is not empty.
+static inline uint32_t opl_ring_due_in(const opl_ring_t *ring, uint32_t now) {
+    __dmb();                                // index read before the entry
+    const uint32_t entry = ring->entries[ring->tail & (OPL_RING_SIZE - 1)];
+    // Difference of the 15-bit stamps, sign-extended.
+    const int32_t delta = (int32_t)((entry - (now << (32 - OPL_RING_STAMP_BITS)))
+                                    & ~((1u << (32 - OPL_RING_STAMP_BITS)) - 1)) >> (32 - OPL_RING_STAMP_BITS);
+    return delta > 0 ? (uint32_t)delta : 0;
+}
+
+// Consumer: remove the oldest write. Only valid when the ring is not empty.
+static inline void opl_ring_pop(opl_ring_t *ring, uint32_t *reg, uint32_t *value) {
+    const uint32_t tail = ring->tail;
+    __dmb();                                // index read before the entry
+    const uint32_t entry = ring->entries[tail & (OPL_RING_SIZE - 1)];
+    *reg = (entry >> 8) & 0x1ff;
+    *value = entry & 0xff;
+    __dmb();                                // entry read before the slot is released
+    ring->tail = tail + 1;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -28,6 +28,7 @@
 #include "deh_main.h"
 #include "i_sound.h"
 #include "i_swap.h"
+#include "m_argv.h"
 #include "m_misc.h"
 #include "w_wad.h"
 #include "z_zone.h"
@@ -384,6 +385,9 @@ static unsigned int last_perc_count;
 // adlib chip.
 
 should_be_const constcharstar snd_dmxoption = "";
+// Murmdoom: 18-voice OPL3 music, as DMXOPTION "-opl3" does; the second
+// register bank is rendered on core 1.
+int murmdoom_opl3 = 0;
 int opl_io_port = 0x388;
 
 // If true, OPL sound channels are reversed to their correct arrangement
@@ -1863,7 +1867,8 @@ static boolean I_OPL_InitMusic(void)
         dmxoption = snd_dmxoption != NULL ? snd_dmxoption : "";
     }
 
-    if (chip_type == OPL_INIT_OPL3 && strstr(dmxoption, "-opl3") != NULL)
+    if (chip_type == OPL_INIT_OPL3
+     && (strstr(dmxoption, "-opl3") != NULL || murmdoom_opl3 || M_CheckParm("-opl3") > 0))
     {
         opl_opl3mode = 1;
         num_opl_voices = OPL_NUM_VOICES * 2;
@@ -34,6 +34,9 @@
 #include "doomtype.h"
 #include "i_picosound.h"
 #include "murmdoom_log.h"
+#include "murmdoom_hot.h"
+#include "murmdoom_prof.h"
+#include "murmdoom_resample.h"
 #define none pico_audio_enum_none
 #include "pico/audio_i2s.h"
 #undef none
@@ -55,12 +58,6 @@
 
 #define ADPCM_BLOCK_SIZE 128
 #define ADPCM_SAMPLES_PER_BLOCK_SIZE 249
-#define LOW_PASS_FILTER
-
-// Enable low-pass filtering to reduce resampling artifacts
-#ifndef SOUND_LOW_PASS
-#define SOUND_LOW_PASS 1
-#endif
 
 // Enable increased I2S drive strength for cleaner signal
 #ifndef INCREASE_I2S_DRIVE_STRENGTH
@@ -88,10 +85,9 @@ struct channel_s
     uint8_t left, right; // 0-255
     uint8_t decompressed_size;
     boolean is_adpcm;
-#if SOUND_LOW_PASS
-    uint8_t alpha256;
-#endif
-    int8_t decompressed[ADPCM_SAMPLES_PER_BLOCK_SIZE];
+    // [0] is the last sample of the previous block, for interpolation
+    // (murmdoom_resample.h); the block starts at [1].
+    int8_t decompressed[1 + ADPCM_SAMPLES_PER_BLOCK_SIZE];
 };
 
 static struct audio_buffer_pool *producer_pool;
@@ -151,16 +147,6 @@ static boolean sound_initialized = false;
 static channel_t channels[NUM_SOUND_CHANNELS];
 static boolean use_sfx_prefix = true;
 
-static inline int16_t clamp_s16(int32_t v) {
-    if (v > INT16_MAX) {
-        return (int16_t)INT16_MAX;
-    }
-    if (v < INT16_MIN) {
-        return (int16_t)INT16_MIN;
-    }
-    return (int16_t)v;
-}
-
 static inline const sfxinfo_t *base_sfxinfo(const sfxinfo_t *sfx)
 {
     return (sfx != NULL && sfx->link != NULL) ? sfx->link : sfx;
@@ -202,7 +188,7 @@ static bool check_and_init_channel(int channel) {
     return sound_initialized && ((uint)channel) < NUM_SOUND_CHANNELS;
 }
 
-int adpcm_decode_block_s8(int8_t *outbuf, const uint8_t *inbuf, int inbufsize)
+int __murmdoom_hot(adpcm_decode_block_s8)(int8_t *outbuf, const uint8_t *inbuf, int inbufsize)
 {
 #if 1
     int samples = 1, chunks;
@@ -268,22 +254,23 @@ int adpcm_decode_block_s8(int8_t *outbuf, const uint8_t *inbuf, int inbufsize)
 #endif
 }
 
-static void decompress_buffer(channel_t *channel) {
+static void __murmdoom_hot(decompress_buffer)(channel_t *channel) {
     if (channel->data == channel->data_end) {
         channel->decompressed_size = 0;
     } else {
+        int8_t *block = channel->decompressed + 1;
+        block[-1] = channel->decompressed_size ? block[channel->decompressed_size - 1] : 0;
         if (channel->is_adpcm) {
             int block_size = MIN(ADPCM_BLOCK_SIZE, channel->data_end - channel->data);
-            channel->decompressed_size = adpcm_decode_block_s8(channel->decompressed, channel->data, block_size);
-            assert(channel->decompressed_size && channel->decompressed_size <= sizeof(channel->decompressed));
+            channel->decompressed_size = adpcm_decode_block_s8(block, channel->data, block_size);
+            assert(channel->decompressed_size && channel->decompressed_size <= ADPCM_SAMPLES_PER_BLOCK_SIZE);
             channel->data += block_size;
         } else {
-            int block_size = MIN((int)sizeof(channel->decompressed), channel->data_end - channel->data);
+            int block_size = MIN(ADPCM_SAMPLES_PER_BLOCK_SIZE, channel->data_end - channel->data);
             channel->decompressed_size = block_size;
-            assert(channel->decompressed_size && channel->decompressed_size <= sizeof(channel->decompressed));
             const uint8_t *src = channel->data;
             for (int i = 0; i < block_size; ++i) {
-                channel->decompressed[i] = (int8_t)src[i];
+                block[i] = (int8_t)src[i];
             }
             channel->data += block_size;
         }
@@ -344,16 +331,9 @@ static boolean init_channel_for_sfx(channel_t *ch, const sfxinfo_t *sfxinfo, int
     else
         ch->step = (uint32_t)((sample_freq * pitch) * 65536ull / (PICO_SOUND_SAMPLE_FREQ * pitch));
 
+    ch->decompressed_size = 0; // no previous block to interpolate from
     decompress_buffer(ch); // we need non-zero decompressed size if playing
     ch->offset = 0;
-
-#if SOUND_LOW_PASS
-//    const float dt = 1.0f / PICO_SOUND_SAMPLE_FREQ;
-//    const float rc = 1.0f / (3.14f * sample_freq);
-//    const float alpha = dt / (rc + dt);
-//    ch->alpha256 = (int)(256*alpha);
-    ch->alpha256 = 256u * 201u * sample_freq / (201u * sample_freq + 64u * (uint)PICO_SOUND_SAMPLE_FREQ);
-#endif
     return true;
 }
 
@@ -445,8 +425,10 @@ static boolean I_Pico_SoundIsPlaying(int channel)
     return is_channel_playing(channel);
 }
 
-static void mix_audio_buffer(audio_buffer_t *buffer)
+static void __murmdoom_hot(mix_audio_buffer)(audio_buffer_t *buffer)
 {
+    PROF_SCOPE(PROF_MIX);
+
     if (music_generator) {
         music_generator(buffer);
     } else {
@@ -466,27 +448,15 @@ static void mix_audio_buffer(audio_buffer_t *buffer)
         uint offset_end = channel->decompressed_size * 65536;
         assert(channel->offset < offset_end);
         int16_t *samples = (int16_t *)buffer->buffer->bytes;
-#if SOUND_LOW_PASS
-        int alpha256 = channel->alpha256;
-        int beta256 = 256 - alpha256;
-        int sample = channel->decompressed[channel->offset >> 16];
-#endif
-        for(int s=0;s<buffer->max_sample_count;s++) {
-#if !SOUND_LOW_PASS
-            int sample = channel->decompressed[channel->offset >> 16];
-#else
-            sample = (beta256 * sample + alpha256 * channel->decompressed[channel->offset >> 16]) / 256;
-#endif
-            int32_t mixed_left = samples[0];
-            mixed_left += sample * voll;
-            samples[0] = clamp_s16(mixed_left);
-
-            int32_t mixed_right = samples[1];
-            mixed_right += sample * volr;
-            samples[1] = clamp_s16(mixed_right);
-
-            samples += 2;
-            channel->offset += channel->step;
+        uint32_t remaining = buffer->max_sample_count;
+        while (remaining) {
+            // Every output sample up to the end of this block in one run.
+            uint32_t run = resample_run(channel->offset, offset_end, channel->step);
+            if (run > remaining) run = remaining;
+            channel->offset = resample_mix_s8(samples, run, channel->decompressed + 1, channel->offset,
+                                              channel->step, voll, volr);
+            samples += run * 2;
+            remaining -= run;
             if (channel->offset >= offset_end) {
                 channel->offset -= offset_end;
                 decompress_buffer(channel);